@@ -0,0 +1,103 @@
+#include "BodyStateStore.h"
+#include "RigidBody.h"
+
+BodyStateStore::BodyStateStore() : m_buffers(), m_current(&m_buffers[0]), m_next(&m_buffers[1]), m_owners(), m_releasedCount(0)
+{
+}
+
+BodyStateStore::~BodyStateStore() = default;
+
+unsigned int BodyStateStore::Allocate(RigidBody* owner, const XMVECTOR& position, const XMVECTOR& velocity)
+{
+	for (auto& buffer : m_buffers)
+	{
+		buffer.positions.push_back(position);
+		buffer.velocities.push_back(velocity);
+	}
+
+	m_owners.push_back(owner);
+
+	return static_cast<unsigned int>(m_owners.size() - 1);
+}
+
+void BodyStateStore::Release(const unsigned int slot)
+{
+	m_owners[slot] = nullptr;
+	m_releasedCount++;
+}
+
+void BodyStateStore::Compact()
+{
+	if (m_releasedCount == 0)
+	{
+		return;
+	}
+
+	auto slotCount = 0u;
+
+	for (auto slot = 0u; slot < m_owners.size(); slot++)
+	{
+		if (!m_owners[slot])
+		{
+			continue;
+		}
+
+		if (slot != slotCount)
+		{
+			for (auto& buffer : m_buffers)
+			{
+				buffer.positions[slotCount] = buffer.positions[slot];
+				buffer.velocities[slotCount] = buffer.velocities[slot];
+			}
+
+			m_owners[slotCount] = m_owners[slot];
+			m_owners[slotCount]->SetBodyStateSlot(slotCount);
+		}
+
+		slotCount++;
+	}
+
+	for (auto& buffer : m_buffers)
+	{
+		buffer.positions.resize(slotCount);
+		buffer.velocities.resize(slotCount);
+	}
+
+	m_owners.resize(slotCount);
+	m_releasedCount = 0;
+}
+
+unsigned int BodyStateStore::GetSlotCount() const
+{
+	return static_cast<unsigned int>(m_owners.size());
+}
+
+RigidBody* BodyStateStore::GetOwner(const unsigned int slot) const
+{
+	return m_owners[slot];
+}
+
+void BodyStateStore::Swap()
+{
+	swap(m_current, m_next);
+}
+
+const BodyStateStore::Buffer& BodyStateStore::GetCurrent() const
+{
+	return *m_current;
+}
+
+BodyStateStore::Buffer& BodyStateStore::GetCurrent()
+{
+	return *m_current;
+}
+
+const BodyStateStore::Buffer& BodyStateStore::GetNext() const
+{
+	return *m_next;
+}
+
+BodyStateStore::Buffer& BodyStateStore::GetNext()
+{
+	return *m_next;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+using namespace DirectX;
+using namespace std;
+
+class RigidBody;
+
+auto const CACHE_LINE_SIZE = 64u;
+
+//Gives every allocation its own cache lines from the start, so a run of slots whose size is a multiple of a line is never split across one
+template <typename T>
+class CacheLineAllocator
+{
+public:
+	typedef T value_type;
+
+	CacheLineAllocator() = default; // Default Constructor
+	template <typename U>
+	CacheLineAllocator(const CacheLineAllocator<U>&) noexcept {} // Converting Constructor
+
+	T* allocate(const size_t count)
+	{
+		const auto size = (count * sizeof(T) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+
+#ifdef _WIN32
+		auto* memory = _aligned_malloc(size, CACHE_LINE_SIZE);
+#else
+		auto* memory = aligned_alloc(CACHE_LINE_SIZE, size);
+#endif
+
+		if (!memory)
+		{
+			throw bad_alloc();
+		}
+
+		return static_cast<T*>(memory);
+	}
+
+	void deallocate(T* memory, const size_t)
+	{
+#ifdef _WIN32
+		_aligned_free(memory);
+#else
+		free(memory);
+#endif
+	}
+
+	template <typename U>
+	bool operator == (const CacheLineAllocator<U>&) const { return true; }
+	template <typename U>
+	bool operator != (const CacheLineAllocator<U>&) const { return false; }
+};
+
+//Position and velocity of every rigidbody, current and next, held in two structure of arrays buffers indexed by each body's slot.
+//Integration and the solver write the next buffer while the current one still holds the start of the step, then Swap makes the next
+//buffer current by exchanging the two pointers so nothing is copied. Bodies that aren't integrated keep the same values in both buffers.
+//Slots are handed out in the order bodies are added and Compact closes the gaps removed bodies leave without reordering the rest, so
+//slot order is always the order of the game object list. Both arrays start on a cache line, see INTEGRATION_CHUNK_SIZE
+class BodyStateStore
+{
+public:
+	struct Buffer {
+		vector<XMVECTOR, CacheLineAllocator<XMVECTOR>> positions;
+		vector<XMVECTOR, CacheLineAllocator<XMVECTOR>> velocities;
+	};
+
+	BodyStateStore(); // Default Constructor
+	BodyStateStore(const BodyStateStore& other) = delete; // Copy Constructor
+	BodyStateStore(BodyStateStore&& other) noexcept = delete; // Move Constructor
+	~BodyStateStore(); // Destructor
+
+	BodyStateStore& operator = (const BodyStateStore& other) = delete; // Copy Assignment Operator
+	BodyStateStore& operator = (BodyStateStore&& other) noexcept = delete; // Move Assignment Operator
+
+	//Returns the slot after every one in use with the position and velocity written to both buffers, the owner is given its new slot
+	//whenever Compact moves it
+	unsigned int Allocate(RigidBody* owner, const XMVECTOR& position, const XMVECTOR& velocity);
+
+	//Leaves the slot empty until the next Compact, so removing a lot of bodies only moves the rest once
+	void Release(const unsigned int slot);
+	void Compact();
+
+	unsigned int GetSlotCount() const;
+
+	//Null for a released slot
+	RigidBody* GetOwner(const unsigned int slot) const;
+
+	//End of step, the next buffer becomes current and the old current buffer is written over by the next step
+	void Swap();
+
+	const Buffer& GetCurrent() const;
+	Buffer& GetCurrent();
+	const Buffer& GetNext() const;
+	Buffer& GetNext();
+
+private:
+	Buffer m_buffers[2];
+
+	Buffer* m_current;
+	Buffer* m_next;
+
+	vector<RigidBody*> m_owners;
+	unsigned int m_releasedCount;
+};
@@ -0,0 +1,469 @@
+#include "BroadphaseGrid.h"
+#include <chrono>
+#include <cmath>
+
+//Buckets and bodies are split into this many ranges for the passes that have to give the same output whatever the thread count
+auto const BROADPHASE_RANGE_COUNT = 64u;
+auto const MINIMUM_BUCKET_COUNT = 1024u;
+
+//Bodies covering more cells than this are cheaper to pair with everything, as are ones too far out for their cells to be indexed
+auto const MAXIMUM_CELLS_PER_BODY = 4096ull;
+auto const MAXIMUM_CELL_INDEX = 1 << 20;
+
+//Bounds tests are a little generous so a pair the narrowphase would find touching is never dropped by rounding
+auto const BOUNDS_OVERLAP_SCALE = 1.0001f;
+
+//Half of the 26 neighbours, every pair of neighbouring cells is only looked at from one side
+const int FORWARD_NEIGHBOURS[13][3] = {
+	{ 1, 0, 0 },
+	{ -1, 1, 0 }, { 0, 1, 0 }, { 1, 1, 0 },
+	{ -1, -1, 1 }, { 0, -1, 1 }, { 1, -1, 1 },
+	{ -1, 0, 1 }, { 0, 0, 1 }, { 1, 0, 1 },
+	{ -1, 1, 1 }, { 0, 1, 1 }, { 1, 1, 1 }
+};
+
+static void RunTasks(WorkerPool* workerPool, const unsigned int taskCount, const function<void(unsigned int)>& task)
+{
+	if (workerPool)
+	{
+		workerPool->Run(taskCount, task);
+		return;
+	}
+
+	for (unsigned int i = 0; i < taskCount; i++)
+	{
+		task(i);
+	}
+}
+
+static float ElapsedMicroseconds(const chrono::steady_clock::time_point& start, const chrono::steady_clock::time_point& end)
+{
+	return chrono::duration<float, micro>(end - start).count();
+}
+
+static bool CellIndexInRange(const float position)
+{
+	return position > -MAXIMUM_CELL_INDEX && position < MAXIMUM_CELL_INDEX;
+}
+
+BroadphaseGrid::BroadphaseGrid(const float cellSize) : m_cellSize(cellSize), m_inverseCellSize(1.0f / cellSize), m_bodyCount(0), m_taskCount(0), m_bucketCount(0), m_entryCount(0), m_timings()
+{
+}
+
+BroadphaseGrid::BroadphaseGrid(const BroadphaseGrid& other) = default;
+
+BroadphaseGrid::BroadphaseGrid(BroadphaseGrid&& other) noexcept = default;
+
+BroadphaseGrid::~BroadphaseGrid() = default;
+
+BroadphaseGrid& BroadphaseGrid::operator=(const BroadphaseGrid& other) = default;
+
+BroadphaseGrid& BroadphaseGrid::operator=(BroadphaseGrid&& other) noexcept = default;
+
+void BroadphaseGrid::Build(const vector<XMFLOAT4>& bounds, WorkerPool* workerPool)
+{
+	const auto buildStart = chrono::steady_clock::now();
+
+	m_bodyCount = static_cast<unsigned int>(bounds.size());
+	m_taskCount = workerPool ? workerPool->GetThreadCount() : 1;
+
+	m_firstCells.resize(m_bodyCount);
+	m_lastCells.resize(m_bodyCount);
+	m_entryCounts.resize(m_bodyCount);
+	m_smallBodies.resize(m_bodyCount);
+
+	m_taskEntryCounts.resize(m_taskCount);
+	m_taskEntryStarts.resize(m_taskCount);
+	m_taskUnboundedBodies.resize(m_taskCount);
+
+	//Cell range of every body
+	RunTasks(workerPool, m_taskCount, [this, &bounds](const unsigned int task) { CalculateCells(bounds, task); });
+
+	m_entryCount = 0;
+	m_unboundedBodies.clear();
+
+	for (unsigned int task = 0; task < m_taskCount; task++)
+	{
+		m_taskEntryStarts[task] = m_entryCount;
+		m_entryCount += m_taskEntryCounts[task];
+
+		m_unboundedBodies.insert(m_unboundedBodies.end(), m_taskUnboundedBodies[task].begin(), m_taskUnboundedBodies[task].end());
+	}
+
+	const auto cellsDone = chrono::steady_clock::now();
+
+	//About two entries to a bucket, a power of two so the hash only needs masking
+	m_bucketCount = MINIMUM_BUCKET_COUNT;
+
+	while (m_bucketCount < m_entryCount / 2)
+	{
+		m_bucketCount *= 2;
+	}
+
+	m_entryCells.resize(m_entryCount);
+	m_entryBodies.resize(m_entryCount);
+	m_entryBuckets.resize(m_entryCount);
+
+	//Every build leaves the histograms zeroed, so only the buckets a bigger grid or more tasks add need clearing
+	m_histograms.resize(static_cast<size_t>(m_taskCount) * m_bucketCount);
+
+	//Write out the entries and count them into each task's histogram
+	RunTasks(workerPool, m_taskCount, [this](const unsigned int task) { WriteEntries(task); });
+
+	const auto entriesDone = chrono::steady_clock::now();
+
+	//Prefix sum over buckets then tasks, done a range of buckets at a time with a short serial sum of the range totals in between
+	m_bucketStarts.resize(m_bucketCount + 1);
+	m_bucketRangeTotals.resize(BROADPHASE_RANGE_COUNT);
+
+	RunTasks(workerPool, BROADPHASE_RANGE_COUNT, [this](const unsigned int range) { SumBucketRange(range); });
+
+	auto rangeStart = 0u;
+
+	for (auto& rangeTotal : m_bucketRangeTotals)
+	{
+		const auto total = rangeTotal;
+		rangeTotal = rangeStart;
+		rangeStart += total;
+	}
+
+	RunTasks(workerPool, BROADPHASE_RANGE_COUNT, [this](const unsigned int range) { OffsetBucketRange(range); });
+
+	m_bucketStarts[m_bucketCount] = m_entryCount;
+
+	m_sortedCells.resize(m_entryCount);
+	m_sortedBodies.resize(m_entryCount);
+
+	RunTasks(workerPool, m_taskCount, [this](const unsigned int task) { ScatterEntries(task); });
+
+	const auto sortDone = chrono::steady_clock::now();
+
+	//Pairs from the buckets and then pairs with the unbounded bodies, each range into its own buffer
+	m_rangePairs.resize(BROADPHASE_RANGE_COUNT * 2);
+
+	RunTasks(workerPool, BROADPHASE_RANGE_COUNT * 2, [this, &bounds](const unsigned int range)
+	{
+		if (range < BROADPHASE_RANGE_COUNT)
+		{
+			FindBucketRangePairs(bounds, range);
+		}
+		else
+		{
+			FindUnboundedPairs(range - BROADPHASE_RANGE_COUNT);
+		}
+	});
+
+	m_pairs.clear();
+
+	for (const auto& pairs : m_rangePairs)
+	{
+		m_pairs.insert(m_pairs.end(), pairs.begin(), pairs.end());
+	}
+
+	const auto pairsDone = chrono::steady_clock::now();
+
+	m_timings.cellKeys = ElapsedMicroseconds(buildStart, cellsDone);
+	m_timings.entries = ElapsedMicroseconds(cellsDone, entriesDone);
+	m_timings.sort = ElapsedMicroseconds(entriesDone, sortDone);
+	m_timings.pairs = ElapsedMicroseconds(sortDone, pairsDone);
+}
+
+const vector<BroadphaseGrid::Pair>& BroadphaseGrid::GetPairs() const
+{
+	return m_pairs;
+}
+
+const BroadphaseGrid::Timings& BroadphaseGrid::GetTimings() const
+{
+	return m_timings;
+}
+
+unsigned int BroadphaseGrid::GetEntryCount() const
+{
+	return m_entryCount;
+}
+
+void BroadphaseGrid::CalculateCells(const vector<XMFLOAT4>& bounds, const unsigned int task)
+{
+	auto& unboundedBodies = m_taskUnboundedBodies[task];
+	unboundedBodies.clear();
+
+	auto entryCount = 0u;
+
+	for (auto body = GetTaskStart(task); body < GetTaskStart(task + 1); body++)
+	{
+		const auto& bound = bounds[body];
+
+		m_entryCounts[body] = 0;
+		m_smallBodies[body] = 0;
+
+		//Also catches bodies whose position has gone to NaN or infinity
+		if (!(bound.w >= 0.0f) || !CellIndexInRange(bound.x * m_inverseCellSize) || !CellIndexInRange(bound.y * m_inverseCellSize) || !CellIndexInRange(bound.z * m_inverseCellSize) ||
+			!CellIndexInRange(bound.w * m_inverseCellSize))
+		{
+			unboundedBodies.push_back(body);
+			continue;
+		}
+
+		if (bound.w <= m_cellSize * 0.5f)
+		{
+			const Cell cell = { static_cast<int>(floor(bound.x * m_inverseCellSize)), static_cast<int>(floor(bound.y * m_inverseCellSize)), static_cast<int>(floor(bound.z * m_inverseCellSize)) };
+
+			m_firstCells[body] = cell;
+			m_lastCells[body] = cell;
+			m_entryCounts[body] = 1;
+			m_smallBodies[body] = 1;
+
+			entryCount++;
+			continue;
+		}
+
+		//Grown by the biggest small body radius so any small body touching this one has its centre in one of these cells
+		const auto reach = bound.w + m_cellSize * 0.5f;
+
+		const Cell firstCell = { static_cast<int>(floor((bound.x - reach) * m_inverseCellSize)), static_cast<int>(floor((bound.y - reach) * m_inverseCellSize)), static_cast<int>(floor((bound.z - reach) * m_inverseCellSize)) };
+		const Cell lastCell = { static_cast<int>(floor((bound.x + reach) * m_inverseCellSize)), static_cast<int>(floor((bound.y + reach) * m_inverseCellSize)), static_cast<int>(floor((bound.z + reach) * m_inverseCellSize)) };
+
+		const auto cellCount = static_cast<unsigned long long>(lastCell.x - firstCell.x + 1) * (lastCell.y - firstCell.y + 1) * (lastCell.z - firstCell.z + 1);
+
+		if (cellCount > MAXIMUM_CELLS_PER_BODY)
+		{
+			unboundedBodies.push_back(body);
+			continue;
+		}
+
+		m_firstCells[body] = firstCell;
+		m_lastCells[body] = lastCell;
+		m_entryCounts[body] = static_cast<unsigned int>(cellCount);
+
+		entryCount += static_cast<unsigned int>(cellCount);
+	}
+
+	m_taskEntryCounts[task] = entryCount;
+}
+
+void BroadphaseGrid::WriteEntries(const unsigned int task)
+{
+	auto* histogram = m_histograms.data() + static_cast<size_t>(task) * m_bucketCount;
+	auto entry = m_taskEntryStarts[task];
+
+	for (auto body = GetTaskStart(task); body < GetTaskStart(task + 1); body++)
+	{
+		if (m_entryCounts[body] == 0)
+		{
+			continue;
+		}
+
+		const auto& firstCell = m_firstCells[body];
+		const auto& lastCell = m_lastCells[body];
+
+		for (auto z = firstCell.z; z <= lastCell.z; z++)
+		{
+			for (auto y = firstCell.y; y <= lastCell.y; y++)
+			{
+				for (auto x = firstCell.x; x <= lastCell.x; x++)
+				{
+					const Cell cell = { x, y, z };
+					const auto bucket = GetBucket(cell);
+
+					m_entryCells[entry] = cell;
+					m_entryBodies[entry] = body;
+					m_entryBuckets[entry] = bucket;
+
+					histogram[bucket]++;
+					entry++;
+				}
+			}
+		}
+	}
+}
+
+void BroadphaseGrid::SumBucketRange(const unsigned int range)
+{
+	auto total = 0u;
+
+	for (auto bucket = m_bucketCount / BROADPHASE_RANGE_COUNT * range; bucket < m_bucketCount / BROADPHASE_RANGE_COUNT * (range + 1); bucket++)
+	{
+		for (unsigned int task = 0; task < m_taskCount; task++)
+		{
+			total += m_histograms[static_cast<size_t>(task) * m_bucketCount + bucket];
+		}
+	}
+
+	m_bucketRangeTotals[range] = total;
+}
+
+void BroadphaseGrid::OffsetBucketRange(const unsigned int range)
+{
+	auto offset = m_bucketRangeTotals[range];
+
+	for (auto bucket = m_bucketCount / BROADPHASE_RANGE_COUNT * range; bucket < m_bucketCount / BROADPHASE_RANGE_COUNT * (range + 1); bucket++)
+	{
+		m_bucketStarts[bucket] = offset;
+
+		//Lower tasks hold lower bodies so giving them the lower slots keeps every bucket in body order
+		for (unsigned int task = 0; task < m_taskCount; task++)
+		{
+			auto& count = m_histograms[static_cast<size_t>(task) * m_bucketCount + bucket];
+			const auto taskCount = count;
+
+			//Buckets a task has no entries in are left at zero so it only has its own buckets to clear after scattering
+			if (taskCount > 0)
+			{
+				count = offset;
+				offset += taskCount;
+			}
+		}
+	}
+}
+
+void BroadphaseGrid::ScatterEntries(const unsigned int task)
+{
+	auto* offsets = m_histograms.data() + static_cast<size_t>(task) * m_bucketCount;
+
+	for (auto entry = m_taskEntryStarts[task]; entry < m_taskEntryStarts[task] + m_taskEntryCounts[task]; entry++)
+	{
+		const auto sortedEntry = offsets[m_entryBuckets[entry]]++;
+
+		m_sortedCells[sortedEntry] = m_entryCells[entry];
+		m_sortedBodies[sortedEntry] = m_entryBodies[entry];
+	}
+
+	//Zero the buckets this task used, which are the only non zero ones in its histogram, ready for the next build
+	for (auto entry = m_taskEntryStarts[task]; entry < m_taskEntryStarts[task] + m_taskEntryCounts[task]; entry++)
+	{
+		offsets[m_entryBuckets[entry]] = 0;
+	}
+}
+
+void BroadphaseGrid::FindBucketRangePairs(const vector<XMFLOAT4>& bounds, const unsigned int range)
+{
+	auto& pairs = m_rangePairs[range];
+	pairs.clear();
+
+	const auto sameCell = [](const Cell& cellOne, const Cell& cellTwo) { return cellOne.x == cellTwo.x && cellOne.y == cellTwo.y && cellOne.z == cellTwo.z; };
+
+	const auto addPair = [&pairs, &bounds](const unsigned int bodyOne, const unsigned int bodyTwo)
+	{
+		const auto& boundsOne = bounds[bodyOne];
+		const auto& boundsTwo = bounds[bodyTwo];
+
+		const auto x = boundsOne.x - boundsTwo.x;
+		const auto y = boundsOne.y - boundsTwo.y;
+		const auto z = boundsOne.z - boundsTwo.z;
+		const auto radiusSum = (boundsOne.w + boundsTwo.w) * BOUNDS_OVERLAP_SCALE;
+
+		if (x * x + y * y + z * z <= radiusSum * radiusSum)
+		{
+			pairs.push_back(bodyOne < bodyTwo ? Pair{ bodyOne, bodyTwo } : Pair{ bodyTwo, bodyOne });
+		}
+	};
+
+	for (auto bucket = m_bucketCount / BROADPHASE_RANGE_COUNT * range; bucket < m_bucketCount / BROADPHASE_RANGE_COUNT * (range + 1); bucket++)
+	{
+		const auto bucketEnd = m_bucketStarts[bucket + 1];
+
+		for (auto entry = m_bucketStarts[bucket]; entry < bucketEnd; entry++)
+		{
+			const auto body = m_sortedBodies[entry];
+			const auto& cell = m_sortedCells[entry];
+			const auto smallBody = m_smallBodies[body] != 0;
+
+			//Everything else in the same cell, buckets can hold more than one cell so the cells are compared
+			for (auto otherEntry = entry + 1; otherEntry < bucketEnd; otherEntry++)
+			{
+				if (!sameCell(m_sortedCells[otherEntry], cell))
+				{
+					continue;
+				}
+
+				const auto otherBody = m_sortedBodies[otherEntry];
+
+				//Two large bodies can share many cells, the pair is only kept in the lowest corner of the cells they share
+				if (!smallBody && !m_smallBodies[otherBody])
+				{
+					const auto& firstCell = m_firstCells[body];
+					const auto& otherFirstCell = m_firstCells[otherBody];
+
+					const Cell sharedCorner = { max(firstCell.x, otherFirstCell.x), max(firstCell.y, otherFirstCell.y), max(firstCell.z, otherFirstCell.z) };
+
+					if (!sameCell(sharedCorner, cell))
+					{
+						continue;
+					}
+				}
+
+				addPair(body, otherBody);
+			}
+
+			//Small bodies reach into the neighbouring cells, large bodies already have an entry in every cell a small body could touch them from
+			if (!smallBody)
+			{
+				continue;
+			}
+
+			for (const auto& offset : FORWARD_NEIGHBOURS)
+			{
+				const Cell neighbour = { cell.x + offset[0], cell.y + offset[1], cell.z + offset[2] };
+				const auto neighbourBucket = GetBucket(neighbour);
+
+				const auto neighbourBucketEnd = m_bucketStarts[neighbourBucket + 1];
+
+				for (auto otherEntry = m_bucketStarts[neighbourBucket]; otherEntry < neighbourBucketEnd; otherEntry++)
+				{
+					if (!sameCell(m_sortedCells[otherEntry], neighbour))
+					{
+						continue;
+					}
+
+					const auto otherBody = m_sortedBodies[otherEntry];
+
+					if (m_smallBodies[otherBody])
+					{
+						addPair(body, otherBody);
+					}
+				}
+			}
+		}
+	}
+}
+
+void BroadphaseGrid::FindUnboundedPairs(const unsigned int range)
+{
+	auto& pairs = m_rangePairs[BROADPHASE_RANGE_COUNT + range];
+	pairs.clear();
+
+	if (m_unboundedBodies.empty())
+	{
+		return;
+	}
+
+	const auto firstBody = static_cast<unsigned int>(static_cast<unsigned long long>(m_bodyCount) * range / BROADPHASE_RANGE_COUNT);
+	const auto lastBody = static_cast<unsigned int>(static_cast<unsigned long long>(m_bodyCount) * (range + 1) / BROADPHASE_RANGE_COUNT);
+
+	for (auto body = firstBody; body < lastBody; body++)
+	{
+		const auto unbounded = m_entryCounts[body] == 0;
+
+		for (const auto unboundedBody : m_unboundedBodies)
+		{
+			//Pairs of unbounded bodies would come up from both sides, only the side with the lower unbounded body keeps them
+			if (unboundedBody == body || (unbounded && unboundedBody > body))
+			{
+				continue;
+			}
+
+			pairs.push_back(unboundedBody < body ? Pair{ unboundedBody, body } : Pair{ body, unboundedBody });
+		}
+	}
+}
+
+unsigned int BroadphaseGrid::GetBucket(const Cell& cell) const
+{
+	return (static_cast<unsigned int>(cell.x) * 73856093u ^ static_cast<unsigned int>(cell.y) * 19349663u ^ static_cast<unsigned int>(cell.z) * 83492791u) & (m_bucketCount - 1);
+}
+
+unsigned int BroadphaseGrid::GetTaskStart(const unsigned int task) const
+{
+	return static_cast<unsigned int>(static_cast<unsigned long long>(m_bodyCount) * task / m_taskCount);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+
+#include "WorkerPool.h"
+
+using namespace DirectX;
+using namespace std;
+
+//Uniform grid broadphase rebuilt from scratch every step. Bodies are bounding spheres, small ones (radius up to half a cell) go in the one cell
+//holding their centre and are paired with the cell and its 13 forward neighbours, larger ones go in every cell their bounds overlap
+//and bodies with no bounds are paired with everything. Bounded pairs are only kept if their spheres overlap. Cells are hashed into buckets and counting sorted so a build is a handful of flat passes,
+//each split over the worker pool. The pairs come out without duplicates and in the same order for any thread count
+class BroadphaseGrid
+{
+public:
+	//Lower index first, the same way round the all pairs loop tested them
+	struct Pair {
+		unsigned int first;
+		unsigned int second;
+	};
+
+	//Microseconds spent in each pass of the last build
+	struct Timings {
+		float cellKeys;
+		float entries;
+		float sort;
+		float pairs;
+	};
+
+	BroadphaseGrid(const float cellSize); // Default Constructor
+	BroadphaseGrid(const BroadphaseGrid& other); // Copy Constructor
+	BroadphaseGrid(BroadphaseGrid&& other) noexcept; // Move Constructor
+	~BroadphaseGrid(); // Destructor
+
+	BroadphaseGrid& operator = (const BroadphaseGrid& other); // Copy Assignment Operator
+	BroadphaseGrid& operator = (BroadphaseGrid&& other) noexcept; // Move Assignment Operator
+
+	//Centre in xyz and radius in w for each body, a negative radius means the body is unbounded. Passes run on the worker pool if there is one
+	void Build(const vector<XMFLOAT4>& bounds, WorkerPool* workerPool);
+
+	const vector<Pair>& GetPairs() const;
+	const Timings& GetTimings() const;
+
+	//Cell entries in the last build, one per small body plus one per overlapped cell for each large body
+	unsigned int GetEntryCount() const;
+
+private:
+	struct Cell {
+		int x;
+		int y;
+		int z;
+	};
+
+	void CalculateCells(const vector<XMFLOAT4>& bounds, const unsigned int task);
+	void WriteEntries(const unsigned int task);
+	void SumBucketRange(const unsigned int range);
+	void OffsetBucketRange(const unsigned int range);
+	void ScatterEntries(const unsigned int task);
+	void FindBucketRangePairs(const vector<XMFLOAT4>& bounds, const unsigned int range);
+	void FindUnboundedPairs(const unsigned int range);
+
+	unsigned int GetBucket(const Cell& cell) const;
+
+	//Body range of a per thread task
+	unsigned int GetTaskStart(const unsigned int task) const;
+
+	float m_cellSize;
+	float m_inverseCellSize;
+
+	unsigned int m_bodyCount;
+	unsigned int m_taskCount;
+	unsigned int m_bucketCount;
+	unsigned int m_entryCount;
+
+	//Per body, the range of cells it covers and how many entries it has (zero for unbounded bodies)
+	vector<Cell> m_firstCells;
+	vector<Cell> m_lastCells;
+	vector<unsigned int> m_entryCounts;
+	vector<unsigned char> m_smallBodies;
+
+	//Per task, how many entries its bodies made, where they start and the unbounded bodies it found
+	vector<unsigned int> m_taskEntryCounts;
+	vector<unsigned int> m_taskEntryStarts;
+	vector<vector<unsigned int>> m_taskUnboundedBodies;
+	vector<unsigned int> m_unboundedBodies;
+
+	//Entries in body order then sorted by bucket, the sort is stable so each bucket stays in body order
+	vector<Cell> m_entryCells;
+	vector<unsigned int> m_entryBodies;
+	vector<unsigned int> m_entryBuckets;
+	vector<Cell> m_sortedCells;
+	vector<unsigned int> m_sortedBodies;
+
+	//Each task's count for every bucket, turned into where each task writes its entries by the prefix sum. Laid out task by task so
+	//no two tasks write to the same cache line while counting, and zeroed again after scattering a task's entries
+	vector<unsigned int> m_histograms;
+	vector<unsigned int> m_bucketStarts;
+
+	//Entries in each fixed range of buckets, then where each range starts
+	vector<unsigned int> m_bucketRangeTotals;
+
+	//Pairs found by each fixed range, joined in range order
+	vector<vector<Pair>> m_rangePairs;
+	vector<Pair> m_pairs;
+
+	Timings m_timings;
+};
@@ -60,6 +60,11 @@ void PlaneCollider::SetNormal(const XMFLOAT3& centre, const XMFLOAT3& pointOne,
 	XMStoreFloat(&m_offsetTest, XMVector3Dot(m_normal, XMLoadFloat3(&centre)));
 }
 
+void PlaneCollider::SetNormal(const XMVECTOR& normal)
+{
+	m_normal = normal;
+}
+
 void PlaneCollider::SetOffset(const float offset)
 {
 	m_offset = offset;
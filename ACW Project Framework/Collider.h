@@ -61,6 +61,7 @@ public:
 	float GetOffset() const;
 
 	void SetNormal(const XMFLOAT3& centre, const XMFLOAT3& pointOne, const XMFLOAT3& pointTwo);
+	void SetNormal(const XMVECTOR& normal);
 	void SetOffset(const float offset);
 
 private:
@@ -1,26 +1,26 @@
 #include "CollisionManager.h"
 
 
-CollisionManager::CollisionManager(vector<GameObject*> &gameObjects, float friction, float restitution) : m_randomTexture(false), m_friction(friction), m_restitution(restitution), m_gameObjects(gameObjects), m_contactManifold(new ContactManifold())
+CollisionManager::CollisionManager(vector<GameObject*> &gameObjects, float friction, float restitution) : m_randomTexture(false), m_deterministic(false), m_friction(friction), m_restitution(restitution), m_gameObjects(gameObjects), m_contactManifold(new ContactManifold()), m_workerPool(nullptr), m_broadphaseGrid(BROADPHASE_CELL_SIZE), m_functionTable()
 {
 	//functionMap.insert(tuple<type_info(Collider*), type_info(Collider*)>(make_tuple(typeid(SphereCollider*), typeid(SphereCollider*))));
 
-	m_functionMap[make_pair(Collider::ColliderType::Sphere, Collider::ColliderType::Sphere)] = &CollisionManager::SphereOnSphereDetection;
-	m_functionMap[make_pair(Collider::ColliderType::Cylinder, Collider::ColliderType::Sphere)] = &CollisionManager::CylinderOnSphereDetection;
-	m_functionMap[make_pair(Collider::ColliderType::Sphere, Collider::ColliderType::Cylinder)] = &CollisionManager::SphereOnCylinderDetection;
-	m_functionMap[make_pair(Collider::ColliderType::Plane, Collider::ColliderType::Sphere)] = &CollisionManager::PlaneOnSphereDetection;
-	m_functionMap[make_pair(Collider::ColliderType::Sphere, Collider::ColliderType::Plane)] = &CollisionManager::SphereOnPlaneDetection;
-	m_functionMap[make_pair(Collider::ColliderType::AABBCube, Collider::ColliderType::Sphere)] = &CollisionManager::AABBOnSphereDetection;
-	m_functionMap[make_pair(Collider::ColliderType::Sphere, Collider::ColliderType::AABBCube)] = &CollisionManager::SphereOnAABBDetection;
-	m_functionMap[make_pair(Collider::ColliderType::OBBCube, Collider::ColliderType::Sphere)] = &CollisionManager::OBBOnSphereDetection;
-	m_functionMap[make_pair(Collider::ColliderType::Sphere, Collider::ColliderType::OBBCube)] = &CollisionManager::SphereOnOBBDetection;
-	m_functionMap[make_pair(Collider::ColliderType::OBBCube, Collider::ColliderType::Cylinder)] = &CollisionManager::OBBOnCylinderDetection;
-	m_functionMap[make_pair(Collider::ColliderType::Cylinder, Collider::ColliderType::OBBCube)] = &CollisionManager::CylinderOnOBBDetection;
+	m_functionTable[Collider::ColliderType::Sphere][Collider::ColliderType::Sphere] = &CollisionManager::SphereOnSphereDetection;
+	m_functionTable[Collider::ColliderType::Cylinder][Collider::ColliderType::Sphere] = &CollisionManager::CylinderOnSphereDetection;
+	m_functionTable[Collider::ColliderType::Sphere][Collider::ColliderType::Cylinder] = &CollisionManager::SphereOnCylinderDetection;
+	m_functionTable[Collider::ColliderType::Plane][Collider::ColliderType::Sphere] = &CollisionManager::PlaneOnSphereDetection;
+	m_functionTable[Collider::ColliderType::Sphere][Collider::ColliderType::Plane] = &CollisionManager::SphereOnPlaneDetection;
+	m_functionTable[Collider::ColliderType::AABBCube][Collider::ColliderType::Sphere] = &CollisionManager::AABBOnSphereDetection;
+	m_functionTable[Collider::ColliderType::Sphere][Collider::ColliderType::AABBCube] = &CollisionManager::SphereOnAABBDetection;
+	m_functionTable[Collider::ColliderType::OBBCube][Collider::ColliderType::Sphere] = &CollisionManager::OBBOnSphereDetection;
+	m_functionTable[Collider::ColliderType::Sphere][Collider::ColliderType::OBBCube] = &CollisionManager::SphereOnOBBDetection;
+	m_functionTable[Collider::ColliderType::OBBCube][Collider::ColliderType::Cylinder] = &CollisionManager::OBBOnCylinderDetection;
+	m_functionTable[Collider::ColliderType::Cylinder][Collider::ColliderType::OBBCube] = &CollisionManager::CylinderOnOBBDetection;
 
 	//Not implemented, we just treat one of the OBBs as a sphere and redirect it to a different function
-	m_functionMap[make_pair(Collider::ColliderType::OBBCube, Collider::ColliderType::Plane)] = &CollisionManager::OBBOnPlaneDetection;
-	m_functionMap[make_pair(Collider::ColliderType::Plane, Collider::ColliderType::OBBCube)] = &CollisionManager::PlaneOnOBBDetection;
-	m_functionMap[make_pair(Collider::ColliderType::OBBCube, Collider::ColliderType::OBBCube)] = &CollisionManager::OBBOnOBBDetection;
+	m_functionTable[Collider::ColliderType::OBBCube][Collider::ColliderType::Plane] = &CollisionManager::OBBOnPlaneDetection;
+	m_functionTable[Collider::ColliderType::Plane][Collider::ColliderType::OBBCube] = &CollisionManager::PlaneOnOBBDetection;
+	m_functionTable[Collider::ColliderType::OBBCube][Collider::ColliderType::OBBCube] = &CollisionManager::OBBOnOBBDetection;
 }
 
 
@@ -47,21 +47,154 @@ void CollisionManager::ToggleRandomTexture() {
 	m_randomTexture = !m_randomTexture;
 }
 
+void CollisionManager::SetDeterministic(const bool deterministic) {
+	m_deterministic = deterministic;
+}
+
+void CollisionManager::SetWorkerPool(WorkerPool* workerPool) {
+	m_workerPool = workerPool;
+}
+
 void CollisionManager::DynamicCollisionDetection() {
 	m_contactManifold->Clear();
 
-	for (unsigned int i = 0; i < m_gameObjects.size(); i++)
+	const auto objectCount = static_cast<unsigned int>(m_gameObjects.size());
+
+	m_bodyBounds.resize(objectCount);
+	m_contactBuffers.resize(DETECTION_CHUNK_COUNT);
+
+	//Chunks only write to their own bounds and buffer so they can run on any thread in any order
+	const function<void(unsigned int)> calculateBodyBounds = [this, objectCount](const unsigned int chunk) { CalculateBodyBounds(chunk, objectCount); };
+	const function<void(unsigned int)> detectChunk = [this](const unsigned int chunk) { DetectChunk(chunk); };
+
+	if (m_workerPool)
+	{
+		m_workerPool->Run(DETECTION_CHUNK_COUNT, calculateBodyBounds);
+	}
+	else
+	{
+		for (unsigned int chunk = 0; chunk < DETECTION_CHUNK_COUNT; chunk++)
+		{
+			calculateBodyBounds(chunk);
+		}
+	}
+
+	m_broadphaseGrid.Build(m_bodyBounds, m_workerPool);
+
+	if (m_workerPool)
+	{
+		m_workerPool->Run(DETECTION_CHUNK_COUNT, detectChunk);
+	}
+	else
+	{
+		for (unsigned int chunk = 0; chunk < DETECTION_CHUNK_COUNT; chunk++)
+		{
+			detectChunk(chunk);
+		}
+	}
+
+	//The broadphase gives the same pair order for any thread count, so merging in chunk order does too
+	for (const auto& contacts : m_contactBuffers)
+	{
+		m_contactManifold->Add(contacts.points);
+	}
+
+	if (m_deterministic)
 	{
-		for (unsigned int j = i + 1; j < m_gameObjects.size(); j++)
+		m_contactManifold->SortByKey();
+	}
+
+	ApplyTextureChanges();
+}
+
+void CollisionManager::CalculateBodyBounds(const unsigned int chunk, const unsigned int objectCount) {
+	const auto firstObject = static_cast<unsigned int>(static_cast<unsigned long long>(objectCount) * chunk / DETECTION_CHUNK_COUNT);
+	const auto lastObject = static_cast<unsigned int>(static_cast<unsigned long long>(objectCount) * (chunk + 1) / DETECTION_CHUNK_COUNT);
+
+	for (auto i = firstObject; i < lastObject; i++)
+	{
+		const auto* gameObject = m_gameObjects[i];
+		const auto collider = gameObject->GetColliderComponent()->GetCollider();
+
+		auto& bounds = m_bodyBounds[i];
+
+		//Planes are infinite and the cylinder tests ignore z, so both are paired with everything
+		if (collider == Collider::ColliderType::Plane || collider == Collider::ColliderType::Cylinder)
 		{
-			const auto functionPointer = m_functionMap[make_pair(m_gameObjects[i]->GetColliderComponent()->GetCollider(), m_gameObjects[j]->GetColliderComponent()->GetCollider())];
+			bounds = XMFLOAT4(0.0f, 0.0f, 0.0f, -1.0f);
+			continue;
+		}
+
+		auto position = XMVECTOR();
+		auto newPosition = XMVECTOR();
+		auto scale = XMVECTOR();
 
-			if (!functionPointer)
-			{
-				continue;
-			}
+		gameObject->GetRigidBodyComponent()->GetPosition(position);
+		gameObject->GetRigidBodyComponent()->GetNewPosition(newPosition);
+		gameObject->GetScale(scale);
 
-			(this->*functionPointer)(m_gameObjects[i], m_gameObjects[j]);
+		XMStoreFloat4(&bounds, newPosition);
+
+		if (collider == Collider::ColliderType::Sphere)
+		{
+			bounds.w = XMVectorGetX(scale);
+		}
+		else
+		{
+			//Cube tests use either position depending on what they're against, so the bounds cover both
+			bounds.w = XMVectorGetX(XMVector3Length(scale)) + XMVectorGetX(XMVector3Length(newPosition - position));
+		}
+	}
+}
+
+void CollisionManager::DetectChunk(const unsigned int chunk) {
+	auto& contacts = m_contactBuffers[chunk];
+
+	contacts.points.clear();
+	contacts.textureChanges.clear();
+
+	const auto& pairs = m_broadphaseGrid.GetPairs();
+
+	const auto firstPair = pairs.size() * chunk / DETECTION_CHUNK_COUNT;
+	const auto lastPair = pairs.size() * (chunk + 1) / DETECTION_CHUNK_COUNT;
+
+	for (auto pair = firstPair; pair < lastPair; pair++)
+	{
+		const auto i = pairs[pair].first;
+		const auto j = pairs[pair].second;
+
+		const auto functionPointer = m_functionTable[m_gameObjects[i]->GetColliderComponent()->GetCollider()][m_gameObjects[j]->GetColliderComponent()->GetCollider()];
+
+		if (!functionPointer)
+		{
+			continue;
+		}
+
+		const auto firstNewPoint = contacts.points.size();
+
+		(this->*functionPointer)(m_gameObjects[i], m_gameObjects[j], contacts);
+
+		//Some detection functions swap the objects round, so which index goes with which contactID has to be checked
+		const auto* rigidBodyOne = m_gameObjects[i]->GetRigidBodyComponent();
+
+		for (auto point = firstNewPoint; point < contacts.points.size(); point++)
+		{
+			auto& contact = contacts.points[point];
+
+			contact.sortKey = static_cast<unsigned long long>(i) << 32 | j;
+			contact.bodyIndex[0] = contact.contactID[0] == rigidBodyOne ? i : j;
+			contact.bodyIndex[1] = contact.contactID[0] == rigidBodyOne ? j : i;
+		}
+	}
+}
+
+void CollisionManager::ApplyTextureChanges() {
+	//Done after detection on the simulation thread, changing textures isn't safe from the workers
+	for (const auto& contacts : m_contactBuffers)
+	{
+		for (auto* gameObject : contacts.textureChanges)
+		{
+			gameObject->ChangeRandomTexture();
 		}
 	}
 }
@@ -71,14 +204,32 @@ ContactManifold* CollisionManager::GetContactManifoldReference() const
 	return m_contactManifold;
 }
 
-void CollisionManager::SphereOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo) {
+const BroadphaseGrid::Timings& CollisionManager::GetBroadphaseTimings() const
+{
+	return m_broadphaseGrid.GetTimings();
+}
+
+unsigned int CollisionManager::GetBroadphasePairCount() const
+{
+	return static_cast<unsigned int>(m_broadphaseGrid.GetPairs().size());
+}
+
+void CollisionManager::SphereOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts) {
+	auto* rigidBodyOne = gameObjectOne->GetRigidBodyComponent();
+	auto* rigidBodyTwo = gameObjectTwo->GetRigidBodyComponent();
+
+	if (!rigidBodyOne->GetUseGravity() && !rigidBodyTwo->GetUseGravity())
+	{
+		return;
+	}
+
 	auto sphereOnePosition = XMVECTOR();
 	auto sphereTwoPosition = XMVECTOR();
 	auto sphereOneScale = XMVECTOR();
 	auto sphereTwoScale = XMVECTOR();
 
-	gameObjectOne->GetRigidBodyComponent()->GetNewPosition(sphereOnePosition);
-	gameObjectTwo->GetRigidBodyComponent()->GetNewPosition(sphereTwoPosition);
+	rigidBodyOne->GetNewPosition(sphereOnePosition);
+	rigidBodyTwo->GetNewPosition(sphereTwoPosition);
 	gameObjectOne->GetScale(sphereOneScale);
 	gameObjectTwo->GetScale(sphereTwoScale);
 
@@ -99,30 +250,43 @@ void CollisionManager::SphereOnSphereDetection(GameObject* gameObjectOne, GameOb
 		const XMVECTOR contactPoint = sphereOnePosition + distance * 0.5f;
 
 		ManifoldPoint contact = ManifoldPoint();
-		contact.contactID[0] = gameObjectOne->GetRigidBodyComponent();
-		contact.contactID[1] = gameObjectTwo->GetRigidBodyComponent();
-		contact.contactNormal = normal;
+
+		//A static sphere is left out of the contact like the other static colliders so the solver never writes to it, the moving
+		//sphere goes first with the normal pointing towards it
+		if (rigidBodyOne->GetUseGravity())
+		{
+			contact.contactID[0] = rigidBodyOne;
+			contact.contactID[1] = rigidBodyTwo->GetUseGravity() ? rigidBodyTwo : nullptr;
+			contact.contactNormal = normal;
+		}
+		else
+		{
+			contact.contactID[0] = rigidBodyTwo;
+			contact.contactID[1] = nullptr;
+			contact.contactNormal = -normal;
+		}
+
 		contact.contactPoint = contactPoint;
 		contact.penetrationDepth = radiusSum - size;
 		contact.friction = m_friction;
 		contact.restitution = m_restitution;
 
-		m_contactManifold->Add(contact);
+		contacts.points.push_back(contact);
 
 		if (m_randomTexture)
 		{
-			gameObjectOne->ChangeRandomTexture();
-			gameObjectTwo->ChangeRandomTexture();
+			contacts.textureChanges.push_back(gameObjectOne);
+			contacts.textureChanges.push_back(gameObjectTwo);
 		}
 	}
 }
 
-void CollisionManager::CylinderOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo)
+void CollisionManager::CylinderOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts)
 {
-	SphereOnCylinderDetection(gameObjectTwo, gameObjectOne);
+	SphereOnCylinderDetection(gameObjectTwo, gameObjectOne, contacts);
 }
 
-void CollisionManager::SphereOnCylinderDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo)
+void CollisionManager::SphereOnCylinderDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts)
 {
 	auto spherePosition = XMVECTOR();
 	auto cylinderPosition = XMVECTOR();
@@ -164,16 +328,16 @@ void CollisionManager::SphereOnCylinderDetection(GameObject* gameObjectOne, Game
 		contact.friction = m_friction;
 		contact.restitution = m_restitution;
 
-		m_contactManifold->Add(contact);
+		contacts.points.push_back(contact);
 	}
 }
 
 //Just switch them around and redirect to the other function
-void CollisionManager::PlaneOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo) {
-	SphereOnPlaneDetection(gameObjectTwo, gameObjectOne);
+void CollisionManager::PlaneOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts) {
+	SphereOnPlaneDetection(gameObjectTwo, gameObjectOne, contacts);
 }
 
-void CollisionManager::SphereOnPlaneDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo) {
+void CollisionManager::SphereOnPlaneDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts) {
 	auto spherePosition = XMVECTOR();
 	auto sphereScale = XMVECTOR();
 	
@@ -206,17 +370,17 @@ void CollisionManager::SphereOnPlaneDetection(GameObject* gameObjectOne, GameObj
 		contact.friction = m_friction;
 		contact.restitution = m_restitution;
 
-		m_contactManifold->Add(contact);
+		contacts.points.push_back(contact);
 	}
 
 }
 
-void CollisionManager::AABBOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo)
+void CollisionManager::AABBOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts)
 {
-	SphereOnAABBDetection(gameObjectTwo, gameObjectOne);
+	SphereOnAABBDetection(gameObjectTwo, gameObjectOne, contacts);
 }
 
-void CollisionManager::SphereOnAABBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo)
+void CollisionManager::SphereOnAABBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts)
 {
 	//Need to get the closest point on our ABB to test against our sphere
 
@@ -271,7 +435,7 @@ void CollisionManager::SphereOnAABBDetection(GameObject* gameObjectOne, GameObje
 		contact.friction = m_friction;
 		contact.restitution = m_restitution;
 
-		m_contactManifold->Add(contact);
+		contacts.points.push_back(contact);
 	}
 
 	//This is just an ABB vs ABB collision test, oops
@@ -303,12 +467,12 @@ void CollisionManager::SphereOnAABBDetection(GameObject* gameObjectOne, GameObje
 	//auto wehaveacollisionboys = 0.0f;
 }
 
-void CollisionManager::OBBOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo)
+void CollisionManager::OBBOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts)
 {
-	SphereOnOBBDetection(gameObjectTwo, gameObjectOne);
+	SphereOnOBBDetection(gameObjectTwo, gameObjectOne, contacts);
 }
 
-void CollisionManager::SphereOnOBBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo)
+void CollisionManager::SphereOnOBBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts)
 {
 	//Projects the spherePosition within the local space of our OBB cube to get the closest point to it and then back to world coordinates to
 	//test the distance between the sphere and the closest point on our OBB
@@ -427,7 +591,7 @@ void CollisionManager::SphereOnOBBDetection(GameObject* gameObjectOne, GameObjec
 		contact.friction = m_friction;
 		contact.restitution = m_restitution;
 
-		m_contactManifold->Add(contact);
+		contacts.points.push_back(contact);
 	}
 
 	//auto wehaveacollisionboys = 0.0f;
@@ -490,12 +654,12 @@ void CollisionManager::SphereOnOBBDetection(GameObject* gameObjectOne, GameObjec
 	//}
 }
 
-void CollisionManager::OBBOnCylinderDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo)
+void CollisionManager::OBBOnCylinderDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts)
 {
-	CylinderOnOBBDetection(gameObjectTwo, gameObjectOne);
+	CylinderOnOBBDetection(gameObjectTwo, gameObjectOne, contacts);
 }
 
-void CollisionManager::CylinderOnOBBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo)
+void CollisionManager::CylinderOnOBBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts)
 {
 	if (!gameObjectTwo->GetRigidBodyComponent()->GetUseGravity())
 	{
@@ -617,24 +781,24 @@ void CollisionManager::CylinderOnOBBDetection(GameObject* gameObjectOne, GameObj
 		contact.friction = m_friction;
 		contact.restitution = m_restitution;
 
-		m_contactManifold->Add(contact);
+		contacts.points.push_back(contact);
 	}
 }
 
 //Not implemented, so we'll just treat it as a sphere for now
-void CollisionManager::OBBOnPlaneDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo)
+void CollisionManager::OBBOnPlaneDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts)
 {
-	SphereOnPlaneDetection(gameObjectOne, gameObjectTwo);
+	SphereOnPlaneDetection(gameObjectOne, gameObjectTwo, contacts);
 }
 
 //Not implemented, so we'll just treat it as a sphere for now
-void CollisionManager::PlaneOnOBBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo)
+void CollisionManager::PlaneOnOBBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts)
 {
-	SphereOnPlaneDetection(gameObjectTwo, gameObjectOne);
+	SphereOnPlaneDetection(gameObjectTwo, gameObjectOne, contacts);
 }
 
 //Not implemented, so we'll just treat one of the OBBs as a sphere for now
-void CollisionManager::OBBOnOBBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo)
+void CollisionManager::OBBOnOBBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts)
 {
-	SphereOnOBBDetection(gameObjectOne, gameObjectTwo);
+	SphereOnOBBDetection(gameObjectOne, gameObjectTwo, contacts);
 }
@@ -1,11 +1,19 @@
 #pragma once
+#include "BroadphaseGrid.h"
 #include "ContactManifold.h"
+#include "WorkerPool.h"
 
 #include <algorithm>
 #include <cmath>
 
 using namespace std;
 
+//Bodies and broadphase pairs are split into this many chunks whatever the thread count so the contacts always come out in the same order
+auto const DETECTION_CHUNK_COUNT = 64u;
+
+//Twice the largest sphere radius that still goes in a single broadphase cell
+auto const BROADPHASE_CELL_SIZE = 1.0f;
+
 class CollisionManager
 {
 
@@ -20,44 +28,68 @@ public:
 
 	void ToggleRandomTexture();
 
+	//Sorts the contacts into body order after detection so the resolver sees the same contacts in the same order however they were found
+	void SetDeterministic(const bool deterministic);
+
+	//Pairs are tested on the worker pool if there is one, otherwise on the calling thread
+	void SetWorkerPool(WorkerPool* workerPool);
+
 	void DynamicCollisionDetection();
 
 	ContactManifold* GetContactManifoldReference() const;
 
-	typedef void (CollisionManager::*CollisionFunction)(GameObject*, GameObject*);
+	const BroadphaseGrid::Timings& GetBroadphaseTimings() const;
+	unsigned int GetBroadphasePairCount() const;
 
 private:
+	//Contacts found by one chunk of the pair loop
+	struct ContactBuffer {
+		vector<ManifoldPoint> points;
+
+		//Objects that collided and need a new random texture, applied once every chunk has finished
+		vector<GameObject*> textureChanges;
+	};
+
+	typedef void (CollisionManager::*CollisionFunction)(GameObject*, GameObject*, ContactBuffer&);
+
+	//Bounding sphere of every object for the broadphase, negative radius for colliders with no useful bounds
+	void CalculateBodyBounds(const unsigned int chunk, const unsigned int objectCount);
+	void DetectChunk(const unsigned int chunk);
+
 	//Sphere Collision Detection
-	void SphereOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo);
+	void SphereOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts);
 
 	//Cylinder Collision Detection
-	void CylinderOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo);
-	void SphereOnCylinderDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo);
+	void CylinderOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts);
+	void SphereOnCylinderDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts);
 
 	//Half-Space Sphere Collision Detection
-	void PlaneOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo);
-	void SphereOnPlaneDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo);
+	void PlaneOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts);
+	void SphereOnPlaneDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts);
 
 	//ABB Sphere Collision Detection
-	void AABBOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo);
-	void SphereOnAABBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo);
+	void AABBOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts);
+	void SphereOnAABBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts);
 
 	//OBB Sphere Collision Detection
-	void OBBOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo);
-	void SphereOnOBBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo);
+	void OBBOnSphereDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts);
+	void SphereOnOBBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts);
 
 	//OBB Cylinder Collision Detection
-	void OBBOnCylinderDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo);
-	void CylinderOnOBBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo);
+	void OBBOnCylinderDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts);
+	void CylinderOnOBBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts);
 
 	//OBB Plane Collision Detection (Not Implemented Properly)
-	void OBBOnPlaneDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo);
-	void PlaneOnOBBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo);
+	void OBBOnPlaneDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts);
+	void PlaneOnOBBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts);
 
 	//OBB OBB Collision Detection (Not Implemented Properly)
-	void OBBOnOBBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo);
+	void OBBOnOBBDetection(GameObject* gameObjectOne, GameObject* gameObjectTwo, ContactBuffer& contacts);
+
+	void ApplyTextureChanges();
 
 	bool m_randomTexture;
+	bool m_deterministic;
 
 	float m_friction;
 	float m_restitution;
@@ -65,6 +97,16 @@ private:
 	vector<GameObject*> &m_gameObjects;
 	ContactManifold* m_contactManifold;
 
-	map<pair<Collider::ColliderType, Collider::ColliderType>, CollisionFunction> m_functionMap;
+	WorkerPool* m_workerPool;
+
+	//Only pairs whose bounds could overlap are handed to the narrowphase
+	BroadphaseGrid m_broadphaseGrid;
+	vector<XMFLOAT4> m_bodyBounds;
+
+	//One buffer per chunk, kept between steps so they don't allocate once they've grown
+	vector<ContactBuffer> m_contactBuffers;
+
+	//Indexed by the collider types of the two objects, a flat table so lookups from the workers never touch a shared container
+	CollisionFunction m_functionTable[Collider::ColliderType::Cylinder + 1][Collider::ColliderType::Cylinder + 1];
 };
 
@@ -1,4 +1,5 @@
 #include "ContactManifold.h"
+#include <algorithm>
 
 ContactManifold::ContactManifold() : m_numberOfPoints(0)
 {
@@ -12,12 +13,26 @@ void ContactManifold::Add(ManifoldPoint &point)
 	m_numberOfPoints++;
 }
 
+void ContactManifold::Add(const vector<ManifoldPoint>& points)
+{
+	m_points.insert(m_points.end(), points.begin(), points.end());
+	m_numberOfPoints += static_cast<unsigned int>(points.size());
+}
+
 void ContactManifold::Clear()
 {
 	m_points.clear();
 	m_numberOfPoints = 0;
 }
 
+void ContactManifold::SortByKey()
+{
+	stable_sort(m_points.begin(), m_points.end(), [](const ManifoldPoint& pointOne, const ManifoldPoint& pointTwo)
+	{
+		return pointOne.sortKey < pointTwo.sortKey;
+	});
+}
+
 unsigned int ContactManifold::GetNumberOfPoints() const
 {
 	return m_numberOfPoints;
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "GameObject.h"
+#include "QuaternionIntegrator.h"
 
 using namespace DirectX;
 
@@ -25,6 +26,12 @@ struct ManifoldPoint
 
 	int testcount = 0;
 
+	//Indices of the two game objects this contact was found between, lower index in the high bits so sorting puts pairs in body order
+	unsigned long long sortKey = 0;
+
+	//Game object index of each contactID, only meaningful where the contactID isn't null
+	unsigned int bodyIndex[2];
+
 	void MatchAwakeState()
 	{
 		//If the other contact is null then there's nothing to match
@@ -221,12 +228,10 @@ struct ManifoldPoint
 		for (unsigned int i = 0; i < 2; i++) if (contactID[i])
 		{
 			auto angularInertiaWorld = XMVECTOR();
-			auto inverseInertiaTensor = XMMATRIX();
-			contactID[i]->GetInverseInertiaTensorWorld(inverseInertiaTensor);
 
 			angularInertiaWorld = XMVector3Cross(relativeContactPosition[i], contactNormal);
 
-			angularInertiaWorld = XMVector3Transform(angularInertiaWorld, inverseInertiaTensor);
+			angularInertiaWorld = contactID[i]->TransformByInverseInertiaTensorWorld(angularInertiaWorld);
 
 			angularInertiaWorld = XMVector3Cross(angularInertiaWorld, relativeContactPosition[i]);
 
@@ -279,16 +284,13 @@ struct ManifoldPoint
 			}
 			else
 			{
-				auto inverseInertiaTensor = XMMATRIX();
-				contactID[i]->GetInverseInertiaTensorWorld(inverseInertiaTensor);
-
 				auto angularDirection = XMVECTOR();
 
 				angularDirection = XMVector3Cross(relativeContactPosition[i], contactNormal);
 
 				auto angularDirectionTransform = XMVECTOR();
 
-				angularDirectionTransform = XMVector3Transform(angularDirection, inverseInertiaTensor);
+				angularDirectionTransform = contactID[i]->TransformByInverseInertiaTensorWorld(angularDirection);
 
 				angularChange[i] = XMVectorScale(angularDirectionTransform, angularMove[i] / angularInertia[i]);
 			}
@@ -304,45 +306,36 @@ struct ManifoldPoint
 
 			auto newRotation = XMVECTOR();
 			contactID[i]->GetRotation(newRotation);
-			auto scaledAngularChange = XMVECTOR();
-			auto angularChangeQuaternion = XMVECTOR();
 
-			//Is this correct? Ian Millingtons Quaternion.addScaledVector...
-			scaledAngularChange = XMVectorScale(angularChange[i], 1.0f);
-			angularChangeQuaternion = XMQuaternionRotationRollPitchYawFromVector(scaledAngularChange);
-			newRotation = XMQuaternionMultiply(newRotation, angularChangeQuaternion);
+			//Ian Millingtons Quaternion.addScaledVector, SetRotation renormalises
+			newRotation = QuaternionIntegrator::Integrate(newRotation, angularChange[i]);
 
 			contactID[i]->SetRotation(newRotation);
-
-			//Updated derived data if it's awake
-			if (!contactID[i]->GetIsAwake())
-			{
-				contactID[i]->CalculateDerivedData();
-			}
 		}
 	}
 
 	void ApplyVelocityChange(XMVECTOR velocityChange[2], XMVECTOR angularChange[2])
 	{
-		XMMATRIX inverseInertiaTensorMatrix[2];
-
-		contactID[0]->GetInverseInertiaTensorWorld(inverseInertiaTensorMatrix[0]);
-
-		if (contactID[1])
-		{
-			contactID[1]->GetInverseInertiaTensorWorld(inverseInertiaTensorMatrix[1]);
-		}
-
 		auto impulseContact = XMVECTOR();
 
 		//Calculate impulse contact depending on friction, if friction is zero we do a frictionless impulse
 		if (friction == 0.0f)
 		{
 			//Calculate frictionless impulse
-			impulseContact = CalculateFrictionlessImpulse(inverseInertiaTensorMatrix);
+			impulseContact = CalculateFrictionlessImpulse();
 		}
 		else
 		{
+			//Only the friction impulse needs the full tensors
+			XMMATRIX inverseInertiaTensorMatrix[2];
+
+			contactID[0]->GetInverseInertiaTensorWorld(inverseInertiaTensorMatrix[0]);
+
+			if (contactID[1])
+			{
+				contactID[1]->GetInverseInertiaTensorWorld(inverseInertiaTensorMatrix[1]);
+			}
+
 			//Calculate friction impulse
 			impulseContact = CalculateFrictionImpulse(inverseInertiaTensorMatrix);
 		}
@@ -357,7 +350,7 @@ struct ManifoldPoint
 		impulseTorqueWorld = XMVector3Cross(relativeContactPosition[0], impulseWorld);
 
 		//New angular velocity
-		angularChange[0] = XMVector3Transform(impulseTorqueWorld, inverseInertiaTensorMatrix[0]);
+		angularChange[0] = contactID[0]->TransformByInverseInertiaTensorWorld(impulseTorqueWorld);
 
 		//New linear velocity
 		velocityChange[0] = XMVECTOR();
@@ -378,7 +371,7 @@ struct ManifoldPoint
 			impulseTorqueWorld = XMVector3Cross(impulseWorld, relativeContactPosition[1]);
 
 			//New angular velocity
-			angularChange[1] = XMVector3Transform(impulseTorqueWorld, inverseInertiaTensorMatrix[1]);
+			angularChange[1] = contactID[1]->TransformByInverseInertiaTensorWorld(impulseTorqueWorld);
 
 			//New linear velocity
 			velocityChange[1] = XMVECTOR();
@@ -392,13 +385,13 @@ struct ManifoldPoint
 		}
 	}
 	
-	XMVECTOR CalculateFrictionlessImpulse(const XMMATRIX inverseInertiaTensor[2])
+	XMVECTOR CalculateFrictionlessImpulse()
 	{
 		//change in velocity in world space
 		auto totalDeltaVelocityWorld = XMVECTOR();
 
 		totalDeltaVelocityWorld = XMVector3Cross(relativeContactPosition[0], contactNormal);
-		totalDeltaVelocityWorld = XMVector3Transform(totalDeltaVelocityWorld, inverseInertiaTensor[0]);
+		totalDeltaVelocityWorld = contactID[0]->TransformByInverseInertiaTensorWorld(totalDeltaVelocityWorld);
 		totalDeltaVelocityWorld = XMVector3Cross(totalDeltaVelocityWorld, relativeContactPosition[0]);
 
 		auto deltaVelocity = 0.0f;
@@ -412,7 +405,7 @@ struct ManifoldPoint
 			totalDeltaVelocityWorld = XMVECTOR();
 
 			totalDeltaVelocityWorld = XMVector3Cross(relativeContactPosition[1], contactNormal);
-			totalDeltaVelocityWorld = XMVector3Transform(totalDeltaVelocityWorld, inverseInertiaTensor[1]);
+			totalDeltaVelocityWorld = contactID[1]->TransformByInverseInertiaTensorWorld(totalDeltaVelocityWorld);
 			totalDeltaVelocityWorld = XMVector3Cross(totalDeltaVelocityWorld, relativeContactPosition[1]);
 
 			XMStoreFloat(&deltaVelocity, XMVectorAdd(XMLoadFloat(&deltaVelocity), XMVector3Dot(totalDeltaVelocityWorld, contactNormal)));
@@ -553,7 +546,11 @@ public:
 	~ContactManifold();
 
 	void Add(ManifoldPoint &point);
+	void Add(const vector<ManifoldPoint>& points);
 	void Clear();
+
+	//Puts the contacts in sort key order, contacts between the same pair keep the order they were added in
+	void SortByKey();
 	unsigned int GetNumberOfPoints() const;
 	ManifoldPoint& GetPoint(int index);
 
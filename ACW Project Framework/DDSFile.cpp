@@ -0,0 +1,50 @@
+#include "DDSFile.h"
+
+#include <cstring>
+
+bool ParseDDSFile(const uint8_t* ddsData, const size_t ddsDataSize, DDSFileLayout& layout)
+{
+	layout = DDSFileLayout();
+
+	//Need at least enough data to fill the header and magic number to be a valid DDS
+	if (!ddsData || ddsDataSize < sizeof(uint32_t) + sizeof(DDS_HEADER))
+	{
+		return false;
+	}
+
+	//Copied out rather than read through a cast so a buffer that isn't four byte aligned is still fine
+	uint32_t magicNumber;
+	memcpy(&magicNumber, ddsData, sizeof(magicNumber));
+
+	if (magicNumber != DDS_MAGIC)
+	{
+		return false;
+	}
+
+	const auto* header = reinterpret_cast<const DDS_HEADER*>(ddsData + sizeof(uint32_t));
+
+	if (header->size != sizeof(DDS_HEADER) || header->ddspf.size != sizeof(DDS_PIXELFORMAT))
+	{
+		return false;
+	}
+
+	auto offset = sizeof(uint32_t) + sizeof(DDS_HEADER);
+
+	//The DX10 extension header follows the main one when the four CC says so
+	if ((header->ddspf.flags & DDS_FOURCC) && header->ddspf.fourCC == MAKEFOURCC('D', 'X', '1', '0'))
+	{
+		if (ddsDataSize < offset + sizeof(DDS_HEADER_DXT10))
+		{
+			return false;
+		}
+
+		layout.dx10Header = reinterpret_cast<const DDS_HEADER_DXT10*>(ddsData + offset);
+		offset += sizeof(DDS_HEADER_DXT10);
+	}
+
+	layout.header = header;
+	layout.bitData = ddsData + offset;
+	layout.bitSize = ddsDataSize - offset;
+
+	return true;
+}
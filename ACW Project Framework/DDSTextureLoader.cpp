@@ -23,6 +23,7 @@
 #include <memory>
 
 #include "DDSTextureLoader.h"
+#include "DDSFile.h"
 
 #if !defined(NO_D3D11_DEBUG_NAME) && ( defined(_DEBUG) || defined(PROFILE) )
 #pragma comment(lib,"dxguid.lib")
@@ -31,91 +32,8 @@
 using namespace DirectX;
 
 //--------------------------------------------------------------------------------------
-// Macros
+// DDS file structure definitions and header checks are in DDSFile.h, which builds without Windows
 //--------------------------------------------------------------------------------------
-#ifndef MAKEFOURCC
-#define MAKEFOURCC(ch0, ch1, ch2, ch3)                              \
-                ((uint32_t)(uint8_t)(ch0) | ((uint32_t)(uint8_t)(ch1) << 8) |       \
-                ((uint32_t)(uint8_t)(ch2) << 16) | ((uint32_t)(uint8_t)(ch3) << 24 ))
-#endif /* defined(MAKEFOURCC) */
-
-//--------------------------------------------------------------------------------------
-// DDS file structure definitions
-//
-// See DDS.h in the 'Texconv' sample and the 'DirectXTex' library
-//--------------------------------------------------------------------------------------
-#pragma pack(push,1)
-
-const uint32_t DDS_MAGIC = 0x20534444; // "DDS "
-
-struct DDS_PIXELFORMAT
-{
-	uint32_t    size;
-	uint32_t    flags;
-	uint32_t    fourCC;
-	uint32_t    RGBBitCount;
-	uint32_t    RBitMask;
-	uint32_t    GBitMask;
-	uint32_t    BBitMask;
-	uint32_t    ABitMask;
-};
-
-#define DDS_FOURCC      0x00000004  // DDPF_FOURCC
-#define DDS_RGB         0x00000040  // DDPF_RGB
-#define DDS_LUMINANCE   0x00020000  // DDPF_LUMINANCE
-#define DDS_ALPHA       0x00000002  // DDPF_ALPHA
-
-#define DDS_HEADER_FLAGS_VOLUME         0x00800000  // DDSD_DEPTH
-
-#define DDS_HEIGHT 0x00000002 // DDSD_HEIGHT
-#define DDS_WIDTH  0x00000004 // DDSD_WIDTH
-
-#define DDS_CUBEMAP_POSITIVEX 0x00000600 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEX
-#define DDS_CUBEMAP_NEGATIVEX 0x00000a00 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEX
-#define DDS_CUBEMAP_POSITIVEY 0x00001200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEY
-#define DDS_CUBEMAP_NEGATIVEY 0x00002200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEY
-#define DDS_CUBEMAP_POSITIVEZ 0x00004200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEZ
-#define DDS_CUBEMAP_NEGATIVEZ 0x00008200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEZ
-
-#define DDS_CUBEMAP_ALLFACES ( DDS_CUBEMAP_POSITIVEX | DDS_CUBEMAP_NEGATIVEX |\
-                               DDS_CUBEMAP_POSITIVEY | DDS_CUBEMAP_NEGATIVEY |\
-                               DDS_CUBEMAP_POSITIVEZ | DDS_CUBEMAP_NEGATIVEZ )
-
-#define DDS_CUBEMAP 0x00000200 // DDSCAPS2_CUBEMAP
-
-enum DDS_MISC_FLAGS2
-{
-	DDS_MISC_FLAGS2_ALPHA_MODE_MASK = 0x7L,
-};
-
-struct DDS_HEADER
-{
-	uint32_t        size;
-	uint32_t        flags;
-	uint32_t        height;
-	uint32_t        width;
-	uint32_t        pitchOrLinearSize;
-	uint32_t        depth; // only if DDS_HEADER_FLAGS_VOLUME is set in flags
-	uint32_t        mipMapCount;
-	uint32_t        reserved1[11];
-	DDS_PIXELFORMAT ddspf;
-	uint32_t        caps;
-	uint32_t        caps2;
-	uint32_t        caps3;
-	uint32_t        caps4;
-	uint32_t        reserved2;
-};
-
-struct DDS_HEADER_DXT10
-{
-	DXGI_FORMAT     dxgiFormat;
-	uint32_t        resourceDimension;
-	uint32_t        miscFlag; // see D3D11_RESOURCE_MISC_FLAG
-	uint32_t        arraySize;
-	uint32_t        miscFlags2;
-};
-
-#pragma pack(pop)
 
 //--------------------------------------------------------------------------------------
 namespace
@@ -225,42 +143,17 @@ static HRESULT LoadTextureDataFromFile(_In_z_ const wchar_t* fileName,
 		return E_FAIL;
 	}
 
-	// DDS files always start with the same magic number ("DDS ")
-	uint32_t dwMagicNumber = *(const uint32_t*)(ddsData.get());
-	if (dwMagicNumber != DDS_MAGIC)
+	// Validate the magic number and headers in place
+	DDSFileLayout layout;
+	if (!ParseDDSFile(ddsData.get(), FileSize.LowPart, layout))
 	{
 		return E_FAIL;
 	}
 
-	auto hdr = reinterpret_cast<DDS_HEADER*>(ddsData.get() + sizeof(uint32_t));
-
-	// Verify header to validate DDS file
-	if (hdr->size != sizeof(DDS_HEADER) ||
-		hdr->ddspf.size != sizeof(DDS_PIXELFORMAT))
-	{
-		return E_FAIL;
-	}
-
-	// Check for DX10 extension
-	bool bDXT10Header = false;
-	if ((hdr->ddspf.flags & DDS_FOURCC) &&
-		(MAKEFOURCC('D', 'X', '1', '0') == hdr->ddspf.fourCC))
-	{
-		// Must be long enough for both headers and magic value
-		if (FileSize.LowPart < (sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10)))
-		{
-			return E_FAIL;
-		}
-
-		bDXT10Header = true;
-	}
-
 	// setup the pointers in the process request
-	*header = hdr;
-	ptrdiff_t offset = sizeof(uint32_t) + sizeof(DDS_HEADER)
-		+ (bDXT10Header ? sizeof(DDS_HEADER_DXT10) : 0);
-	*bitData = ddsData.get() + offset;
-	*bitSize = FileSize.LowPart - offset;
+	*header = const_cast<DDS_HEADER*>(layout.header);
+	*bitData = const_cast<uint8_t*>(layout.bitData);
+	*bitSize = layout.bitSize;
 
 	return S_OK;
 }
@@ -1196,7 +1089,10 @@ static HRESULT CreateTextureFromDDS(_In_ ID3D11Device* d3dDevice,
 			return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
 		}
 
-		switch (d3d10ext->dxgiFormat)
+		// DDSFile.h keeps the format as a plain integer so it builds without Direct3D
+		const auto dxgiFormat = static_cast<DXGI_FORMAT>(d3d10ext->dxgiFormat);
+
+		switch (dxgiFormat)
 		{
 		case DXGI_FORMAT_AI44:
 		case DXGI_FORMAT_IA44:
@@ -1205,13 +1101,13 @@ static HRESULT CreateTextureFromDDS(_In_ ID3D11Device* d3dDevice,
 			return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
 
 		default:
-			if (BitsPerPixel(d3d10ext->dxgiFormat) == 0)
+			if (BitsPerPixel(dxgiFormat) == 0)
 			{
 				return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
 			}
 		}
 
-		format = d3d10ext->dxgiFormat;
+		format = dxgiFormat;
 
 		switch (d3d10ext->resourceDimension)
 		{
@@ -1611,47 +1507,17 @@ HRESULT DirectX::CreateDDSTextureFromMemoryEx(ID3D11Device* d3dDevice,
 		return E_INVALIDARG;
 	}
 
-	// Validate DDS file in memory
-	if (ddsDataSize < (sizeof(uint32_t) + sizeof(DDS_HEADER)))
-	{
-		return E_FAIL;
-	}
-
-	uint32_t dwMagicNumber = *(const uint32_t*)(ddsData);
-	if (dwMagicNumber != DDS_MAGIC)
+	// Validate DDS file in memory, nothing is copied so the pixel data is read straight from the caller's buffer
+	DDSFileLayout layout;
+	if (!ParseDDSFile(ddsData, ddsDataSize, layout))
 	{
 		return E_FAIL;
 	}
 
-	auto header = reinterpret_cast<const DDS_HEADER*>(ddsData + sizeof(uint32_t));
-
-	// Verify header to validate DDS file
-	if (header->size != sizeof(DDS_HEADER) ||
-		header->ddspf.size != sizeof(DDS_PIXELFORMAT))
-	{
-		return E_FAIL;
-	}
-
-	// Check for DX10 extension
-	bool bDXT10Header = false;
-	if ((header->ddspf.flags & DDS_FOURCC) &&
-		(MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC))
-	{
-		// Must be long enough for both headers and magic value
-		if (ddsDataSize < (sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10)))
-		{
-			return E_FAIL;
-		}
-
-		bDXT10Header = true;
-	}
-
-	ptrdiff_t offset = sizeof(uint32_t)
-		+ sizeof(DDS_HEADER)
-		+ (bDXT10Header ? sizeof(DDS_HEADER_DXT10) : 0);
+	auto header = layout.header;
 
 	HRESULT hr = CreateTextureFromDDS(d3dDevice, d3dContext, header,
-		ddsData + offset, ddsDataSize - offset, maxsize,
+		layout.bitData, layout.bitSize, maxsize,
 		usage, bindFlags, cpuAccessFlags, miscFlags, forceSRGB,
 		texture, textureView);
 	if (SUCCEEDED(hr))
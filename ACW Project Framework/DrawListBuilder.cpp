@@ -0,0 +1,174 @@
+#include "DrawListBuilder.h"
+
+//Key layout from the most significant bit, shader (8 bits), texture (16 bits), model (8 bits), object index (32 bits)
+auto const SHADER_SHIFT = 56u;
+auto const TEXTURE_SHIFT = 40u;
+auto const MODEL_SHIFT = 32u;
+
+auto const SHADER_MASK = 0xFFull;
+auto const TEXTURE_MASK = 0xFFFFull;
+auto const MODEL_MASK = 0xFFull;
+auto const OBJECT_INDEX_MASK = 0xFFFFFFFFull;
+
+DrawListBuilder::DrawListBuilder() : m_unsortedStateChanges(), m_sortedStateChanges()
+{
+}
+
+DrawListBuilder::DrawListBuilder(const DrawListBuilder& other) = default;
+
+DrawListBuilder::DrawListBuilder(DrawListBuilder&& other) noexcept = default;
+
+DrawListBuilder::~DrawListBuilder() = default;
+
+DrawListBuilder& DrawListBuilder::operator=(const DrawListBuilder& other) = default;
+
+DrawListBuilder& DrawListBuilder::operator=(DrawListBuilder&& other) noexcept = default;
+
+void DrawListBuilder::Clear()
+{
+	//Keep the capacity so we aren't reallocating every frame
+	m_sortKeys.clear();
+
+	m_unsortedStateChanges = StateChangeCounters();
+	m_sortedStateChanges = StateChangeCounters();
+}
+
+void DrawListBuilder::Add(const void* shader, const void* texture, const unsigned int modelKey, const unsigned int objectIndex)
+{
+	const unsigned long long shaderID = GetStateID(m_shaderIDs, shader);
+	const unsigned long long textureID = GetStateID(m_textureIDs, texture);
+
+	auto sortKey = (shaderID & SHADER_MASK) << SHADER_SHIFT;
+	sortKey |= (textureID & TEXTURE_MASK) << TEXTURE_SHIFT;
+	sortKey |= (modelKey & MODEL_MASK) << MODEL_SHIFT;
+	sortKey |= objectIndex & OBJECT_INDEX_MASK;
+
+	m_sortKeys.push_back(sortKey);
+}
+
+void DrawListBuilder::Build()
+{
+	m_unsortedStateChanges = CountStateChanges(m_sortKeys);
+
+	RadixSort();
+
+	m_sortedStateChanges = CountStateChanges(m_sortKeys);
+}
+
+const vector<unsigned long long>& DrawListBuilder::GetSortedKeys() const
+{
+	return m_sortKeys;
+}
+
+const DrawListBuilder::StateChangeCounters& DrawListBuilder::GetUnsortedStateChanges() const
+{
+	return m_unsortedStateChanges;
+}
+
+const DrawListBuilder::StateChangeCounters& DrawListBuilder::GetSortedStateChanges() const
+{
+	return m_sortedStateChanges;
+}
+
+unsigned int DrawListBuilder::GetObjectIndex(const unsigned long long sortKey)
+{
+	return static_cast<unsigned int>(sortKey & OBJECT_INDEX_MASK);
+}
+
+unsigned int DrawListBuilder::GetStateKey(const unsigned long long sortKey)
+{
+	return static_cast<unsigned int>(sortKey >> MODEL_SHIFT);
+}
+
+unsigned int DrawListBuilder::GetStateID(map<const void*, unsigned int>& stateIDs, const void* state)
+{
+	const auto stateID = stateIDs.find(state);
+
+	if (stateID != stateIDs.end())
+	{
+		return stateID->second;
+	}
+
+	const auto newStateID = static_cast<unsigned int>(stateIDs.size());
+	stateIDs.insert(pair<const void*, unsigned int>(state, newStateID));
+
+	return newStateID;
+}
+
+void DrawListBuilder::RadixSort()
+{
+	//Least significant digit first, a byte at a time. Only the state half of the key is sorted, the object indices are added in
+	//increasing order and every pass is stable so they stay in order within each state
+	m_scratchKeys.resize(m_sortKeys.size());
+
+	for (auto shift = MODEL_SHIFT; shift < 64u; shift += 8u)
+	{
+		unsigned int counts[256] = {};
+
+		for (const auto sortKey : m_sortKeys)
+		{
+			counts[(sortKey >> shift) & 0xFF]++;
+		}
+
+		//Every key has the same digit so this pass wouldn't move anything
+		if (!m_sortKeys.empty() && counts[(m_sortKeys.front() >> shift) & 0xFF] == m_sortKeys.size())
+		{
+			continue;
+		}
+
+		unsigned int offset = 0;
+
+		for (auto& count : counts)
+		{
+			const auto digitCount = count;
+			count = offset;
+			offset += digitCount;
+		}
+
+		for (const auto sortKey : m_sortKeys)
+		{
+			m_scratchKeys[counts[(sortKey >> shift) & 0xFF]++] = sortKey;
+		}
+
+		m_sortKeys.swap(m_scratchKeys);
+	}
+}
+
+DrawListBuilder::StateChangeCounters DrawListBuilder::CountStateChanges(const vector<unsigned long long>& sortKeys)
+{
+	auto stateChanges = StateChangeCounters();
+
+	if (sortKeys.empty())
+	{
+		return stateChanges;
+	}
+
+	//The first draw always has to bind everything
+	stateChanges.shaderChanges = 1;
+	stateChanges.textureChanges = 1;
+	stateChanges.modelChanges = 1;
+
+	auto previousKey = sortKeys.front();
+
+	for (const auto sortKey : sortKeys)
+	{
+		if (((sortKey ^ previousKey) >> SHADER_SHIFT & SHADER_MASK) != 0)
+		{
+			stateChanges.shaderChanges++;
+		}
+
+		if (((sortKey ^ previousKey) >> TEXTURE_SHIFT & TEXTURE_MASK) != 0)
+		{
+			stateChanges.textureChanges++;
+		}
+
+		if (((sortKey ^ previousKey) >> MODEL_SHIFT & MODEL_MASK) != 0)
+		{
+			stateChanges.modelChanges++;
+		}
+
+		previousKey = sortKey;
+	}
+
+	return stateChanges;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <map>
+
+using namespace std;
+
+//Builds the order objects are submitted in each frame. Every object gets a 64 bit sort key made up of its shader, texture and model
+//with the object index in the low bits, the keys are radix sorted so objects sharing render state end up next to each other.
+//No Direct3D in here, the states are only used as keys
+class DrawListBuilder
+{
+public:
+	//Number of times the shader, texture and model would need binding when drawing in a given order
+	struct StateChangeCounters {
+		unsigned int shaderChanges;
+		unsigned int textureChanges;
+		unsigned int modelChanges;
+	};
+
+	DrawListBuilder(); // Default Constructor
+	DrawListBuilder(const DrawListBuilder& other); // Copy Constructor
+	DrawListBuilder(DrawListBuilder&& other) noexcept; // Move Constructor
+	~DrawListBuilder(); // Destructor
+
+	DrawListBuilder& operator = (const DrawListBuilder& other); // Copy Assignment Operator
+	DrawListBuilder& operator = (DrawListBuilder&& other) noexcept; // Move Assignment Operator
+
+	void Clear();
+
+	void Add(const void* shader, const void* texture, const unsigned int modelKey, const unsigned int objectIndex);
+
+	//Sorts everything added since the last clear and counts the state changes before and after sorting
+	void Build();
+
+	const vector<unsigned long long>& GetSortedKeys() const;
+
+	const StateChangeCounters& GetUnsortedStateChanges() const;
+	const StateChangeCounters& GetSortedStateChanges() const;
+
+	static unsigned int GetObjectIndex(const unsigned long long sortKey);
+	static unsigned int GetStateKey(const unsigned long long sortKey);
+
+private:
+	static unsigned int GetStateID(map<const void*, unsigned int>& stateIDs, const void* state);
+
+	void RadixSort();
+
+	static StateChangeCounters CountStateChanges(const vector<unsigned long long>& sortKeys);
+
+	//Ids are handed out the first time a state is seen and kept between frames so the order batches are drawn in is stable
+	map<const void*, unsigned int> m_shaderIDs;
+	map<const void*, unsigned int> m_textureIDs;
+
+	vector<unsigned long long> m_sortKeys;
+	vector<unsigned long long> m_scratchKeys;
+
+	StateChangeCounters m_unsortedStateChanges;
+	StateChangeCounters m_sortedStateChanges;
+};
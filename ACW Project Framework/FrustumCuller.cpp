@@ -0,0 +1,137 @@
+#include "FrustumCuller.h"
+
+FrustumCuller::FrustumCuller() : m_planes(), m_objectCount(0)
+{
+}
+
+FrustumCuller::FrustumCuller(const FrustumCuller& other) = default;
+
+FrustumCuller::FrustumCuller(FrustumCuller&& other) noexcept = default;
+
+FrustumCuller::~FrustumCuller() = default;
+
+FrustumCuller& FrustumCuller::operator=(const FrustumCuller& other) = default;
+
+FrustumCuller& FrustumCuller::operator=(FrustumCuller&& other) noexcept = default;
+
+void FrustumCuller::ExtractPlanes(const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix)
+{
+	//Rows of the transpose are the columns of the view projection matrix, the planes are sums and differences of them
+	const auto viewProjection = XMMatrixTranspose(XMMatrixMultiply(viewMatrix, projectionMatrix));
+
+	XMVECTOR planes[6];
+
+	//Left, right, bottom, top
+	planes[0] = XMVectorAdd(viewProjection.r[3], viewProjection.r[0]);
+	planes[1] = XMVectorSubtract(viewProjection.r[3], viewProjection.r[0]);
+	planes[2] = XMVectorAdd(viewProjection.r[3], viewProjection.r[1]);
+	planes[3] = XMVectorSubtract(viewProjection.r[3], viewProjection.r[1]);
+
+	//Near and far, depth runs from 0 to 1 in Direct3D so the near plane is just the z column
+	planes[4] = viewProjection.r[2];
+	planes[5] = XMVectorSubtract(viewProjection.r[3], viewProjection.r[2]);
+
+	for (auto i = 0; i < 6; i++)
+	{
+		XMStoreFloat4(&m_planes[i], XMPlaneNormalize(planes[i]));
+	}
+}
+
+void FrustumCuller::Clear()
+{
+	//Keep the capacity so we aren't reallocating every frame
+	m_objectCount = 0;
+
+	m_centreX.clear();
+	m_centreY.clear();
+	m_centreZ.clear();
+	m_radius.clear();
+
+	m_visibleIndices.clear();
+}
+
+void FrustumCuller::Add(const XMVECTOR& centre, const float radius)
+{
+	m_centreX.push_back(XMVectorGetX(centre));
+	m_centreY.push_back(XMVectorGetY(centre));
+	m_centreZ.push_back(XMVectorGetZ(centre));
+	m_radius.push_back(radius);
+
+	m_objectCount++;
+}
+
+void FrustumCuller::Cull()
+{
+	m_visibleIndices.clear();
+
+	//Pad up to a multiple of four so the last group can be loaded whole, padding is never added to the visible list
+	const auto paddedCount = (m_objectCount + 3) & ~3u;
+
+	m_centreX.resize(paddedCount, 0.0f);
+	m_centreY.resize(paddedCount, 0.0f);
+	m_centreZ.resize(paddedCount, 0.0f);
+	m_radius.resize(paddedCount, 0.0f);
+
+	//Splat each plane component across a vector once so every group of spheres can use them
+	XMVECTOR planeX[6];
+	XMVECTOR planeY[6];
+	XMVECTOR planeZ[6];
+	XMVECTOR planeW[6];
+
+	for (auto i = 0; i < 6; i++)
+	{
+		const auto plane = XMLoadFloat4(&m_planes[i]);
+
+		planeX[i] = XMVectorSplatX(plane);
+		planeY[i] = XMVectorSplatY(plane);
+		planeZ[i] = XMVectorSplatZ(plane);
+		planeW[i] = XMVectorSplatW(plane);
+	}
+
+	for (unsigned int i = 0; i < paddedCount; i += 4)
+	{
+		const auto centreX = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_centreX[i]));
+		const auto centreY = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_centreY[i]));
+		const auto centreZ = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_centreZ[i]));
+		const auto negativeRadius = XMVectorNegate(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&m_radius[i])));
+
+		auto outside = XMVectorFalseInt();
+
+		//A sphere is outside if its centre is further than its radius behind any plane
+		for (auto j = 0; j < 6; j++)
+		{
+			auto distance = XMVectorMultiplyAdd(centreZ, planeZ[j], planeW[j]);
+			distance = XMVectorMultiplyAdd(centreY, planeY[j], distance);
+			distance = XMVectorMultiplyAdd(centreX, planeX[j], distance);
+
+			outside = XMVectorOrInt(outside, XMVectorLess(distance, negativeRadius));
+		}
+
+		uint32_t outsideMask[4];
+		XMStoreInt4(outsideMask, outside);
+
+		for (unsigned int lane = 0; lane < 4; lane++)
+		{
+			if (!outsideMask[lane] && i + lane < m_objectCount)
+			{
+				m_visibleIndices.push_back(i + lane);
+			}
+		}
+	}
+
+	//Drop the padding again so more spheres can be added on the end
+	m_centreX.resize(m_objectCount);
+	m_centreY.resize(m_objectCount);
+	m_centreZ.resize(m_objectCount);
+	m_radius.resize(m_objectCount);
+}
+
+const vector<unsigned int>& FrustumCuller::GetVisibleIndices() const
+{
+	return m_visibleIndices;
+}
+
+unsigned int FrustumCuller::GetObjectCount() const
+{
+	return m_objectCount;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+
+using namespace DirectX;
+using namespace std;
+
+//Tests object bounding spheres against the six planes of the camera frustum four at a time and keeps the indices of the ones that can be seen.
+//Sphere data is stored as separate x, y, z and radius arrays so four spheres load straight into one vector per component
+class FrustumCuller
+{
+public:
+	FrustumCuller(); // Default Constructor
+	FrustumCuller(const FrustumCuller& other); // Copy Constructor
+	FrustumCuller(FrustumCuller&& other) noexcept; // Move Constructor
+	~FrustumCuller(); // Destructor
+
+	FrustumCuller& operator = (const FrustumCuller& other); // Copy Assignment Operator
+	FrustumCuller& operator = (FrustumCuller&& other) noexcept; // Move Assignment Operator
+
+	//Planes point inwards and are normalised so the plane distance can be compared straight against a sphere radius
+	void ExtractPlanes(const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix);
+
+	void Clear();
+
+	//Bounding spheres are indexed in the order they are added
+	void Add(const XMVECTOR& centre, const float radius);
+
+	void Cull();
+
+	const vector<unsigned int>& GetVisibleIndices() const;
+	unsigned int GetObjectCount() const;
+
+private:
+	XMFLOAT4 m_planes[6];
+
+	unsigned int m_objectCount;
+
+	vector<float> m_centreX;
+	vector<float> m_centreY;
+	vector<float> m_centreZ;
+	vector<float> m_radius;
+
+	vector<unsigned int> m_visibleIndices;
+};
@@ -1,5 +1,21 @@
 #include "GameObject.h"
+
+#ifdef _WIN32
+#include "Texture.h"
 #include "TextureShader.h"
+#else
+#include <cstdio>
+#endif
+
+//A message box on Windows and the console everywhere else
+static void ReportError(const HWND hwnd, const char* message, const char* title)
+{
+#ifdef _WIN32
+	MessageBox(hwnd, message, title, MB_OK);
+#else
+	fprintf(stderr, "%s: %s\n", title, message);
+#endif
+}
 
 //For adding default components or making it empty (defaults components: Position, Rotation, Scale)
 GameObject::GameObject(HWND hwnd) : m_initializationFailed(false), m_hwnd(hwnd), m_position(nullptr), m_rotation(nullptr), m_scale(nullptr), m_velocity(nullptr), m_rigidBody(nullptr), m_collider(nullptr), m_model(nullptr), m_texture(nullptr), m_shader(nullptr)
@@ -37,11 +53,13 @@ GameObject::~GameObject()
 		m_shader = nullptr;
 	}
 
+#ifdef _WIN32
 	if (m_texture)
 	{
 		delete m_texture;
 		m_texture = nullptr;
 	}
+#endif
 
 	if (m_model)
 	{
@@ -137,7 +155,7 @@ void GameObject::AddVelocityComponent(const float x, const float y, const float
 }
 
 //Inertia tensor is based off the model type, if the model isn't initialised before the rigidbody then it will try the colliders type, else it throws an error stating this
-void GameObject::AddRigidBodyComponent(const bool useGravity, const float mass, const float drag, const float angularDrag, const XMFLOAT3 position, const XMFLOAT4 rotation, const XMFLOAT3 velocity, const XMFLOAT3 angularVelocity) {
+void GameObject::AddRigidBodyComponent(BodyStateStore* bodyStateStore, const bool useGravity, const float mass, const float drag, const float angularDrag, const XMFLOAT3 position, const XMFLOAT4 rotation, const XMFLOAT3 velocity, const XMFLOAT3 angularVelocity) {
 	
 	auto inertiaTensor = XMFLOAT3X3();
 	auto scale = XMVECTOR();
@@ -149,7 +167,7 @@ void GameObject::AddRigidBodyComponent(const bool useGravity, const float mass,
 	}
 	else
 	{
-		MessageBox(m_hwnd, "You need to define a scale component before the rigidbody!", "Error: Missing Component", MB_OK);
+		ReportError(m_hwnd, "You need to define a scale component before the rigidbody!", "Error: Missing Component");
 		m_initializationFailed = true;
 		return;
 	}
@@ -187,12 +205,12 @@ void GameObject::AddRigidBodyComponent(const bool useGravity, const float mass,
 	}
 	else
 	{
-		MessageBox(m_hwnd, "You need to define a model component before the rigidbody!", "Error: Missing Component", MB_OK);
+		ReportError(m_hwnd, "You need to define a model component before the rigidbody!", "Error: Missing Component");
 		m_initializationFailed = true;
 		return;
 	}
 	
-	m_rigidBody = new RigidBody(useGravity, mass, drag, angularDrag, position, rotation, velocity, angularVelocity, inertiaTensor);
+	m_rigidBody = new RigidBody(bodyStateStore, useGravity, mass, drag, angularDrag, position, rotation, velocity, angularVelocity, inertiaTensor);
 }
 
 void GameObject::AddColliderComponent(const Collider::ColliderType colliderType) {
@@ -226,7 +244,7 @@ void GameObject::SetPlaneColliderData(const XMFLOAT3& centre, const XMFLOAT3& po
 
 	if (!planeCollider)
 	{
-		MessageBox(m_hwnd, "You tried setting data to a collider type that's isn't a plane collider!", "Error: Collider Conversion", MB_OK);
+		ReportError(m_hwnd, "You tried setting data to a collider type that's isn't a plane collider!", "Error: Collider Conversion");
 		return;
 	}
 
@@ -250,7 +268,9 @@ void GameObject::AddModelComponent(ID3D11Device* device, const Model::ModelType
 	}
 }
 
-void GameObject::AddTextureComponent(ID3D11Device* device, const WCHAR* textureFileName, ResourceManager* resourceManager) {
+#ifdef _WIN32
+
+void GameObject::AddTextureComponent(ID3D11Device* device, const wchar_t* textureFileName, ResourceManager* resourceManager) {
 	
 	//Create and load texture
 	m_texture = new Texture(device, textureFileName, resourceManager);
@@ -264,6 +284,8 @@ void GameObject::AddTextureComponent(ID3D11Device* device, const WCHAR* textureF
 	}
 }
 
+#endif
+
 void GameObject::AddShaderComponent(Shader* shader) {
 	m_shader = shader;
 }
@@ -312,6 +334,20 @@ Collider* GameObject::GetColliderComponent() const {
 	return m_collider;
 }
 
+Model::ModelType GameObject::GetModelType() const {
+	return m_model->GetModelType();
+}
+
+Shader* GameObject::GetShader() const {
+	return m_shader;
+}
+
+bool GameObject::GetInitializationState() const {
+	return m_initializationFailed;
+}
+
+#ifdef _WIN32
+
 int GameObject::GetIndexCount() const {
 	return m_model->GetIndexCount();
 }
@@ -320,8 +356,20 @@ ID3D11ShaderResourceView* GameObject::GetTexture() const {
 	return m_texture->GetTexture();
 }
 
-bool GameObject::GetInitializationState() const {
-	return m_initializationFailed;
+ID3D11ShaderResourceView* GameObject::GetTextureArray() const {
+	return m_texture->GetTextureArray();
+}
+
+unsigned int GameObject::GetTextureLayer() const {
+	return m_texture->GetTextureLayer();
+}
+
+unsigned int GameObject::GetTextureHandle() const {
+	return m_texture->GetTextureHandle();
+}
+
+void GameObject::SetTextureHandle(const unsigned int textureHandle) const {
+	m_texture->SetTextureHandle(textureHandle);
 }
 
 bool GameObject::Render(ID3D11DeviceContext* deviceContext, XMMATRIX &worldMatrix, XMMATRIX &viewMatrix, XMMATRIX &projectionMatrix, XMFLOAT4 diffuseLight, XMFLOAT3 lightDirection) {
@@ -330,10 +378,17 @@ bool GameObject::Render(ID3D11DeviceContext* deviceContext, XMMATRIX &worldMatri
 	//const auto rotation = m_rotation->GetRotation();
 	auto position = XMVECTOR();
 	auto rotation = XMVECTOR();
-	auto scale = XMVECTOR();
 
 	m_rigidBody->GetPosition(position);
 	m_rigidBody->GetRotation(rotation);
+
+	return Render(deviceContext, position, rotation, GetTexture(), worldMatrix, viewMatrix, projectionMatrix, diffuseLight, lightDirection);
+}
+
+bool GameObject::Render(ID3D11DeviceContext* deviceContext, const XMVECTOR &position, const XMVECTOR &rotation, ID3D11ShaderResourceView* texture, XMMATRIX &worldMatrix, XMMATRIX &viewMatrix, XMMATRIX &projectionMatrix, XMFLOAT4 diffuseLight, XMFLOAT3 lightDirection) {
+
+	auto scale = XMVECTOR();
+
 	m_scale->GetScale(scale);
 
 	worldMatrix = XMMatrixMultiply(worldMatrix, XMMatrixScalingFromVector(scale));
@@ -347,14 +402,27 @@ bool GameObject::Render(ID3D11DeviceContext* deviceContext, XMMATRIX &worldMatri
 	//Render shader
 	if (m_shader)
 	{
-		result = m_shader->Render(deviceContext, GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix, GetTexture(), diffuseLight, lightDirection);
+		result = m_shader->Render(deviceContext, GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix, texture, diffuseLight, lightDirection);
 	}
 
 	return result;
 }
 
+void GameObject::RenderModel(ID3D11DeviceContext* deviceContext) const {
+	m_model->Render(deviceContext);
+}
+
+#endif
+
 void GameObject::ChangeRandomTexture() {
-	m_texture->ChangeRandomTexture();
+
+#ifdef _WIN32
+	//Bodies in a headless world have no texture
+	if (m_texture)
+	{
+		m_texture->ChangeRandomTexture();
+	}
+#endif
 }
 
 
@@ -1,21 +1,31 @@
 #pragma once
 
+#ifdef _WIN32
+#include <Windows.h>
+#else
+//Errors go to a message box on the window that owns the object, anywhere else there is no window and they go to the console
+typedef void* HWND;
+#endif
+
 #include "Model.h"
-#include "Texture.h"
 #include "Position.h"
 #include "Rotation.h"
 #include "Scale.h"
 #include "RigidBody.h"
-#include "Shader.h"
 #include "Velocity.h"
 #include "Collider.h"
 
+//Drawing is only used through pointers here so the header builds without the Windows SDK
+struct ID3D11ShaderResourceView;
+class Texture;
+class Shader;
+
 class GameObject
 {
 public:
 	GameObject(HWND hwnd); // Default Constructor (Empty GameObject)
 	//GameObject(ID3D11Device* device, const ModelType modelType, ResourceManager* resourceManager); //GameObject with model
-	//GameObject(ID3D11Device* device, const ModelType modelType, const WCHAR* textureFileName, ResourceManager* resourceManager); //GameObject with model/ texture
+	//GameObject(ID3D11Device* device, const ModelType modelType, const wchar_t* textureFileName, ResourceManager* resourceManager); //GameObject with model/ texture
 	GameObject(const GameObject& other); // Copy Constructor
 	GameObject(GameObject&& other) noexcept; // Move Constructor
 	~GameObject(); // Destructor
@@ -39,12 +49,14 @@ public:
 	void AddVelocityComponent(const XMFLOAT3 velocity);
 	void AddVelocityComponent(const float x, const float y, const float z);
 
-	void AddRigidBodyComponent(const bool useGravity, const float mass, const float drag, const float angularDrag, const XMFLOAT3 position, const XMFLOAT4 rotation, const XMFLOAT3 velocity, const XMFLOAT3 angularVelocity);
+	void AddRigidBodyComponent(BodyStateStore* bodyStateStore, const bool useGravity, const float mass, const float drag, const float angularDrag, const XMFLOAT3 position, const XMFLOAT4 rotation, const XMFLOAT3 velocity, const XMFLOAT3 angularVelocity);
 	void AddColliderComponent(const Collider::ColliderType colliderType);
 	void SetPlaneColliderData(const XMFLOAT3& centre, const XMFLOAT3& pointOne, const XMFLOAT3& pointTwo, const float offset) const;
 
 	void AddModelComponent(ID3D11Device* device, const Model::ModelType modelType, ResourceManager* resourceManager);
-	void AddTextureComponent(ID3D11Device* device, const WCHAR* textureFileName, ResourceManager* resourceManager);
+
+	//Windows only like every other texture and drawing call, headless bodies have neither
+	void AddTextureComponent(ID3D11Device* device, const wchar_t* textureFileName, ResourceManager* resourceManager);
 	void AddShaderComponent(Shader* shader);
 
 	Position* GetPositionComponent() const;
@@ -63,12 +75,24 @@ public:
 	Collider* GetColliderComponent() const;
 
 	int GetIndexCount() const;
+	Model::ModelType GetModelType() const;
 	ID3D11ShaderResourceView* GetTexture() const;
+	ID3D11ShaderResourceView* GetTextureArray() const;
+	unsigned int GetTextureLayer() const;
+	unsigned int GetTextureHandle() const;
+	void SetTextureHandle(const unsigned int textureHandle) const;
+	Shader* GetShader() const;
 
 	bool GetInitializationState() const;
 
 	bool Render(ID3D11DeviceContext* deviceContext, XMMATRIX &worldMatrix, XMMATRIX &viewMatrix, XMMATRIX &projectionMatrix, XMFLOAT4 diffuseLight, XMFLOAT3 lightDirection);
 
+	//Renders with a transform and texture taken from a published snapshot instead of the rigidbody the simulation thread is writing to
+	bool Render(ID3D11DeviceContext* deviceContext, const XMVECTOR &position, const XMVECTOR &rotation, ID3D11ShaderResourceView* texture, XMMATRIX &worldMatrix, XMMATRIX &viewMatrix, XMMATRIX &projectionMatrix, XMFLOAT4 diffuseLight, XMFLOAT3 lightDirection);
+
+	//Only binds the model buffers, used by the instanced path where the shader draws the whole batch
+	void RenderModel(ID3D11DeviceContext* deviceContext) const;
+
 	void ChangeRandomTexture();
 
 private:
@@ -1,12 +1,13 @@
 #include "GameObjectFactory.h"
+#include "WorldSnapshot.h"
 
-GameObjectFactory::GameObjectFactory(vector<GameObject*> &gameObjects) : m_gameObjects(gameObjects)
+GameObjectFactory::GameObjectFactory(vector<GameObject*> &gameObjects, BodyStateStore* bodyStateStore) : m_gameObjects(gameObjects), m_bodyStateStore(bodyStateStore)
 {
 }
 
 GameObjectFactory::~GameObjectFactory() = default;
 
-bool GameObjectFactory::AddGameObject(const HWND hwnd, ID3D11Device* device, const XMFLOAT3& position, const XMFLOAT3& rotation, const XMFLOAT3& scale, const XMFLOAT3& velocity, const XMFLOAT3& angularVelocity, const Collider::ColliderType& colliderType, const Model::ModelType& modelType, const bool& useGravity, const float& mass, const float& drag, const float& angularDrag, Shader* shader, const WCHAR* textureFileName, ResourceManager* resourceManager)
+bool GameObjectFactory::AddGameObject(const HWND hwnd, ID3D11Device* device, const XMFLOAT3& position, const XMFLOAT3& rotation, const XMFLOAT3& scale, const XMFLOAT3& velocity, const XMFLOAT3& angularVelocity, const Collider::ColliderType& colliderType, const Model::ModelType& modelType, const bool& useGravity, const float& mass, const float& drag, const float& angularDrag, Shader* shader, const wchar_t* textureFileName, ResourceManager* resourceManager)
 {
 	auto quaternionRotation = XMFLOAT4();
 
@@ -22,9 +23,65 @@ bool GameObjectFactory::AddGameObject(const HWND hwnd, ID3D11Device* device, con
 	m_gameObjects.back()->AddScaleComponent(scale);
 	m_gameObjects.back()->AddColliderComponent(colliderType);
 	m_gameObjects.back()->AddModelComponent(device, modelType, resourceManager);
-	m_gameObjects.back()->AddRigidBodyComponent(useGravity, mass, drag, angularDrag, position, quaternionRotation, velocity, angularVelocity);
-	m_gameObjects.back()->AddTextureComponent(device, textureFileName, resourceManager);
-	m_gameObjects.back()->AddShaderComponent(shader);
+	m_gameObjects.back()->AddRigidBodyComponent(m_bodyStateStore, useGravity, mass, drag, angularDrag, position, quaternionRotation, velocity, angularVelocity);
+
+#ifdef _WIN32
+	//Headless worlds pass no device, their bodies are never drawn so they only get the model type the inertia tensor needs
+	if (device)
+	{
+		m_gameObjects.back()->AddTextureComponent(device, textureFileName, resourceManager);
+		m_gameObjects.back()->AddShaderComponent(shader);
+	}
+#endif
+
+	return false;
+}
+
+bool GameObjectFactory::AddScene(const HWND hwnd, ID3D11Device* device, const SceneFile& scene, Shader* shader, ResourceManager* resourceManager)
+{
+	const auto& bodies = scene.GetBodies();
+	const auto& textureNames = scene.GetTextureNames();
+
+	//One allocation for the whole scene rather than growing the list a body at a time
+	m_gameObjects.reserve(m_gameObjects.size() + bodies.size());
+
+	for (const auto& body : bodies)
+	{
+		const auto colliderType = static_cast<Collider::ColliderType>(body.colliderType);
+
+		if (AddGameObject(hwnd, device, body.position, body.rotation, body.scale, body.velocity, body.angularVelocity,
+			colliderType, static_cast<Model::ModelType>(body.modelType),
+			body.useGravity != 0, body.mass, body.drag, body.angularDrag,
+			shader, textureNames[body.textureIndex].c_str(), resourceManager))
+		{
+			return true;
+		}
+
+		if (colliderType == Collider::ColliderType::Plane)
+		{
+			m_gameObjects.back()->SetPlaneColliderData(body.planeCentre, body.planePointOne, body.planePointTwo, body.planeOffset);
+		}
+	}
+
+	return false;
+}
+
+bool GameObjectFactory::AddSnapshot(const HWND hwnd, ID3D11Device* device, const WorldSnapshot& worldSnapshot, Shader* shader, ResourceManager* resourceManager)
+{
+	m_gameObjects.reserve(m_gameObjects.size() + worldSnapshot.GetObjectCount());
+
+	for (auto i = 0u; i < worldSnapshot.GetObjectCount(); i++)
+	{
+		const auto& objectState = worldSnapshot.GetObjectState(i);
+
+		//Placeholder transform and mass, the rigidbody state replaces all of it
+		if (AddGameObject(hwnd, device, XMFLOAT3(), XMFLOAT3(), XMFLOAT3(1.0f, 1.0f, 1.0f), XMFLOAT3(), XMFLOAT3(),
+			static_cast<Collider::ColliderType>(objectState.colliderType), static_cast<Model::ModelType>(objectState.modelType), objectState.rigidBody.useGravity != 0, 1.0f, 0.0f, 0.0f,
+			shader, worldSnapshot.GetTextureName(objectState.textureIndex).c_str(), resourceManager))
+		{
+			return true;
+		}
+	}
 
 	return false;
 }
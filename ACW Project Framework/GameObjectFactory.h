@@ -1,21 +1,34 @@
 #pragma once
 #include "GameObject.h"
+#include "SceneFile.h"
 #include <vector>
 
+class WorldSnapshot;
+
 class GameObjectFactory
 {
 public:
-	GameObjectFactory(vector<GameObject*> &gameObjects);
+	//Every rigidbody created keeps its position and velocity in the state store
+	GameObjectFactory(vector<GameObject*> &gameObjects, BodyStateStore* bodyStateStore);
 	~GameObjectFactory();
 
 	bool AddGameObject(const HWND hwnd, ID3D11Device* device, 
 		const XMFLOAT3 &position, const XMFLOAT3 &rotation, const XMFLOAT3 &scale, const XMFLOAT3 &velocity, const XMFLOAT3 &angularVelocity,
 		const Collider::ColliderType &colliderType, const Model::ModelType &modelType, 
 		const bool &useGravity, const float &mass, const float &drag, const float &angularDrag,
-		Shader* shader, const WCHAR* textureFileName, ResourceManager* resourceManager);
+		Shader* shader, const wchar_t* textureFileName, ResourceManager* resourceManager);
+
+	//Creates a game object for every body in the scene, returns true if any of them failed like AddGameObject
+	bool AddScene(const HWND hwnd, ID3D11Device* device, const SceneFile& scene, Shader* shader, ResourceManager* resourceManager);
+
+	//Creates a game object for every object in the snapshot with a placeholder transform and mass for WorldSnapshot::Apply to write
+	//the saved state over, returns true if any of them failed like AddGameObject
+	bool AddSnapshot(const HWND hwnd, ID3D11Device* device, const WorldSnapshot& worldSnapshot, Shader* shader, ResourceManager* resourceManager);
 
 private:
 
 	vector<GameObject*> &m_gameObjects;
+
+	BodyStateStore* m_bodyStateStore;
 };
 
@@ -1,7 +1,11 @@
 #include "GraphicsRenderer.h"
 #include <iostream>
+#include <fstream>
+
+GraphicsRenderer::GraphicsRenderer(int screenWidth, int screenHeight, HWND hwnd, const char* replayFileName, const bool deterministic, const unsigned int threadCount) : m_initializationFailed(false), m_d3D(nullptr), m_camera(nullptr), m_light(nullptr), m_gameObjectFactory(nullptr), m_bodyStateStore(nullptr), m_physicsManager(nullptr), m_collisionManager(nullptr), m_resolutionManager(nullptr), m_shaderManager(nullptr), m_resourceManager(nullptr), m_instanceBatcher(nullptr), m_drawListBuilder(nullptr), m_frustumCuller(nullptr), m_transformStore(nullptr), m_simulationThread(nullptr), m_workerPool(nullptr), m_worldSnapshot(nullptr), m_replayFile(nullptr), m_consoleOutputFile(nullptr), m_pauseSimulation(false), m_deterministic(deterministic), m_substepCount(1), m_timeScale(1), m_totalSpheresInSystem(0), m_totalCubesInSystem(0), m_numberOfSpheresToAdd(200), m_sphereDiameter(0.7f), m_friction(0.4f), m_restitution(0.4f), m_drawListBuildTime(0.0f), m_cullTime(0.0f), m_simulationStepTime(0.0f), m_simulationStepCount(0), m_stateHash(0), m_derivedDataUpdateCount(0), m_startupTime(0.0f), m_sceneLoadTime(0.0f), m_sceneCreateTime(0.0f), m_sceneBodyCount(0), m_resourcesReadyTime(0.0f), m_resourcesReadyPeakMemory(0), m_worldSnapshotTime(0.0f), m_replayStepCount(0), m_replayEventCount(0), m_replayStateHash(0), m_replaySimulatedTime(0.0f), m_replayTime(0.0f), m_replayAverageStageTimes() {
+	QueryPerformanceCounter(&m_startupStart);
+	QueryPerformanceFrequency(&m_frequency);
 
-GraphicsRenderer::GraphicsRenderer(int screenWidth, int screenHeight, HWND hwnd) : m_initializationFailed(false), m_d3D(nullptr), m_camera(nullptr), m_light(nullptr), m_gameObjectFactory(nullptr), m_physicsManager(nullptr), m_shaderManager(nullptr), m_resourceManager(nullptr), m_consoleOutputFile(nullptr), m_pauseSimulation(false), m_timeScale(1), m_totalSpheresInSystem(0), m_totalCubesInSystem(0), m_numberOfSpheresToAdd(200), m_sphereDiameter(0.7f), m_friction(0.4f), m_restitution(0.4f) {
 	//Create D3D object
 	m_d3D = new D3DContainer(screenWidth, screenHeight, hwnd, FULL_SCREEN, VSYNC_ENABLED, SCREEN_DEPTH, SCREEN_NEAR);
 
@@ -28,6 +32,16 @@ GraphicsRenderer::GraphicsRenderer(int screenWidth, int screenHeight, HWND hwnd)
 		return;
 	}
 
+	m_instanceBatcher = new InstanceBatcher();
+	m_drawListBuilder = new DrawListBuilder();
+	m_frustumCuller = new FrustumCuller();
+
+	m_transformStore = new TransformStore();
+	m_simulationThread = new SimulationThread();
+	m_workerPool = new WorkerPool(threadCount > 0 ? threadCount : WorkerPool::GetDefaultThreadCount());
+	m_worldSnapshot = new WorldSnapshot();
+	m_replayFile = new ReplayFile();
+
 	//Create camera
 	m_camera = new Camera();
 
@@ -53,330 +67,60 @@ GraphicsRenderer::GraphicsRenderer(int screenWidth, int screenHeight, HWND hwnd)
 	m_light->SetDiffuseColour(1.0f, 1.0f, 1.0f, 1.0f);
 	m_light->SetLightDirection(0.0f, 1.0f, 1.0f);
 
-	m_gameObjectFactory = new GameObjectFactory(m_gameObjects);
-
-	m_gameObjects.push_back(new GameObject(hwnd));
-	//m_gameObjects.back()->AddPositionComponent(0.0f, -3.0f, 0.0f);
-	//m_gameObjects.back()->AddRotationComponent(0.0f, 0.0f, 0.0f);
-	m_gameObjects.back()->AddScaleComponent(XMFLOAT3(9.375f, 1.0f, 3.0f));
-	m_gameObjects.back()->AddColliderComponent(Collider::ColliderType::Plane);
-	m_gameObjects.back()->SetPlaneColliderData(XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT3(9.375f, 1.0f, 0.0f), XMFLOAT3(0.0f, 1.0f, 9.375f), -1.0f);
-	m_gameObjects.back()->AddModelComponent(m_d3D->GetDevice(), Model::ModelType::Plane, m_resourceManager);
-	m_gameObjects.back()->AddRigidBodyComponent(false, 0.5f, 0.2f, 0.1f, XMFLOAT3(0.0f, 0.375f, 0.0f), XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f), XMFLOAT3(), XMFLOAT3());
-	m_gameObjects.back()->AddTextureComponent(m_d3D->GetDevice(), L"walls.dds", m_resourceManager);
-	m_gameObjects.back()->AddShaderComponent(m_shaderManager->GetTextureShader());
-
-	//Left wall
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-9.375f, 16.875f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.375f, 16.5f, 3.0f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::AABBCube, Model::ModelType::Cube, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"walls.dds", m_resourceManager);
-
-	//Right wall
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(9.375f, 16.875f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.375f, 16.5f, 3.0f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::AABBCube, Model::ModelType::Cube, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"walls.dds", m_resourceManager);
-
-	//Back wall
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(0.0f, 16.875f, 3.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(9.0f, 16.5f, 0.375f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::AABBCube, Model::ModelType::Cube, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"walls.dds", m_resourceManager);
-
-	//Top wall left
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-5.25f, 33.75f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(3.75f, 0.375f, 3.0f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::AABBCube, Model::ModelType::Cube, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"walls.dds", m_resourceManager);
-
-	//Top wall right
-	//Bottom floor
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(5.25f, 33.75f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(3.75f, 0.375f, 3.0f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::AABBCube, Model::ModelType::Cube, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"walls.dds", m_resourceManager);
-
-	//bins
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-7.5f, 7.875f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0375f, 7.5f, 3.0f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::AABBCube, Model::ModelType::Cube, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-6.0f, 7.875f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0375f, 7.5f, 3.0f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::AABBCube, Model::ModelType::Cube, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-4.5f, 7.875f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0375f, 7.5f, 3.0f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::AABBCube, Model::ModelType::Cube, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-3.0f, 7.875f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0375f, 7.5f, 3.0f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::AABBCube, Model::ModelType::Cube, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-1.5f, 7.875f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0375f, 7.5f, 3.0f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::AABBCube, Model::ModelType::Cube, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(0.0f, 7.875f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0375f, 7.5f, 3.0f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::AABBCube, Model::ModelType::Cube, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(1.5f, 7.875f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0375f, 7.5f, 3.0f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::AABBCube, Model::ModelType::Cube, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(3.0f, 7.875f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0375f, 7.5f, 3.0f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::AABBCube, Model::ModelType::Cube, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(4.5f, 7.875f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0375f, 7.5f, 3.0f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::AABBCube, Model::ModelType::Cube, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(6.0f, 7.875f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0375f, 7.5f, 3.0f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::AABBCube, Model::ModelType::Cube, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(7.5f, 7.875f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0375f, 7.5f, 3.0f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::AABBCube, Model::ModelType::Cube, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	//Pegs - Row 1
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-6.75f, 30.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-5.25f, 30.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-3.75f, 30.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-2.25f, 30.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-0.75f, 30.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(0.75f, 30.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(2.25f, 30.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(3.75f, 30.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(5.25f, 30.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(6.75f, 30.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	//Pegs - Row 2
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-6.0f, 27.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-4.5f, 27.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-3.0f, 27.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-1.5f, 27.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(0.0f, 27.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(1.5f, 27.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(3.0f, 27.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(4.5f, 27.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(6.0f, 27.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	//Pegs - Row 3
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-6.75f, 24.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-5.25f, 24.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-3.75f, 24.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-2.25f, 24.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-0.75f, 24.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(0.75f, 24.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(2.25f, 24.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
+	m_bodyStateStore = new BodyStateStore();
+	m_gameObjectFactory = new GameObjectFactory(m_gameObjects, m_bodyStateStore);
 
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(3.75f, 24.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
+	//Everything in the scene comes from the scene file, the walls, bins and pegs are static bodies
+	SceneFile scene;
 
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(5.25f, 24.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(6.75f, 24.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	//Pegs - Row 4
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-6.0f, 21.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-4.5f, 21.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-3.0f, 21.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-1.5f, 21.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(0.0f, 21.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(1.5f, 21.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(3.0f, 21.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(4.5f, 21.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(6.0f, 21.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	//Pegs - Row 5
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-6.75f, 18.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-5.25f, 18.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-3.75f, 18.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-2.25f, 18.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-0.75f, 18.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(0.75f, 18.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(2.25f, 18.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(3.75f, 18.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(5.25f, 18.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(6.75f, 18.0f, 0.0f), XMFLOAT3(XM_PIDIV2, 0.0f, 0.0), XMFLOAT3(0.075f, 3.0f, 0.075f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::Cylinder, Model::ModelType::Cylinder, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"bins.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(-5.75f, 36.75f, 0.0f), XMFLOAT3(0.0f, 0.0f, -XM_PI/6), XMFLOAT3(4.5f, 0.75f, 3.0f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::OBBCube, Model::ModelType::Cube, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"walls.dds", m_resourceManager);
-
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(5.75f, 36.75f, 0.0f), XMFLOAT3(0.0f, 0.0f, XM_PI / 6), XMFLOAT3(4.5f, 0.75f, 3.0f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::OBBCube, Model::ModelType::Cube, false, 0.5f, 0.0f, 0.0f,
-		m_shaderManager->GetTextureShader(), L"walls.dds", m_resourceManager);
-
-	auto quaternionRotation = XMFLOAT4();
-
-	XMStoreFloat4(&quaternionRotation, XMQuaternionRotationRollPitchYaw(0.0f, 0.0f, -XM_PIDIV2));
-
-	m_gameObjects.push_back(new GameObject(hwnd));
-	//m_gameObjects.back()->AddPositionComponent(0.0f, -3.0f, 0.0f);
-	//m_gameObjects.back()->AddRotationComponent(0.0f, 0.0f, 0.0f);
-	m_gameObjects.back()->AddScaleComponent(XMFLOAT3(15.0f, 1.0f, 3.0f));
-	m_gameObjects.back()->AddColliderComponent(Collider::ColliderType::Plane);
-	m_gameObjects.back()->SetPlaneColliderData(XMFLOAT3(-9.375f, 45.0f, 0.0f), XMFLOAT3(-9.375f, 46.0f, 0.0f), XMFLOAT3(-9.375f, 45.0f, 1.0f), 8.5f);
-	m_gameObjects.back()->AddModelComponent(m_d3D->GetDevice(), Model::ModelType::Plane, m_resourceManager);
-	m_gameObjects.back()->AddRigidBodyComponent(false, 0.5f, 0.2f, 0.1f, XMFLOAT3(-9.375f, 45.0f, 0.0f), quaternionRotation, XMFLOAT3(), XMFLOAT3());
-	m_gameObjects.back()->AddTextureComponent(m_d3D->GetDevice(), L"walls.dds", m_resourceManager);
-	m_gameObjects.back()->AddShaderComponent(m_shaderManager->GetTextureShader());
-
-	XMStoreFloat4(&quaternionRotation, XMQuaternionRotationRollPitchYaw(0.0f, 0.0f, XM_PIDIV2));
-
-	m_gameObjects.push_back(new GameObject(hwnd));
-	//m_gameObjects.back()->AddPositionComponent(0.0f, -3.0f, 0.0f);
-	//m_gameObjects.back()->AddRotationComponent(0.0f, 0.0f, 0.0f);
-	m_gameObjects.back()->AddScaleComponent(XMFLOAT3(15.0f, 1.0f, 3.0f));
-	m_gameObjects.back()->AddColliderComponent(Collider::ColliderType::Plane);
-	m_gameObjects.back()->SetPlaneColliderData(XMFLOAT3(9.375f, 0.0f, 0.0f), XMFLOAT3(9.375f, 0.0f, 1.0f), XMFLOAT3(9.375f, 1.0f, 0.0f), 8.5f);
-	m_gameObjects.back()->AddModelComponent(m_d3D->GetDevice(), Model::ModelType::Plane, m_resourceManager);
-	m_gameObjects.back()->AddRigidBodyComponent(false, 0.5f, 0.2f, 0.1f, XMFLOAT3(9.375f, 45.0f, 0.0f), quaternionRotation, XMFLOAT3(), XMFLOAT3());
-	m_gameObjects.back()->AddTextureComponent(m_d3D->GetDevice(), L"walls.dds", m_resourceManager);
-	m_gameObjects.back()->AddShaderComponent(m_shaderManager->GetTextureShader());
-
-	m_physicsManager = new PhysicsManager(m_gameObjects);
+	LARGE_INTEGER sceneStart;
+	LARGE_INTEGER sceneLoaded;
+	LARGE_INTEGER sceneCreated;
+
+	QueryPerformanceCounter(&sceneStart);
+
+	if (!scene.Load(SCENE_FILE_NAME))
+	{
+		m_initializationFailed = true;
+
+		auto message = "Could not load the scene file " + string(SCENE_FILE_NAME);
+
+		if (scene.GetErrorLine() > 0)
+		{
+			message += ", error on line " + to_string(scene.GetErrorLine());
+		}
+
+		MessageBox(hwnd, message.c_str(), "Error", MB_OK);
+		return;
+	}
+
+	QueryPerformanceCounter(&sceneLoaded);
+
+	if (m_gameObjectFactory->AddScene(hwnd, m_d3D->GetDevice(), scene, m_shaderManager->GetTextureShader(), m_resourceManager))
+	{
+		m_initializationFailed = true;
+		MessageBox(hwnd, "Could not create the scene", "Error", MB_OK);
+		return;
+	}
+
+	QueryPerformanceCounter(&sceneCreated);
+
+	m_sceneLoadTime = static_cast<float>((sceneLoaded.QuadPart - sceneStart.QuadPart) * 1000.0 / static_cast<double>(m_frequency.QuadPart));
+	m_sceneCreateTime = static_cast<float>((sceneCreated.QuadPart - sceneLoaded.QuadPart) * 1000.0 / static_cast<double>(m_frequency.QuadPart));
+	m_sceneBodyCount = static_cast<unsigned int>(scene.GetBodies().size());
+
+	m_physicsManager = new PhysicsManager(m_gameObjects, m_bodyStateStore);
 	m_collisionManager = new CollisionManager(m_gameObjects, m_friction, m_restitution);
+	m_collisionManager->SetDeterministic(m_deterministic);
+	m_collisionManager->SetWorkerPool(m_workerPool);
+	m_physicsManager->SetWorkerPool(m_workerPool);
 	m_resolutionManager = new ResolutionManager(m_collisionManager->GetContactManifoldReference(), 1000, 1000, 0.001f, 0.01f);
+	m_resolutionManager->SetWorkerPool(m_workerPool);
 
-	QueryPerformanceFrequency(&m_frequency);
 	QueryPerformanceCounter(&m_start);
 
+	m_startupTime = static_cast<float>((m_start.QuadPart - m_startupStart.QuadPart) * 1000.0 / static_cast<double>(m_frequency.QuadPart));
+
 	//Create console window
 	if (!AllocConsole())
 	{
@@ -385,14 +129,30 @@ GraphicsRenderer::GraphicsRenderer(int screenWidth, int screenHeight, HWND hwnd)
 
 	freopen_s(&m_consoleOutputFile, "CONOUT$", "w", stdout);
 
-	UpdateConsole();
-
-	//For each gameObject that has a rigidbody we clear our accumulated force and calculate our derived data for the transform matrix (translation and rotation matrix)
+	//For each gameObject that has a rigidbody we clear our accumulated force, derived data was built when the body was created
 	for (auto* gameObject : m_gameObjects)
 	{
 		gameObject->GetRigidBodyComponent()->ClearAccumulators();
-		gameObject->GetRigidBodyComponent()->CalculateDerivedData();
 	}
+
+	//Playback happens before the simulation thread starts so nothing else touches the scene, and isn't recorded so it can't overwrite the replay being played
+	if (replayFileName)
+	{
+		PlayReplay(hwnd, replayFileName);
+	}
+	else
+	{
+		StartReplayRecording();
+	}
+
+	UpdateConsole();
+
+	//Give the renderer something to draw before the first step, then hand physics over to its own thread
+	PublishTransforms();
+
+	QueryPerformanceCounter(&m_start);
+
+	m_simulationThread->Start([this]() { StepSimulation(); }, MINIMUM_SIMULATION_STEP);
 }
 
 GraphicsRenderer::GraphicsRenderer(const GraphicsRenderer& other) = default;
@@ -403,6 +163,57 @@ GraphicsRenderer::~GraphicsRenderer()
 {
 	//Release resources
 
+	//Stop the simulation first, it uses everything below
+	if (m_simulationThread)
+	{
+		m_simulationThread->Stop();
+		delete m_simulationThread;
+		m_simulationThread = nullptr;
+	}
+
+	if (m_workerPool)
+	{
+		delete m_workerPool;
+		m_workerPool = nullptr;
+	}
+
+	//Writes out whatever the recording still has buffered
+	if (m_replayFile)
+	{
+		delete m_replayFile;
+		m_replayFile = nullptr;
+	}
+
+	if (m_worldSnapshot)
+	{
+		delete m_worldSnapshot;
+		m_worldSnapshot = nullptr;
+	}
+
+	if (m_transformStore)
+	{
+		delete m_transformStore;
+		m_transformStore = nullptr;
+	}
+
+	if (m_frustumCuller)
+	{
+		delete m_frustumCuller;
+		m_frustumCuller = nullptr;
+	}
+
+	if (m_drawListBuilder)
+	{
+		delete m_drawListBuilder;
+		m_drawListBuilder = nullptr;
+	}
+
+	if (m_instanceBatcher)
+	{
+		delete m_instanceBatcher;
+		m_instanceBatcher = nullptr;
+	}
+
 	if (m_resourceManager)
 	{
 		delete m_resourceManager;
@@ -415,6 +226,13 @@ GraphicsRenderer::~GraphicsRenderer()
 		m_shaderManager = nullptr;
 	}
 
+	//Holds a reference to the collision manager's contact manifold so goes first
+	if (m_resolutionManager)
+	{
+		delete m_resolutionManager;
+		m_resolutionManager = nullptr;
+	}
+
 	if (m_collisionManager)
 	{
 		delete m_collisionManager;
@@ -436,6 +254,13 @@ GraphicsRenderer::~GraphicsRenderer()
 		}
 	}
 
+	//The rigidbodies hand their slots back as they're deleted, so this goes after them
+	if (m_bodyStateStore)
+	{
+		delete m_bodyStateStore;
+		m_bodyStateStore = nullptr;
+	}
+
 	if (m_light)
 	{
 		delete m_light;
@@ -465,89 +290,145 @@ Camera* GraphicsRenderer::GetCamera() const
 
 void GraphicsRenderer::TogglePauseSimulation()
 {
+	lock_guard<mutex> lock(m_simulationThread->GetMutex());
+
 	m_pauseSimulation = !m_pauseSimulation;
 }
 
 void GraphicsRenderer::ToggleRandomTexture() {
+	lock_guard<mutex> lock(m_simulationThread->GetMutex());
+
 	m_collisionManager->ToggleRandomTexture();
 }
 
-void GraphicsRenderer::ClearMoveableGameObjects()
+void GraphicsRenderer::ToggleDeterministicMode()
 {
-	for (unsigned i = 0; i < m_gameObjects.size(); i++)
-	{
-		if (m_gameObjects[i]->GetRigidBodyComponent()->GetUseGravity())
-		{
-			delete m_gameObjects[i];
-			m_gameObjects.at(i) = nullptr;
-			m_gameObjects.erase(m_gameObjects.begin() + i);
-			--i;
-		}
-	}
+	lock_guard<mutex> lock(m_simulationThread->GetMutex());
+
+	SetDeterministic(!m_deterministic);
 
-	m_totalSpheresInSystem = 0;
-	m_totalCubesInSystem = 0;
 	UpdateConsole();
 }
 
+void GraphicsRenderer::ToggleWideSolver()
+{
+	lock_guard<mutex> lock(m_simulationThread->GetMutex());
 
-void GraphicsRenderer::AddNumberOfSpheres(const HWND hwnd)
+	SetWideSolver(!m_resolutionManager->GetWideSolver());
+
+	UpdateConsole();
+}
+
+void GraphicsRenderer::CycleSubsteps()
 {
-	XMFLOAT3 startPosition(-7.5f, 38.75f, 0.0f);
-	auto distributionX = abs(startPosition.x * 2) / 7;
+	lock_guard<mutex> lock(m_simulationThread->GetMutex());
 
-	int totalCount = 0;
-	unsigned xCount = 1;
-	unsigned yCount = 1;
+	SetSubsteps(m_substepCount < MAXIMUM_SIMULATION_SUBSTEPS ? m_substepCount * 2 : 1);
+
+	UpdateConsole();
+}
+
+void GraphicsRenderer::SaveWorldSnapshot()
+{
+	//Wait for the current physics step to finish so the snapshot is of one consistent step
+	lock_guard<mutex> lock(m_simulationThread->GetMutex());
+
+	LARGE_INTEGER snapshotStart;
+	LARGE_INTEGER snapshotEnd;
+
+	QueryPerformanceCounter(&snapshotStart);
+
+	m_worldSnapshot->Capture(m_gameObjects, m_resourceManager, GetWorldSettings());
 
-	while (totalCount < m_numberOfSpheresToAdd)
+	if (!m_worldSnapshot->Save(WORLD_SNAPSHOT_FILE_NAME))
 	{
-		if (xCount == 7)
-		{
-			xCount = 1;
-			yCount++;
-		}
+		MessageBox(nullptr, "The world snapshot could not be saved", "Error", MB_OK);
+	}
 
-		m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(startPosition.x + (xCount * distributionX), startPosition.y + (yCount * distributionX), 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(m_sphereDiameter / 2, m_sphereDiameter / 2, m_sphereDiameter / 2), XMFLOAT3(), XMFLOAT3(),
-			Collider::ColliderType::Sphere, Model::ModelType::Sphere, true, 0.5f, 0.3f, 0.3f,
-			m_shaderManager->GetTextureShader(), L"sphere2.dds", m_resourceManager);
+	QueryPerformanceCounter(&snapshotEnd);
 
-		xCount++;
-		totalCount++;
+	m_worldSnapshotTime = static_cast<float>((snapshotEnd.QuadPart - snapshotStart.QuadPart) * 1000.0 / static_cast<double>(m_frequency.QuadPart));
+
+	UpdateConsole();
+}
+
+void GraphicsRenderer::LoadWorldSnapshot(const HWND hwnd)
+{
+	//Wait for the current physics step to finish before changing the scene
+	lock_guard<mutex> lock(m_simulationThread->GetMutex());
+
+	LARGE_INTEGER snapshotStart;
+	LARGE_INTEGER snapshotEnd;
+
+	QueryPerformanceCounter(&snapshotStart);
+
+	if (!m_worldSnapshot->Load(WORLD_SNAPSHOT_FILE_NAME))
+	{
+		MessageBox(hwnd, "The world snapshot could not be loaded", "Error", MB_OK);
+		return;
 	}
 
-	m_totalSpheresInSystem += m_numberOfSpheresToAdd;
+	RestoreWorldSnapshot(hwnd, *m_worldSnapshot);
 
-	//For each gameObject that has a rigidbody we clear our accumulated force and calculate our derived data for the transform matrix (translation and rotation matrix)
-	for (auto* gameObject : m_gameObjects)
+	QueryPerformanceCounter(&snapshotEnd);
+
+	m_worldSnapshotTime = static_cast<float>((snapshotEnd.QuadPart - snapshotStart.QuadPart) * 1000.0 / static_cast<double>(m_frequency.QuadPart));
+
+	//Restart the step timer so the time spent restoring isn't simulated
+	m_start = snapshotEnd;
+
+	//The recording has to start again from the restored world
+	if (m_replayFile->IsRecording())
 	{
-		gameObject->GetRigidBodyComponent()->ClearAccumulators();
-		gameObject->GetRigidBodyComponent()->CalculateDerivedData();
+		StartReplayRecording();
 	}
 
+	PublishTransforms();
+
+	UpdateConsole();
+}
+
+void GraphicsRenderer::ClearMoveableGameObjects()
+{
+	//Wait for the current physics step to finish before changing the scene
+	lock_guard<mutex> lock(m_simulationThread->GetMutex());
+
+	RemoveMoveableGameObjects();
+
+	//Indices have shifted so the last snapshot no longer lines up with m_gameObjects
+	PublishTransforms();
+
+	UpdateConsole();
+}
+
+void GraphicsRenderer::AddNumberOfSpheres(const HWND hwnd)
+{
+	//Wait for the current physics step to finish before changing the scene
+	lock_guard<mutex> lock(m_simulationThread->GetMutex());
+
+	SpawnSpheres(hwnd, m_numberOfSpheresToAdd, m_sphereDiameter);
+
+	PublishTransforms();
+
 	UpdateConsole();
 }
 
 void GraphicsRenderer::AddCube(const HWND hwnd)
 {
-	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(0.3f, 42.75f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.45f, 0.45f, 0.45f), XMFLOAT3(), XMFLOAT3(),
-		Collider::ColliderType::OBBCube, Model::ModelType::Cube, true, 0.2f, 0.1f, 0.1f,
-		m_shaderManager->GetTextureShader(), L"sphere.dds", m_resourceManager);
+	//Wait for the current physics step to finish before changing the scene
+	lock_guard<mutex> lock(m_simulationThread->GetMutex());
 
-	m_totalCubesInSystem++;
+	SpawnCube(hwnd);
 
-	//For each gameObject that has a rigidbody we clear our accumulated force and calculate our derived data for the transform matrix (translation and rotation matrix)
-	for (auto* gameObject : m_gameObjects)
-	{
-		gameObject->GetRigidBodyComponent()->ClearAccumulators();
-		gameObject->GetRigidBodyComponent()->CalculateDerivedData();
-	}
+	PublishTransforms();
 
 	UpdateConsole();
 }
 
 void GraphicsRenderer::AddTimeScale(const int number)
 {
+	lock_guard<mutex> lock(m_simulationThread->GetMutex());
+
 	m_timeScale += number;
 
 	if (m_timeScale < 1)
@@ -560,6 +441,8 @@ void GraphicsRenderer::AddTimeScale(const int number)
 
 void GraphicsRenderer::AddNumberOfSpheres(const int number)
 {
+	lock_guard<mutex> lock(m_simulationThread->GetMutex());
+
 	m_numberOfSpheresToAdd += number;
 
 	if (m_numberOfSpheresToAdd < 0)
@@ -572,6 +455,8 @@ void GraphicsRenderer::AddNumberOfSpheres(const int number)
 
 void GraphicsRenderer::AddSphereDiameter(const float diameter)
 {
+	lock_guard<mutex> lock(m_simulationThread->GetMutex());
+
 	m_sphereDiameter += diameter;
 
 	if (m_sphereDiameter < 0.1f)
@@ -589,6 +474,8 @@ void GraphicsRenderer::AddSphereDiameter(const float diameter)
 
 void GraphicsRenderer::AddFriction(const float friction)
 {
+	lock_guard<mutex> lock(m_simulationThread->GetMutex());
+
 	m_friction += friction;
 
 	if (m_friction < 0.0f)
@@ -596,13 +483,15 @@ void GraphicsRenderer::AddFriction(const float friction)
 		m_friction = 0.0f;
 	}
 
-	m_collisionManager->SetFriction(m_friction);
+	SetFriction(m_friction);
 
 	UpdateConsole();
 }
 
 void GraphicsRenderer::AddRestitution(const float restitution)
 {
+	lock_guard<mutex> lock(m_simulationThread->GetMutex());
+
 	m_restitution += restitution;
 
 	if (m_restitution < 0.0f)
@@ -615,7 +504,15 @@ void GraphicsRenderer::AddRestitution(const float restitution)
 		m_restitution = 1.0f;
 	}
 
-	m_collisionManager->SetRestitution(m_restitution);
+	SetRestitution(m_restitution);
+
+	UpdateConsole();
+}
+
+void GraphicsRenderer::RefreshFrameStatistics()
+{
+	//The console reads the simulation's counters and settings, so wait for the current step to finish
+	lock_guard<mutex> lock(m_simulationThread->GetMutex());
 
 	UpdateConsole();
 }
@@ -633,6 +530,9 @@ void GraphicsRenderer::UpdateConsole()
 	cout << " 2 - Add Cube" << endl;
 	cout << " R - Reset System" << endl;
 	cout << " P - Toggle Pause Simulation" << endl;
+	cout << " M - Toggle Deterministic Mode: " << (m_deterministic ? "on" : "off") << endl;
+	cout << " V - Toggle Wide Contact Solver: " << (m_resolutionManager->GetWideSolver() ? "on" : "off") << endl;
+	cout << " N - Cycle Solver Substeps: " << m_substepCount << endl;
 	cout << " U, J - Increase/Decrease TimeScale: x" << m_timeScale << endl;
 	cout << " [, ] - Increase/Decrease Number of Spheres: " << m_numberOfSpheresToAdd << endl;
 	cout << " T, B - Increase/Decrease Sphere Diameter: " << m_sphereDiameter << endl;
@@ -640,15 +540,131 @@ void GraphicsRenderer::UpdateConsole()
 	cout << " O, L - Increase/Decrease Restitution: " << m_restitution << endl << endl;
 	cout << " W, S, A, D - Up, Down, Left, Right Camera Controls" << endl;
 	cout << " Up, Down Arrow - Zoom In/Out" << endl;
+	cout << " F - Refresh Frame Statistics" << endl;
+	cout << " F5, F9 - Save/Restore World Snapshot" << endl << endl;
+
+	cout << " Scene: " << m_sceneBodyCount << " bodies, file load: " << m_sceneLoadTime << "ms, object creation: " << m_sceneCreateTime << "ms" << endl;
+	if (!m_worldSnapshot->IsEmpty())
+	{
+		cout << " World snapshot: " << m_worldSnapshot->GetObjectCount() << " objects, " << m_worldSnapshot->GetSize() / 1024 << "KB, last save/restore: " << m_worldSnapshotTime << "ms" << endl;
+	}
+
+	if (m_replayFile->IsRecording())
+	{
+		cout << " Recording " << REPLAY_FILE_NAME << ": " << m_replayFile->GetRecordedCount() << " records" << endl;
+	}
+
+	if (!m_replayTimingsFileName.empty())
+	{
+		cout << " Replay: " << m_replayStepCount << " steps, " << m_replayEventCount << " scene changes, " << m_replaySimulatedTime << "s simulated in " << m_replayTime << "ms, step timings in " << m_replayTimingsFileName << endl;
+		cout << "   average integrate/detect/resolve/update: " << m_replayAverageStageTimes.integrate << "/" << m_replayAverageStageTimes.detect << "/" << m_replayAverageStageTimes.resolve << "/" << m_replayAverageStageTimes.update << "us, final state hash: " << hex << m_replayStateHash << dec << endl;
+	}
+
+	cout << " Startup time: " << m_startupTime << "ms, resources ready after: ";
+
+	if (m_resourceManager->HasPendingLoads())
+	{
+		cout << "still loading" << endl;
+	}
+	else
+	{
+		cout << m_resourcesReadyTime << "ms, failed loads: " << m_resourceManager->GetFailedLoadCount() << ", peak working set: " << m_resourcesReadyPeakMemory / 1024 << "KB" << endl;
+	}
+
+	for (auto modelHandle = 0u; modelHandle < m_resourceManager->GetModelCount(); modelHandle++)
+	{
+		const auto& loadInformation = m_resourceManager->GetModelLoadInformation(modelHandle);
+
+		if (!loadInformation.loaded)
+		{
+			cout << " " << loadInformation.fileName << ": " << (loadInformation.loadFailed ? "failed to load" : "loading") << endl;
+			continue;
+		}
+
+		cout << " " << loadInformation.fileName << ": " << loadInformation.loadTime << "ms " << (loadInformation.loadedFromCache ? "from cache" : "parsed") << ", " << loadInformation.vertexCount << " vertices, " << loadInformation.indexCount << " indices" << endl;
+		cout << "   vertex bytes " << loadInformation.unoptimizedVertexBytes << " -> " << loadInformation.vertexBytes << ", index bytes " << loadInformation.unoptimizedIndexBytes << " -> " << loadInformation.indexBytes << endl;
+	}
+
+	const auto& unsortedStateChanges = m_drawListBuilder->GetUnsortedStateChanges();
+	const auto& sortedStateChanges = m_drawListBuilder->GetSortedStateChanges();
+
+	const auto objectCount = m_frustumCuller->GetObjectCount();
+
+	const auto& snapshot = m_transformStore->AcquireLatest();
+
+	cout << " Simulation worker threads: " << m_workerPool->GetThreadCount() << endl;
+	cout << " Simulation step: " << snapshot.stepNumber << ", step time: " << snapshot.stepTime << "us, transform checksum: " << hex << TransformStore::Checksum(snapshot) << dec << endl;
+	cout << " Contacts: " << snapshot.contactCount << ", coloured solver batches: " << snapshot.contactBatchCount << ", velocity solve: " << snapshot.velocitySolveRate << " contacts/us" << endl;
+	cout << " Inertia tensors rebuilt last step: " << snapshot.derivedDataUpdates << endl;
+	cout << " Broadphase pairs: " << snapshot.broadphasePairCount << ", cells/entries/sort/pairs: " << snapshot.broadphaseTimings.cellKeys << "/" << snapshot.broadphaseTimings.entries << "/" << snapshot.broadphaseTimings.sort << "/" << snapshot.broadphaseTimings.pairs << "us" << endl;
+
+	if (m_deterministic)
+	{
+		cout << " Deterministic state hash: " << hex << snapshot.stateHash << dec << endl;
+	}
+	cout << " Visible objects: " << m_frustumCuller->GetVisibleIndices().size() << " of " << objectCount << endl;
+	cout << " Culling time: " << m_cullTime << "us (" << (m_cullTime > 0.0f ? objectCount / m_cullTime : 0.0f) << " objects/us)" << endl;
+	cout << " Draw list build time: " << m_drawListBuildTime << "us" << endl;
+	cout << " State changes unsorted (shader/texture/model): " << unsortedStateChanges.shaderChanges << "/" << unsortedStateChanges.textureChanges << "/" << unsortedStateChanges.modelChanges << endl;
+	cout << " State changes sorted (shader/texture/model): " << sortedStateChanges.shaderChanges << "/" << sortedStateChanges.textureChanges << "/" << sortedStateChanges.modelChanges << endl;
+	cout << " Instanced draw calls: " << m_instanceBatcher->GetBatches().size() << ", largest batch: " << m_instanceBatcher->GetLargestBatchSize() << endl;
+	cout << " Texture arrays: " << m_resourceManager->GetTextureArrayCount() << endl;
 }
 
 bool GraphicsRenderer::Frame() {
 
+	//Textures and models are read on worker threads, create the resources for any that have finished since the last frame
+	if (m_resourceManager->HasPendingLoads())
+	{
+		lock_guard<mutex> lock(m_simulationThread->GetMutex());
+
+		if (m_resourceManager->CompleteLoads(m_d3D->GetDevice(), false))
+		{
+			//Snapshots hold texture pointers so republish to swap the placeholders out
+			PublishTransforms();
+		}
+
+		if (!m_resourceManager->HasPendingLoads())
+		{
+			LARGE_INTEGER resourcesReady;
+			QueryPerformanceCounter(&resourcesReady);
+
+			m_resourcesReadyTime = static_cast<float>((resourcesReady.QuadPart - m_startupStart.QuadPart) * 1000.0 / static_cast<double>(m_frequency.QuadPart));
+
+			//Peak working set covers the mapped files as well as our own allocations
+			PROCESS_MEMORY_COUNTERS memoryCounters;
+
+			if (GetProcessMemoryInfo(GetCurrentProcess(), &memoryCounters, sizeof(memoryCounters)))
+			{
+				m_resourcesReadyPeakMemory = memoryCounters.PeakWorkingSetSize;
+			}
+		}
+	}
+
+	//Draw whatever the simulation thread published last, this never waits on a physics step
+	const auto& snapshot = m_transformStore->AcquireLatest();
+
+	//Render the graphics scene
+	auto const result = Render(snapshot);
+
+	return result;
+}
+
+void GraphicsRenderer::StepSimulation() {
+
 	//calculate dt based on the simulation loop rate using a timer
 	QueryPerformanceCounter(&m_end);
 	m_dt = static_cast<float>((m_end.QuadPart - m_start.QuadPart) / static_cast<double>(m_frequency.QuadPart));
+
+	//The simulation thread only calls this once a step is due, so this is never much less than MINIMUM_SIMULATION_STEP
 	m_start = m_end;
 
+	//A fixed step doesn't depend on how late the thread woke up, the simulation falls behind real time rather than taking a longer step
+	if (m_deterministic)
+	{
+		m_dt = DETERMINISTIC_SIMULATION_STEP;
+	}
+
 	m_dt *= m_timeScale;
 
 	if (m_pauseSimulation)
@@ -658,22 +674,404 @@ bool GraphicsRenderer::Frame() {
 
 	m_fps = static_cast<int>(1.0 / m_dt);
 
-	m_physicsManager->CalculateGameObjectPhysics(m_dt);
+	//The dt actually simulated is recorded rather than the timer, so the replay takes exactly the same steps
+	m_replayFile->AddRecord(ReplayFile::RecordType::Step, m_timeScale, m_dt);
 
-	m_collisionManager->DynamicCollisionDetection();
+	StageTimes stageTimes;
+	RunSimulationStages(m_dt, stageTimes);
 
-	//m_collisionManager->DynamicCollisionResponse(m_dt);
-	m_resolutionManager->ResolveContacts(m_dt);
+	m_stateHash = m_deterministic ? m_physicsManager->CalculateStateHash() : 0;
 
-	m_physicsManager->UpdateGameObjectPhysics();
+	LARGE_INTEGER stepEnd;
+	QueryPerformanceCounter(&stepEnd);
 
-	//Render the graphics scene
-	auto const result = Render();
+	m_simulationStepTime = ElapsedMicroseconds(m_end, stepEnd);
 
-	return result;
+	PublishTransforms();
 }
 
-bool GraphicsRenderer::Render() {
+void GraphicsRenderer::RunSimulationStages(const float dt, StageTimes& stageTimes) {
+
+	LARGE_INTEGER stageStart;
+	LARGE_INTEGER integrateEnd;
+	LARGE_INTEGER detectEnd;
+	LARGE_INTEGER resolveEnd;
+	LARGE_INTEGER updateEnd;
+
+	stageTimes = StageTimes();
+
+	const auto substepDt = dt / m_substepCount;
+
+	//One substep runs exactly as before, with more the contacts found after the first are reused for the rest of the frame
+	for (unsigned int substep = 0; substep < m_substepCount; substep++)
+	{
+		QueryPerformanceCounter(&stageStart);
+
+		m_physicsManager->CalculateGameObjectPhysics(substepDt);
+
+		QueryPerformanceCounter(&integrateEnd);
+
+		if (substep == 0)
+		{
+			m_collisionManager->DynamicCollisionDetection();
+
+			if (m_substepCount > 1)
+			{
+				m_resolutionManager->BeginSubsteps();
+			}
+		}
+
+		QueryPerformanceCounter(&detectEnd);
+
+		//m_collisionManager->DynamicCollisionResponse(m_dt);
+		if (m_substepCount > 1)
+		{
+			m_resolutionManager->ResolveSubstep(substepDt, SUBSTEP_SOLVER_PASSES, COLOURED_SUBSTEP_SOLVER_PASSES);
+		}
+		else
+		{
+			m_resolutionManager->ResolveContacts(dt);
+		}
+
+		QueryPerformanceCounter(&resolveEnd);
+
+		m_physicsManager->UpdateGameObjectPhysics();
+
+		QueryPerformanceCounter(&updateEnd);
+
+		stageTimes.integrate += ElapsedMicroseconds(stageStart, integrateEnd);
+		stageTimes.detect += ElapsedMicroseconds(integrateEnd, detectEnd);
+		stageTimes.resolve += ElapsedMicroseconds(detectEnd, resolveEnd);
+		stageTimes.update += ElapsedMicroseconds(resolveEnd, updateEnd);
+	}
+}
+
+void GraphicsRenderer::PublishTransforms() {
+
+	auto& snapshot = m_transformStore->GetWriteSnapshot();
+
+	snapshot.transforms.resize(m_gameObjects.size());
+
+	for (unsigned int i = 0; i < m_gameObjects.size(); i++)
+	{
+		auto position = XMVECTOR();
+		auto rotation = XMVECTOR();
+
+		m_gameObjects[i]->GetRigidBodyComponent()->GetPosition(position);
+		m_gameObjects[i]->GetRigidBodyComponent()->GetRotation(rotation);
+
+		XMStoreFloat3(&snapshot.transforms[i].position, position);
+		XMStoreFloat4(&snapshot.transforms[i].rotation, rotation);
+		snapshot.transforms[i].texture = m_gameObjects[i]->GetTexture();
+		snapshot.transforms[i].textureArray = m_gameObjects[i]->GetTextureArray();
+		snapshot.transforms[i].textureLayer = m_gameObjects[i]->GetTextureLayer();
+	}
+
+	snapshot.stepNumber = m_simulationStepCount++;
+	snapshot.stepTime = m_simulationStepTime;
+	snapshot.stateHash = m_stateHash;
+	snapshot.broadphasePairCount = m_collisionManager->GetBroadphasePairCount();
+	snapshot.broadphaseTimings = m_collisionManager->GetBroadphaseTimings();
+	snapshot.contactCount = m_collisionManager->GetContactManifoldReference()->GetNumberOfPoints();
+	snapshot.contactBatchCount = m_resolutionManager->GetBatchCount();
+	snapshot.velocitySolveRate = m_resolutionManager->GetVelocitySolveRate();
+
+	//PhysicsManager keeps a running total, every integration since the last snapshot counts towards this one
+	snapshot.derivedDataUpdates = m_physicsManager->GetDerivedDataUpdateCount() - m_derivedDataUpdateCount;
+	m_derivedDataUpdateCount = m_physicsManager->GetDerivedDataUpdateCount();
+
+	m_transformStore->Publish();
+}
+
+void GraphicsRenderer::SpawnSpheres(const HWND hwnd, const int count, const float diameter)
+{
+	m_replayFile->AddRecord(ReplayFile::RecordType::SpawnSpheres, count, diameter);
+
+	XMFLOAT3 startPosition(-7.5f, 38.75f, 0.0f);
+	auto distributionX = abs(startPosition.x * 2) / 7;
+
+	int totalCount = 0;
+	unsigned xCount = 1;
+	unsigned yCount = 1;
+
+	while (totalCount < count)
+	{
+		if (xCount == 7)
+		{
+			xCount = 1;
+			yCount++;
+		}
+
+		m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(startPosition.x + (xCount * distributionX), startPosition.y + (yCount * distributionX), 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(diameter / 2, diameter / 2, diameter / 2), XMFLOAT3(), XMFLOAT3(),
+			Collider::ColliderType::Sphere, Model::ModelType::Sphere, true, 0.5f, 0.3f, 0.3f,
+			m_shaderManager->GetTextureShader(), L"sphere2.dds", m_resourceManager);
+
+		xCount++;
+		totalCount++;
+	}
+
+	m_totalSpheresInSystem += count;
+
+	//For each gameObject that has a rigidbody we clear our accumulated force, derived data was built when the body was created
+	for (auto* gameObject : m_gameObjects)
+	{
+		gameObject->GetRigidBodyComponent()->ClearAccumulators();
+	}
+}
+
+void GraphicsRenderer::SpawnCube(const HWND hwnd)
+{
+	m_replayFile->AddRecord(ReplayFile::RecordType::SpawnCube, 1, 0.0f);
+
+	m_gameObjectFactory->AddGameObject(hwnd, m_d3D->GetDevice(), XMFLOAT3(0.3f, 42.75f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.45f, 0.45f, 0.45f), XMFLOAT3(), XMFLOAT3(),
+		Collider::ColliderType::OBBCube, Model::ModelType::Cube, true, 0.2f, 0.1f, 0.1f,
+		m_shaderManager->GetTextureShader(), L"sphere.dds", m_resourceManager);
+
+	m_totalCubesInSystem++;
+
+	//For each gameObject that has a rigidbody we clear our accumulated force, derived data was built when the body was created
+	for (auto* gameObject : m_gameObjects)
+	{
+		gameObject->GetRigidBodyComponent()->ClearAccumulators();
+	}
+}
+
+void GraphicsRenderer::RemoveMoveableGameObjects()
+{
+	m_replayFile->AddRecord(ReplayFile::RecordType::ClearMoveable, 0, 0.0f);
+
+	for (unsigned i = 0; i < m_gameObjects.size(); i++)
+	{
+		if (m_gameObjects[i]->GetRigidBodyComponent()->GetUseGravity())
+		{
+			delete m_gameObjects[i];
+			m_gameObjects.at(i) = nullptr;
+			m_gameObjects.erase(m_gameObjects.begin() + i);
+			--i;
+		}
+	}
+
+	//Close the gaps in one pass so the remaining bodies' slots still follow the game object list
+	m_bodyStateStore->Compact();
+
+	m_totalSpheresInSystem = 0;
+	m_totalCubesInSystem = 0;
+}
+
+void GraphicsRenderer::SetFriction(const float friction)
+{
+	m_replayFile->AddRecord(ReplayFile::RecordType::SetFriction, 0, friction);
+
+	m_friction = friction;
+	m_collisionManager->SetFriction(m_friction);
+}
+
+void GraphicsRenderer::SetRestitution(const float restitution)
+{
+	m_replayFile->AddRecord(ReplayFile::RecordType::SetRestitution, 0, restitution);
+
+	m_restitution = restitution;
+	m_collisionManager->SetRestitution(m_restitution);
+}
+
+void GraphicsRenderer::SetDeterministic(const bool deterministic)
+{
+	m_replayFile->AddRecord(ReplayFile::RecordType::SetDeterministic, deterministic ? 1 : 0, 0.0f);
+
+	m_deterministic = deterministic;
+	m_collisionManager->SetDeterministic(m_deterministic);
+}
+
+void GraphicsRenderer::SetWideSolver(const bool wideSolver)
+{
+	m_replayFile->AddRecord(ReplayFile::RecordType::SetWideSolver, wideSolver ? 1 : 0, 0.0f);
+
+	m_resolutionManager->SetWideSolver(wideSolver);
+}
+
+void GraphicsRenderer::SetSubsteps(const unsigned int substepCount)
+{
+	m_replayFile->AddRecord(ReplayFile::RecordType::SetSubsteps, static_cast<int>(substepCount), 0.0f);
+
+	m_substepCount = substepCount;
+}
+
+WorldSnapshot::Settings GraphicsRenderer::GetWorldSettings() const
+{
+	WorldSnapshot::Settings settings;
+	settings.friction = m_friction;
+	settings.restitution = m_restitution;
+	settings.sphereCount = m_totalSpheresInSystem;
+	settings.cubeCount = m_totalCubesInSystem;
+
+	return settings;
+}
+
+void GraphicsRenderer::RestoreWorldSnapshot(const HWND hwnd, const WorldSnapshot& worldSnapshot)
+{
+	//Restoring over the same set of objects only copies state, anything else rebuilds the objects and then copies the state over them
+	if (!worldSnapshot.MatchesObjects(m_gameObjects))
+	{
+		for (auto* gameObject : m_gameObjects)
+		{
+			delete gameObject;
+		}
+
+		m_gameObjects.clear();
+
+		//Drop the old bodies' slots so the rebuilt bodies start from slot zero in the same order as the list
+		m_bodyStateStore->Compact();
+
+		m_gameObjectFactory->AddSnapshot(hwnd, m_d3D->GetDevice(), worldSnapshot, m_shaderManager->GetTextureShader(), m_resourceManager);
+	}
+
+	worldSnapshot.Apply(m_gameObjects, m_resourceManager);
+
+	const auto& settings = worldSnapshot.GetSettings();
+
+	m_friction = settings.friction;
+	m_restitution = settings.restitution;
+	m_totalSpheresInSystem = settings.sphereCount;
+	m_totalCubesInSystem = settings.cubeCount;
+
+	m_collisionManager->SetFriction(m_friction);
+	m_collisionManager->SetRestitution(m_restitution);
+}
+
+void GraphicsRenderer::StartReplayRecording()
+{
+	WorldSnapshot startState;
+	startState.Capture(m_gameObjects, m_resourceManager, GetWorldSettings());
+
+	if (!m_replayFile->BeginRecording(REPLAY_FILE_NAME, startState))
+	{
+		MessageBox(nullptr, "The session replay could not be recorded", "Error", MB_OK);
+		return;
+	}
+
+	//Playback starts in whichever mode the session was in
+	m_replayFile->AddRecord(ReplayFile::RecordType::SetDeterministic, m_deterministic ? 1 : 0, 0.0f);
+	m_replayFile->AddRecord(ReplayFile::RecordType::SetWideSolver, m_resolutionManager->GetWideSolver() ? 1 : 0, 0.0f);
+	m_replayFile->AddRecord(ReplayFile::RecordType::SetSubsteps, static_cast<int>(m_substepCount), 0.0f);
+}
+
+bool GraphicsRenderer::PlayReplay(const HWND hwnd, const char* fileName)
+{
+	ReplayFile replay;
+
+	if (!replay.Load(fileName))
+	{
+		MessageBox(hwnd, ("Could not load the replay " + string(fileName)).c_str(), "Error", MB_OK);
+		return false;
+	}
+
+	m_replayTimingsFileName = string(fileName) + ".csv";
+
+	ofstream timings;
+
+	timings.open(m_replayTimingsFileName, ios::out | ios::trunc);
+
+	if (timings.fail())
+	{
+		MessageBox(hwnd, ("Could not write the replay timings to " + m_replayTimingsFileName).c_str(), "Error", MB_OK);
+		return false;
+	}
+
+	timings << "step,dt,time scale,objects,integrate us,detect us,resolve us,update us,state hash" << endl;
+
+	LARGE_INTEGER replayStart;
+	LARGE_INTEGER replayEnd;
+
+	QueryPerformanceCounter(&replayStart);
+
+	RestoreWorldSnapshot(hwnd, replay.GetStartState());
+
+	auto totalStageTimes = StageTimes();
+
+	m_replayStepCount = 0;
+	m_replayEventCount = 0;
+	m_replaySimulatedTime = 0.0f;
+
+	for (const auto& record : replay.GetRecords())
+	{
+		if (record.type != ReplayFile::RecordType::Step)
+		{
+			m_replayEventCount++;
+		}
+
+		switch (record.type)
+		{
+		case ReplayFile::RecordType::Step:
+		{
+			StageTimes stageTimes;
+			RunSimulationStages(record.value, stageTimes);
+
+			//Hashed whatever the mode so two builds can be compared step by step by playing the same replay through both
+			m_replayStateHash = m_physicsManager->CalculateStateHash();
+
+			timings << m_replayStepCount << ',' << record.value << ',' << record.count << ',' << m_gameObjects.size() << ','
+				<< stageTimes.integrate << ',' << stageTimes.detect << ',' << stageTimes.resolve << ',' << stageTimes.update << ',' << hex << m_replayStateHash << dec << '\n';
+
+			totalStageTimes.integrate += stageTimes.integrate;
+			totalStageTimes.detect += stageTimes.detect;
+			totalStageTimes.resolve += stageTimes.resolve;
+			totalStageTimes.update += stageTimes.update;
+
+			m_replaySimulatedTime += record.value;
+			m_replayStepCount++;
+			break;
+		}
+		case ReplayFile::RecordType::SpawnSpheres:
+			SpawnSpheres(hwnd, record.count, record.value);
+			break;
+		case ReplayFile::RecordType::SpawnCube:
+			SpawnCube(hwnd);
+			break;
+		case ReplayFile::RecordType::ClearMoveable:
+			RemoveMoveableGameObjects();
+			break;
+		case ReplayFile::RecordType::SetFriction:
+			SetFriction(record.value);
+			break;
+		case ReplayFile::RecordType::SetRestitution:
+			SetRestitution(record.value);
+			break;
+		case ReplayFile::RecordType::SetDeterministic:
+			SetDeterministic(record.count != 0);
+			break;
+		case ReplayFile::RecordType::SetWideSolver:
+			SetWideSolver(record.count != 0);
+			break;
+		case ReplayFile::RecordType::SetSubsteps:
+			//Kept in range so a damaged record can't stop the steps running
+			SetSubsteps(min(max(static_cast<unsigned int>(record.count), 1u), MAXIMUM_SIMULATION_SUBSTEPS));
+			break;
+		default:
+			break;
+		}
+	}
+
+	QueryPerformanceCounter(&replayEnd);
+
+	m_replayTime = ElapsedMicroseconds(replayStart, replayEnd) / 1000.0f;
+
+	if (m_replayStepCount > 0)
+	{
+		m_replayAverageStageTimes.integrate = totalStageTimes.integrate / m_replayStepCount;
+		m_replayAverageStageTimes.detect = totalStageTimes.detect / m_replayStepCount;
+		m_replayAverageStageTimes.resolve = totalStageTimes.resolve / m_replayStepCount;
+		m_replayAverageStageTimes.update = totalStageTimes.update / m_replayStepCount;
+	}
+
+	return !timings.fail();
+}
+
+float GraphicsRenderer::ElapsedMicroseconds(const LARGE_INTEGER& start, const LARGE_INTEGER& end) const
+{
+	return static_cast<float>((end.QuadPart - start.QuadPart) * 1000000.0 / static_cast<double>(m_frequency.QuadPart));
+}
+
+bool GraphicsRenderer::Render(const TransformStore::Snapshot& snapshot) {
 
 	XMMATRIX viewMatrix = {};
 	XMMATRIX projectionMatrix = {};
@@ -688,16 +1086,138 @@ bool GraphicsRenderer::Render() {
 	m_d3D->GetProjectionMatrix(projectionMatrix);
 	m_d3D->GetWorldMatrix(worldMatrix);
 
-	for (auto* gameObject : m_gameObjects)
+	auto* deviceContext = m_d3D->GetDeviceContext();
+	auto* instancedTextureShader = m_shaderManager->GetInstancedTextureShader();
+
+	LARGE_INTEGER cullStart;
+	LARGE_INTEGER cullEnd;
+
+	QueryPerformanceCounter(&cullStart);
+
+	//Only objects with a bounding sphere inside the camera frustum go into the draw list
+	m_frustumCuller->ExtractPlanes(viewMatrix, projectionMatrix);
+	m_frustumCuller->Clear();
+
+	//Objects added since the last published snapshot aren't drawn until the simulation has stepped them
+	const auto objectCount = min(static_cast<unsigned int>(snapshot.transforms.size()), static_cast<unsigned int>(m_gameObjects.size()));
+
+	for (unsigned int i = 0; i < objectCount; i++)
+	{
+		auto* gameObject = m_gameObjects[i];
+
+		const auto position = XMLoadFloat3(&snapshot.transforms[i].position);
+		auto scale = XMVECTOR();
+
+		gameObject->GetScale(scale);
+
+		//Models are unit sized so a sphere's radius is its scale, anything else is bounded by the corner of its scaled unit cube
+		const auto radius = gameObject->GetModelType() == Model::Sphere ? XMVectorGetX(scale) : XMVectorGetX(XMVector3Length(scale));
+
+		m_frustumCuller->Add(position, radius);
+	}
+
+	m_frustumCuller->Cull();
+
+	QueryPerformanceCounter(&cullEnd);
+
+	m_cullTime = static_cast<float>((cullEnd.QuadPart - cullStart.QuadPart) * 1000000.0 / static_cast<double>(m_frequency.QuadPart));
+
+	LARGE_INTEGER drawListStart;
+	LARGE_INTEGER drawListEnd;
+
+	QueryPerformanceCounter(&drawListStart);
+
+	//Sort everything by shader, texture and model so objects sharing state are submitted together
+	m_drawListBuilder->Clear();
+
+	for (const auto i : m_frustumCuller->GetVisibleIndices())
+	{
+		//The instanced path binds a whole texture array, objects using different layers of it can still share a batch
+		const auto* shader = m_gameObjects[i]->GetShader();
+		const auto* texture = shader == m_shaderManager->GetTextureShader() ? snapshot.transforms[i].textureArray : snapshot.transforms[i].texture;
+
+		m_drawListBuilder->Add(shader, texture, m_gameObjects[i]->GetModelType(), i);
+	}
+
+	m_drawListBuilder->Build();
+
+	QueryPerformanceCounter(&drawListEnd);
+
+	m_drawListBuildTime = static_cast<float>((drawListEnd.QuadPart - drawListStart.QuadPart) * 1000000.0 / static_cast<double>(m_frequency.QuadPart));
+
+	//Gather everything using the texture shader into batches, the draw list already has objects sharing a model and texture next to each other
+	//Anything else is drawn one at a time
+	m_instanceBatcher->Clear();
+
+	for (const auto sortKey : m_drawListBuilder->GetSortedKeys())
+	{
+		const auto objectIndex = DrawListBuilder::GetObjectIndex(sortKey);
+		auto* gameObject = m_gameObjects[objectIndex];
+		const auto& transform = snapshot.transforms[objectIndex];
+
+		const auto position = XMLoadFloat3(&transform.position);
+		const auto rotation = XMLoadFloat4(&transform.rotation);
+
+		if (gameObject->GetShader() != m_shaderManager->GetTextureShader())
+		{
+			const auto result = gameObject->Render(deviceContext, position, rotation, transform.texture, worldMatrix, viewMatrix, projectionMatrix, m_light->GetDiffuseColour(), m_light->GetLightDirection());
+
+			if (!result)
+			{
+				return false;
+			}
+
+			m_d3D->GetWorldMatrix(worldMatrix);
+			continue;
+		}
+
+		auto scale = XMVECTOR();
+
+		gameObject->GetScale(scale);
+
+		m_instanceBatcher->Add(gameObject->GetModelType(), transform.textureArray, transform.textureLayer, objectIndex, position, rotation, scale);
+	}
+
+	const auto& instances = m_instanceBatcher->GetInstances();
+	const auto& batches = m_instanceBatcher->GetBatches();
+
+	if (!batches.empty())
 	{
-		const auto result = gameObject->Render(m_d3D->GetDeviceContext(), worldMatrix, viewMatrix, projectionMatrix, m_light->GetDiffuseColour(), m_light->GetLightDirection());
+		//The matrices, shaders and sampler are shared by every batch so only bind them once
+		auto result = instancedTextureShader->SetFrameParameters(deviceContext, viewMatrix, projectionMatrix);
 
 		if (!result)
 		{
 			return false;
 		}
 
-		m_d3D->GetWorldMatrix(worldMatrix);
+		const void* boundTexture = nullptr;
+		auto boundModel = -1;
+
+		//Only rebind the texture and model when they change between batches, then one instance buffer update and one draw call per batch
+		for (const auto& batch : batches)
+		{
+			auto* gameObject = m_gameObjects[batch.objectIndex];
+
+			if (batch.textureKey != boundTexture)
+			{
+				instancedTextureShader->SetTexture(deviceContext, snapshot.transforms[batch.objectIndex].textureArray);
+				boundTexture = batch.textureKey;
+			}
+
+			if (static_cast<int>(batch.modelKey) != boundModel)
+			{
+				gameObject->RenderModel(deviceContext);
+				boundModel = static_cast<int>(batch.modelKey);
+			}
+
+			result = instancedTextureShader->DrawInstances(deviceContext, gameObject->GetIndexCount(), &instances[batch.firstInstance], batch.instanceCount);
+
+			if (!result)
+			{
+				return false;
+			}
+		}
 	}
 
 	//Present the scene
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Windows.h>
+#include <Psapi.h>
 #include <vector>
 #include <DirectXMath.h>
 
@@ -16,6 +17,14 @@
 #include "CollisionManager.h"
 #include "GameObjectFactory.h"
 #include "ResolutionManager.h"
+#include "InstanceBatcher.h"
+#include "DrawListBuilder.h"
+#include "FrustumCuller.h"
+#include "TransformStore.h"
+#include "SimulationThread.h"
+#include "WorldSnapshot.h"
+#include "ReplayFile.h"
+#include "WorkerPool.h"
 
 using namespace DirectX;
 
@@ -23,11 +32,28 @@ auto const FULL_SCREEN = false;
 auto const VSYNC_ENABLED = true;
 auto const SCREEN_DEPTH = 1000.0f;
 auto const SCREEN_NEAR = 0.1f;
+//The simulation thread steps at this rate, the one the solver was tuned for
+auto const MINIMUM_SIMULATION_STEP = 1.0f / 60.0f;
+
+//Every step in the deterministic mode is this long whatever the timer says, before the time scale is applied
+auto const DETERMINISTIC_SIMULATION_STEP = 1.0f / 60.0f;
+
+//Substep counts go up in powers of two to this and back round to one
+auto const MAXIMUM_SIMULATION_SUBSTEPS = 8u;
+
+//Text or binary scene file, see SceneFile for the formats
+auto const SCENE_FILE_NAME = "scene.txt";
+
+//Saved and restored with F5 and F9
+auto const WORLD_SNAPSHOT_FILE_NAME = "world.snapshot";
+
+//Every interactive session is recorded here, pass -replay <file> on the command line to play one back
+auto const REPLAY_FILE_NAME = "session.replay";
 
 class GraphicsRenderer
 {
 public:
-	GraphicsRenderer(int screenWidth, int screenHeight, HWND hwnd); // Default Constructor
+	GraphicsRenderer(int screenWidth, int screenHeight, HWND hwnd, const char* replayFileName, const bool deterministic, const unsigned int threadCount); // Default Constructor
 	GraphicsRenderer(const GraphicsRenderer& other); // Copy Constructor
 	GraphicsRenderer(GraphicsRenderer&& other) noexcept; // Move Constructor
 	~GraphicsRenderer(); // Destructor
@@ -40,6 +66,18 @@ public:
 	void TogglePauseSimulation();
 	void ToggleRandomTexture();
 
+	//Fixed steps and contacts in body order so the same inputs give bit for bit the same results, with a state hash after every step
+	void ToggleDeterministicMode();
+
+	//Coloured velocity batches four contacts at a time, see WideContactSolver
+	void ToggleWideSolver();
+
+	//Splits every step into substeps that share one collision detection, see ResolutionManager::BeginSubsteps
+	void CycleSubsteps();
+
+	void SaveWorldSnapshot();
+	void LoadWorldSnapshot(const HWND hwnd);
+
 	void ClearMoveableGameObjects();
 
 	void AddNumberOfSpheres(const HWND hwnd);
@@ -51,14 +89,50 @@ public:
 	void AddFriction(const float friction);
 	void AddRestitution(const float restitution);
 
-	void UpdateConsole();
+	void RefreshFrameStatistics();
 
 	bool Frame();
 
 	bool GetInitializationState() const;
 
 private:
-	bool Render();
+	//Time spent in each stage of one simulation step in microseconds
+	struct StageTimes {
+		float integrate;
+		float detect;
+		float resolve;
+		float update;
+	};
+
+	//The caller holds the simulation mutex
+	void UpdateConsole();
+
+	//Runs on the simulation thread with the simulation mutex held
+	void StepSimulation();
+	void RunSimulationStages(const float dt, StageTimes& stageTimes);
+	void PublishTransforms();
+
+	//Scene changes shared by the key handlers and replay playback, the caller holds the simulation mutex
+	void SpawnSpheres(const HWND hwnd, const int count, const float diameter);
+	void SpawnCube(const HWND hwnd);
+	void RemoveMoveableGameObjects();
+	void SetFriction(const float friction);
+	void SetRestitution(const float restitution);
+	void SetDeterministic(const bool deterministic);
+	void SetWideSolver(const bool wideSolver);
+	void SetSubsteps(const unsigned int substepCount);
+
+	WorldSnapshot::Settings GetWorldSettings() const;
+	void RestoreWorldSnapshot(const HWND hwnd, const WorldSnapshot& worldSnapshot);
+
+	void StartReplayRecording();
+
+	//Runs every recorded step back to back without rendering and writes the stage times of each step next to the replay
+	bool PlayReplay(const HWND hwnd, const char* fileName);
+
+	float ElapsedMicroseconds(const LARGE_INTEGER& start, const LARGE_INTEGER& end) const;
+
+	bool Render(const TransformStore::Snapshot& snapshot);
 
 	bool m_initializationFailed;
 
@@ -69,6 +143,7 @@ private:
 	GameObjectFactory* m_gameObjectFactory;
 
 	vector<GameObject*> m_gameObjects;
+	BodyStateStore* m_bodyStateStore;
 
 	PhysicsManager* m_physicsManager;
 	CollisionManager* m_collisionManager;
@@ -77,9 +152,22 @@ private:
 	ShaderManager* m_shaderManager;
 	ResourceManager* m_resourceManager;
 
+	InstanceBatcher* m_instanceBatcher;
+	DrawListBuilder* m_drawListBuilder;
+	FrustumCuller* m_frustumCuller;
+
+	TransformStore* m_transformStore;
+	SimulationThread* m_simulationThread;
+	WorkerPool* m_workerPool;
+	WorldSnapshot* m_worldSnapshot;
+	ReplayFile* m_replayFile;
+
 	FILE* m_consoleOutputFile;
 
 	bool m_pauseSimulation;
+	bool m_deterministic;
+
+	unsigned int m_substepCount;
 
 	int m_timeScale;
 	int m_totalSpheresInSystem;
@@ -89,6 +177,28 @@ private:
 	float m_friction;
 	float m_restitution;
 
+	float m_drawListBuildTime;
+	float m_cullTime;
+	float m_simulationStepTime;
+	unsigned long long m_simulationStepCount;
+	unsigned long long m_stateHash;
+	unsigned long long m_derivedDataUpdateCount;
+	float m_startupTime;
+	float m_sceneLoadTime;
+	float m_sceneCreateTime;
+	unsigned int m_sceneBodyCount;
+	float m_resourcesReadyTime;
+	SIZE_T m_resourcesReadyPeakMemory;
+	float m_worldSnapshotTime;
+	unsigned long long m_replayStepCount;
+	unsigned long long m_replayEventCount;
+	unsigned long long m_replayStateHash;
+	float m_replaySimulatedTime;
+	float m_replayTime;
+	StageTimes m_replayAverageStageTimes;
+	string m_replayTimingsFileName;
+	LARGE_INTEGER m_startupStart;
+
 	float m_dt;
 	float m_fps;
 	LARGE_INTEGER m_start;
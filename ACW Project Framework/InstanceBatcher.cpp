@@ -0,0 +1,70 @@
+#include "InstanceBatcher.h"
+
+InstanceBatcher::InstanceBatcher() : m_largestBatchSize(0)
+{
+}
+
+InstanceBatcher::InstanceBatcher(const InstanceBatcher& other) = default;
+
+InstanceBatcher::InstanceBatcher(InstanceBatcher&& other) noexcept = default;
+
+InstanceBatcher::~InstanceBatcher() = default;
+
+InstanceBatcher& InstanceBatcher::operator=(const InstanceBatcher& other) = default;
+
+InstanceBatcher& InstanceBatcher::operator=(InstanceBatcher&& other) noexcept = default;
+
+void InstanceBatcher::Clear()
+{
+	//Keep the capacity so we aren't reallocating every frame
+	m_instances.clear();
+	m_batches.clear();
+
+	m_largestBatchSize = 0;
+}
+
+void InstanceBatcher::Add(const unsigned int modelKey, const void* textureKey, const unsigned int textureLayer, const unsigned int objectIndex, const XMVECTOR &position, const XMVECTOR &rotation, const XMVECTOR &scale)
+{
+	//Same scale, rotation, translation order as GameObject::Render
+	auto worldMatrix = XMMatrixScalingFromVector(scale);
+	worldMatrix = XMMatrixMultiply(worldMatrix, XMMatrixRotationQuaternion(rotation));
+	worldMatrix = XMMatrixMultiply(worldMatrix, XMMatrixTranslationFromVector(position));
+
+	InstanceType instance;
+
+	//Stored untransposed, the instance rows are rebuilt into a row major matrix in the vertex shader
+	XMStoreFloat4x4(&instance.worldMatrix, worldMatrix);
+	instance.textureLayer = textureLayer;
+
+	if (m_batches.empty() || m_batches.back().modelKey != modelKey || m_batches.back().textureKey != textureKey)
+	{
+		InstanceBatch batch;
+		batch.modelKey = modelKey;
+		batch.textureKey = textureKey;
+		batch.objectIndex = objectIndex;
+		batch.firstInstance = static_cast<unsigned int>(m_instances.size());
+		batch.instanceCount = 0;
+
+		m_batches.push_back(batch);
+	}
+
+	m_instances.push_back(instance);
+	m_batches.back().instanceCount++;
+
+	m_largestBatchSize = max(m_largestBatchSize, m_batches.back().instanceCount);
+}
+
+const vector<InstanceBatcher::InstanceType>& InstanceBatcher::GetInstances() const
+{
+	return m_instances;
+}
+
+const vector<InstanceBatcher::InstanceBatch>& InstanceBatcher::GetBatches() const
+{
+	return m_batches;
+}
+
+unsigned int InstanceBatcher::GetLargestBatchSize() const
+{
+	return m_largestBatchSize;
+}
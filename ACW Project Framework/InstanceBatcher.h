@@ -0,0 +1,54 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+#include <algorithm>
+
+using namespace DirectX;
+using namespace std;
+
+//Packs the world matrices of objects that share a model and texture into one instance array so each group can be drawn with a single
+//instance buffer update and a single draw call. Objects are expected in draw list order so everything sharing state arrives together.
+//There's no Direct3D in here so the packing can be run and timed without a device
+class InstanceBatcher
+{
+public:
+	//Per instance data that is copied straight into the instance buffer, layout needs to match the WORLD semantics in the instanced vertex shader
+	struct InstanceType {
+		XMFLOAT4X4 worldMatrix;
+		unsigned int textureLayer;
+	};
+
+	//A run of instances in the packed array that can be drawn with one call
+	struct InstanceBatch {
+		unsigned int modelKey;
+		const void* textureKey;
+		unsigned int objectIndex; //Index of the first object in the batch, used to bind the model buffers
+		unsigned int firstInstance;
+		unsigned int instanceCount;
+	};
+
+	InstanceBatcher(); // Default Constructor
+	InstanceBatcher(const InstanceBatcher& other); // Copy Constructor
+	InstanceBatcher(InstanceBatcher&& other) noexcept; // Move Constructor
+	~InstanceBatcher(); // Destructor
+
+	InstanceBatcher& operator = (const InstanceBatcher& other); // Copy Assignment Operator
+	InstanceBatcher& operator = (InstanceBatcher&& other) noexcept; // Move Assignment Operator
+
+	void Clear();
+
+	//Starts a new batch whenever the model or texture differs from the previous object, the texture layer is per instance so it never splits a batch
+	void Add(const unsigned int modelKey, const void* textureKey, const unsigned int textureLayer, const unsigned int objectIndex, const XMVECTOR &position, const XMVECTOR &rotation, const XMVECTOR &scale);
+
+	const vector<InstanceType>& GetInstances() const;
+	const vector<InstanceBatch>& GetBatches() const;
+
+	unsigned int GetLargestBatchSize() const;
+
+private:
+	unsigned int m_largestBatchSize;
+
+	vector<InstanceType> m_instances;
+	vector<InstanceBatch> m_batches;
+};
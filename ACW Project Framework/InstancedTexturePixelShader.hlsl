@@ -0,0 +1,21 @@
+//Globals
+Texture2DArray shaderTextures;
+SamplerState sampleType;
+
+//Type definitions
+struct PixelInput
+{
+	float4 position : SV_POSITION;
+	float2 tex : TEXCOORD0;
+	nointerpolation uint layer : TEXTURELAYER;
+};
+
+float4 InstancedTexturePixelShader(PixelInput input) : SV_TARGET
+{
+	float4 textureColour;
+
+	//Sample the instance's layer of the texture array
+	textureColour = shaderTextures.Sample(sampleType, float3(input.tex, input.layer));
+
+	return textureColour;
+}
@@ -0,0 +1,279 @@
+#include "InstancedTextureShader.h"
+
+InstancedTextureShader::InstancedTextureShader(ID3D11Device* device, HWND hwnd) : Shader("InstancedTextureVertexShader", "InstancedTexturePixelShader", device, hwnd), m_inputLayout(nullptr), m_sampleState(nullptr), m_instanceBuffer(nullptr), m_instanceBufferCapacity(0)
+{
+	if (m_initializationFailed)
+	{
+		return;
+	}
+
+	D3D11_INPUT_ELEMENT_DESC polygonLayout[7];
+	D3D11_SAMPLER_DESC samplerDescription;
+
+	unsigned int numberOfElements = 0;
+
+	//Setup layout of buffer data in the shader
+	//Slot 0 is the model vertex data and needs to match the struct in our ResourceManager class, slot 1 is the per instance world matrix and texture layer
+
+	polygonLayout[0].SemanticName = "POSITION";
+	polygonLayout[0].SemanticIndex = 0;
+	polygonLayout[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+	polygonLayout[0].InputSlot = 0;
+	polygonLayout[0].AlignedByteOffset = 0;
+	polygonLayout[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[0].InstanceDataStepRate = 0;
+
+	polygonLayout[1].SemanticName = "TEXCOORD";
+	polygonLayout[1].SemanticIndex = 0;
+	polygonLayout[1].Format = DXGI_FORMAT_R32G32_FLOAT;
+	polygonLayout[1].InputSlot = 0;
+	polygonLayout[1].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+	polygonLayout[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[1].InstanceDataStepRate = 0;
+
+	//One row of the world matrix per element
+	for (unsigned int row = 0; row < 4; row++)
+	{
+		polygonLayout[2 + row].SemanticName = "WORLD";
+		polygonLayout[2 + row].SemanticIndex = row;
+		polygonLayout[2 + row].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+		polygonLayout[2 + row].InputSlot = 1;
+		polygonLayout[2 + row].AlignedByteOffset = row * sizeof(XMFLOAT4);
+		polygonLayout[2 + row].InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
+		polygonLayout[2 + row].InstanceDataStepRate = 1;
+	}
+
+	polygonLayout[6].SemanticName = "TEXTURELAYER";
+	polygonLayout[6].SemanticIndex = 0;
+	polygonLayout[6].Format = DXGI_FORMAT_R32_UINT;
+	polygonLayout[6].InputSlot = 1;
+	polygonLayout[6].AlignedByteOffset = sizeof(XMFLOAT4X4);
+	polygonLayout[6].InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
+	polygonLayout[6].InstanceDataStepRate = 1;
+
+	//Get count of elements in layout
+	numberOfElements = sizeof(polygonLayout) / sizeof(polygonLayout[0]);
+
+	//Create vertex input layout
+	auto result = device->CreateInputLayout(polygonLayout, numberOfElements, m_vertexShaderBuffer->GetBufferPointer(), m_vertexShaderBuffer->GetBufferSize(), &m_inputLayout);
+
+	if (FAILED(result))
+	{
+		m_initializationFailed = true;
+		return;
+	}
+
+	//Release buffer resources
+	m_vertexShaderBuffer->Release();
+	m_vertexShaderBuffer = nullptr;
+
+	m_pixelShaderBuffer->Release();
+	m_pixelShaderBuffer = nullptr;
+
+	//Same sampler as the texture shader
+	samplerDescription.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+	samplerDescription.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
+	samplerDescription.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
+	samplerDescription.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+	samplerDescription.MipLODBias = 0.0f;
+	samplerDescription.MaxAnisotropy = 1;
+	samplerDescription.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+	samplerDescription.BorderColor[0] = 0.0f;
+	samplerDescription.BorderColor[1] = 0.0f;
+	samplerDescription.BorderColor[2] = 0.0f;
+	samplerDescription.BorderColor[3] = 0.0f;
+	samplerDescription.MinLOD = 0.0f;
+	samplerDescription.MaxLOD = D3D11_FLOAT32_MAX;
+
+	result = device->CreateSamplerState(&samplerDescription, &m_sampleState);
+
+	if (FAILED(result))
+	{
+		m_initializationFailed = true;
+	}
+}
+
+InstancedTextureShader::InstancedTextureShader(const InstancedTextureShader& other) = default;
+
+InstancedTextureShader::InstancedTextureShader(InstancedTextureShader&& other) noexcept = default;
+
+InstancedTextureShader::~InstancedTextureShader()
+{
+	//Release resources
+	if (m_instanceBuffer)
+	{
+		m_instanceBuffer->Release();
+		m_instanceBuffer = nullptr;
+	}
+
+	if (m_sampleState)
+	{
+		m_sampleState->Release();
+		m_sampleState = nullptr;
+	}
+
+	if (m_inputLayout)
+	{
+		m_inputLayout->Release();
+		m_inputLayout = nullptr;
+	}
+}
+
+InstancedTextureShader& InstancedTextureShader::operator=(const InstancedTextureShader& other) = default;
+
+InstancedTextureShader& InstancedTextureShader::operator=(InstancedTextureShader&& other) noexcept = default;
+
+bool InstancedTextureShader::Render(ID3D11DeviceContext* deviceContext, int indexCount, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, ID3D11ShaderResourceView* texture, XMFLOAT4 diffuseColour, XMFLOAT3 lightDirection) {
+
+	InstanceBatcher::InstanceType instance;
+	XMStoreFloat4x4(&instance.worldMatrix, worldMatrix);
+	instance.textureLayer = 0;
+
+	return RenderInstanced(deviceContext, indexCount, &instance, 1, viewMatrix, projectionMatrix, texture);
+}
+
+bool InstancedTextureShader::RenderInstanced(ID3D11DeviceContext* deviceContext, int indexCount, const InstanceBatcher::InstanceType* instances, unsigned int instanceCount, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, ID3D11ShaderResourceView* texture) {
+
+	if (instanceCount == 0)
+	{
+		return true;
+	}
+
+	const auto result = SetFrameParameters(deviceContext, viewMatrix, projectionMatrix);
+
+	if (!result)
+	{
+		return false;
+	}
+
+	SetTexture(deviceContext, texture);
+
+	return DrawInstances(deviceContext, indexCount, instances, instanceCount);
+}
+
+bool InstancedTextureShader::SetFrameParameters(ID3D11DeviceContext* deviceContext, XMMATRIX viewMatrix, XMMATRIX projectionMatrix) {
+
+	//World matrix in the constant buffer isn't used, each instance brings its own
+	const auto result = Shader::SetShaderParameters(deviceContext, XMMatrixIdentity(), viewMatrix, projectionMatrix);
+
+	if (!result)
+	{
+		return false;
+	}
+
+	//Set input layout
+	deviceContext->IASetInputLayout(m_inputLayout);
+
+	//Set our shaders
+	Shader::RenderShader(deviceContext);
+
+	//Set pixel shaders sampler state
+	deviceContext->PSSetSamplers(0, 1, &m_sampleState);
+
+	return true;
+}
+
+void InstancedTextureShader::SetTexture(ID3D11DeviceContext* deviceContext, ID3D11ShaderResourceView* texture) const {
+	//Set the texture resource to the pixel shader
+	deviceContext->PSSetShaderResources(0, 1, &texture);
+}
+
+bool InstancedTextureShader::DrawInstances(ID3D11DeviceContext* deviceContext, int indexCount, const InstanceBatcher::InstanceType* instances, unsigned int instanceCount) {
+
+	if (instanceCount == 0)
+	{
+		return true;
+	}
+
+	const auto result = UpdateInstanceBuffer(deviceContext, instances, instanceCount);
+
+	if (!result)
+	{
+		return false;
+	}
+
+	//Render every instance in the batch
+	deviceContext->DrawIndexedInstanced(indexCount, instanceCount, 0, 0, 0);
+
+	return true;
+}
+
+bool InstancedTextureShader::UpdateInstanceBuffer(ID3D11DeviceContext* deviceContext, const InstanceBatcher::InstanceType* instances, unsigned int instanceCount) {
+
+	if (instanceCount > m_instanceBufferCapacity)
+	{
+		const auto result = ResizeInstanceBuffer(deviceContext, instanceCount);
+
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	//One map per batch, discard so we don't stall on the previous draw still using the buffer
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+
+	const auto result = deviceContext->Map(m_instanceBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	memcpy(mappedResource.pData, instances, sizeof(InstanceBatcher::InstanceType) * instanceCount);
+
+	deviceContext->Unmap(m_instanceBuffer, 0);
+
+	//Bind the instance buffer to the second input slot, the model binds its vertex buffer to the first
+	unsigned int stride = sizeof(InstanceBatcher::InstanceType);
+	unsigned int offset = 0;
+
+	deviceContext->IASetVertexBuffers(1, 1, &m_instanceBuffer, &stride, &offset);
+
+	return true;
+}
+
+bool InstancedTextureShader::ResizeInstanceBuffer(ID3D11DeviceContext* deviceContext, unsigned int instanceCount) {
+
+	//Grow in powers of two so adding balls doesn't recreate the buffer every time
+	auto capacity = max(m_instanceBufferCapacity, 64u);
+
+	while (capacity < instanceCount)
+	{
+		capacity *= 2;
+	}
+
+	if (m_instanceBuffer)
+	{
+		m_instanceBuffer->Release();
+		m_instanceBuffer = nullptr;
+	}
+
+	m_instanceBufferCapacity = 0;
+
+	ID3D11Device* device = nullptr;
+	deviceContext->GetDevice(&device);
+
+	D3D11_BUFFER_DESC instanceBufferDescription;
+
+	instanceBufferDescription.Usage = D3D11_USAGE_DYNAMIC;
+	instanceBufferDescription.ByteWidth = sizeof(InstanceBatcher::InstanceType) * capacity;
+	instanceBufferDescription.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	instanceBufferDescription.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	instanceBufferDescription.MiscFlags = 0;
+	instanceBufferDescription.StructureByteStride = 0;
+
+	const auto result = device->CreateBuffer(&instanceBufferDescription, nullptr, &m_instanceBuffer);
+
+	device->Release();
+	device = nullptr;
+
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_instanceBufferCapacity = capacity;
+
+	return true;
+}
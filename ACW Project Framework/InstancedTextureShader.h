@@ -0,0 +1,48 @@
+#pragma once
+
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include <d3dcompiler.h>
+#include <fstream>
+#include "Shader.h"
+#include "InstanceBatcher.h"
+
+using namespace DirectX;
+using namespace std;
+
+//Texture shader that reads the world matrix and texture array layer from a per instance vertex buffer so a whole batch of objects can be drawn with one DrawIndexedInstanced call
+class InstancedTextureShader : public Shader
+{
+public:
+	InstancedTextureShader(ID3D11Device* device, HWND hwnd); // Default Constructor
+	InstancedTextureShader(const InstancedTextureShader& other); // Copy Constructor
+	InstancedTextureShader(InstancedTextureShader&& other) noexcept; // Move Constructor
+	~InstancedTextureShader() override; // Destructor
+
+	InstancedTextureShader& operator = (const InstancedTextureShader& other); // Copy Assignment Operator
+	InstancedTextureShader& operator = (InstancedTextureShader&& other) noexcept; // Move Assignment Operator
+
+	//Single object path, draws the object as a batch of one using the first layer of the texture array
+	bool Render(ID3D11DeviceContext* deviceContext, int indexCount, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, ID3D11ShaderResourceView* texture, XMFLOAT4 diffuseColour, XMFLOAT3 lightDirection) override;
+
+	//Binds everything and draws a single batch
+	bool RenderInstanced(ID3D11DeviceContext* deviceContext, int indexCount, const InstanceBatcher::InstanceType* instances, unsigned int instanceCount, XMMATRIX viewMatrix, XMMATRIX projectionMatrix, ID3D11ShaderResourceView* texture);
+
+	//Split up version of RenderInstanced so a sorted draw list only binds what changes between batches
+	//The matrices, input layout, shaders and sampler are the same for every batch so they are bound once
+	bool SetFrameParameters(ID3D11DeviceContext* deviceContext, XMMATRIX viewMatrix, XMMATRIX projectionMatrix);
+	void SetTexture(ID3D11DeviceContext* deviceContext, ID3D11ShaderResourceView* texture) const;
+
+	//Uploads the instances with one map of the instance buffer and draws them all with one call, the model buffers need to be bound before this
+	bool DrawInstances(ID3D11DeviceContext* deviceContext, int indexCount, const InstanceBatcher::InstanceType* instances, unsigned int instanceCount);
+
+private:
+	bool UpdateInstanceBuffer(ID3D11DeviceContext* deviceContext, const InstanceBatcher::InstanceType* instances, unsigned int instanceCount);
+	bool ResizeInstanceBuffer(ID3D11DeviceContext* deviceContext, unsigned int instanceCount);
+
+	ID3D11InputLayout* m_inputLayout;
+	ID3D11SamplerState* m_sampleState;
+
+	ID3D11Buffer* m_instanceBuffer;
+	unsigned int m_instanceBufferCapacity;
+};
@@ -0,0 +1,53 @@
+//Global
+cbuffer MatrixBuffer
+{
+	matrix worldMatrix;
+	matrix viewMatrix;
+	matrix projectionMatrix;
+};
+
+//Type definitions
+struct VertexInput
+{
+	float4 position : POSITION;
+	float2 tex : TEXCOORD0;
+
+	//Per instance world matrix rows
+	float4 world0 : WORLD0;
+	float4 world1 : WORLD1;
+	float4 world2 : WORLD2;
+	float4 world3 : WORLD3;
+
+	uint layer : TEXTURELAYER;
+};
+
+struct PixelInput
+{
+	float4 position : SV_POSITION;
+	float2 tex : TEXCOORD0;
+	nointerpolation uint layer : TEXTURELAYER;
+};
+
+PixelInput InstancedTextureVertexShader(VertexInput input)
+{
+	PixelInput output;
+
+	//Rebuild the instance world matrix from the rows in the instance buffer
+	const float4x4 instanceWorldMatrix = float4x4(input.world0, input.world1, input.world2, input.world3);
+
+	//Change the position vector to be 4 units for proper matrix calculations
+	input.position.w = 1.0f;
+
+	//Calculate the position of the vertex against the matrices
+	output.position = mul(input.position, instanceWorldMatrix);
+	output.position = mul(output.position, viewMatrix);
+	output.position = mul(output.position, projectionMatrix);
+
+	//Pass colour as is to pixel shader
+	output.tex = input.tex;
+
+	//Which texture in the array this instance uses
+	output.layer = input.layer;
+
+	return output;
+}
@@ -0,0 +1,201 @@
+#include "MappedFile.h"
+
+#ifndef _WIN32
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//Smallest page size on any platform we run on, touching one byte per page faults the whole file in
+auto const PREFETCH_STRIDE = 4096u;
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+void MappedFile::Prefetch() const
+{
+	volatile unsigned char touched = 0;
+
+	for (auto offset = 0ull; offset < m_size; offset += PREFETCH_STRIDE)
+	{
+		touched += m_view[offset];
+	}
+}
+
+const unsigned char* MappedFile::GetData() const
+{
+	return m_view;
+}
+
+unsigned long long MappedFile::GetSize() const
+{
+	return m_size;
+}
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : m_file(INVALID_HANDLE_VALUE), m_fileMapping(nullptr), m_view(nullptr), m_size(0)
+{
+}
+
+bool MappedFile::Open(const char* fileName)
+{
+	Close();
+
+	m_file = CreateFile(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	return Map();
+}
+
+bool MappedFile::Open(const wchar_t* fileName)
+{
+	Close();
+
+	m_file = CreateFileW(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	return Map();
+}
+
+void MappedFile::Close()
+{
+	if (m_view)
+	{
+		UnmapViewOfFile(m_view);
+		m_view = nullptr;
+	}
+
+	if (m_fileMapping)
+	{
+		CloseHandle(m_fileMapping);
+		m_fileMapping = nullptr;
+	}
+
+	if (m_file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_file);
+		m_file = INVALID_HANDLE_VALUE;
+	}
+
+	m_size = 0;
+}
+
+bool MappedFile::Map()
+{
+	if (m_file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart <= 0)
+	{
+		Close();
+		return false;
+	}
+
+	m_fileMapping = CreateFileMapping(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (!m_fileMapping)
+	{
+		Close();
+		return false;
+	}
+
+	m_view = static_cast<const unsigned char*>(MapViewOfFile(m_fileMapping, FILE_MAP_READ, 0, 0, 0));
+
+	if (!m_view)
+	{
+		Close();
+		return false;
+	}
+
+	m_size = static_cast<unsigned long long>(fileSize.QuadPart);
+
+	return true;
+}
+
+#else
+
+MappedFile::MappedFile() : m_file(-1), m_view(nullptr), m_size(0)
+{
+}
+
+bool MappedFile::Open(const char* fileName)
+{
+	Close();
+
+	m_file = open(fileName, O_RDONLY);
+
+	return Map();
+}
+
+bool MappedFile::Open(const wchar_t* fileName)
+{
+	//File names are passed to open in the current locale's multibyte encoding
+	const auto length = wcstombs(nullptr, fileName, 0);
+
+	if (length == static_cast<size_t>(-1))
+	{
+		Close();
+		return false;
+	}
+
+	std::string narrowFileName(length, '\0');
+	wcstombs(&narrowFileName[0], fileName, length + 1);
+
+	return Open(narrowFileName.c_str());
+}
+
+void MappedFile::Close()
+{
+	if (m_view)
+	{
+		munmap(const_cast<unsigned char*>(m_view), static_cast<size_t>(m_size));
+		m_view = nullptr;
+	}
+
+	if (m_file != -1)
+	{
+		close(m_file);
+		m_file = -1;
+	}
+
+	m_size = 0;
+}
+
+bool MappedFile::Map()
+{
+	if (m_file == -1)
+	{
+		return false;
+	}
+
+	struct stat fileStatus;
+
+	if (fstat(m_file, &fileStatus) != 0 || fileStatus.st_size <= 0)
+	{
+		Close();
+		return false;
+	}
+
+	auto* view = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, m_file, 0);
+
+	if (view == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+
+	m_view = static_cast<const unsigned char*>(view);
+	m_size = static_cast<unsigned long long>(fileStatus.st_size);
+
+	return true;
+}
+
+#endif
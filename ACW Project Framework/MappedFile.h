@@ -0,0 +1,42 @@
+#pragma once
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+//Read only memory mapping of a whole file. The data stays valid until the file is closed so it can be handed straight to
+//resource creation without copying it into a buffer first. Windows uses a file mapping object and everything else mmap
+class MappedFile
+{
+public:
+	MappedFile(); // Default Constructor
+	MappedFile(const MappedFile& other) = delete; // Copy Constructor
+	MappedFile(MappedFile&& other) noexcept = delete; // Move Constructor
+	~MappedFile(); // Destructor
+
+	MappedFile& operator = (const MappedFile& other) = delete; // Copy Assignment Operator
+	MappedFile& operator = (MappedFile&& other) noexcept = delete; // Move Assignment Operator
+
+	//Fails for missing and empty files, an empty file can't be mapped
+	bool Open(const char* fileName);
+	bool Open(const wchar_t* fileName);
+	void Close();
+
+	//Touches every page so the disk reads happen on the calling thread rather than whoever reads the data first
+	void Prefetch() const;
+
+	const unsigned char* GetData() const;
+	unsigned long long GetSize() const;
+
+private:
+	bool Map();
+
+#ifdef _WIN32
+	HANDLE m_file;
+	HANDLE m_fileMapping;
+#else
+	int m_file;
+#endif
+	const unsigned char* m_view;
+	unsigned long long m_size;
+};
@@ -0,0 +1,125 @@
+#include "MeshCache.h"
+#include <fstream>
+
+//"MESH" in little endian, bump the version whenever the header or the vertex layout changes
+auto const MESH_CACHE_MAGIC = 0x4853454Du;
+auto const MESH_CACHE_VERSION = 2u;
+
+MeshCache::MeshCache() : m_header()
+{
+}
+
+MeshCache::~MeshCache()
+{
+	Close();
+}
+
+bool MeshCache::Open(const char* sourceFileName, const unsigned int vertexStride)
+{
+	Close();
+
+	unsigned long long sourceFileSize = 0;
+	unsigned long long sourceLastWriteTime = 0;
+
+	if (!GetSourceFileInformation(sourceFileName, sourceFileSize, sourceLastWriteTime))
+	{
+		return false;
+	}
+
+	const auto cacheFileName = GetCacheFileName(sourceFileName);
+
+	if (!m_mappedFile.Open(cacheFileName.c_str()) || m_mappedFile.GetSize() < sizeof(Header))
+	{
+		Close();
+		return false;
+	}
+
+	memcpy(&m_header, m_mappedFile.GetData(), sizeof(Header));
+
+	const auto expectedFileSize = sizeof(Header) + static_cast<unsigned long long>(m_header.vertexStride) * m_header.vertexCount + static_cast<unsigned long long>(m_header.indexStride) * m_header.indexCount;
+
+	//Anything that doesn't match means the cache is stale or was written by another version, it gets rebuilt from the source
+	if (m_header.magic != MESH_CACHE_MAGIC || m_header.version != MESH_CACHE_VERSION ||
+		m_header.sourceFileSize != sourceFileSize || m_header.sourceLastWriteTime != sourceLastWriteTime ||
+		m_header.vertexStride != vertexStride || (m_header.indexStride != 2 && m_header.indexStride != 4) ||
+		m_mappedFile.GetSize() != expectedFileSize)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MeshCache::Close()
+{
+	m_mappedFile.Close();
+
+	m_header = Header();
+}
+
+const MeshCache::Header& MeshCache::GetHeader() const
+{
+	return m_header;
+}
+
+const void* MeshCache::GetVertexData() const
+{
+	return m_mappedFile.GetData() + sizeof(Header);
+}
+
+const void* MeshCache::GetIndexData() const
+{
+	return m_mappedFile.GetData() + sizeof(Header) + m_header.vertexStride * m_header.vertexCount;
+}
+
+bool MeshCache::Write(const char* sourceFileName, const unsigned int vertexStride, const void* vertices, const unsigned int vertexCount, const unsigned int indexStride, const void* indices, const unsigned int indexCount)
+{
+	Header header;
+	header.magic = MESH_CACHE_MAGIC;
+	header.version = MESH_CACHE_VERSION;
+	header.vertexStride = vertexStride;
+	header.vertexCount = vertexCount;
+	header.indexStride = indexStride;
+	header.indexCount = indexCount;
+
+	if (!GetSourceFileInformation(sourceFileName, header.sourceFileSize, header.sourceLastWriteTime))
+	{
+		return false;
+	}
+
+	ofstream fout;
+
+	fout.open(GetCacheFileName(sourceFileName), ios::out | ios::binary | ios::trunc);
+
+	if (fout.fail())
+	{
+		return false;
+	}
+
+	fout.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	fout.write(static_cast<const char*>(vertices), static_cast<streamsize>(vertexStride) * vertexCount);
+	fout.write(static_cast<const char*>(indices), static_cast<streamsize>(indexStride) * indexCount);
+
+	return !fout.fail();
+}
+
+string MeshCache::GetCacheFileName(const char* sourceFileName)
+{
+	return string(sourceFileName) + ".mesh";
+}
+
+bool MeshCache::GetSourceFileInformation(const char* sourceFileName, unsigned long long& fileSize, unsigned long long& lastWriteTime)
+{
+	WIN32_FILE_ATTRIBUTE_DATA fileAttributes;
+
+	if (!GetFileAttributesEx(sourceFileName, GetFileExInfoStandard, &fileAttributes))
+	{
+		return false;
+	}
+
+	fileSize = (static_cast<unsigned long long>(fileAttributes.nFileSizeHigh) << 32) | fileAttributes.nFileSizeLow;
+	lastWriteTime = (static_cast<unsigned long long>(fileAttributes.ftLastWriteTime.dwHighDateTime) << 32) | fileAttributes.ftLastWriteTime.dwLowDateTime;
+
+	return true;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Windows.h>
+#include <string>
+
+#include "MappedFile.h"
+
+using namespace std;
+
+//Binary copy of a parsed model stored next to the source file so later runs can skip parsing it.
+//The file is a header followed by the vertex blob and the index blob, opening it memory maps the file so the blobs can be handed
+//straight to buffer creation without copying
+class MeshCache
+{
+public:
+	struct Header {
+		unsigned int magic;
+		unsigned int version;
+		unsigned long long sourceFileSize;
+		unsigned long long sourceLastWriteTime;
+		unsigned int vertexStride;
+		unsigned int vertexCount;
+		unsigned int indexStride;
+		unsigned int indexCount;
+	};
+
+	MeshCache(); // Default Constructor
+	MeshCache(const MeshCache& other) = delete; // Copy Constructor
+	MeshCache(MeshCache&& other) noexcept = delete; // Move Constructor
+	~MeshCache(); // Destructor
+
+	MeshCache& operator = (const MeshCache& other) = delete; // Copy Assignment Operator
+	MeshCache& operator = (MeshCache&& other) noexcept = delete; // Move Assignment Operator
+
+	//Fails if there is no cache, it was written from a different version of the source file or the vertex stride doesn't match
+	//Indices can be 16 or 32 bit, check the header's index stride
+	bool Open(const char* sourceFileName, const unsigned int vertexStride);
+	void Close();
+
+	const Header& GetHeader() const;
+	const void* GetVertexData() const;
+	const void* GetIndexData() const;
+
+	static bool Write(const char* sourceFileName, const unsigned int vertexStride, const void* vertices, const unsigned int vertexCount, const unsigned int indexStride, const void* indices, const unsigned int indexCount);
+
+	static string GetCacheFileName(const char* sourceFileName);
+
+private:
+	static bool GetSourceFileInformation(const char* sourceFileName, unsigned long long& fileSize, unsigned long long& lastWriteTime);
+
+	MappedFile m_mappedFile;
+
+	Header m_header;
+};
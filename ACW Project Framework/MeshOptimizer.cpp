@@ -0,0 +1,254 @@
+#include "MeshOptimizer.h"
+#include <cmath>
+#include <algorithm>
+
+//Tuning values from Forsyth's paper, the simulated cache is bigger than most hardware caches which still works well for smaller ones
+auto const VERTEX_CACHE_SIZE = 32;
+auto const CACHE_DECAY_POWER = 1.5f;
+auto const LAST_TRIANGLE_SCORE = 0.75f;
+auto const VALENCE_BOOST_SCALE = 2.0f;
+auto const VALENCE_BOOST_POWER = 0.5f;
+
+void MeshOptimizer::OptimizeVertexCache(vector<unsigned int>& indices, const unsigned int vertexCount)
+{
+	const auto triangleCount = static_cast<unsigned int>(indices.size() / 3);
+
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	//Triangles using each vertex, stored as one flat list with an offset per vertex
+	vector<unsigned int> remainingValence(vertexCount, 0);
+	vector<unsigned int> triangleOffsets(vertexCount + 1, 0);
+	vector<unsigned int> vertexTriangles(indices.size());
+
+	for (const auto index : indices)
+	{
+		remainingValence[index]++;
+	}
+
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		triangleOffsets[i + 1] = triangleOffsets[i] + remainingValence[i];
+	}
+
+	vector<unsigned int> fillCounts(vertexCount, 0);
+
+	for (unsigned int i = 0; i < indices.size(); i++)
+	{
+		const auto vertex = indices[i];
+		vertexTriangles[triangleOffsets[vertex] + fillCounts[vertex]++] = i / 3;
+	}
+
+	vector<int> cachePositions(vertexCount, -1);
+	vector<float> vertexScores(vertexCount);
+	vector<float> triangleScores(triangleCount, 0.0f);
+	vector<bool> triangleEmitted(triangleCount, false);
+
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		vertexScores[i] = CalculateVertexScore(-1, remainingValence[i]);
+	}
+
+	for (unsigned int i = 0; i < triangleCount; i++)
+	{
+		triangleScores[i] = vertexScores[indices[i * 3]] + vertexScores[indices[i * 3 + 1]] + vertexScores[indices[i * 3 + 2]];
+	}
+
+	vector<unsigned int> optimizedIndices;
+	optimizedIndices.reserve(indices.size());
+
+	//Holds the cache plus room for the three vertices of the triangle being added
+	vector<unsigned int> cache;
+	vector<unsigned int> newCache;
+
+	cache.reserve(VERTEX_CACHE_SIZE + 3);
+	newCache.reserve(VERTEX_CACHE_SIZE + 3);
+
+	auto bestTriangle = -1;
+
+	for (unsigned int emitted = 0; emitted < triangleCount; emitted++)
+	{
+		//Nothing in the cache has triangles left so fall back to searching everything
+		if (bestTriangle < 0)
+		{
+			auto bestScore = -1.0f;
+
+			for (unsigned int i = 0; i < triangleCount; i++)
+			{
+				if (!triangleEmitted[i] && triangleScores[i] > bestScore)
+				{
+					bestScore = triangleScores[i];
+					bestTriangle = static_cast<int>(i);
+				}
+			}
+		}
+
+		const auto triangle = static_cast<unsigned int>(bestTriangle);
+
+		triangleEmitted[triangle] = true;
+
+		newCache.clear();
+
+		for (auto corner = 0u; corner < 3; corner++)
+		{
+			const auto vertex = indices[triangle * 3 + corner];
+
+			optimizedIndices.push_back(vertex);
+
+			//Move the emitted triangle to the end of the vertex's list and shrink the list so only unemitted triangles are left in it
+			auto* triangles = &vertexTriangles[triangleOffsets[vertex]];
+			const auto valence = remainingValence[vertex];
+
+			for (unsigned int i = 0; i < valence; i++)
+			{
+				if (triangles[i] == triangle)
+				{
+					swap(triangles[i], triangles[valence - 1]);
+					break;
+				}
+			}
+
+			remainingValence[vertex]--;
+
+			newCache.push_back(vertex);
+		}
+
+		for (const auto vertex : cache)
+		{
+			if (vertex != newCache[0] && vertex != newCache[1] && vertex != newCache[2])
+			{
+				newCache.push_back(vertex);
+			}
+		}
+
+		//Anything pushed off the end of the cache loses its cache score
+		for (auto i = static_cast<unsigned int>(VERTEX_CACHE_SIZE); i < newCache.size(); i++)
+		{
+			cachePositions[newCache[i]] = -1;
+			vertexScores[newCache[i]] = CalculateVertexScore(-1, remainingValence[newCache[i]]);
+		}
+
+		if (newCache.size() > static_cast<unsigned int>(VERTEX_CACHE_SIZE))
+		{
+			newCache.resize(VERTEX_CACHE_SIZE);
+		}
+
+		cache.swap(newCache);
+
+		for (unsigned int i = 0; i < cache.size(); i++)
+		{
+			cachePositions[cache[i]] = static_cast<int>(i);
+			vertexScores[cache[i]] = CalculateVertexScore(static_cast<int>(i), remainingValence[cache[i]]);
+		}
+
+		//Only triangles touching the cache change score, the best of those is the next one out
+		bestTriangle = -1;
+		auto bestScore = -1.0f;
+
+		for (const auto vertex : cache)
+		{
+			const auto* triangles = &vertexTriangles[triangleOffsets[vertex]];
+
+			for (unsigned int i = 0; i < remainingValence[vertex]; i++)
+			{
+				const auto candidate = triangles[i];
+
+				triangleScores[candidate] = vertexScores[indices[candidate * 3]] + vertexScores[indices[candidate * 3 + 1]] + vertexScores[indices[candidate * 3 + 2]];
+
+				if (triangleScores[candidate] > bestScore)
+				{
+					bestScore = triangleScores[candidate];
+					bestTriangle = static_cast<int>(candidate);
+				}
+			}
+		}
+	}
+
+	indices.swap(optimizedIndices);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(vector<unsigned int>& indices, const unsigned int vertexCount, vector<unsigned int>& remap)
+{
+	auto const unused = ~0u;
+
+	remap.assign(vertexCount, unused);
+
+	auto nextVertex = 0u;
+
+	for (auto& index : indices)
+	{
+		if (remap[index] == unused)
+		{
+			remap[index] = nextVertex++;
+		}
+
+		index = remap[index];
+	}
+
+	//Vertices no index uses go on the end so the table stays a complete permutation
+	for (auto& newVertex : remap)
+	{
+		if (newVertex == unused)
+		{
+			newVertex = nextVertex++;
+		}
+	}
+}
+
+float MeshOptimizer::CalculateACMR(const vector<unsigned int>& indices, const unsigned int vertexCount, const unsigned int cacheSize)
+{
+	if (indices.size() < 3)
+	{
+		return 0.0f;
+	}
+
+	//Time each vertex last went into the FIFO, it is still cached if fewer than cacheSize misses have happened since
+	vector<unsigned int> insertedAt(vertexCount, 0);
+	vector<bool> everCached(vertexCount, false);
+
+	auto misses = 0u;
+
+	for (const auto index : indices)
+	{
+		if (!everCached[index] || misses - insertedAt[index] > cacheSize)
+		{
+			everCached[index] = true;
+			insertedAt[index] = misses;
+			misses++;
+		}
+	}
+
+	return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
+
+float MeshOptimizer::CalculateVertexScore(const int cachePosition, const unsigned int remainingValence)
+{
+	//No triangles left to draw so the vertex is no use to us
+	if (remainingValence == 0)
+	{
+		return -1.0f;
+	}
+
+	auto score = 0.0f;
+
+	if (cachePosition >= 0)
+	{
+		//The last triangle's vertices get a fixed score so the next triangle doesn't just reuse the same edge
+		if (cachePosition < 3)
+		{
+			score = LAST_TRIANGLE_SCORE;
+		}
+		else
+		{
+			const auto scaler = 1.0f / (VERTEX_CACHE_SIZE - 3);
+			score = pow(1.0f - (cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+		}
+	}
+
+	//Boost vertices with few triangles left so they get finished off rather than left as lone triangles
+	score += VALENCE_BOOST_SCALE * pow(static_cast<float>(remainingValence), -VALENCE_BOOST_POWER);
+
+	return score;
+}
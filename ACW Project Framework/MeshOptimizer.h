@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vector>
+
+using namespace std;
+
+//Index buffer optimisations run on models after they are parsed. Works on indices only so it doesn't need to know the vertex layout,
+//reordering the vertices themselves is left to the caller through the remap table
+class MeshOptimizer
+{
+public:
+	//Reorders triangles so vertices are reused while they are still in the post transform cache, uses Tom Forsyth's linear speed
+	//vertex cache optimisation
+	static void OptimizeVertexCache(vector<unsigned int>& indices, const unsigned int vertexCount);
+
+	//Builds a table mapping each old vertex to its new position so vertices are stored in the order the indices first use them,
+	//the indices are rewritten to match
+	static void OptimizeVertexFetch(vector<unsigned int>& indices, const unsigned int vertexCount, vector<unsigned int>& remap);
+
+	//Average number of vertices transformed per triangle with a FIFO cache of the given size, 3 is the worst case and 0.5 is about the best
+	static float CalculateACMR(const vector<unsigned int>& indices, const unsigned int vertexCount, const unsigned int cacheSize);
+
+private:
+	static float CalculateVertexScore(const int cachePosition, const unsigned int remainingValence);
+};
@@ -1,6 +1,11 @@
 #include "Model.h"
+#include "ResourceRegistry.h"
 
-Model::Model(ID3D11Device* device, ModelType modelType, ResourceManager* resourceManager) : m_initializationFailed(false), m_sizeOfVertexType(0), m_modelType(modelType), m_vertexBuffer(nullptr), m_indexBuffer(nullptr)
+#ifdef _WIN32
+#include "ResourceManager.h"
+#endif
+
+Model::Model(ID3D11Device* device, ModelType modelType, ResourceManager* resourceManager) : m_initializationFailed(false), m_sizeOfVertexType(0), m_modelType(modelType), m_modelHandle(INVALID_RESOURCE_HANDLE), m_resourceManager(resourceManager)
 {
 	const auto* modelFileName = "";
 
@@ -23,16 +28,17 @@ Model::Model(ID3D11Device* device, ModelType modelType, ResourceManager* resourc
 			return;
 	}
 
-	const auto result = resourceManager->GetModel(device, modelFileName, m_vertexBuffer, m_indexBuffer);
-
-	if (!result)
+	//Headless worlds have no resource manager, the model is only there for its type
+	if (!resourceManager)
 	{
-		m_initializationFailed = true;
 		return;
 	}
 
+#ifdef _WIN32
+	//The buffers may still be loading so they are looked up every time the model is drawn
+	m_modelHandle = resourceManager->GetModelHandle(modelFileName);
 	m_sizeOfVertexType = resourceManager->GetSizeOfVertexType();
-	m_indexCount = resourceManager->GetIndexCount(modelFileName);
+#endif
 }
 
 Model::Model(const Model& other) = default;
@@ -41,49 +47,46 @@ Model::Model(Model&& other) noexcept = default;
 
 Model::~Model()
 {
-	//Release resources
-
-	if (m_indexBuffer)
-	{
-		m_indexBuffer->Release();
-		m_indexBuffer = nullptr;
-	}
-
-	if (m_vertexBuffer)
-	{
-		m_vertexBuffer->Release();
-		m_vertexBuffer = nullptr;
-	}
+	//The buffers are shared with every other model of this type and released by the resource manager
+	m_resourceManager = nullptr;
 }
 
 Model& Model::operator=(const Model& other) = default;
 
 Model& Model::operator=(Model&& other) noexcept = default;
 
+#ifdef _WIN32
+
 void Model::Render(ID3D11DeviceContext* deviceContext) {
 	
 	//Render buffers
+	ID3D11Buffer* vertexBuffer = nullptr;
+	ID3D11Buffer* indexBuffer = nullptr;
+
+	m_resourceManager->GetModel(m_modelHandle, vertexBuffer, indexBuffer);
 
 	//Set vertex buffer stride and offset
 	unsigned int stride = m_sizeOfVertexType;
 	unsigned int offset = 0;
 
 	//Set the vertex buffer to active in the input assembler so it will render it
-	deviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
+	deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
 
 	//Set the index buffer to active in the input assembler so it will render it
-	deviceContext->IASetIndexBuffer(m_indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+	deviceContext->IASetIndexBuffer(indexBuffer, m_resourceManager->GetIndexFormat(m_modelHandle), 0);
 
 	//Set the type of primitive render style for the vertex buffer
 	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 }
 
-bool Model::GetInitializationState() const {
-	return m_initializationFailed;
+int Model::GetIndexCount() const {
+	return m_resourceManager->GetIndexCount(m_modelHandle);
 }
 
-int Model::GetIndexCount() const {
-	return m_indexCount;
+#endif
+
+bool Model::GetInitializationState() const {
+	return m_initializationFailed;
 }
 
 Model::ModelType Model::GetModelType() const
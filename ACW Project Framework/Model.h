@@ -1,16 +1,17 @@
 #pragma once
 
-#include <d3d11.h>
 #include <DirectXMath.h>
 #include <vector>
 #include <fstream>
 
-#include "Texture.h"
-#include "ResourceManager.h"
-
 using namespace DirectX;
 using namespace std;
 
+//Direct3D and the resource manager are only used through pointers here so the header builds without the Windows SDK
+struct ID3D11Device;
+struct ID3D11DeviceContext;
+class ResourceManager;
+
 class Model
 {
 public:
@@ -32,10 +33,11 @@ public:
 	Model& operator = (const Model& other); // Copy Assignment Operator
 	Model& operator = (Model&& other) noexcept; // Move Assignment Operator
 
+	//Windows only, the buffers come from the resource manager
 	void Render(ID3D11DeviceContext* deviceContext);
+	int GetIndexCount() const;
 
 	bool GetInitializationState() const;
-	int GetIndexCount() const;
 	ModelType GetModelType() const;
 
 private:
@@ -44,10 +46,9 @@ private:
 
 	int m_sizeOfVertexType;
 
-	int m_indexCount;
-
 	ModelType m_modelType;
 
-	ID3D11Buffer *m_vertexBuffer;
-	ID3D11Buffer *m_indexBuffer;
+	unsigned int m_modelHandle;
+
+	ResourceManager* m_resourceManager;
 };
\ No newline at end of file
@@ -1,6 +1,6 @@
 #include "PhysicsManager.h"
 
-PhysicsManager::PhysicsManager(vector<GameObject*> &gameObjects) : m_gameObjects(gameObjects)
+PhysicsManager::PhysicsManager(vector<GameObject*> &gameObjects, BodyStateStore* bodyStateStore) : m_gameObjects(gameObjects), m_bodyStateStore(bodyStateStore), m_workerPool(nullptr), m_chunkDerivedDataUpdates(), m_derivedDataUpdateCount(0)
 {
 	XMFLOAT3 gravity(0.0f, -9.81f, 0.0f);
 	m_gravity = XMLoadFloat3(&gravity);
@@ -10,19 +10,92 @@ PhysicsManager::~PhysicsManager() = default;
 
 void PhysicsManager::CalculateGameObjectPhysics(const float dt)
 {
-	for (auto* gameObject : m_gameObjects)
+	//Each chunk writes only its own tally so the workers never share a counter
+	m_chunkDerivedDataUpdates.assign((m_bodyStateStore->GetSlotCount() + INTEGRATION_CHUNK_SIZE - 1) / INTEGRATION_CHUNK_SIZE, 0);
+
+	RunChunks([this, dt](const unsigned int firstSlot, const unsigned int lastSlot)
+	{
+		m_chunkDerivedDataUpdates[firstSlot / INTEGRATION_CHUNK_SIZE] = CalculateChunkPhysics(firstSlot, lastSlot, dt);
+	});
+
+	for (const auto derivedDataUpdates : m_chunkDerivedDataUpdates)
+	{
+		m_derivedDataUpdateCount += derivedDataUpdates;
+	}
+}
+
+unsigned long long PhysicsManager::GetDerivedDataUpdateCount() const
+{
+	return m_derivedDataUpdateCount;
+}
+
+void PhysicsManager::UpdateGameObjectPhysics()
+{
+	m_bodyStateStore->Swap();
+}
+
+void PhysicsManager::SetWorkerPool(WorkerPool* workerPool)
+{
+	m_workerPool = workerPool;
+}
+
+void PhysicsManager::RunChunks(const function<void(unsigned int, unsigned int)>& chunkFunction) const
+{
+	const auto slotCount = m_bodyStateStore->GetSlotCount();
+	const auto chunkCount = (slotCount + INTEGRATION_CHUNK_SIZE - 1) / INTEGRATION_CHUNK_SIZE;
+
+	const function<void(unsigned int)> runChunk = [&chunkFunction, slotCount](const unsigned int chunk)
+	{
+		chunkFunction(chunk * INTEGRATION_CHUNK_SIZE, min(slotCount, (chunk + 1) * INTEGRATION_CHUNK_SIZE));
+	};
+
+	if (m_workerPool)
+	{
+		m_workerPool->Run(chunkCount, runChunk);
+	}
+	else
+	{
+		for (unsigned int chunk = 0; chunk < chunkCount; chunk++)
+		{
+			runChunk(chunk);
+		}
+	}
+}
+
+unsigned int PhysicsManager::CalculateChunkPhysics(const unsigned int firstSlot, const unsigned int lastSlot, const float dt)
+{
+	//Rotations are held back and integrated four bodies at a time
+	RigidBody* rotatingBodies[QUATERNION_INTEGRATOR_LANES];
+	XMVECTOR rotations[QUATERNION_INTEGRATOR_LANES];
+	XMVECTOR rotationVectors[QUATERNION_INTEGRATOR_LANES];
+	auto rotatingCount = 0u;
+	auto derivedDataUpdates = 0u;
+
+	for (auto slot = firstSlot; slot < lastSlot; slot++)
 	{
-		if (gameObject->GetRigidBodyComponent())
+		auto* rigidBody = m_bodyStateStore->GetOwner(slot);
+
+		//Released slots stay empty until the store is compacted
+		if (rigidBody)
 		{
 			//Improved Euler, all my other physics implementations are in the simulation loop project
-			if (gameObject->GetRigidBodyComponent()->GetUseGravity())
+			if (rigidBody->GetUseGravity())
 			{
-				auto* rigidBody = gameObject->GetRigidBodyComponent();
-
-				//Return if the rigidbody is asleep, we only wake up if another object makes contact with it
+				//Skip the rigidbody if it is asleep, we only wake up if another object makes contact with it
+				//Its state is carried over as it is since the buffers swap at the end of the step
 				if (!rigidBody->GetIsAwake())
 				{
-					return;
+					auto position = XMVECTOR();
+					auto velocity = XMVECTOR();
+
+					rigidBody->GetPosition(position);
+					rigidBody->GetVelocity(velocity);
+					rigidBody->SetNewPosition(position);
+					rigidBody->SetNewVelocity(velocity);
+
+					//Anything the solver rotated it by while it was awake still needs its world inertia tensor
+					derivedDataUpdates += rigidBody->UpdateDerivedData() ? 1 : 0;
+					continue;
 				}
 
 				const auto mass = rigidBody->GetMass();
@@ -57,12 +130,13 @@ void PhysicsManager::CalculateGameObjectPhysics(const float dt)
 
 				rigidBody->SetLastFrameAcceleration(linearAcceleration);
 
-				auto inverseInertiaTensorWorld = XMMATRIX();
-				rigidBody->GetInverseInertiaTensorWorld(inverseInertiaTensorWorld);
-
-				//Calculate angularAcceleration
+				//Calculate angularAcceleration, nothing applies torque yet so this usually skips reading the world inertia tensor
 				auto angularAcceleration = XMVECTOR();
-				angularAcceleration = XMVector3Transform(accumulatedToque, inverseInertiaTensorWorld);
+
+				if (!XMVector3Equal(accumulatedToque, XMVectorZero()))
+				{
+					angularAcceleration = rigidBody->TransformByInverseInertiaTensorWorld(accumulatedToque);
+				}
 
 				//Update velocity and angular velocity
 				auto newVelocity = velocity + (linearAcceleration * dt);
@@ -78,20 +152,22 @@ void PhysicsManager::CalculateGameObjectPhysics(const float dt)
 
 				const auto newPosition = position + (((velocity + newVelocity) / 2) * dt);
 
-				auto angularVelocityQuaternion = XMVECTOR();
+				rotatingBodies[rotatingCount] = rigidBody;
+				rotations[rotatingCount] = rotation;
+				rotationVectors[rotatingCount] = newAngularVelocity * dt;
 
-				angularVelocityQuaternion = XMQuaternionRotationRollPitchYawFromVector(newAngularVelocity * dt);
-
-				const auto newRotation = XMQuaternionMultiply(rotation, angularVelocityQuaternion);
+				if (++rotatingCount == QUATERNION_INTEGRATOR_LANES)
+				{
+					derivedDataUpdates += IntegrateRotations(rotatingBodies, rotations, rotationVectors, rotatingCount);
+					rotatingCount = 0;
+				}
 
-				//Update position, velocity, rotation, angular velocity and calculate our new inverse inertia tensor in world space and clear any accumulated force.
+				//Update position, velocity, angular velocity and clear any accumulated force, the inverse inertia tensor in world space is rebuilt with the new rotation
 
 				rigidBody->SetNewPosition(newPosition);
 				rigidBody->SetNewVelocity(newVelocity);
-				rigidBody->SetRotation(newRotation);
 				rigidBody->SetAngularVelocity(newAngularVelocity);
 
-				rigidBody->CalculateDerivedData();
 				rigidBody->ClearAccumulators();
 
 				//Check and see if the rigidbody needs to be put to sleep
@@ -127,20 +203,50 @@ void PhysicsManager::CalculateGameObjectPhysics(const float dt)
 		}
 
 	}
+
+	if (rotatingCount > 0)
+	{
+		derivedDataUpdates += IntegrateRotations(rotatingBodies, rotations, rotationVectors, rotatingCount);
+	}
+
+	return derivedDataUpdates;
+}
+
+unsigned int PhysicsManager::IntegrateRotations(RigidBody* const rigidBodies[], XMVECTOR rotations[], const XMVECTOR rotationVectors[], const unsigned int count)
+{
+	QuaternionIntegrator::IntegrateWide(rotations, rotationVectors, count);
+
+	auto derivedDataUpdates = 0u;
+
+	for (unsigned int lane = 0; lane < count; lane++)
+	{
+		rigidBodies[lane]->SetRotation(rotations[lane]);
+
+		//Once per body per integration, on the thread that owns its chunk, so the solver only ever reads the tensor
+		derivedDataUpdates += rigidBodies[lane]->UpdateDerivedData() ? 1 : 0;
+	}
+
+	return derivedDataUpdates;
 }
 
-void PhysicsManager::UpdateGameObjectPhysics()
+unsigned long long PhysicsManager::CalculateStateHash() const
 {
-	for (auto* gameObject : m_gameObjects)
+	//FNV-1a over the raw bytes, the state has no padding so every byte is a value the simulation wrote
+	auto hash = 14695981039346656037ull;
+
+	for (const auto* gameObject : m_gameObjects)
 	{
-		//Improved Euler, all my other physics implementations are in the simulation loop
-		if (gameObject->GetRigidBodyComponent()->GetUseGravity())
+		RigidBody::State state;
+		gameObject->GetRigidBodyComponent()->GetState(state);
+
+		const auto* bytes = reinterpret_cast<const unsigned char*>(&state);
+
+		for (unsigned int i = 0; i < sizeof(RigidBody::State); i++)
 		{
-			//gameObject->GetVelocityComponent()->UpdateVelocity();
-			//gameObject->GetPositionComponent()->UpdatePosition();
-			gameObject->GetRigidBodyComponent()->UpdateVelocity();
-			gameObject->GetRigidBodyComponent()->UpdatePosition();
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
 		}
-
 	}
+
+	return hash;
 }
@@ -1,23 +1,59 @@
 #pragma once
 
 #include <vector>
+#include "BodyStateStore.h"
 #include "GameObject.h"
+#include "QuaternionIntegrator.h"
+#include "WorkerPool.h"
 #include "XMFLOAT3Maths.h"
 
 using namespace std;
 
+//Bodies are integrated in chunks of this many slots, enough work per task that handing it out is cheap. A chunk's positions and velocities
+//fill whole cache lines and BodyStateStore starts its arrays on a line, so neighbouring chunks never write to the same line of the store.
+//The RigidBody objects are separate allocations and aren't covered, two bodies either side of a chunk boundary can still share a line
+auto const INTEGRATION_CHUNK_SIZE = 256u;
+static_assert(INTEGRATION_CHUNK_SIZE * sizeof(XMVECTOR) % CACHE_LINE_SIZE == 0, "a chunk of the store must fill whole cache lines");
+
 class PhysicsManager
 {
 public:
-	PhysicsManager(vector<GameObject*> &gameObjects);
+	PhysicsManager(vector<GameObject*> &gameObjects, BodyStateStore* bodyStateStore);
 	~PhysicsManager();
 
+	//Only touches each body's own state, so chunks run on the worker pool if there is one. Bodies are walked in state store slot order
+	//so each chunk reads its positions and velocities straight through
 	void CalculateGameObjectPhysics(const float dt);
+
+	//Makes the new positions and velocities current by swapping the state store's buffers
 	void UpdateGameObjectPhysics();
 
+	void SetWorkerPool(WorkerPool* workerPool);
+
+	//World inertia tensors rebuilt by every integration so far, take the difference across a step for the rebuilds in that step
+	unsigned long long GetDerivedDataUpdateCount() const;
+
+	//Hash of the full rigidbody state of every object in order, equal hashes after the same steps mean the runs matched bit for bit
+	unsigned long long CalculateStateHash() const;
+
 private:
+	void RunChunks(const function<void(unsigned int, unsigned int)>& chunkFunction) const;
+
+	//Returns how many world inertia tensors the chunk rebuilt
+	unsigned int CalculateChunkPhysics(const unsigned int firstSlot, const unsigned int lastSlot, const float dt);
+
+	//Integrates up to four held back rotations and hands them to their bodies, which renormalise them, returns the tensors rebuilt
+	static unsigned int IntegrateRotations(RigidBody* const rigidBodies[], XMVECTOR rotations[], const XMVECTOR rotationVectors[], const unsigned int count);
+
 	XMVECTOR m_gravity;
 
 	vector<GameObject*> &m_gameObjects;
+
+	BodyStateStore* m_bodyStateStore;
+
+	WorkerPool* m_workerPool;
+
+	vector<unsigned int> m_chunkDerivedDataUpdates;
+	unsigned long long m_derivedDataUpdateCount;
 };
 
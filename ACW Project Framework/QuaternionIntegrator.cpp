@@ -0,0 +1,47 @@
+#include "QuaternionIntegrator.h"
+
+XMVECTOR QuaternionIntegrator::Integrate(const XMVECTOR& rotation, const XMVECTOR& rotationVector)
+{
+	//DirectX multiplies in the opposite order to the book, so this is (0, v) * q
+	const auto spin = XMQuaternionMultiply(rotation, XMVectorSetW(rotationVector, 0.0f));
+
+	return XMVectorAdd(rotation, XMVectorScale(spin, 0.5f));
+}
+
+void QuaternionIntegrator::IntegrateWide(XMVECTOR rotations[], const XMVECTOR rotationVectors[], const unsigned int count)
+{
+	//Unused lanes repeat the first body, their results are never written back
+	XMVECTOR laneRotations[QUATERNION_INTEGRATOR_LANES];
+	XMVECTOR laneRotationVectors[QUATERNION_INTEGRATOR_LANES];
+
+	for (unsigned int lane = 0; lane < QUATERNION_INTEGRATOR_LANES; lane++)
+	{
+		laneRotations[lane] = rotations[lane < count ? lane : 0];
+		laneRotationVectors[lane] = rotationVectors[lane < count ? lane : 0];
+	}
+
+	//One vector per lane in, one component per vector out
+	const auto q = XMMatrixTranspose(XMMATRIX(laneRotations[0], laneRotations[1], laneRotations[2], laneRotations[3]));
+	const auto v = XMMatrixTranspose(XMMATRIX(laneRotationVectors[0], laneRotationVectors[1], laneRotationVectors[2], laneRotationVectors[3]));
+
+	const auto& qx = q.r[0];
+	const auto& qy = q.r[1];
+	const auto& qz = q.r[2];
+	const auto& qw = q.r[3];
+	const auto vx = XMVectorScale(v.r[0], 0.5f);
+	const auto vy = XMVectorScale(v.r[1], 0.5f);
+	const auto vz = XMVectorScale(v.r[2], 0.5f);
+
+	//Half of (0, v) * q written out, the vector part is w * v + v x q and the scalar part is -v . q
+	const auto x = XMVectorAdd(qx, XMVectorAdd(XMVectorMultiply(qw, vx), XMVectorSubtract(XMVectorMultiply(vy, qz), XMVectorMultiply(vz, qy))));
+	const auto y = XMVectorAdd(qy, XMVectorAdd(XMVectorMultiply(qw, vy), XMVectorSubtract(XMVectorMultiply(vz, qx), XMVectorMultiply(vx, qz))));
+	const auto z = XMVectorAdd(qz, XMVectorAdd(XMVectorMultiply(qw, vz), XMVectorSubtract(XMVectorMultiply(vx, qy), XMVectorMultiply(vy, qx))));
+	const auto w = XMVectorSubtract(qw, XMVectorAdd(XMVectorMultiply(vx, qx), XMVectorAdd(XMVectorMultiply(vy, qy), XMVectorMultiply(vz, qz))));
+
+	const auto results = XMMatrixTranspose(XMMATRIX(x, y, z, w));
+
+	for (unsigned int lane = 0; lane < count; lane++)
+	{
+		rotations[lane] = results.r[lane];
+	}
+}
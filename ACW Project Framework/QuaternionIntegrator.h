@@ -0,0 +1,30 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+//Bodies rotated side by side, one per lane of an XMVECTOR
+auto const QUATERNION_INTEGRATOR_LANES = 4u;
+
+//Turns a rotation vector (angular velocity times dt, or an angular change from the resolver) into a new orientation without any trig.
+//Uses Ian Millingtons Quaternion.addScaledVector, q += 0.5 * (0, v) * q, which agrees with the exact rotation to second order in |v|.
+//The result isn't unit length, RigidBody::SetRotation renormalises it.
+class QuaternionIntegrator
+{
+public:
+	QuaternionIntegrator() = delete; // Default Constructor
+	QuaternionIntegrator(const QuaternionIntegrator& other) = delete; // Copy Constructor
+	QuaternionIntegrator(QuaternionIntegrator&& other) noexcept = delete; // Move Constructor
+	~QuaternionIntegrator() = delete; // Destructor
+
+	QuaternionIntegrator& operator = (const QuaternionIntegrator& other) = delete; // Copy Assignment Operator
+	QuaternionIntegrator& operator = (QuaternionIntegrator&& other) noexcept = delete; // Move Assignment Operator
+
+	//Rotates a single orientation by a world space rotation vector
+	static XMVECTOR Integrate(const XMVECTOR& rotation, const XMVECTOR& rotationVector);
+
+	//Same as Integrate for up to four bodies at once, the rotations are gathered into structure of arrays form so every XMVECTOR holds
+	//one component for all four bodies, and the results are written back over them
+	static void IntegrateWide(XMVECTOR rotations[], const XMVECTOR rotationVectors[], const unsigned int count);
+};
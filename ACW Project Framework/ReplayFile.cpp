@@ -0,0 +1,185 @@
+#include "ReplayFile.h"
+
+//"RPLY" in little endian, bump the version whenever the header or Record changes
+auto const REPLAY_FILE_MAGIC = 0x594C5052u;
+auto const REPLAY_FILE_VERSION = 1u;
+
+//About four seconds of steps at 60Hz, a crash loses at most this much of the recording
+auto const REPLAY_RECORDS_PER_WRITE = 256u;
+
+ReplayFile::ReplayFile() : m_recordedCount(0)
+{
+}
+
+ReplayFile::~ReplayFile()
+{
+	EndRecording();
+}
+
+bool ReplayFile::BeginRecording(const char* fileName, const WorldSnapshot& startState)
+{
+	EndRecording();
+
+	m_records.clear();
+	m_records.reserve(REPLAY_RECORDS_PER_WRITE);
+	m_recordedCount = 0;
+
+	m_file.open(fileName, ios::out | ios::binary | ios::trunc);
+
+	if (m_file.fail())
+	{
+		m_file.close();
+		m_file.clear();
+		return false;
+	}
+
+	Header header;
+	header.magic = REPLAY_FILE_MAGIC;
+	header.version = REPLAY_FILE_VERSION;
+	header.snapshotBytes = startState.GetSize();
+
+	m_file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	m_file.write(reinterpret_cast<const char*>(startState.GetData()), static_cast<streamsize>(startState.GetSize()));
+	m_file.flush();
+
+	if (m_file.fail())
+	{
+		m_file.close();
+		m_file.clear();
+		return false;
+	}
+
+	return true;
+}
+
+void ReplayFile::EndRecording()
+{
+	if (!m_file.is_open())
+	{
+		return;
+	}
+
+	WritePendingRecords();
+
+	m_file.close();
+	m_file.clear();
+}
+
+bool ReplayFile::IsRecording() const
+{
+	return m_file.is_open();
+}
+
+void ReplayFile::AddRecord(const RecordType type, const int count, const float value)
+{
+	if (!m_file.is_open())
+	{
+		return;
+	}
+
+	Record record;
+	record.type = type;
+	record.count = count;
+	record.value = value;
+
+	m_records.push_back(record);
+	m_recordedCount++;
+
+	if (m_records.size() >= REPLAY_RECORDS_PER_WRITE)
+	{
+		WritePendingRecords();
+	}
+}
+
+bool ReplayFile::Load(const char* fileName)
+{
+	EndRecording();
+
+	m_records.clear();
+	m_recordedCount = 0;
+
+	ifstream fin;
+
+	fin.open(fileName, ios::in | ios::binary | ios::ate);
+
+	if (fin.fail())
+	{
+		return false;
+	}
+
+	const auto fileSize = static_cast<unsigned long long>(fin.tellg());
+
+	if (fileSize < sizeof(Header))
+	{
+		return false;
+	}
+
+	Header header;
+
+	fin.seekg(0, ios::beg);
+	fin.read(reinterpret_cast<char*>(&header), sizeof(Header));
+
+	//A recording cut short part way through a record is still played up to the last whole one
+	if (fin.fail() || header.magic != REPLAY_FILE_MAGIC || header.version != REPLAY_FILE_VERSION || header.snapshotBytes > fileSize - sizeof(Header))
+	{
+		return false;
+	}
+
+	vector<unsigned char> snapshot(static_cast<size_t>(header.snapshotBytes));
+	fin.read(reinterpret_cast<char*>(snapshot.data()), static_cast<streamsize>(snapshot.size()));
+
+	if (fin.fail() || !m_startState.Read(snapshot.data(), snapshot.size()))
+	{
+		return false;
+	}
+
+	m_records.resize(static_cast<size_t>((fileSize - sizeof(Header) - header.snapshotBytes) / sizeof(Record)));
+	fin.read(reinterpret_cast<char*>(m_records.data()), static_cast<streamsize>(sizeof(Record) * m_records.size()));
+
+	if (fin.fail())
+	{
+		m_records.clear();
+		return false;
+	}
+
+	for (const auto& record : m_records)
+	{
+		if (record.type > RecordType::SetSubsteps)
+		{
+			m_records.clear();
+			return false;
+		}
+	}
+
+	m_recordedCount = m_records.size();
+
+	return true;
+}
+
+const WorldSnapshot& ReplayFile::GetStartState() const
+{
+	return m_startState;
+}
+
+const vector<ReplayFile::Record>& ReplayFile::GetRecords() const
+{
+	return m_records;
+}
+
+unsigned long long ReplayFile::GetRecordedCount() const
+{
+	return m_recordedCount;
+}
+
+void ReplayFile::WritePendingRecords()
+{
+	if (m_records.empty())
+	{
+		return;
+	}
+
+	m_file.write(reinterpret_cast<const char*>(m_records.data()), static_cast<streamsize>(sizeof(Record) * m_records.size()));
+	m_file.flush();
+
+	m_records.clear();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <fstream>
+#include <vector>
+
+#include "WorldSnapshot.h"
+
+using namespace std;
+
+//Recording of everything that changes the simulation so a session can be played back step for step. It starts with a world snapshot
+//of where the session began, then one fixed size record per simulation step or scene change in the order they happened.
+//Steps keep the dt that was actually simulated so timer jitter, time scale and pausing all replay exactly
+class ReplayFile
+{
+public:
+	enum RecordType : unsigned int {
+		Step, //value is the dt passed to the physics, count is the time scale it was taken at
+		SpawnSpheres, //count spheres of diameter value
+		SpawnCube,
+		ClearMoveable,
+		SetFriction, //value is the new friction
+		SetRestitution, //value is the new restitution
+		SetDeterministic, //count is one when the deterministic mode is on
+		SetWideSolver, //count is one when the wide contact solver is on
+		SetSubsteps //count is the number of substeps each step is split into
+	};
+
+	struct Record {
+		unsigned int type;
+		int count;
+		float value;
+	};
+
+	struct Header {
+		unsigned int magic;
+		unsigned int version;
+		unsigned long long snapshotBytes; //Start state, the records follow it up to the end of the file
+	};
+
+	ReplayFile(); // Default Constructor
+	ReplayFile(const ReplayFile& other) = delete; // Copy Constructor
+	ReplayFile(ReplayFile&& other) noexcept = delete; // Move Constructor
+	~ReplayFile(); // Destructor
+
+	ReplayFile& operator = (const ReplayFile& other) = delete; // Copy Assignment Operator
+	ReplayFile& operator = (ReplayFile&& other) noexcept = delete; // Move Assignment Operator
+
+	//Replaces the file with a new recording starting from the given state, anything still being recorded is finished first
+	bool BeginRecording(const char* fileName, const WorldSnapshot& startState);
+	void EndRecording();
+	bool IsRecording() const;
+
+	//Does nothing when not recording, records are written out in blocks so this doesn't touch the disk every step
+	void AddRecord(const RecordType type, const int count, const float value);
+
+	//Reads a whole recording for playback, fails for damaged files and files written by another version
+	bool Load(const char* fileName);
+
+	const WorldSnapshot& GetStartState() const;
+	const vector<Record>& GetRecords() const;
+
+	unsigned long long GetRecordedCount() const;
+
+private:
+	void WritePendingRecords();
+
+	ofstream m_file;
+
+	//Records not yet written when recording, every record in the file after a Load
+	vector<Record> m_records;
+	unsigned long long m_recordedCount;
+
+	WorldSnapshot m_startState;
+};
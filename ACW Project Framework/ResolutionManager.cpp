@@ -1,8 +1,9 @@
 #include "ResolutionManager.h"
+#include <chrono>
 
 
 
-ResolutionManager::ResolutionManager(ContactManifold* contactManifold, const int positionIterations, const int velocityIterations, const float positionEpsilon, const float velocityEpsilon) : m_positionIterationsDone(0), m_positionIterations(positionIterations), m_velocityIterationsDone(0), m_velocityIterations(velocityIterations), m_positionEpsilon(positionEpsilon), m_velocityEpsilon(velocityEpsilon), m_contactManifold(contactManifold)
+ResolutionManager::ResolutionManager(ContactManifold* contactManifold, const int positionIterations, const int velocityIterations, const float positionEpsilon, const float velocityEpsilon) : m_positionIterationsDone(0), m_positionIterations(positionIterations), m_velocityIterationsDone(0), m_velocityIterations(velocityIterations), m_positionEpsilon(positionEpsilon), m_velocityEpsilon(velocityEpsilon), m_contactManifold(contactManifold), m_workerPool(nullptr), m_batchSolvedCount(0), m_wideSolver(false), m_velocitySolvedCount(0), m_velocitySolveNanoseconds(0)
 {
 }
 
@@ -15,6 +16,8 @@ void ResolutionManager::ResolveContacts(const float dt)
 {
 	m_positionIterationsDone = 0;
 	m_velocityIterationsDone = 0;
+	m_velocitySolvedCount = 0;
+	m_velocitySolveNanoseconds = 0;
 
 	//If we have no contacts then we return
 	if (!m_contactManifold->GetNumberOfPoints())
@@ -25,22 +28,137 @@ void ResolutionManager::ResolveContacts(const float dt)
 	//Prepare Contacts
 	PrepareContacts(dt);
 
-	AdjustPositions(dt);
+	if (m_contactManifold->GetNumberOfPoints() < COLOURED_SOLVER_MINIMUM_CONTACTS)
+	{
+		m_batchStarts.clear();
+
+		AdjustPositions(dt, m_positionIterations);
+
+		AdjustVelocities(dt, m_velocityIterations);
+
+		return;
+	}
+
+	ColourContacts();
+
+	AdjustPositionsColoured(COLOURED_SOLVER_PASSES);
 
-	AdjustVelocities(dt);
+	AdjustVelocitiesColoured(dt, COLOURED_SOLVER_PASSES);
 }
 
-void ResolutionManager::PrepareContacts(const float dt)
+void ResolutionManager::BeginSubsteps()
 {
-	for (unsigned int collision = 0; collision < m_contactManifold->GetNumberOfPoints(); ++collision)
+	const auto contactCount = m_contactManifold->GetNumberOfPoints();
+
+	m_velocitySolvedCount = 0;
+	m_velocitySolveNanoseconds = 0;
+
+	//Coloured on the first substep, the contacts don't change until the next frame
+	m_batchStarts.clear();
+
+	m_substepPenetrations.resize(contactCount);
+
+	for (unsigned int i = 0; i < contactCount; i++)
 	{
-		auto &point = m_contactManifold->GetPoint(collision);
+		const auto& point = m_contactManifold->GetPoint(i);
+
+		m_substepPenetrations[i] = point.penetrationDepth;
+
+		for (unsigned int b = 0; b < 2; b++) if (point.contactID[b])
+		{
+			if (point.bodyIndex[b] >= m_substepPositions.size())
+			{
+				m_substepPositions.resize(point.bodyIndex[b] + 1);
+			}
+
+			point.contactID[b]->GetNewPosition(m_substepPositions[point.bodyIndex[b]]);
+		}
+	}
+}
+
+void ResolutionManager::ResolveSubstep(const float dt, const int passes, const int colouredPasses)
+{
+	m_positionIterationsDone = 0;
+	m_velocityIterationsDone = 0;
+
+	const auto contactCount = m_contactManifold->GetNumberOfPoints();
+
+	if (!contactCount)
+	{
+		return;
+	}
+
+	RunChunks(0, contactCount, [this](const unsigned int firstContact, const unsigned int lastContact) { RefreshPenetrations(firstContact, lastContact); });
+
+	PrepareContacts(dt);
+
+	if (contactCount < COLOURED_SOLVER_MINIMUM_CONTACTS)
+	{
+		//The worst contact is solved each iteration, so a sweep is as many iterations as there are contacts
+		const auto iterations = passes * static_cast<int>(contactCount);
+
+		AdjustPositions(dt, min(iterations, m_positionIterations));
+
+		AdjustVelocities(dt, min(iterations, m_velocityIterations));
+
+		return;
+	}
 
-		point.CalculateInternals(dt);
+	if (m_batchStarts.empty())
+	{
+		ColourContacts();
 	}
+
+	AdjustPositionsColoured(colouredPasses);
+
+	AdjustVelocitiesColoured(dt, colouredPasses);
+}
+
+void ResolutionManager::SetWorkerPool(WorkerPool* workerPool)
+{
+	m_workerPool = workerPool;
+}
+
+unsigned int ResolutionManager::GetBatchCount() const
+{
+	return m_batchStarts.empty() ? 0 : static_cast<unsigned int>(m_batchStarts.size() - 1);
+}
+
+void ResolutionManager::SetWideSolver(const bool wideSolver)
+{
+	m_wideSolver = wideSolver;
+}
+
+bool ResolutionManager::GetWideSolver() const
+{
+	return m_wideSolver;
+}
+
+float ResolutionManager::GetVelocitySolveRate() const
+{
+	return m_velocitySolveNanoseconds > 0 ? m_velocitySolvedCount * 1000.0f / m_velocitySolveNanoseconds : 0.0f;
 }
 
-void ResolutionManager::AdjustPositions(const float dt)
+float ResolutionManager::GetVelocitySolveMicroseconds() const
+{
+	return m_velocitySolveNanoseconds / 1000.0f;
+}
+
+void ResolutionManager::PrepareContacts(const float dt)
+{
+	//Each contact only reads its bodies and writes itself
+	RunChunks(0, m_contactManifold->GetNumberOfPoints(), [this, dt](const unsigned int firstContact, const unsigned int lastContact)
+	{
+		for (auto collision = firstContact; collision < lastContact; ++collision)
+		{
+			auto &point = m_contactManifold->GetPoint(collision);
+
+			point.CalculateInternals(dt);
+		}
+	});
+}
+
+void ResolutionManager::AdjustPositions(const float dt, const int iterations)
 {
 	//Now adjust positions and resolve penetrations
 	unsigned int i = 0;
@@ -54,7 +172,7 @@ void ResolutionManager::AdjustPositions(const float dt)
 
 	m_positionIterationsDone = 0;
 
-	while (m_positionIterationsDone < m_positionIterations)
+	while (m_positionIterationsDone < iterations)
 	{
 		//Find the biggest penetration
 		maxPenetration = m_positionEpsilon; // Set small value so we ignore any small penetrations, position epsilon
@@ -108,14 +226,14 @@ void ResolutionManager::AdjustPositions(const float dt)
 	}
 }
 
-void ResolutionManager::AdjustVelocities(const float dt)
+void ResolutionManager::AdjustVelocities(const float dt, const int iterations)
 {
 	//Now need to update velocities
 	XMVECTOR velocityChange[2];
 	XMVECTOR angularVelocityChange[2];
 	auto deltaVelocity = XMVECTOR();
 
-	while (m_velocityIterationsDone < m_velocityIterations)
+	while (m_velocityIterationsDone < iterations)
 	{
 		auto max = m_velocityEpsilon;
 		auto index = m_contactManifold->GetNumberOfPoints();
@@ -172,3 +290,442 @@ void ResolutionManager::AdjustVelocities(const float dt)
 		m_velocityIterationsDone++;
 	}
 }
+
+void ResolutionManager::ColourContacts()
+{
+	const auto contactCount = m_contactManifold->GetNumberOfPoints();
+
+	auto bodyCount = 0u;
+
+	for (unsigned int i = 0; i < contactCount; i++)
+	{
+		const auto& point = m_contactManifold->GetPoint(i);
+
+		for (unsigned int b = 0; b < 2; b++) if (point.contactID[b])
+		{
+			bodyCount = max(bodyCount, point.bodyIndex[b] + 1);
+		}
+	}
+
+	m_bodyColours.assign(bodyCount, 0);
+	m_contactColours.resize(contactCount);
+	m_colourStarts.assign(COLOURED_SOLVER_MAXIMUM_COLOURS + 1, 0);
+
+	//Lowest colour neither body has used yet, contacts whose bodies have used every colour are left over
+	for (unsigned int i = 0; i < contactCount; i++)
+	{
+		const auto& point = m_contactManifold->GetPoint(i);
+
+		auto usedColours = m_bodyColours[point.bodyIndex[0]];
+
+		if (point.contactID[1])
+		{
+			usedColours |= m_bodyColours[point.bodyIndex[1]];
+		}
+
+		auto colour = 0u;
+
+		while (colour < COLOURED_SOLVER_MAXIMUM_COLOURS && (usedColours & 1ull << colour))
+		{
+			colour++;
+		}
+
+		if (colour < COLOURED_SOLVER_MAXIMUM_COLOURS)
+		{
+			m_bodyColours[point.bodyIndex[0]] |= 1ull << colour;
+
+			if (point.contactID[1])
+			{
+				m_bodyColours[point.bodyIndex[1]] |= 1ull << colour;
+			}
+		}
+
+		m_contactColours[i] = colour;
+		m_colourStarts[colour]++;
+	}
+
+	//Counting sort into colour order, one batch per colour that's in use and then one for each left over contact
+	m_batchStarts.clear();
+
+	auto contactStart = 0u;
+
+	for (unsigned int colour = 0; colour <= COLOURED_SOLVER_MAXIMUM_COLOURS; colour++)
+	{
+		const auto colourCount = m_colourStarts[colour];
+
+		m_colourStarts[colour] = contactStart;
+
+		if (colour < COLOURED_SOLVER_MAXIMUM_COLOURS && colourCount > 0)
+		{
+			m_batchStarts.push_back(contactStart);
+		}
+
+		contactStart += colourCount;
+	}
+
+	for (auto leftOver = m_colourStarts[COLOURED_SOLVER_MAXIMUM_COLOURS]; leftOver < contactCount; leftOver++)
+	{
+		m_batchStarts.push_back(leftOver);
+	}
+
+	m_batchStarts.push_back(contactCount);
+
+	m_batchContacts.resize(contactCount);
+
+	for (unsigned int i = 0; i < contactCount; i++)
+	{
+		m_batchContacts[m_colourStarts[m_contactColours[i]]++] = i;
+	}
+
+	//Every body starts each phase with no changes, the contacts are kept as they were when the phase began
+	m_bodyLinearChanges.resize(bodyCount);
+	m_bodyAngularChanges.resize(bodyCount);
+	m_bodyChangeCounts.resize(bodyCount);
+	m_startPenetrations.resize(contactCount);
+	m_startContactVelocities.resize(contactCount);
+	m_contactChangeCounts.resize(contactCount);
+}
+
+void ResolutionManager::BeginColouredPhase()
+{
+	fill(m_bodyLinearChanges.begin(), m_bodyLinearChanges.end(), XMVectorZero());
+	fill(m_bodyAngularChanges.begin(), m_bodyAngularChanges.end(), XMVectorZero());
+	fill(m_bodyChangeCounts.begin(), m_bodyChangeCounts.end(), 0);
+	fill(m_contactChangeCounts.begin(), m_contactChangeCounts.end(), 0);
+
+	RunChunks(0, m_contactManifold->GetNumberOfPoints(), [this](const unsigned int firstContact, const unsigned int lastContact)
+	{
+		for (auto i = firstContact; i < lastContact; i++)
+		{
+			const auto &point = m_contactManifold->GetPoint(i);
+
+			m_startPenetrations[i] = point.penetrationDepth;
+			m_startContactVelocities[i] = point.contactVelocity;
+		}
+	});
+}
+
+void ResolutionManager::AdjustPositionsColoured(const int passes)
+{
+	const auto batchCount = GetBatchCount();
+
+	BeginColouredPhase();
+
+	m_positionIterationsDone = 0;
+
+	while (m_positionIterationsDone < passes)
+	{
+		auto passSolvedCount = 0u;
+
+		for (unsigned int batch = 0; batch < batchCount; batch++)
+		{
+			m_batchSolvedCount = 0;
+
+			RunChunks(m_batchStarts[batch], m_batchStarts[batch + 1], [this](const unsigned int firstContact, const unsigned int lastContact) { ResolveBatchPenetrations(firstContact, lastContact); });
+
+			passSolvedCount += m_batchSolvedCount;
+		}
+
+		m_positionIterationsDone++;
+
+		if (passSolvedCount == 0)
+		{
+			break;
+		}
+	}
+}
+
+void ResolutionManager::AdjustVelocitiesColoured(const float dt, const int passes)
+{
+	const auto batchCount = GetBatchCount();
+
+	BeginColouredPhase();
+
+	m_velocityIterationsDone = 0;
+
+	while (m_velocityIterationsDone < passes)
+	{
+		auto passSolvedCount = 0u;
+
+		for (unsigned int batch = 0; batch < batchCount; batch++)
+		{
+			m_batchSolvedCount = 0;
+
+			if (m_wideSolver)
+			{
+				RunChunks(m_batchStarts[batch], m_batchStarts[batch + 1], [this, dt](const unsigned int firstContact, const unsigned int lastContact) { ApplyBatchVelocityChangesWide(firstContact, lastContact, dt); });
+			}
+			else
+			{
+				RunChunks(m_batchStarts[batch], m_batchStarts[batch + 1], [this, dt](const unsigned int firstContact, const unsigned int lastContact) { ApplyBatchVelocityChanges(firstContact, lastContact, dt); });
+			}
+
+			m_velocitySolvedCount += m_batchSolvedCount;
+			passSolvedCount += m_batchSolvedCount;
+		}
+
+		m_velocityIterationsDone++;
+
+		if (passSolvedCount == 0)
+		{
+			break;
+		}
+	}
+}
+
+void ResolutionManager::ResolveBatchPenetrations(const unsigned int firstContact, const unsigned int lastContact)
+{
+	XMVECTOR linearChange[2];
+	XMVECTOR angularChange[2];
+
+	auto solvedCount = 0u;
+
+	for (auto i = firstContact; i < lastContact; i++)
+	{
+		const auto contact = m_batchContacts[i];
+		auto &point = m_contactManifold->GetPoint(contact);
+
+		UpdatePenetration(contact);
+
+		if (point.penetrationDepth <= m_positionEpsilon)
+		{
+			continue;
+		}
+
+		point.MatchAwakeState(); //Match awake state
+
+		point.ResolvePenetration(linearChange, angularChange, point.penetrationDepth);
+
+		//No other contact in the batch has these bodies, so nothing else reads or writes their changes
+		AddBodyChanges(point, linearChange, angularChange);
+
+		solvedCount++;
+	}
+
+	m_batchSolvedCount += solvedCount;
+}
+
+void ResolutionManager::ApplyBatchVelocityChanges(const unsigned int firstContact, const unsigned int lastContact, const float dt)
+{
+	const auto solveStart = chrono::steady_clock::now();
+
+	XMVECTOR velocityChange[2];
+	XMVECTOR angularChange[2];
+
+	auto solvedCount = 0u;
+
+	for (auto i = firstContact; i < lastContact; i++)
+	{
+		const auto contact = m_batchContacts[i];
+		auto &point = m_contactManifold->GetPoint(contact);
+
+		UpdateVelocity(contact, dt);
+
+		if (point.desiredDeltaVelocity <= m_velocityEpsilon)
+		{
+			continue;
+		}
+
+		point.MatchAwakeState(); //Match awake state
+
+		point.ApplyVelocityChange(velocityChange, angularChange);
+
+		AddBodyChanges(point, velocityChange, angularChange);
+
+		solvedCount++;
+	}
+
+	m_batchSolvedCount += solvedCount;
+	m_velocitySolveNanoseconds += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - solveStart).count();
+}
+
+void ResolutionManager::ApplyBatchVelocityChangesWide(const unsigned int firstContact, const unsigned int lastContact, const float dt)
+{
+	const auto solveStart = chrono::steady_clock::now();
+
+	ManifoldPoint* points[WIDE_SOLVER_LANES];
+	XMVECTOR laneVelocityChanges[WIDE_SOLVER_LANES][2];
+	XMVECTOR laneAngularChanges[WIDE_SOLVER_LANES][2];
+	XMVECTOR* velocityChanges[WIDE_SOLVER_LANES];
+	XMVECTOR* angularChanges[WIDE_SOLVER_LANES];
+
+	for (unsigned int lane = 0; lane < WIDE_SOLVER_LANES; lane++)
+	{
+		velocityChanges[lane] = laneVelocityChanges[lane];
+		angularChanges[lane] = laneAngularChanges[lane];
+	}
+
+	auto pointCount = 0u;
+	auto solvedCount = 0u;
+
+	for (auto i = firstContact; i < lastContact; i++)
+	{
+		const auto contact = m_batchContacts[i];
+		auto &point = m_contactManifold->GetPoint(contact);
+
+		UpdateVelocity(contact, dt);
+
+		if (point.desiredDeltaVelocity <= m_velocityEpsilon)
+		{
+			continue;
+		}
+
+		//Waking bodies before their contact is solved is fine, no other contact in the batch has them
+		point.MatchAwakeState(); //Match awake state
+
+		points[pointCount] = &point;
+
+		if (++pointCount == WIDE_SOLVER_LANES)
+		{
+			ApplyWideVelocityChanges(points, velocityChanges, angularChanges, pointCount);
+			pointCount = 0;
+		}
+
+		solvedCount++;
+	}
+
+	//Whatever didn't fill a full set of lanes
+	if (pointCount > 0)
+	{
+		ApplyWideVelocityChanges(points, velocityChanges, angularChanges, pointCount);
+	}
+
+	m_batchSolvedCount += solvedCount;
+	m_velocitySolveNanoseconds += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - solveStart).count();
+}
+
+void ResolutionManager::ApplyWideVelocityChanges(ManifoldPoint* const points[], XMVECTOR* const velocityChanges[], XMVECTOR* const angularChanges[], const unsigned int pointCount)
+{
+	WideContactSolver::ApplyVelocityChanges(points, velocityChanges, angularChanges, pointCount);
+
+	for (unsigned int lane = 0; lane < pointCount; lane++)
+	{
+		AddBodyChanges(*points[lane], velocityChanges[lane], angularChanges[lane]);
+	}
+}
+
+void ResolutionManager::AddBodyChanges(const ManifoldPoint& point, const XMVECTOR linearChange[2], const XMVECTOR angularChange[2])
+{
+	for (unsigned int b = 0; b < 2; b++) if (point.contactID[b])
+	{
+		m_bodyLinearChanges[point.bodyIndex[b]] = XMVectorAdd(m_bodyLinearChanges[point.bodyIndex[b]], linearChange[b]);
+		m_bodyAngularChanges[point.bodyIndex[b]] = XMVectorAdd(m_bodyAngularChanges[point.bodyIndex[b]], angularChange[b]);
+		m_bodyChangeCounts[point.bodyIndex[b]]++;
+	}
+}
+
+bool ResolutionManager::HasBodyChanges(const unsigned int contact)
+{
+	const auto &point = m_contactManifold->GetPoint(contact);
+
+	//Counts only go up, so the sum only stays the same if neither body has changed since the contact was last brought up to date
+	auto changeCount = m_bodyChangeCounts[point.bodyIndex[0]];
+
+	if (point.contactID[1])
+	{
+		changeCount += m_bodyChangeCounts[point.bodyIndex[1]];
+	}
+
+	if (changeCount == m_contactChangeCounts[contact])
+	{
+		return false;
+	}
+
+	m_contactChangeCounts[contact] = changeCount;
+
+	return true;
+}
+
+void ResolutionManager::UpdatePenetration(const unsigned int contact)
+{
+	if (!HasBodyChanges(contact))
+	{
+		return;
+	}
+
+	auto &point = m_contactManifold->GetPoint(contact);
+
+	auto penetrationDepth = XMLoadFloat(&m_startPenetrations[contact]);
+
+	//Moving the first body along the normal or the second against it separates them
+	for (unsigned int b = 0; b < 2; b++) if (point.contactID[b])
+	{
+		const auto body = point.bodyIndex[b];
+		const auto deltaPosition = XMVectorAdd(m_bodyLinearChanges[body], XMVector3Cross(m_bodyAngularChanges[body], point.relativeContactPosition[b]));
+
+		penetrationDepth = XMVectorAdd(penetrationDepth, XMVectorScale(XMVector3Dot(deltaPosition, point.contactNormal), (b?1:-1)));
+	}
+
+	XMStoreFloat(&point.penetrationDepth, penetrationDepth);
+}
+
+void ResolutionManager::UpdateVelocity(const unsigned int contact, const float dt)
+{
+	if (!HasBodyChanges(contact))
+	{
+		return;
+	}
+
+	auto &point = m_contactManifold->GetPoint(contact);
+
+	auto deltaVelocity = XMVECTOR();
+
+	//The contact velocity is the first body's less the second's
+	for (unsigned int b = 0; b < 2; b++) if (point.contactID[b])
+	{
+		const auto body = point.bodyIndex[b];
+		const auto bodyDeltaVelocity = XMVectorAdd(m_bodyLinearChanges[body], XMVector3Cross(m_bodyAngularChanges[body], point.relativeContactPosition[b]));
+
+		deltaVelocity = XMVectorAdd(deltaVelocity, XMVectorScale(bodyDeltaVelocity, (b?-1:1)));
+	}
+
+	const auto contactToWorldTranspose = XMMatrixTranspose(point.contactToWorld);
+
+	point.contactVelocity = XMVectorAdd(m_startContactVelocities[contact], XMVector3Transform(deltaVelocity, contactToWorldTranspose));
+
+	point.CalculateDesiredDeltaVelocity(dt);
+}
+
+void ResolutionManager::RefreshPenetrations(const unsigned int firstContact, const unsigned int lastContact)
+{
+	auto position = XMVECTOR();
+
+	for (auto i = firstContact; i < lastContact; i++)
+	{
+		auto &point = m_contactManifold->GetPoint(i);
+
+		auto penetrationDepth = m_substepPenetrations[i];
+
+		//Moving the first body along the normal or the second against it separates them
+		for (unsigned int b = 0; b < 2; b++) if (point.contactID[b])
+		{
+			point.contactID[b]->GetNewPosition(position);
+
+			penetrationDepth += XMVectorGetX(XMVector3Dot(XMVectorSubtract(position, m_substepPositions[point.bodyIndex[b]]), point.contactNormal)) * (b ? 1.0f : -1.0f);
+		}
+
+		point.penetrationDepth = penetrationDepth;
+	}
+}
+
+void ResolutionManager::RunChunks(const unsigned int first, const unsigned int last, const function<void(unsigned int, unsigned int)>& chunkFunction) const
+{
+	const auto chunkCount = (last - first + SOLVER_CHUNK_SIZE - 1) / SOLVER_CHUNK_SIZE;
+
+	const function<void(unsigned int)> runChunk = [&chunkFunction, first, last](const unsigned int chunk)
+	{
+		chunkFunction(first + chunk * SOLVER_CHUNK_SIZE, min(last, first + (chunk + 1) * SOLVER_CHUNK_SIZE));
+	};
+
+	if (m_workerPool)
+	{
+		m_workerPool->Run(chunkCount, runChunk);
+	}
+	else
+	{
+		for (unsigned int chunk = 0; chunk < chunkCount; chunk++)
+		{
+			runChunk(chunk);
+		}
+	}
+}
@@ -1,5 +1,32 @@
 #pragma once
 #include "ContactManifold.h"
+#include "WideContactSolver.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+//Manifolds with at least this many contacts are solved in coloured batches, smaller ones one contact at a time
+auto const COLOURED_SOLVER_MINIMUM_CONTACTS = 1024u;
+
+//Sweeps over every batch in the coloured position and velocity phases, each phase stops early once nothing is above its epsilon.
+//The iteration counts are for the one contact at a time solver and would be far too many sweeps
+auto const COLOURED_SOLVER_PASSES = 16;
+
+//Sweeps over the contacts after each substep when they're solved one contact at a time, the substeps themselves do most of the
+//correcting. Two is the fewest that rests a stack as well as the one step solver at two substeps, and past that more substeps settle
+//it better than more sweeps for the same time
+auto const SUBSTEP_SOLVER_PASSES = 2;
+
+//Sweeps after each substep when the contacts go through the coloured batches. A coloured sweep only carries a correction a contact
+//or two up a stack where the one contact at a time solver goes straight to the worst one, so it needs more. Eight is the fewest that
+//rests a tall stack as well as the one step solver's sixteen sweeps at two substeps
+auto const COLOURED_SUBSTEP_SOLVER_PASSES = 8;
+
+//One bit per colour in each body's mask, contacts that can't get a colour are solved in a batch of their own
+auto const COLOURED_SOLVER_MAXIMUM_COLOURS = 64u;
+
+//Contacts per task when a batch is split over the worker pool
+auto const SOLVER_CHUNK_SIZE = 128u;
 
 //Based off and inspired by Ian Millingtons ContactResolver in the Game Physics Engine Development Book
 class ResolutionManager
@@ -10,10 +37,64 @@ public:
 
 	void ResolveContacts(const float dt);
 
+	//Substepping splits the frame into shorter steps that all reuse the contacts found after the first one, each resolved with only a
+	//few sweeps. BeginSubsteps keeps the penetration of every contact and where its bodies were once the frame's contacts are found,
+	//then each ResolveSubstep moves the penetrations on by how far the bodies have gone since before resolving them.
+	//Only the linear movement is tracked, a body doesn't turn far enough over one frame for its rotation to matter
+	void BeginSubsteps();
+	void ResolveSubstep(const float dt, const int passes, const int colouredPasses);
+
+	//Coloured batches are split over the worker pool if there is one
+	void SetWorkerPool(WorkerPool* workerPool);
+
+	//Batches the last resolve was split into, zero if it was solved one contact at a time
+	unsigned int GetBatchCount() const;
+
+	//Solve the coloured velocity batches four contacts at a time with the WideContactSolver, off by default as the results
+	//aren't bit for bit the same as the one contact at a time maths
+	void SetWideSolver(const bool wideSolver);
+	bool GetWideSolver() const;
+
+	//Contacts the coloured velocity batches of the last resolve solved per microsecond spent solving them, zero if nothing went through them
+	float GetVelocitySolveRate() const;
+
+	//Time the coloured velocity batches of the last resolve spent solving, summed over the tasks that ran them
+	float GetVelocitySolveMicroseconds() const;
+
 private:
 	void PrepareContacts(const float dt);
-	void AdjustPositions(const float dt);
-	void AdjustVelocities(const float dt);
+	void AdjustPositions(const float dt, const int iterations);
+	void AdjustVelocities(const float dt, const int iterations);
+
+	//A pile that's all touching through the floor and walls is one island, so instead the contacts are split into batches where no
+	//body appears twice and each batch is solved all at once. Contacts with the static world (a null second body) never conflict.
+	//Colours are handed out greedily in contact order so the same contacts always give the same batches, whatever the thread count
+	void ColourContacts();
+	void AdjustPositionsColoured(const int passes);
+	void AdjustVelocitiesColoured(const float dt, const int passes);
+
+	//Clears every body's changes and keeps each contact as it is at the start of a coloured position or velocity phase
+	void BeginColouredPhase();
+
+	//Bring every contact in part of a batch up to date and solve it, adding what it changed to its bodies' totals
+	void ResolveBatchPenetrations(const unsigned int firstContact, const unsigned int lastContact);
+	void ApplyBatchVelocityChanges(const unsigned int firstContact, const unsigned int lastContact, const float dt);
+	void ApplyBatchVelocityChangesWide(const unsigned int firstContact, const unsigned int lastContact, const float dt);
+	void ApplyWideVelocityChanges(ManifoldPoint* const points[], XMVECTOR* const velocityChanges[], XMVECTOR* const angularChanges[], const unsigned int pointCount);
+	void AddBodyChanges(const ManifoldPoint& point, const XMVECTOR linearChange[2], const XMVECTOR angularChange[2]);
+
+	//A contact's penetration or velocity from when the phase began, moved on by everything the phase has changed its two bodies by.
+	//Worked out when the contact is about to be solved rather than pushed to every contact of a body each time a batch moves it
+	void UpdatePenetration(const unsigned int contact);
+	void UpdateVelocity(const unsigned int contact, const float dt);
+
+	//False if neither of the contact's bodies has changed since it was last brought up to date, so it already is
+	bool HasBodyChanges(const unsigned int contact);
+
+	//Penetrations as they were when the substeps began, moved on by each body's movement since
+	void RefreshPenetrations(const unsigned int firstContact, const unsigned int lastContact);
+
+	void RunChunks(const unsigned int first, const unsigned int last, const function<void(unsigned int, unsigned int)>& chunkFunction) const;
 
 	int m_positionIterationsDone;
 	int m_positionIterations;
@@ -24,5 +105,41 @@ private:
 	float m_velocityEpsilon;
 
 	ContactManifold* m_contactManifold;
-};
 
+	WorkerPool* m_workerPool;
+
+	//Contact indices grouped by batch and where each batch starts
+	vector<unsigned int> m_batchContacts;
+	vector<unsigned int> m_batchStarts;
+	vector<unsigned int> m_contactColours;
+	vector<unsigned int> m_colourStarts;
+
+	//Per body, the colours its contacts have taken
+	vector<unsigned long long> m_bodyColours;
+
+	//Per body, the total change the contacts solved so far this phase have made, to its position and rotation in the position phase
+	//and to its velocity and angular velocity in the velocity phase
+	vector<XMVECTOR> m_bodyLinearChanges;
+	vector<XMVECTOR> m_bodyAngularChanges;
+	vector<unsigned int> m_bodyChangeCounts;
+
+	//Penetration and contact velocity of every contact when the phase began
+	vector<float> m_startPenetrations;
+	vector<XMVECTOR> m_startContactVelocities;
+
+	//Sum of the two bodies' change counts when each contact was last brought up to date
+	vector<unsigned int> m_contactChangeCounts;
+
+	//Penetration of every contact and position of every body when the substeps began
+	vector<float> m_substepPenetrations;
+	vector<XMVECTOR> m_substepPositions;
+
+	atomic<unsigned int> m_batchSolvedCount;
+
+	bool m_wideSolver;
+
+	//Contacts solved in the coloured velocity batches and time spent solving them, for the solve rate. The time is summed over the tasks
+	//inside ApplyBatchVelocityChanges, so handing the chunks to the worker pool isn't counted
+	unsigned int m_velocitySolvedCount;
+	atomic<unsigned long long> m_velocitySolveNanoseconds;
+};
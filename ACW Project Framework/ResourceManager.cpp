@@ -1,103 +1,512 @@
 #include "ResourceManager.h"
 
-ResourceManager::ResourceManager(ID3D11Device* device)
+ResourceManager::ResourceManager(ID3D11Device* device) : m_placeholderTexture(nullptr), m_placeholderTextureArray(nullptr), m_failedLoadCount(0)
 {
-	LoadTexture(device, L"texture1.dds");
-	LoadTexture(device, L"texture2.dds");
-	LoadTexture(device, L"texture3.dds");
-	LoadTexture(device, L"texture4.dds");
-	LoadTexture(device, L"texture5.dds");
-	LoadTexture(device, L"texture6.dds");
-	LoadTexture(device, L"texture7.dds");
-	LoadTexture(device, L"texture8.dds");
-	LoadTexture(device, L"texture9.dds");
-	LoadTexture(device, L"texture10.dds");
-}
+	//Plain white texture that is drawn until a texture has finished loading
+	D3D11_TEXTURE2D_DESC placeholderDescription;
+	D3D11_SUBRESOURCE_DATA placeholderData;
+
+	const unsigned int white = 0xFFFFFFFF;
+
+	placeholderDescription.Width = 1;
+	placeholderDescription.Height = 1;
+	placeholderDescription.MipLevels = 1;
+	placeholderDescription.ArraySize = 1;
+	placeholderDescription.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	placeholderDescription.SampleDesc.Count = 1;
+	placeholderDescription.SampleDesc.Quality = 0;
+	placeholderDescription.Usage = D3D11_USAGE_IMMUTABLE;
+	placeholderDescription.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	placeholderDescription.CPUAccessFlags = 0;
+	placeholderDescription.MiscFlags = 0;
+
+	placeholderData.pSysMem = &white;
+	placeholderData.SysMemPitch = sizeof(white);
+	placeholderData.SysMemSlicePitch = 0;
+
+	ID3D11Texture2D* placeholder = nullptr;
+
+	auto const result = device->CreateTexture2D(&placeholderDescription, &placeholderData, &placeholder);
+
+	if (SUCCEEDED(result))
+	{
+		device->CreateShaderResourceView(placeholder, nullptr, &m_placeholderTexture);
+
+		//Same texture viewed as a one layer array for the instanced shader
+		D3D11_SHADER_RESOURCE_VIEW_DESC placeholderArrayDescription;
+		placeholderArrayDescription.Format = placeholderDescription.Format;
+		placeholderArrayDescription.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+		placeholderArrayDescription.Texture2DArray.MostDetailedMip = 0;
+		placeholderArrayDescription.Texture2DArray.MipLevels = 1;
+		placeholderArrayDescription.Texture2DArray.FirstArraySlice = 0;
+		placeholderArrayDescription.Texture2DArray.ArraySize = 1;
+
+		device->CreateShaderResourceView(placeholder, &placeholderArrayDescription, &m_placeholderTextureArray);
 
-ResourceManager::ResourceManager(const ResourceManager& other) = default;
+		placeholder->Release();
+		placeholder = nullptr;
+	}
+
+	GetTextureHandle(L"texture1.dds");
+	GetTextureHandle(L"texture2.dds");
+	GetTextureHandle(L"texture3.dds");
+	GetTextureHandle(L"texture4.dds");
+	GetTextureHandle(L"texture5.dds");
+	GetTextureHandle(L"texture6.dds");
+	GetTextureHandle(L"texture7.dds");
+	GetTextureHandle(L"texture8.dds");
+	GetTextureHandle(L"texture9.dds");
+	GetTextureHandle(L"texture10.dds");
+}
 
 //ResourceManager::ResourceManager(ResourceManager&& other) noexcept = default;
 
 ResourceManager::~ResourceManager()
 {
-	
-}
+	//Let the workers finish before anything is released, their results are thrown away
+	m_pendingModels.clear();
+	m_pendingTextures.clear();
 
-ResourceManager& ResourceManager::operator=(const ResourceManager& other) = default;
+	//Release resources, models and textures only hold handles so we are the only owner
+	for (auto& model : m_models)
+	{
+		if (model.vertexBuffer)
+		{
+			model.vertexBuffer->Release();
+			model.vertexBuffer = nullptr;
+		}
+
+		if (model.indexBuffer)
+		{
+			model.indexBuffer->Release();
+			model.indexBuffer = nullptr;
+		}
+	}
+
+	for (auto& texture : m_textures)
+	{
+		if (texture)
+		{
+			texture->Release();
+			texture = nullptr;
+		}
+	}
+
+	ReleaseTextureArrays();
+
+	if (m_placeholderTextureArray)
+	{
+		m_placeholderTextureArray->Release();
+		m_placeholderTextureArray = nullptr;
+	}
+
+	if (m_placeholderTexture)
+	{
+		m_placeholderTexture->Release();
+		m_placeholderTexture = nullptr;
+	}
+}
 
 ResourceManager& ResourceManager::operator=(ResourceManager&& other) noexcept = default;
 
-bool ResourceManager::GetModel(ID3D11Device* device, const char* modelFileName, ID3D11Buffer* &vertexBuffer, ID3D11Buffer* &indexBuffer)
+unsigned int ResourceManager::GetModelHandle(const char* modelFileName)
 {
-	if (0 == m_vertexBuffers.count(modelFileName))
+	//Only used as a key so a straight widening of each character is enough
+	const wstring modelPath(modelFileName, modelFileName + strlen(modelFileName));
+
+	auto modelHandle = m_modelRegistry.Find(modelPath);
+
+	if (modelHandle != INVALID_RESOURCE_HANDLE)
 	{
-		auto const result = LoadModel(device, modelFileName);
+		return modelHandle;
+	}
 
-		if (!result)
-		{
-			return false;
-		}
+	modelHandle = m_modelRegistry.Add(modelPath);
+
+	//Empty until the buffers are created, drawing it draws nothing
+	ModelResource model;
+	model.vertexBuffer = nullptr;
+	model.indexBuffer = nullptr;
+	model.indexCount = 0;
+	model.indexFormat = DXGI_FORMAT_R16_UINT;
+	model.loadInformation = ModelLoadInformation();
+	model.loadInformation.fileName = modelFileName;
+
+	m_models.push_back(model);
+
+	PendingModel pendingModel;
+	pendingModel.handle = modelHandle;
+	pendingModel.data = async(launch::async, &ResourceManager::LoadModelData, string(modelFileName));
+
+	m_pendingModels.push_back(move(pendingModel));
+
+	return modelHandle;
+}
+
+unsigned int ResourceManager::GetTextureHandle(const WCHAR* textureFileName)
+{
+	const wstring texturePath(textureFileName);
+
+	auto textureHandle = m_textureRegistry.Find(texturePath);
+
+	if (textureHandle != INVALID_RESOURCE_HANDLE)
+	{
+		return textureHandle;
 	}
 
-	vertexBuffer = m_vertexBuffers.at(modelFileName);
-	indexBuffer = m_indexBuffers.at(modelFileName);
+	textureHandle = m_textureRegistry.Add(texturePath);
 
-	return true;
+	//GetTexture hands out the placeholder while this is empty
+	m_textures.push_back(nullptr);
+
+	PendingTexture pendingTexture;
+	pendingTexture.handle = textureHandle;
+	pendingTexture.data = async(launch::async, &ResourceManager::LoadTextureData, texturePath);
+
+	m_pendingTextures.push_back(move(pendingTexture));
+
+	return textureHandle;
 }
 
-bool ResourceManager::GetTexture(ID3D11Device* device, const WCHAR* textureFileName, ID3D11ShaderResourceView* &texture)
+bool ResourceManager::CompleteLoads(ID3D11Device* device, const bool waitForAll)
 {
-	if (0 == m_textures.count(textureFileName))
+	auto changed = false;
+	auto texturesChanged = false;
+
+	for (auto pendingModel = m_pendingModels.begin(); pendingModel != m_pendingModels.end();)
 	{
-		auto const result = LoadTexture(device, textureFileName);
+		if (!waitForAll && pendingModel->data.wait_for(chrono::seconds(0)) != future_status::ready)
+		{
+			++pendingModel;
+			continue;
+		}
 
-		if (!result)
+		auto modelData = pendingModel->data.get();
+
+		CreateModel(device, pendingModel->handle, modelData);
+
+		pendingModel = m_pendingModels.erase(pendingModel);
+		changed = true;
+	}
+
+	for (auto pendingTexture = m_pendingTextures.begin(); pendingTexture != m_pendingTextures.end();)
+	{
+		if (!waitForAll && pendingTexture->data.wait_for(chrono::seconds(0)) != future_status::ready)
 		{
-			return false;
+			++pendingTexture;
+			continue;
 		}
+
+		auto textureData = pendingTexture->data.get();
+
+		CreateTexture(device, pendingTexture->handle, textureData);
+
+		pendingTexture = m_pendingTextures.erase(pendingTexture);
+		changed = true;
+		texturesChanged = true;
 	}
 
-	texture = m_textures.at(textureFileName);
+	//Wait for the last texture so a burst of loads only packs the arrays once
+	if (texturesChanged && m_pendingTextures.empty())
+	{
+		BuildTextureArrays(device);
+	}
 
-	return true;
+	return changed;
+}
+
+bool ResourceManager::HasPendingLoads() const {
+	return !m_pendingModels.empty() || !m_pendingTextures.empty();
+}
+
+unsigned int ResourceManager::GetFailedLoadCount() const {
+	return m_failedLoadCount;
+}
+
+void ResourceManager::GetModel(const unsigned int modelHandle, ID3D11Buffer* &vertexBuffer, ID3D11Buffer* &indexBuffer) const
+{
+	vertexBuffer = m_models[modelHandle].vertexBuffer;
+	indexBuffer = m_models[modelHandle].indexBuffer;
+}
+
+ID3D11ShaderResourceView* ResourceManager::GetTexture(const unsigned int textureHandle) const
+{
+	if (!m_textures[textureHandle])
+	{
+		return m_placeholderTexture;
+	}
+
+	return m_textures[textureHandle];
+}
+
+ID3D11ShaderResourceView* ResourceManager::GetTextureArray(const unsigned int textureHandle) const
+{
+	if (textureHandle >= m_texturePlacements.size() || m_texturePlacements[textureHandle].array == INVALID_RESOURCE_HANDLE)
+	{
+		return m_placeholderTextureArray;
+	}
+
+	return m_textureArrays[m_texturePlacements[textureHandle].array];
+}
+
+unsigned int ResourceManager::GetTextureLayer(const unsigned int textureHandle) const
+{
+	if (textureHandle >= m_texturePlacements.size() || m_texturePlacements[textureHandle].array == INVALID_RESOURCE_HANDLE)
+	{
+		return 0;
+	}
+
+	return m_texturePlacements[textureHandle].layer;
+}
+
+unsigned int ResourceManager::GetTextureArrayCount() const {
+	return static_cast<unsigned int>(m_textureArrays.size());
+}
+
+const wstring& ResourceManager::GetTexturePath(const unsigned int textureHandle) const {
+	return m_textureRegistry.GetPath(textureHandle);
 }
 
 int ResourceManager::GetSizeOfVertexType() const {
 	return sizeof(VertexType);
 }
 
-int ResourceManager::GetIndexCount(const char* modelFileName) const {
-	return m_indexCount.at(modelFileName);
+int ResourceManager::GetIndexCount(const unsigned int modelHandle) const {
+	return m_models[modelHandle].indexCount;
+}
+
+DXGI_FORMAT ResourceManager::GetIndexFormat(const unsigned int modelHandle) const {
+	return m_models[modelHandle].indexFormat;
+}
+
+unsigned int ResourceManager::GetModelCount() const {
+	return static_cast<unsigned int>(m_models.size());
+}
+
+const ResourceManager::ModelLoadInformation& ResourceManager::GetModelLoadInformation(const unsigned int modelHandle) const {
+	return m_models[modelHandle].loadInformation;
 }
 
-void ResourceManager::ReturnRandomTexture(ID3D11ShaderResourceView*& texture) {
-	random_device rd;
-	std::mt19937 rng(rd());
-	uniform_int_distribution<int> uni(0, m_textures.size());
+unsigned int ResourceManager::ReturnRandomTexture(const unsigned int textureHandle) const {
+	const auto textureCount = static_cast<unsigned int>(m_textures.size());
 
-	const auto randomInt = uni(rng);
+	//Scale a 32 bit random number into [0, textureCount] with a multiply instead of a division
+	const auto randomInt = static_cast<unsigned int>((static_cast<unsigned long long>(NextRandom()) * (textureCount + 1)) >> 32);
 
-	auto count = 0;
+	//One past the end keeps the current texture
+	if (randomInt < m_textures.size())
+	{
+		return randomInt;
+	}
+
+	return textureHandle;
+}
+
+unsigned int ResourceManager::NextRandom()
+{
+	//PCG32, each thread seeds its own generator from random_device once and then never touches the device again
+	thread_local auto state = (static_cast<unsigned long long>(random_device()()) << 32) | random_device()();
 
-	for (auto it = m_textures.begin(); it != m_textures.end(); ++it)
+	const auto oldState = state;
+	state = oldState * 6364136223846793005ull + 1442695040888963407ull;
+
+	const auto xorShifted = static_cast<unsigned int>(((oldState >> 18u) ^ oldState) >> 27u);
+	const auto rotation = static_cast<unsigned int>(oldState >> 59u);
+
+	return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+}
+
+ResourceManager::ModelData ResourceManager::LoadModelData(const string& modelFileName)
+{
+	//Runs on a worker thread so it can't touch any members, everything it makes goes back through the future
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER loadStart;
+	LARGE_INTEGER loadEnd;
+
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&loadStart);
+
+	ModelData modelData;
+	modelData.succeeded = false;
+	modelData.loadTime = 0.0f;
+	modelData.vertexCount = 0;
+	modelData.indexCount = 0;
+	modelData.indexStride = 0;
+
+	//Use the binary cache if it was built from this version of the obj, otherwise parse the obj and write a new cache for next time
+	modelData.meshCache.reset(new MeshCache());
+
+	modelData.loadedFromCache = modelData.meshCache->Open(modelFileName.c_str(), sizeof(VertexType));
+
+	if (modelData.loadedFromCache)
 	{
-		if (count == randomInt)
+		modelData.vertexCount = modelData.meshCache->GetHeader().vertexCount;
+		modelData.indexCount = modelData.meshCache->GetHeader().indexCount;
+		modelData.indexStride = modelData.meshCache->GetHeader().indexStride;
+	}
+	else
+	{
+		modelData.meshCache.reset();
+
+		const auto result = ParseModel(modelFileName.c_str(), modelData.vertices, modelData.indices);
+
+		if (!result)
 		{
-			texture = it->second;
-			return;
+			return modelData;
 		}
 
-		count++;
+		modelData.vertexCount = static_cast<unsigned int>(modelData.vertices.size());
+		modelData.indexCount = static_cast<unsigned int>(modelData.indices.size());
+		modelData.indexStride = sizeof(unsigned int);
+
+		OptimizeModel(modelData.vertices, modelData.indices);
+
+		//Most of our models are nowhere near 65k vertices so half the index buffer size
+		if (modelData.vertexCount <= 0xFFFF)
+		{
+			modelData.shortIndices.assign(modelData.indices.begin(), modelData.indices.end());
+			modelData.indices.clear();
+
+			modelData.indexStride = sizeof(unsigned short);
+		}
+
+		//Not being able to write the cache just means we parse again next time
+		MeshCache::Write(modelFileName.c_str(), sizeof(VertexType), GetVertexData(modelData), modelData.vertexCount, modelData.indexStride, GetIndexData(modelData), modelData.indexCount);
 	}
+
+	QueryPerformanceCounter(&loadEnd);
+
+	modelData.loadTime = static_cast<float>((loadEnd.QuadPart - loadStart.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart));
+	modelData.succeeded = true;
+
+	return modelData;
 }
 
+const void* ResourceManager::GetVertexData(const ModelData& modelData)
+{
+	if (modelData.meshCache)
+	{
+		return modelData.meshCache->GetVertexData();
+	}
+
+	return modelData.vertices.data();
+}
+
+const void* ResourceManager::GetIndexData(const ModelData& modelData)
+{
+	if (modelData.meshCache)
+	{
+		return modelData.meshCache->GetIndexData();
+	}
+
+	if (modelData.indexStride == sizeof(unsigned short))
+	{
+		return modelData.shortIndices.data();
+	}
+
+	return modelData.indices.data();
+}
 
-bool ResourceManager::LoadModel(ID3D11Device* device, const char* modelFileName)
+bool ResourceManager::CreateModel(ID3D11Device* device, const unsigned int modelHandle, const ModelData& modelData)
+{
+	auto& model = m_models[modelHandle];
+
+	if (!modelData.succeeded)
+	{
+		model.loadInformation.loadFailed = true;
+		m_failedLoadCount++;
+
+		return false;
+	}
+
+	const auto vertexCount = modelData.vertexCount;
+	const auto indexCount = modelData.indexCount;
+	const auto indexStride = modelData.indexStride;
+
+	ID3D11Buffer* vertexBuffer;
+	ID3D11Buffer* indexBuffer;
+
+	//Initialize buffers
+	D3D11_BUFFER_DESC vertexBufferDescription;
+	D3D11_BUFFER_DESC indexBufferDescription;
+
+	D3D11_SUBRESOURCE_DATA vertexSubresourceData;
+	D3D11_SUBRESOURCE_DATA indexSubresourceData;
+
+	//Initialize vertex and index descriptions and then create buffers
+	vertexBufferDescription.Usage = D3D11_USAGE_DEFAULT;
+	vertexBufferDescription.ByteWidth = sizeof(VertexType) * vertexCount;
+	vertexBufferDescription.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	vertexBufferDescription.CPUAccessFlags = 0;
+	vertexBufferDescription.MiscFlags = 0;
+	vertexBufferDescription.StructureByteStride = 0;
+
+	vertexSubresourceData.pSysMem = GetVertexData(modelData);
+	vertexSubresourceData.SysMemPitch = 0;
+	vertexSubresourceData.SysMemSlicePitch = 0;
+
+	auto result = device->CreateBuffer(&vertexBufferDescription, &vertexSubresourceData, &vertexBuffer);
+
+	if (FAILED(result))
+	{
+		model.loadInformation.loadFailed = true;
+		m_failedLoadCount++;
+
+		return false;
+	}
+
+	indexBufferDescription.Usage = D3D11_USAGE_DEFAULT;
+	indexBufferDescription.ByteWidth = indexStride * indexCount;
+	indexBufferDescription.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	indexBufferDescription.CPUAccessFlags = 0;
+	indexBufferDescription.MiscFlags = 0;
+	indexBufferDescription.StructureByteStride = 0;
+
+	indexSubresourceData.pSysMem = GetIndexData(modelData);
+	indexSubresourceData.SysMemPitch = 0;
+	indexSubresourceData.SysMemSlicePitch = 0;
+
+	result = device->CreateBuffer(&indexBufferDescription, &indexSubresourceData, &indexBuffer);
+
+	if (FAILED(result))
+	{
+		vertexBuffer->Release();
+
+		model.loadInformation.loadFailed = true;
+		m_failedLoadCount++;
+
+		return false;
+	}
+
+	model.vertexBuffer = vertexBuffer;
+	model.indexBuffer = indexBuffer;
+	model.indexCount = static_cast<int>(indexCount);
+	model.indexFormat = indexStride == sizeof(unsigned short) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+
+	auto& loadInformation = model.loadInformation;
+	loadInformation.loaded = true;
+	loadInformation.loadTime = modelData.loadTime;
+	loadInformation.loadedFromCache = modelData.loadedFromCache;
+	loadInformation.vertexCount = vertexCount;
+	loadInformation.indexCount = indexCount;
+
+	//Before deduplication every corner was its own vertex with a 32 bit index
+	loadInformation.vertexBytes = sizeof(VertexType) * vertexCount;
+	loadInformation.indexBytes = indexStride * indexCount;
+	loadInformation.unoptimizedVertexBytes = sizeof(VertexType) * indexCount;
+	loadInformation.unoptimizedIndexBytes = sizeof(unsigned int) * indexCount;
+
+	//Release resources
+	vertexBuffer = nullptr;
+	indexBuffer = nullptr;
+
+	return true;
+}
+
+bool ResourceManager::ParseModel(const char* modelFileName, vector<VertexType>& vertices, vector<unsigned int>& indices)
 {
 	//Load Model
 	ifstream fin;
-	char input;
-	int i;
 
 	//Open obj file
 	fin.open(modelFileName);
@@ -107,21 +516,14 @@ bool ResourceManager::LoadModel(ID3D11Device* device, const char* modelFileName)
 		return false;
 	}
 
-	ID3D11Buffer* vertexBuffer;
-	ID3D11Buffer* indexBuffer;
-
 	vector<XMFLOAT3> positions;
 	vector<XMFLOAT2> textures;
 	vector<XMFLOAT3> normals;
 
-	char cmd[256] = { 0 };
-
-	auto faceCount = 0;
-	auto vertexCount = 0;
-	auto indexCount = 0;
+	//Each unique position/texture/normal index triple becomes one vertex, corners that share all three share the vertex
+	unordered_map<unsigned long long, unsigned int> uniqueVertices;
 
-	VertexType* vertices = nullptr;
-	unsigned long* indices = nullptr;
+	char cmd[256] = { 0 };
 
 	while (!fin.eof())
 	{
@@ -131,24 +533,12 @@ bool ResourceManager::LoadModel(ID3D11Device* device, const char* modelFileName)
 
 		if (0 == strcmp(cmd, "faces"))
 		{
+			int faceCount;
 			fin >> faceCount;
-			vertices = new VertexType[faceCount * 3];
-
-			if (!vertices)
-			{
-				return false;
-			}
-
-			vertexCount = faceCount * 3;
-
-			indices = new unsigned long[faceCount * 3];
-
-			if (!indices)
-			{
-				return false;
-			}
 
-			indexCount = faceCount * 3;
+			vertices.reserve(faceCount * 3);
+			indices.reserve(faceCount * 3);
+			uniqueVertices.reserve(faceCount * 3);
 		}
 
 		if (0 == strcmp(cmd, "v"))
@@ -168,114 +558,287 @@ bool ResourceManager::LoadModel(ID3D11Device* device, const char* modelFileName)
 		}
 		else if (0 == strcmp(cmd, "f"))
 		{
-			int value;
-			auto count = 0;
-
 			while (0 == strcmp(cmd, "f"))
 			{
-
 				for (auto i = 0; i < 3; i++)
 				{
-					fin >> value;
-					vertices[count].position = (positions[value - 1]);
+					unsigned long long position, texture, normal;
+
+					fin >> position;
 					fin.ignore();
 
-					fin >> value;
-					vertices[count].texture = (textures[value - 1]);
+					fin >> texture;
 					fin.ignore();
 
-					fin >> value;
-					vertices[count].normal = (normals[value - 1]);
+					fin >> normal;
 					fin.ignore();
 
-					indices[count] = count;
+					if (fin.fail() || position == 0 || position > positions.size() || texture == 0 || texture > textures.size() || normal == 0 || normal > normals.size())
+					{
+						return false;
+					}
+
+					const auto key = (position << 42) | (texture << 21) | normal;
+					const auto uniqueVertex = uniqueVertices.find(key);
+
+					if (uniqueVertex != uniqueVertices.end())
+					{
+						indices.push_back(uniqueVertex->second);
+						continue;
+					}
 
-					count++;
+					VertexType vertex;
+					vertex.position = positions[position - 1];
+					vertex.texture = textures[texture - 1];
+					vertex.normal = normals[normal - 1];
+
+					const auto index = static_cast<unsigned int>(vertices.size());
+
+					vertices.push_back(vertex);
+					indices.push_back(index);
+
+					uniqueVertices.insert(pair<unsigned long long, unsigned int>(key, index));
 				}
 
-				fin >> cmd;
+				//The file can end straight after the last face
+				if (!(fin >> cmd))
+				{
+					break;
+				}
 			}
 		}
 	}
 
-	//Initialize buffers
-	D3D11_BUFFER_DESC vertexBufferDescription;
-	D3D11_BUFFER_DESC indexBufferDescription;
+	return !vertices.empty();
+}
 
-	D3D11_SUBRESOURCE_DATA vertexData;
-	D3D11_SUBRESOURCE_DATA indexData;
+void ResourceManager::OptimizeModel(vector<VertexType>& vertices, vector<unsigned int>& indices)
+{
+	const auto vertexCount = static_cast<unsigned int>(vertices.size());
 
-	//Initialize vertex and index descriptions and then create buffers
-	vertexBufferDescription.Usage = D3D11_USAGE_DEFAULT;
-	vertexBufferDescription.ByteWidth = sizeof(VertexType) * vertexCount;
-	vertexBufferDescription.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vertexBufferDescription.CPUAccessFlags = 0;
-	vertexBufferDescription.MiscFlags = 0;
-	vertexBufferDescription.StructureByteStride = 0;
+	//Order triangles for the post transform cache and then store vertices in the order they are first used
+	MeshOptimizer::OptimizeVertexCache(indices, vertexCount);
 
-	vertexData.pSysMem = vertices;
-	vertexData.SysMemPitch = 0;
-	vertexData.SysMemSlicePitch = 0;
+	vector<unsigned int> remap;
+	MeshOptimizer::OptimizeVertexFetch(indices, vertexCount, remap);
 
-	auto result = device->CreateBuffer(&vertexBufferDescription, &vertexData, &vertexBuffer);
+	vector<VertexType> remappedVertices(vertexCount);
 
-	if (FAILED(result))
+	for (unsigned int i = 0; i < vertexCount; i++)
 	{
-		return false;
+		remappedVertices[remap[i]] = vertices[i];
 	}
 
-	indexBufferDescription.Usage = D3D11_USAGE_DEFAULT;
-	indexBufferDescription.ByteWidth = sizeof(unsigned long) * indexCount;
-	indexBufferDescription.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	indexBufferDescription.CPUAccessFlags = 0;
-	indexBufferDescription.MiscFlags = 0;
-	indexBufferDescription.StructureByteStride = 0;
+	vertices.swap(remappedVertices);
+}
 
-	indexData.pSysMem = indices;
-	indexData.SysMemPitch = 0;
-	indexData.SysMemSlicePitch = 0;
+ResourceManager::TextureData ResourceManager::LoadTextureData(const wstring& textureFileName)
+{
+	//Runs on a worker thread, reading the file is the slow part so only the texture creation is left for the main thread
+	TextureData textureData;
+	textureData.mappedFile.reset(new MappedFile());
 
-	result = device->CreateBuffer(&indexBufferDescription, &indexData, &indexBuffer);
+	textureData.succeeded = textureData.mappedFile->Open(textureFileName.c_str());
 
-	if (FAILED(result))
+	if (textureData.succeeded)
 	{
-		return false;
-	}
+		//Fault the pages in here so the main thread doesn't stall on the disk while creating the texture
+		textureData.mappedFile->Prefetch();
 
-	m_indexCount.insert(pair<const char*, int>(modelFileName, indexCount));
-
-	m_vertexBuffers.insert(pair<const char*, ID3D11Buffer*>(modelFileName, vertexBuffer));
-	m_indexBuffers.insert(pair<const char*, ID3D11Buffer*>(modelFileName, indexBuffer));
-
-	//Release resources
-	vertexBuffer = nullptr;
-	indexBuffer = nullptr;
-
-	delete[] vertices;
-	vertices = nullptr;
-
-	delete[] indices;
-	indices = nullptr;
+		//Anything that isn't a DDS file is turned away here rather than when the main thread comes to create it
+		DDSFileLayout layout;
+		textureData.succeeded = ParseDDSFile(textureData.mappedFile->GetData(), static_cast<size_t>(textureData.mappedFile->GetSize()), layout);
+	}
 
-	return true;
+	return textureData;
 }
 
-bool ResourceManager::LoadTexture(ID3D11Device* device, const WCHAR* textureFileName)
+bool ResourceManager::CreateTexture(ID3D11Device* device, const unsigned int textureHandle, const TextureData& textureData)
 {
+	if (!textureData.succeeded)
+	{
+		m_failedLoadCount++;
+		return false;
+	}
+
 	ID3D11ShaderResourceView* texture;
 
-	const auto result = CreateDDSTextureFromFile(device, textureFileName, nullptr, &texture);
+	//The header is validated and the mip chain laid out in place in the mapping, nothing is copied before the upload
+	//The size limits depend on the device feature level so this has to happen here
+	const auto result = CreateDDSTextureFromMemory(device, textureData.mappedFile->GetData(), static_cast<size_t>(textureData.mappedFile->GetSize()), nullptr, &texture);
 
 	if (SUCCEEDED(result))
 	{
-		m_textures.insert(pair<const WCHAR*, ID3D11ShaderResourceView*>(textureFileName, texture));
+		m_textures[textureHandle] = texture;
 		texture = nullptr;
 
 		return true;
 	}
 	else
 	{
+		m_failedLoadCount++;
+
 		texture = nullptr;
 		return false;
 	}
-}
\ No newline at end of file
+}
+
+bool ResourceManager::BuildTextureArrays(ID3D11Device* device)
+{
+	ReleaseTextureArrays();
+
+	TextureArrayPacker::Placement unpacked;
+	unpacked.array = INVALID_RESOURCE_HANDLE;
+	unpacked.layer = 0;
+
+	m_texturePlacements.assign(m_textures.size(), unpacked);
+
+	TextureArrayPacker packer;
+
+	vector<unsigned int> packedHandles;
+	vector<ID3D11Texture2D*> sourceTextures;
+
+	//Only plain 2D textures can go in an array, anything else keeps drawing the placeholder through the instanced shader
+	for (auto textureHandle = 0u; textureHandle < m_textures.size(); textureHandle++)
+	{
+		auto* texture = m_textures[textureHandle];
+
+		if (!texture)
+		{
+			continue;
+		}
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC viewDescription;
+		texture->GetDesc(&viewDescription);
+
+		if (viewDescription.ViewDimension != D3D11_SRV_DIMENSION_TEXTURE2D)
+		{
+			continue;
+		}
+
+		ID3D11Resource* resource = nullptr;
+		texture->GetResource(&resource);
+
+		auto* sourceTexture = static_cast<ID3D11Texture2D*>(resource);
+
+		D3D11_TEXTURE2D_DESC sourceDescription;
+		sourceTexture->GetDesc(&sourceDescription);
+
+		TextureArrayPacker::TextureDescription description;
+		description.width = sourceDescription.Width;
+		description.height = sourceDescription.Height;
+		description.mipLevels = sourceDescription.MipLevels;
+		description.format = sourceDescription.Format;
+
+		packer.Add(description);
+
+		packedHandles.push_back(textureHandle);
+		sourceTextures.push_back(sourceTexture);
+	}
+
+	if (packer.GetArrayCount() == 0)
+	{
+		return true;
+	}
+
+	ID3D11DeviceContext* deviceContext = nullptr;
+	device->GetImmediateContext(&deviceContext);
+
+	auto succeeded = true;
+
+	for (auto array = 0u; array < packer.GetArrayCount(); array++)
+	{
+		const auto& description = packer.GetArrayDescription(array);
+		const auto layerCount = packer.GetLayerCount(array);
+
+		D3D11_TEXTURE2D_DESC arrayDescription;
+		arrayDescription.Width = description.width;
+		arrayDescription.Height = description.height;
+		arrayDescription.MipLevels = description.mipLevels;
+		arrayDescription.ArraySize = layerCount;
+		arrayDescription.Format = static_cast<DXGI_FORMAT>(description.format);
+		arrayDescription.SampleDesc.Count = 1;
+		arrayDescription.SampleDesc.Quality = 0;
+		arrayDescription.Usage = D3D11_USAGE_DEFAULT;
+		arrayDescription.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		arrayDescription.CPUAccessFlags = 0;
+		arrayDescription.MiscFlags = 0;
+
+		ID3D11Texture2D* arrayTexture = nullptr;
+		ID3D11ShaderResourceView* arrayView = nullptr;
+
+		auto result = device->CreateTexture2D(&arrayDescription, nullptr, &arrayTexture);
+
+		if (SUCCEEDED(result))
+		{
+			//Copied on the GPU, every mip of every layer comes straight from the texture that was already uploaded
+			for (auto layer = 0u; layer < layerCount; layer++)
+			{
+				auto* sourceTexture = sourceTextures[packer.GetTextureIndex(array, layer)];
+
+				for (auto mipLevel = 0u; mipLevel < description.mipLevels; mipLevel++)
+				{
+					deviceContext->CopySubresourceRegion(arrayTexture, TextureArrayPacker::GetSubresource(mipLevel, layer, description.mipLevels), 0, 0, 0, sourceTexture, mipLevel, nullptr);
+				}
+			}
+
+			D3D11_SHADER_RESOURCE_VIEW_DESC arrayViewDescription;
+			arrayViewDescription.Format = arrayDescription.Format;
+			arrayViewDescription.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+			arrayViewDescription.Texture2DArray.MostDetailedMip = 0;
+			arrayViewDescription.Texture2DArray.MipLevels = description.mipLevels;
+			arrayViewDescription.Texture2DArray.FirstArraySlice = 0;
+			arrayViewDescription.Texture2DArray.ArraySize = layerCount;
+
+			result = device->CreateShaderResourceView(arrayTexture, &arrayViewDescription, &arrayView);
+
+			arrayTexture->Release();
+			arrayTexture = nullptr;
+		}
+
+		if (FAILED(result))
+		{
+			succeeded = false;
+			arrayView = nullptr;
+		}
+
+		m_textureArrays.push_back(arrayView);
+	}
+
+	//Textures whose array couldn't be made stay unpacked
+	for (unsigned int i = 0; i < packedHandles.size(); i++)
+	{
+		const auto& placement = packer.GetPlacements()[i];
+
+		if (m_textureArrays[placement.array])
+		{
+			m_texturePlacements[packedHandles[i]] = placement;
+		}
+	}
+
+	//Release resources
+	for (auto* sourceTexture : sourceTextures)
+	{
+		sourceTexture->Release();
+	}
+
+	deviceContext->Release();
+	deviceContext = nullptr;
+
+	return succeeded;
+}
+
+void ResourceManager::ReleaseTextureArrays()
+{
+	for (auto& textureArray : m_textureArrays)
+	{
+		if (textureArray)
+		{
+			textureArray->Release();
+			textureArray = nullptr;
+		}
+	}
+
+	m_textureArrays.clear();
+	m_texturePlacements.clear();
+}
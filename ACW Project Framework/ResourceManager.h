@@ -6,8 +6,17 @@
 #include <d3d11.h>
 #include <DirectXMath.h>
 #include <random>
+#include <unordered_map>
+#include <future>
+#include <chrono>
 
 #include "DDSTextureLoader.h"
+#include "DDSFile.h"
+#include "MeshCache.h"
+#include "MappedFile.h"
+#include "MeshOptimizer.h"
+#include "ResourceRegistry.h"
+#include "TextureArrayPacker.h"
 
 using namespace std;
 using namespace DirectX;
@@ -15,37 +24,139 @@ using namespace DirectX;
 class ResourceManager
 {
 public:
+	struct ModelLoadInformation {
+		bool loaded;
+		bool loadFailed;
+		float loadTime;
+		bool loadedFromCache;
+		unsigned int vertexCount;
+		unsigned int indexCount;
+		unsigned int vertexBytes;
+		unsigned int indexBytes;
+		unsigned int unoptimizedVertexBytes;
+		unsigned int unoptimizedIndexBytes;
+		string fileName;
+	};
+
 	ResourceManager(ID3D11Device* device);
-	ResourceManager(const ResourceManager& other); // Copy Constructor
+	ResourceManager(const ResourceManager& other) = delete; // Copy Constructor
 	//ResourceManager(ResourceManager&& other) noexcept; // Move Constructor
 	~ResourceManager();
 
-	ResourceManager& operator = (const ResourceManager& other); // Copy Assignment Operator
+	ResourceManager& operator = (const ResourceManager& other) = delete; // Copy Assignment Operator
 	ResourceManager& operator = (ResourceManager&& other) noexcept; // Move Assignment Operator
 
-	bool GetModel(ID3D11Device* device, const char* modelFileName, ID3D11Buffer* &vertexBuffer, ID3D11Buffer* &indexBuffer);
-	bool GetTexture(ID3D11Device* device, const WCHAR* textureFileName, ID3D11ShaderResourceView* &texture);
+	//Return the same handle every time a file is asked for, the first time the file is read and parsed on a worker thread
+	//Until CompleteLoads has created its Direct3D resources a model draws nothing and a texture is a plain white placeholder
+	unsigned int GetModelHandle(const char* modelFileName);
+	unsigned int GetTextureHandle(const WCHAR* textureFileName);
+
+	//Creates the resources for every load whose worker has finished, resource creation only ever happens here on the calling thread
+	//Returns true if any resource was filled in so anything holding placeholders can pick up the real ones
+	bool CompleteLoads(ID3D11Device* device, const bool waitForAll);
+	bool HasPendingLoads() const;
+	unsigned int GetFailedLoadCount() const;
+
+	void GetModel(const unsigned int modelHandle, ID3D11Buffer* &vertexBuffer, ID3D11Buffer* &indexBuffer) const;
+	ID3D11ShaderResourceView* GetTexture(const unsigned int textureHandle) const;
+
+	//Every loaded texture is also copied into a texture array shared with the other textures of the same size and format
+	//Until the arrays are built this is a one layer placeholder array
+	ID3D11ShaderResourceView* GetTextureArray(const unsigned int textureHandle) const;
+	unsigned int GetTextureLayer(const unsigned int textureHandle) const;
+	unsigned int GetTextureArrayCount() const;
+
+	const wstring& GetTexturePath(const unsigned int textureHandle) const;
 
 	int GetSizeOfVertexType() const;
-	int GetIndexCount(const char* modelFileName) const;
+	int GetIndexCount(const unsigned int modelHandle) const;
+	DXGI_FORMAT GetIndexFormat(const unsigned int modelHandle) const;
 
-	void ReturnRandomTexture(ID3D11ShaderResourceView* &texture);
+	unsigned int GetModelCount() const;
+	const ModelLoadInformation& GetModelLoadInformation(const unsigned int modelHandle) const;
 
-private:
-	bool LoadModel(ID3D11Device* device, const char* modelFileName);
-	bool LoadTexture(ID3D11Device* device, const WCHAR* textureFileName);
+	unsigned int ReturnRandomTexture(const unsigned int textureHandle) const;
 
+private:
 	struct VertexType {
 		XMFLOAT3 position;
 		XMFLOAT2 texture;
 		XMFLOAT3 normal;
 	};
 
-	map<const char*, int> m_indexCount;
+	struct ModelResource {
+		ID3D11Buffer* vertexBuffer;
+		ID3D11Buffer* indexBuffer;
+		int indexCount;
+		DXGI_FORMAT indexFormat;
+		ModelLoadInformation loadInformation;
+	};
 
-	map<const char*, ID3D11Buffer*> m_vertexBuffers;
-	map<const char*, ID3D11Buffer*> m_indexBuffers;
+	//What a worker hands back, either the mapped cache or the parsed and optimized model
+	struct ModelData {
+		bool succeeded;
+		bool loadedFromCache;
+		float loadTime;
+		unsigned int vertexCount;
+		unsigned int indexCount;
+		unsigned int indexStride;
+		unique_ptr<MeshCache> meshCache;
+		vector<VertexType> vertices;
+		vector<unsigned int> indices;
+		vector<unsigned short> shortIndices;
+	};
 
-	map<const WCHAR*, ID3D11ShaderResourceView*> m_textures;
-};
+	//The DDS file stays mapped until its texture is created, the subresources point straight into the mapping
+	struct TextureData {
+		bool succeeded;
+		unique_ptr<MappedFile> mappedFile;
+	};
+
+	struct PendingModel {
+		unsigned int handle;
+		future<ModelData> data;
+	};
 
+	struct PendingTexture {
+		unsigned int handle;
+		future<TextureData> data;
+	};
+
+	//Worker side, these only read files and do CPU work
+	static ModelData LoadModelData(const string& modelFileName);
+	static bool ParseModel(const char* modelFileName, vector<VertexType>& vertices, vector<unsigned int>& indices);
+	static void OptimizeModel(vector<VertexType>& vertices, vector<unsigned int>& indices);
+	static TextureData LoadTextureData(const wstring& textureFileName);
+
+	static const void* GetVertexData(const ModelData& modelData);
+	static const void* GetIndexData(const ModelData& modelData);
+
+	static unsigned int NextRandom();
+
+	//Main thread side
+	bool CreateModel(ID3D11Device* device, const unsigned int modelHandle, const ModelData& modelData);
+	bool CreateTexture(ID3D11Device* device, const unsigned int textureHandle, const TextureData& textureData);
+
+	//Rebuilt from scratch whenever a texture finishes loading and nothing else is still loading
+	bool BuildTextureArrays(ID3D11Device* device);
+	void ReleaseTextureArrays();
+
+	//Handles index straight into these, the registries map file paths to handles
+	ResourceRegistry m_modelRegistry;
+	vector<ModelResource> m_models;
+
+	ResourceRegistry m_textureRegistry;
+	vector<ID3D11ShaderResourceView*> m_textures;
+
+	ID3D11ShaderResourceView* m_placeholderTexture;
+	ID3D11ShaderResourceView* m_placeholderTextureArray;
+
+	//Indexed by texture handle, textures that aren't in an array have INVALID_RESOURCE_HANDLE as their array
+	vector<TextureArrayPacker::Placement> m_texturePlacements;
+	vector<ID3D11ShaderResourceView*> m_textureArrays;
+
+	vector<PendingModel> m_pendingModels;
+	vector<PendingTexture> m_pendingTextures;
+
+	unsigned int m_failedLoadCount;
+};
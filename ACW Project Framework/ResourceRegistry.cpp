@@ -0,0 +1,132 @@
+#include "ResourceRegistry.h"
+
+auto const INITIAL_SLOT_COUNT = 32u;
+
+ResourceRegistry::ResourceRegistry()
+{
+	Slot emptySlot;
+	emptySlot.hash = 0;
+	emptySlot.handle = INVALID_RESOURCE_HANDLE;
+
+	m_slots.assign(INITIAL_SLOT_COUNT, emptySlot);
+}
+
+ResourceRegistry::ResourceRegistry(const ResourceRegistry& other) = default;
+
+ResourceRegistry::ResourceRegistry(ResourceRegistry&& other) noexcept = default;
+
+ResourceRegistry::~ResourceRegistry() = default;
+
+ResourceRegistry& ResourceRegistry::operator=(const ResourceRegistry& other) = default;
+
+ResourceRegistry& ResourceRegistry::operator=(ResourceRegistry&& other) noexcept = default;
+
+unsigned int ResourceRegistry::Find(const wstring& path) const
+{
+	const auto hash = Hash(path);
+	const auto mask = m_slots.size() - 1;
+
+	//Walk from the home slot until we hit the path or an empty slot, the table is never full so this always stops
+	for (auto slot = hash & mask; ; slot = (slot + 1) & mask)
+	{
+		const auto& current = m_slots[slot];
+
+		if (current.handle == INVALID_RESOURCE_HANDLE)
+		{
+			return INVALID_RESOURCE_HANDLE;
+		}
+
+		if (current.hash == hash && m_paths[current.handle] == path)
+		{
+			return current.handle;
+		}
+	}
+}
+
+unsigned int ResourceRegistry::Add(const wstring& path)
+{
+	const auto existingHandle = Find(path);
+
+	if (existingHandle != INVALID_RESOURCE_HANDLE)
+	{
+		return existingHandle;
+	}
+
+	if ((m_paths.size() + 1) * 2 > m_slots.size())
+	{
+		Grow();
+	}
+
+	const auto handle = static_cast<unsigned int>(m_paths.size());
+	const auto hash = Hash(path);
+	const auto mask = m_slots.size() - 1;
+
+	auto slot = hash & mask;
+
+	while (m_slots[slot].handle != INVALID_RESOURCE_HANDLE)
+	{
+		slot = (slot + 1) & mask;
+	}
+
+	m_slots[slot].hash = hash;
+	m_slots[slot].handle = handle;
+
+	m_paths.push_back(path);
+
+	return handle;
+}
+
+const wstring& ResourceRegistry::GetPath(const unsigned int handle) const
+{
+	return m_paths.at(handle);
+}
+
+unsigned int ResourceRegistry::GetCount() const
+{
+	return static_cast<unsigned int>(m_paths.size());
+}
+
+unsigned long long ResourceRegistry::Hash(const wstring& path)
+{
+	//64 bit FNV-1a over each character
+	auto hash = 14695981039346656037ull;
+
+	for (const auto character : path)
+	{
+		hash ^= static_cast<unsigned long long>(character);
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+void ResourceRegistry::Grow()
+{
+	Slot emptySlot;
+	emptySlot.hash = 0;
+	emptySlot.handle = INVALID_RESOURCE_HANDLE;
+
+	vector<Slot> slots(m_slots.size() * 2, emptySlot);
+
+	const auto mask = slots.size() - 1;
+
+	//Hashes are stored with the handle so nothing needs rehashing
+	for (const auto& current : m_slots)
+	{
+		if (current.handle == INVALID_RESOURCE_HANDLE)
+		{
+			continue;
+		}
+
+		auto slot = current.hash & mask;
+
+		while (slots[slot].handle != INVALID_RESOURCE_HANDLE)
+		{
+			slot = (slot + 1) & mask;
+		}
+
+		slots[slot] = current;
+	}
+
+	m_slots.swap(slots);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+using namespace std;
+
+auto const INVALID_RESOURCE_HANDLE = ~0u;
+
+//Interns resource file paths and hands out a small integer handle per unique path. Lookups compare the path contents so the same file
+//asked for through different string pointers always gets the same handle. Paths are found with an open addressing hash table using linear probing
+class ResourceRegistry
+{
+public:
+	ResourceRegistry(); // Default Constructor
+	ResourceRegistry(const ResourceRegistry& other); // Copy Constructor
+	ResourceRegistry(ResourceRegistry&& other) noexcept; // Move Constructor
+	~ResourceRegistry(); // Destructor
+
+	ResourceRegistry& operator = (const ResourceRegistry& other); // Copy Assignment Operator
+	ResourceRegistry& operator = (ResourceRegistry&& other) noexcept; // Move Assignment Operator
+
+	//Returns INVALID_RESOURCE_HANDLE if the path hasn't been added
+	unsigned int Find(const wstring& path) const;
+
+	//Handles are given out in order starting at zero so they can index straight into arrays of resources
+	unsigned int Add(const wstring& path);
+
+	const wstring& GetPath(const unsigned int handle) const;
+	unsigned int GetCount() const;
+
+private:
+	struct Slot {
+		unsigned long long hash;
+		unsigned int handle;
+	};
+
+	static unsigned long long Hash(const wstring& path);
+
+	void Grow();
+
+	//Always a power of two in size and kept at most half full so probe runs stay short
+	vector<Slot> m_slots;
+
+	vector<wstring> m_paths;
+};
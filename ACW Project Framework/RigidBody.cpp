@@ -1,25 +1,33 @@
 #include "RigidBody.h"
 #include <complex>
 
-RigidBody::RigidBody(const bool useGravity, const float mass, const float drag, const float angularDrag, const XMFLOAT3 position, const XMFLOAT4 rotation, const XMFLOAT3 velocity, const XMFLOAT3 angularVelocity, const XMFLOAT3X3 inertiaTensor) 
-	: m_isAwake(true), m_useGravity(useGravity), m_motion(0.0f), m_inverseMass(1.0f / mass), m_drag(drag), m_angularDrag(angularDrag), m_lastFrameAcceleration(XMVECTOR()), m_position(XMLoadFloat3(&position)), m_newPosition(XMVECTOR()), m_rotation(XMLoadFloat4(&rotation)), m_velocity(XMLoadFloat3(&velocity)), m_newVelocity(XMVECTOR()), m_angularVelocity(XMLoadFloat3(&angularVelocity)), m_accumulatedForce(XMVECTOR()), m_accumulatedTorque(XMVECTOR()) {
+//Diagonal with all three entries the same, a zero tensor doesn't count as planes have one
+static bool IsIsotropic(const XMFLOAT3X3 &tensor)
+{
+	return tensor._12 == 0.0f && tensor._13 == 0.0f && tensor._21 == 0.0f && tensor._23 == 0.0f && tensor._31 == 0.0f && tensor._32 == 0.0f &&
+		tensor._11 > 0.0f && tensor._11 == tensor._22 && tensor._11 == tensor._33;
+}
+
+RigidBody::RigidBody(BodyStateStore* bodyStateStore, const bool useGravity, const float mass, const float drag, const float angularDrag, const XMFLOAT3 position, const XMFLOAT4 rotation, const XMFLOAT3 velocity, const XMFLOAT3 angularVelocity, const XMFLOAT3X3 inertiaTensor) 
+	: m_isAwake(true), m_useGravity(useGravity), m_motion(0.0f), m_inverseMass(1.0f / mass), m_drag(drag), m_angularDrag(angularDrag), m_lastFrameAcceleration(XMVECTOR()), m_bodyStateStore(bodyStateStore), m_bodyStateSlot(bodyStateStore->Allocate(this, XMLoadFloat3(&position), XMLoadFloat3(&velocity))), m_rotation(XMLoadFloat4(&rotation)), m_angularVelocity(XMLoadFloat3(&angularVelocity)), m_accumulatedForce(XMVECTOR()), m_accumulatedTorque(XMVECTOR()), m_inverseInertiaTensorInWorld(XMMatrixIdentity()), m_derivedDataDirty(true), m_isotropicInertia(false), m_inverseInertia(0.0f) {
 
 	m_rotation = XMQuaternionNormalize(m_rotation);
 
 	SetInertiaTensor(inertiaTensor);
+	UpdateDerivedData();
 
 	//m_accumulatedTorque = angularVelocity / 2;
 }
 
-RigidBody::RigidBody(const RigidBody& other) = default;
-
-RigidBody::RigidBody(RigidBody&& other) noexcept = default;
-
-RigidBody::~RigidBody() = default;
-
-RigidBody& RigidBody::operator=(const RigidBody& other) = default;
+RigidBody::~RigidBody()
+{
+	m_bodyStateStore->Release(m_bodyStateSlot);
+}
 
-//RigidBody& RigidBody::operator=(RigidBody&& other) noexcept = default;
+void RigidBody::SetBodyStateSlot(const unsigned int bodyStateSlot)
+{
+	m_bodyStateSlot = bodyStateSlot;
+}
 
 bool RigidBody::GetIsAwake() const
 {
@@ -71,12 +79,12 @@ void RigidBody::GetLastFrameAcceleration(XMVECTOR &getLastFrameAcceleration) con
 
 void RigidBody::GetPosition(XMVECTOR &position) const
 {
-	position = m_position;
+	position = m_bodyStateStore->GetCurrent().positions[m_bodyStateSlot];
 }
 
 void RigidBody::GetNewPosition(XMVECTOR &position) const
 {
-	position = m_newPosition;
+	position = m_bodyStateStore->GetNext().positions[m_bodyStateSlot];
 }
 
 void RigidBody::GetRotation(XMVECTOR &rotation) const
@@ -86,12 +94,12 @@ void RigidBody::GetRotation(XMVECTOR &rotation) const
 
 void RigidBody::GetVelocity(XMVECTOR &velocity) const
 {
-	velocity = m_velocity;
+	velocity = m_bodyStateStore->GetCurrent().velocities[m_bodyStateSlot];
 }
 
 void RigidBody::GetNewVelocity(XMVECTOR &velocity) const
 {
-	velocity = m_newVelocity;
+	velocity = m_bodyStateStore->GetNext().velocities[m_bodyStateSlot];
 }
 
 
@@ -126,6 +134,21 @@ void RigidBody::GetInverseInertiaTensorWorld(XMMATRIX &inverseInertiaTensorInWor
 	inverseInertiaTensorInWorld = m_inverseInertiaTensorInWorld;
 }
 
+XMVECTOR RigidBody::TransformByInverseInertiaTensorWorld(const XMVECTOR &vector) const
+{
+	if (m_isotropicInertia)
+	{
+		return XMVectorScale(vector, m_inverseInertia);
+	}
+
+	return XMVector3Transform(vector, m_inverseInertiaTensorInWorld);
+}
+
+bool RigidBody::HasIsotropicInertia() const
+{
+	return m_isotropicInertia;
+}
+
 void RigidBody::SetIsAwake(const bool isAwake)
 {
 	if (isAwake)
@@ -138,8 +161,8 @@ void RigidBody::SetIsAwake(const bool isAwake)
 	else
 	{
 		m_isAwake = isAwake;
-		m_velocity = XMVECTOR();
-		m_newVelocity = XMVECTOR();
+		m_bodyStateStore->GetCurrent().velocities[m_bodyStateSlot] = XMVECTOR();
+		m_bodyStateStore->GetNext().velocities[m_bodyStateSlot] = XMVECTOR();
 		m_angularVelocity = XMVECTOR();
 	}
 }
@@ -177,7 +200,13 @@ void RigidBody::SetLastFrameAcceleration(const XMVECTOR &newLastFrameAcceleratio
 
 void RigidBody::SetNewPosition(const XMVECTOR &newPosition)
 {
-	m_newPosition = newPosition;
+	//Static bodies have to keep the same state in both buffers, a write here would make them flicker between two positions
+	if (!m_useGravity)
+	{
+		return;
+	}
+
+	m_bodyStateStore->GetNext().positions[m_bodyStateSlot] = newPosition;
 }
 
 //void RigidBody::SetNewPosition(const float x, const float y, const float z)
@@ -188,6 +217,7 @@ void RigidBody::SetNewPosition(const XMVECTOR &newPosition)
 void RigidBody::SetRotation(const XMVECTOR &newRotation)
 {
 	m_rotation = XMQuaternionNormalize(newRotation);
+	m_derivedDataDirty = true;
 }
 
 //void RigidBody::SetRotation(const float x, const float y, const float z, const float w)
@@ -197,7 +227,12 @@ void RigidBody::SetRotation(const XMVECTOR &newRotation)
 
 void RigidBody::SetNewVelocity(const XMVECTOR &newVelocity)
 {
-	m_newVelocity = newVelocity;
+	if (!m_useGravity)
+	{
+		return;
+	}
+
+	m_bodyStateStore->GetNext().velocities[m_bodyStateSlot] = newVelocity;
 }
 
 //void RigidBody::SetNewVelocity(const float x, const float y, const float z)
@@ -212,19 +247,87 @@ void RigidBody::SetAngularVelocity(const XMVECTOR &angularVelocity)
 
 void RigidBody::SetInertiaTensor(const XMFLOAT3X3 &inertiaTensor)
 {
-	auto determinant = XMMatrixDeterminant(XMLoadFloat3x3(&inertiaTensor));
+	//The inverse is written out exactly for isotropic tensors so all three entries stay equal
+	if (IsIsotropic(inertiaTensor))
+	{
+		const auto inverseInertia = 1.0f / inertiaTensor._11;
+
+		m_inverseInertiaTensor = XMFLOAT3X3(inverseInertia, 0.0f, 0.0f,
+			0.0f, inverseInertia, 0.0f,
+			0.0f, 0.0f, inverseInertia);
+	}
+	else
+	{
+		auto determinant = XMMatrixDeterminant(XMLoadFloat3x3(&inertiaTensor));
+
+		XMStoreFloat3x3(&m_inverseInertiaTensor, XMMatrixInverse(&determinant, XMLoadFloat3x3(&inertiaTensor)));
+	}
+
+	ClassifyInertia();
 
-	XMStoreFloat3x3(&m_inverseInertiaTensor, XMMatrixInverse(&determinant, XMLoadFloat3x3(&inertiaTensor)));
+	m_derivedDataDirty = true;
 }
 
-void RigidBody::UpdatePosition()
+void RigidBody::GetState(State &state) const
 {
-	m_position = m_newPosition;
+	state.isAwake = m_isAwake ? 1 : 0;
+	state.useGravity = m_useGravity ? 1 : 0;
+	state.motion = m_motion;
+	state.inverseMass = m_inverseMass;
+	state.drag = m_drag;
+	state.angularDrag = m_angularDrag;
+
+	//Full four component stores so the w lanes come back exactly as they were too
+	XMStoreFloat4(&state.lastFrameAcceleration, m_lastFrameAcceleration);
+
+	const auto& current = m_bodyStateStore->GetCurrent();
+	const auto& next = m_bodyStateStore->GetNext();
+
+	XMStoreFloat4(&state.position, current.positions[m_bodyStateSlot]);
+	XMStoreFloat4(&state.newPosition, next.positions[m_bodyStateSlot]);
+	XMStoreFloat4(&state.rotation, m_rotation);
+	XMStoreFloat4(&state.velocity, current.velocities[m_bodyStateSlot]);
+	XMStoreFloat4(&state.newVelocity, next.velocities[m_bodyStateSlot]);
+	XMStoreFloat4(&state.angularVelocity, m_angularVelocity);
+	XMStoreFloat4(&state.accumulatedForce, m_accumulatedForce);
+	XMStoreFloat4(&state.accumulatedTorque, m_accumulatedTorque);
+
+	state.inverseInertiaTensor = m_inverseInertiaTensor;
+	XMStoreFloat4x4(&state.inverseInertiaTensorInWorld, m_inverseInertiaTensorInWorld);
+	XMStoreFloat4x4(&state.transformMatrix, XMMatrixMultiply(XMMatrixRotationQuaternion(m_rotation), XMMatrixTranslationFromVector(current.positions[m_bodyStateSlot])));
 }
 
-void RigidBody::UpdateVelocity()
+void RigidBody::SetState(const State &state)
 {
-	m_velocity = m_newVelocity;
+	m_isAwake = state.isAwake != 0;
+	m_useGravity = state.useGravity != 0;
+	m_motion = state.motion;
+	m_inverseMass = state.inverseMass;
+	m_drag = state.drag;
+	m_angularDrag = state.angularDrag;
+
+	m_lastFrameAcceleration = XMLoadFloat4(&state.lastFrameAcceleration);
+
+	auto& current = m_bodyStateStore->GetCurrent();
+	auto& next = m_bodyStateStore->GetNext();
+
+	//Bodies that aren't integrated never write their next state, so it has to match the current one
+	current.positions[m_bodyStateSlot] = XMLoadFloat4(&state.position);
+	next.positions[m_bodyStateSlot] = m_useGravity ? XMLoadFloat4(&state.newPosition) : current.positions[m_bodyStateSlot];
+	m_rotation = XMLoadFloat4(&state.rotation);
+	current.velocities[m_bodyStateSlot] = XMLoadFloat4(&state.velocity);
+	next.velocities[m_bodyStateSlot] = m_useGravity ? XMLoadFloat4(&state.newVelocity) : current.velocities[m_bodyStateSlot];
+	m_angularVelocity = XMLoadFloat4(&state.angularVelocity);
+	m_accumulatedForce = XMLoadFloat4(&state.accumulatedForce);
+	m_accumulatedTorque = XMLoadFloat4(&state.accumulatedTorque);
+
+	m_inverseInertiaTensor = state.inverseInertiaTensor;
+
+	ClassifyInertia();
+
+	//The saved world tensor is the one the body was using, the transform matrix is rebuilt from the position and rotation when needed
+	m_inverseInertiaTensorInWorld = XMLoadFloat4x4(&state.inverseInertiaTensorInWorld);
+	m_derivedDataDirty = false;
 }
 
 bool RigidBody::HasFiniteMass() const
@@ -256,26 +359,6 @@ void RigidBody::AddForceAtLocalPoint(const XMFLOAT3& force, const XMFLOAT3& poin
 	//AddForceAtPoint(force, worldPoint);
 }
 
-void RigidBody::CalculateDerivedData()
-{
-	m_rotation = XMQuaternionNormalize(m_rotation);
-
-	m_transformMatrix = XMMatrixRotationQuaternion(m_rotation);
-	m_transformMatrix = XMMatrixMultiply(m_transformMatrix, XMMatrixTranslationFromVector(m_newPosition));
-
-	//CalculateTransformMatrix(m_transformMatrix, m_newPosition, m_rotation);
-	//Calculate the transform matrix for the rigidbody
-
-	auto tempTransformMatrix = XMFLOAT4X4();
-	XMStoreFloat4x4(&tempTransformMatrix, m_transformMatrix);
-
-	auto inverseInertiaTensorInWorld = XMFLOAT3X3();
-
-	InertiaTensorTransformLocalToWorld(inverseInertiaTensorInWorld, m_inverseInertiaTensor, tempTransformMatrix);
-
-	m_inverseInertiaTensorInWorld = XMLoadFloat3x3(&inverseInertiaTensorInWorld);
-}
-
 //XMFLOAT3 RigidBody::GetPointInWorldSpace(const XMFLOAT3& point) const
 //{
 //	return { point.x * m_transformMatrix._11 +
@@ -307,32 +390,7 @@ void RigidBody::CalculateDerivedData()
 //}
 
 //Automated optimised code used from Ian Millingtons book on Game Physics Engine Development: Edition 1
-void RigidBody::CalculateTransformMatrix(XMFLOAT4X4 &transformMatrix, const XMFLOAT3 &position, const XMFLOAT4 &rotation)
-{
-
-	transformMatrix._11 = 1 - 2 * rotation.y * rotation.y - 2 * rotation.z * rotation.z;
-	transformMatrix._12 = 2 * rotation.x * rotation.y - 2 * rotation.w  *rotation.z;
-	transformMatrix._13 = 2 * rotation.x * rotation.z + 2 * rotation.w * rotation.y;
-	transformMatrix._14 = position.x;
-
-	transformMatrix._21 = 2 * rotation.x * rotation.y + 2 * rotation.w * rotation.z;
-	transformMatrix._22 = 1 - 2 * rotation.x * rotation.x - 2 * rotation.z * rotation.z;
-	transformMatrix._23 = 2 * rotation.y * rotation.z - 2 * rotation.w * rotation.x;
-	transformMatrix._24 = position.y;
-
-	transformMatrix._31 = 2 * rotation.x * rotation.z - 2 * rotation.w * rotation.y;
-	transformMatrix._32 = 2 * rotation.y * rotation.z + 2 * rotation.w * rotation.x;
-	transformMatrix._33 = 1 - 2 * rotation.x * rotation.x - 2 * rotation.y * rotation.y;
-	transformMatrix._34 = position.z;
-
-	transformMatrix._41 = 0;
-	transformMatrix._42 = 0;
-	transformMatrix._43 = 0;
-	transformMatrix._44 = 1;
-}
-
-//Automated optimised code used from Ian Millingtons book on Game Physics Engine Development: Edition 1
-void RigidBody::InertiaTensorTransformLocalToWorld(XMFLOAT3X3& inverseInertiaTensorInWorld, const XMFLOAT3X3& inertiaTensorInLocal, const XMFLOAT4X4& transformMatrix)
+void RigidBody::InertiaTensorTransformLocalToWorld(XMFLOAT3X3& inverseInertiaTensorInWorld, const XMFLOAT3X3& inertiaTensorInLocal, const XMFLOAT4X4& transformMatrix) const
 {
 	//Only using the rotation data from our transform matrix
 	auto t4 = transformMatrix._11 * inertiaTensorInLocal._11 +
@@ -395,3 +453,36 @@ void RigidBody::InertiaTensorTransformLocalToWorld(XMFLOAT3X3& inverseInertiaTen
 		t57 * transformMatrix._32 +
 		t62 * transformMatrix._33;
 }
+
+void RigidBody::ClassifyInertia()
+{
+	m_isotropicInertia = IsIsotropic(m_inverseInertiaTensor);
+	m_inverseInertia = m_isotropicInertia ? m_inverseInertiaTensor._11 : 0.0f;
+
+	if (m_isotropicInertia)
+	{
+		m_inverseInertiaTensorInWorld = XMLoadFloat3x3(&m_inverseInertiaTensor);
+	}
+}
+
+bool RigidBody::UpdateDerivedData()
+{
+	//Rotating an isotropic tensor gives the same tensor back, so there's nothing to derive
+	if (!m_derivedDataDirty || m_isotropicInertia)
+	{
+		return false;
+	}
+
+	//The rotation is normalised whenever it's set and only the rotation part of the transform is used
+	auto rotationMatrix = XMFLOAT4X4();
+	XMStoreFloat4x4(&rotationMatrix, XMMatrixRotationQuaternion(m_rotation));
+
+	auto inverseInertiaTensorInWorld = XMFLOAT3X3();
+
+	InertiaTensorTransformLocalToWorld(inverseInertiaTensorInWorld, m_inverseInertiaTensor, rotationMatrix);
+
+	m_inverseInertiaTensorInWorld = XMLoadFloat3x3(&inverseInertiaTensorInWorld);
+	m_derivedDataDirty = false;
+
+	return true;
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <limits>
 #include "XMFLOAT3Maths.h"
+#include "BodyStateStore.h"
 
 using namespace std;
 using namespace DirectX;
@@ -8,13 +9,38 @@ using namespace DirectX;
 class RigidBody
 {
 public:
-	RigidBody(const bool useGravity, const float mass, const float drag, const float angularDrag, const XMFLOAT3 position, const XMFLOAT4 rotation, const XMFLOAT3 velocity, const XMFLOAT3 angularVelocity, const XMFLOAT3X3 inertiaTensor);
-	RigidBody(const RigidBody& other); // Copy Constructor
-	RigidBody(RigidBody&& other) noexcept; // Move Constructor
+	//Every member as plain data so a body can be saved and restored bit for bit, derived data included
+	struct State {
+		unsigned int isAwake;
+		unsigned int useGravity;
+		float motion;
+		float inverseMass;
+		float drag;
+		float angularDrag;
+
+		XMFLOAT4 lastFrameAcceleration;
+		XMFLOAT4 position;
+		XMFLOAT4 newPosition;
+		XMFLOAT4 rotation;
+		XMFLOAT4 velocity;
+		XMFLOAT4 newVelocity;
+		XMFLOAT4 angularVelocity;
+		XMFLOAT4 accumulatedForce;
+		XMFLOAT4 accumulatedTorque;
+
+		XMFLOAT3X3 inverseInertiaTensor;
+		XMFLOAT4X4 inverseInertiaTensorInWorld;
+		XMFLOAT4X4 transformMatrix;
+	};
+
+	//Position and velocity live in the state store's buffers, the body holds its slot until it's destroyed
+	RigidBody(BodyStateStore* bodyStateStore, const bool useGravity, const float mass, const float drag, const float angularDrag, const XMFLOAT3 position, const XMFLOAT4 rotation, const XMFLOAT3 velocity, const XMFLOAT3 angularVelocity, const XMFLOAT3X3 inertiaTensor);
+	RigidBody(const RigidBody& other) = delete; // Copy Constructor
+	RigidBody(RigidBody&& other) noexcept = delete; // Move Constructor
 	~RigidBody(); // Destructor
 
-	RigidBody& operator = (const RigidBody& other); // Copy Assignment Operator
-	RigidBody& operator = (RigidBody&& other) noexcept; // Move Assignment Operator
+	RigidBody& operator = (const RigidBody& other) = delete; // Copy Assignment Operator
+	RigidBody& operator = (RigidBody&& other) noexcept = delete; // Move Assignment Operator
 
 	//Gets
 	bool GetIsAwake() const;
@@ -41,6 +67,12 @@ public:
 	XMFLOAT3X3 GetInertiaTensor() const;
 	void GetInverseInertiaTensorWorld(XMMATRIX &inverseInertiaTensorInWorld) const;
 
+	//The vector times the inverse inertia tensor in world space, a single scale for isotropic bodies
+	XMVECTOR TransformByInverseInertiaTensorWorld(const XMVECTOR &vector) const;
+
+	//Spheres and cubes with equal sides turn the same way about every axis, their tensor is the same whichever way they face
+	bool HasIsotropicInertia() const;
+
 	//Sets
 	void SetIsAwake(const bool isAwake);
 	void SetUseGravity(const bool useGravity);
@@ -62,9 +94,9 @@ public:
 	void SetAngularVelocity(const XMVECTOR &angularVelocity);
 	void SetInertiaTensor(const XMFLOAT3X3 &inertiaTensor);
 
-	//Updates
-	void UpdatePosition();
-	void UpdateVelocity();
+	//Whole body state for snapshots, SetState copies the values as they are without normalizing or recalculating anything
+	void GetState(State &state) const;
+	void SetState(const State &state);
 
 	bool HasFiniteMass() const;
 
@@ -76,19 +108,22 @@ public:
 	//We don't use this unless we're using springs
 	void AddForceAtLocalPoint(const XMFLOAT3 &force, const XMFLOAT3 &point);
 
-	//Updates our derived data (transform matrix) whenever a change is made to the transform or orientation
-	//Might cut this out as it's pointless, just a checking mechanism.
-	void CalculateDerivedData();
+	//Rebuilds the world space inverse inertia tensor if the rotation or tensor has changed since it was last built, returns true if it did
+	//PhysicsManager calls this once per integration, everything else reads the tensor as it was left then
+	bool UpdateDerivedData();
+
+	//Only BodyStateStore calls this, when compacting moves the body's state down to fill a released slot
+	void SetBodyStateSlot(const unsigned int bodyStateSlot);
 
 private:
 	//XMFLOAT3 GetPointInWorldSpace(const XMFLOAT3 &point) const;
 	//void AddForceAtPoint(const XMFLOAT3 &force, const XMFLOAT3 &point);
 
-	//Calculate the transform matrix from the position and rotation
-	void CalculateTransformMatrix(XMFLOAT4X4 &transformMatrix, const XMFLOAT3 &position, const XMFLOAT4 &rotation);
-	
 	//Convert the inverseInertiaTensor to world space
-	void InertiaTensorTransformLocalToWorld(XMFLOAT3X3 &inverseInertiaTensorInWorld, const XMFLOAT3X3 &inertiaTensorInLocal, const XMFLOAT4X4 &transformMatrix);
+	void InertiaTensorTransformLocalToWorld(XMFLOAT3X3 &inverseInertiaTensorInWorld, const XMFLOAT3X3 &inertiaTensorInLocal, const XMFLOAT4X4 &transformMatrix) const;
+
+	//Sets the isotropic flag and scalar from the local inverse tensor, isotropic bodies get their fixed world tensor here too
+	void ClassifyInertia();
 
 	bool m_isAwake;
 	bool m_useGravity;
@@ -99,15 +134,13 @@ private:
 
 	XMVECTOR m_lastFrameAcceleration;
 
-	XMVECTOR m_position;
-	XMVECTOR m_newPosition;
+	//Current and new position and velocity are in here
+	BodyStateStore* m_bodyStateStore;
+	unsigned int m_bodyStateSlot;
 
 	//"Orientation"
 	XMVECTOR m_rotation;
 
-	XMVECTOR m_velocity;
-	XMVECTOR m_newVelocity;
-
 	//"Rotation"
 	XMVECTOR m_angularVelocity;
 
@@ -117,12 +150,12 @@ private:
 	//In local space
 	XMFLOAT3X3 m_inverseInertiaTensor;
 
-	//In world space
+	//In world space, rebuilt by UpdateDerivedData only when the rotation or tensor has changed so static bodies only build it once
 	XMMATRIX m_inverseInertiaTensorInWorld;
+	bool m_derivedDataDirty;
 
-	//Holds transform matrix for converting body space into world space and vice versa
-	//Note: Just derived data that already exists and can be calculated and used as is with our transform position and orientation
-	//Last row is just 0,0,0,1
-	XMMATRIX m_transformMatrix;
+	//The diagonal of the inverse inertia tensor when every entry is the same and the rest are zero, with the flag set
+	bool m_isotropicInertia;
+	float m_inverseInertia;
 };
 
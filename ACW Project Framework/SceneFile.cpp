@@ -0,0 +1,414 @@
+#include "SceneFile.h"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+//"SCNE" in little endian, bump the version whenever SceneBody or the header changes
+auto const SCENE_FILE_MAGIC = 0x454E4353u;
+auto const SCENE_FILE_VERSION = 1u;
+
+//Same order as Collider::ColliderType and Model::ModelType, the text form uses the names and the binary form uses the values
+const char* const COLLIDER_TYPE_NAMES[] = { "Sphere", "AABBCube", "OBBCube", "Plane", "Cylinder" };
+const char* const MODEL_TYPE_NAMES[] = { "Sphere", "Cube", "Plane", "Cylinder" };
+
+auto const COLLIDER_TYPE_COUNT = static_cast<unsigned int>(sizeof(COLLIDER_TYPE_NAMES) / sizeof(COLLIDER_TYPE_NAMES[0]));
+auto const MODEL_TYPE_COUNT = static_cast<unsigned int>(sizeof(MODEL_TYPE_NAMES) / sizeof(MODEL_TYPE_NAMES[0]));
+auto const PLANE_COLLIDER_TYPE = 3u;
+auto const PLANE_MODEL_TYPE = 2u;
+
+//Returns the count if the name isn't in the table
+static unsigned int FindTypeName(const char* const names[], const unsigned int count, const string& name)
+{
+	for (unsigned int i = 0; i < count; i++)
+	{
+		if (name == names[i])
+		{
+			return i;
+		}
+	}
+
+	return count;
+}
+
+static istream& ReadFloat3(istream& stream, XMFLOAT3& value)
+{
+	return stream >> value.x >> value.y >> value.z;
+}
+
+static ostream& WriteFloat3(ostream& stream, const XMFLOAT3& value)
+{
+	return stream << ' ' << value.x << ' ' << value.y << ' ' << value.z;
+}
+
+SceneFile::SceneFile() : m_errorLine(0)
+{
+}
+
+SceneFile::SceneFile(const SceneFile& other) = default;
+
+SceneFile::SceneFile(SceneFile&& other) noexcept = default;
+
+SceneFile::~SceneFile() = default;
+
+SceneFile& SceneFile::operator=(const SceneFile& other) = default;
+
+SceneFile& SceneFile::operator=(SceneFile&& other) noexcept = default;
+
+bool SceneFile::Load(const char* fileName)
+{
+	ifstream fin;
+
+	fin.open(fileName, ios::in | ios::binary);
+
+	if (fin.fail())
+	{
+		Clear();
+		return false;
+	}
+
+	auto magic = 0u;
+	fin.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+	fin.close();
+
+	if (magic == SCENE_FILE_MAGIC)
+	{
+		return LoadBinary(fileName);
+	}
+
+	return LoadText(fileName);
+}
+
+bool SceneFile::LoadText(const char* fileName)
+{
+	Clear();
+
+	ifstream fin;
+
+	fin.open(fileName);
+
+	if (fin.fail())
+	{
+		return false;
+	}
+
+	string line;
+	auto lineNumber = 0u;
+
+	while (getline(fin, line))
+	{
+		lineNumber++;
+
+		if (!ParseLine(line))
+		{
+			Clear();
+			m_errorLine = lineNumber;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool SceneFile::LoadBinary(const char* fileName)
+{
+	Clear();
+
+	MappedFile mappedFile;
+
+	if (!mappedFile.Open(fileName) || mappedFile.GetSize() < sizeof(BinaryHeader))
+	{
+		return false;
+	}
+
+	BinaryHeader header;
+	memcpy(&header, mappedFile.GetData(), sizeof(BinaryHeader));
+
+	const auto expectedFileSize = sizeof(BinaryHeader) + static_cast<unsigned long long>(header.textureNameBytes) + static_cast<unsigned long long>(header.bodyCount) * sizeof(SceneBody);
+
+	if (header.magic != SCENE_FILE_MAGIC || header.version != SCENE_FILE_VERSION || header.textureNameBytes % 4 != 0 || mappedFile.GetSize() != expectedFileSize)
+	{
+		return false;
+	}
+
+	//Names are plain ASCII file names so they are widened a character at a time
+	const auto* names = reinterpret_cast<const char*>(mappedFile.GetData() + sizeof(BinaryHeader));
+	const auto* namesEnd = names + header.textureNameBytes;
+
+	m_textureNames.reserve(header.textureCount);
+
+	for (unsigned int i = 0; i < header.textureCount; i++)
+	{
+		const auto* nameEnd = static_cast<const char*>(memchr(names, '\0', namesEnd - names));
+
+		if (!nameEnd)
+		{
+			Clear();
+			return false;
+		}
+
+		m_textureNames.emplace_back(names, nameEnd);
+		names = nameEnd + 1;
+	}
+
+	//The body array is stored exactly as it is in memory, one copy and it's loaded
+	m_bodies.resize(header.bodyCount);
+
+	if (header.bodyCount > 0)
+	{
+		memcpy(m_bodies.data(), mappedFile.GetData() + sizeof(BinaryHeader) + header.textureNameBytes, sizeof(SceneBody) * header.bodyCount);
+	}
+
+	for (const auto& body : m_bodies)
+	{
+		if (!IsValid(body))
+		{
+			Clear();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool SceneFile::SaveText(const char* fileName) const
+{
+	ofstream fout;
+
+	fout.open(fileName, ios::out | ios::trunc);
+
+	if (fout.fail())
+	{
+		return false;
+	}
+
+	//Enough digits that every float reads back as the same value
+	fout.precision(9);
+
+	for (const auto& body : m_bodies)
+	{
+		const auto isPlane = body.colliderType == PLANE_COLLIDER_TYPE;
+
+		if (isPlane)
+		{
+			fout << "plane";
+		}
+		else
+		{
+			fout << "body " << COLLIDER_TYPE_NAMES[body.colliderType] << ' ' << MODEL_TYPE_NAMES[body.modelType];
+		}
+
+		fout << (body.useGravity ? " dynamic" : " static");
+
+		WriteFloat3(fout, body.position);
+		WriteFloat3(fout, body.rotation);
+		WriteFloat3(fout, body.scale);
+
+		fout << ' ' << body.mass << ' ' << body.drag << ' ' << body.angularDrag << ' ';
+
+		for (const auto character : m_textureNames[body.textureIndex])
+		{
+			fout << static_cast<char>(character);
+		}
+
+		if (isPlane)
+		{
+			WriteFloat3(fout, body.planeCentre);
+			WriteFloat3(fout, body.planePointOne);
+			WriteFloat3(fout, body.planePointTwo);
+
+			fout << ' ' << body.planeOffset;
+		}
+		else if (body.velocity.x != 0.0f || body.velocity.y != 0.0f || body.velocity.z != 0.0f ||
+			body.angularVelocity.x != 0.0f || body.angularVelocity.y != 0.0f || body.angularVelocity.z != 0.0f)
+		{
+			WriteFloat3(fout, body.velocity);
+			WriteFloat3(fout, body.angularVelocity);
+		}
+
+		fout << '\n';
+	}
+
+	return !fout.fail();
+}
+
+bool SceneFile::SaveBinary(const char* fileName) const
+{
+	string textureNames;
+
+	for (const auto& textureName : m_textureNames)
+	{
+		for (const auto character : textureName)
+		{
+			textureNames.push_back(static_cast<char>(character));
+		}
+
+		textureNames.push_back('\0');
+	}
+
+	textureNames.resize((textureNames.size() + 3) & ~static_cast<size_t>(3), '\0');
+
+	BinaryHeader header;
+	header.magic = SCENE_FILE_MAGIC;
+	header.version = SCENE_FILE_VERSION;
+	header.bodyCount = static_cast<unsigned int>(m_bodies.size());
+	header.textureCount = static_cast<unsigned int>(m_textureNames.size());
+	header.textureNameBytes = static_cast<unsigned int>(textureNames.size());
+
+	ofstream fout;
+
+	fout.open(fileName, ios::out | ios::binary | ios::trunc);
+
+	if (fout.fail())
+	{
+		return false;
+	}
+
+	fout.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeader));
+	fout.write(textureNames.data(), static_cast<streamsize>(textureNames.size()));
+	fout.write(reinterpret_cast<const char*>(m_bodies.data()), static_cast<streamsize>(sizeof(SceneBody) * m_bodies.size()));
+
+	return !fout.fail();
+}
+
+void SceneFile::Clear()
+{
+	m_bodies.clear();
+	m_textureNames.clear();
+
+	m_errorLine = 0;
+}
+
+unsigned int SceneFile::AddTexture(const wstring& textureFileName)
+{
+	//Scenes only use a handful of textures so a search is quicker than keeping a map
+	for (unsigned int i = 0; i < m_textureNames.size(); i++)
+	{
+		if (m_textureNames[i] == textureFileName)
+		{
+			return i;
+		}
+	}
+
+	m_textureNames.push_back(textureFileName);
+
+	return static_cast<unsigned int>(m_textureNames.size() - 1);
+}
+
+void SceneFile::AddBody(const SceneBody& body)
+{
+	m_bodies.push_back(body);
+}
+
+const vector<SceneFile::SceneBody>& SceneFile::GetBodies() const
+{
+	return m_bodies;
+}
+
+const vector<wstring>& SceneFile::GetTextureNames() const
+{
+	return m_textureNames;
+}
+
+unsigned int SceneFile::GetErrorLine() const
+{
+	return m_errorLine;
+}
+
+bool SceneFile::ParseLine(const string& line)
+{
+	istringstream stream(line.substr(0, line.find('#')));
+
+	string keyword;
+
+	//Blank and comment only lines
+	if (!(stream >> keyword))
+	{
+		return true;
+	}
+
+	auto body = SceneBody();
+
+	if (keyword == "body")
+	{
+		string colliderName;
+		string modelName;
+
+		stream >> colliderName >> modelName;
+
+		body.colliderType = FindTypeName(COLLIDER_TYPE_NAMES, COLLIDER_TYPE_COUNT, colliderName);
+		body.modelType = FindTypeName(MODEL_TYPE_NAMES, MODEL_TYPE_COUNT, modelName);
+	}
+	else if (keyword == "plane")
+	{
+		body.colliderType = PLANE_COLLIDER_TYPE;
+		body.modelType = PLANE_MODEL_TYPE;
+	}
+	else
+	{
+		return false;
+	}
+
+	string bodyKind;
+	stream >> bodyKind;
+
+	if (bodyKind != "static" && bodyKind != "dynamic")
+	{
+		return false;
+	}
+
+	body.useGravity = bodyKind == "dynamic" ? 1 : 0;
+
+	ReadFloat3(stream, body.position);
+	ReadFloat3(stream, body.rotation);
+	ReadFloat3(stream, body.scale);
+
+	stream >> body.mass >> body.drag >> body.angularDrag;
+
+	string textureName;
+	stream >> textureName;
+
+	if (stream.fail())
+	{
+		return false;
+	}
+
+	body.textureIndex = AddTexture(wstring(textureName.begin(), textureName.end()));
+
+	if (body.colliderType == PLANE_COLLIDER_TYPE)
+	{
+		ReadFloat3(stream, body.planeCentre);
+		ReadFloat3(stream, body.planePointOne);
+		ReadFloat3(stream, body.planePointTwo);
+
+		stream >> body.planeOffset;
+	}
+	else if (!stream.eof() && !(stream >> ws).eof())
+	{
+		//Velocities are optional, everything starts at rest unless they are given
+		ReadFloat3(stream, body.velocity);
+		ReadFloat3(stream, body.angularVelocity);
+	}
+
+	if (stream.fail() || !IsValid(body))
+	{
+		return false;
+	}
+
+	//Anything left over means the line has the wrong number of values
+	string leftOver;
+
+	if (stream >> leftOver)
+	{
+		return false;
+	}
+
+	m_bodies.push_back(body);
+
+	return true;
+}
+
+bool SceneFile::IsValid(const SceneBody& body) const
+{
+	//Static bodies still need a mass, the rigidbody stores its inverse
+	return body.colliderType < COLLIDER_TYPE_COUNT && body.modelType < MODEL_TYPE_COUNT && body.textureIndex < m_textureNames.size() && body.mass > 0.0f;
+}
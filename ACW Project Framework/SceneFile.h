@@ -0,0 +1,84 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+using namespace DirectX;
+using namespace std;
+
+//Description of every body in a scene, read from either a text file that's easy to edit by hand or a binary file that's the body array
+//as it sits in memory so large scenes can be loaded with one copy. Creating the game objects is left to the GameObjectFactory,
+//there's no Direct3D in here so the same files can be read and written without a window
+class SceneFile
+{
+public:
+	//Plain data so the binary form can be copied straight into the body array, bump the binary version if this changes
+	struct SceneBody {
+		XMFLOAT3 position;
+		XMFLOAT3 rotation; //Roll, pitch and yaw in radians
+		XMFLOAT3 scale;
+		XMFLOAT3 velocity;
+		XMFLOAT3 angularVelocity;
+		float mass;
+		float drag;
+		float angularDrag;
+		unsigned int colliderType; //Collider::ColliderType
+		unsigned int modelType; //Model::ModelType
+		unsigned int useGravity; //Static bodies don't use gravity
+		unsigned int textureIndex; //Index into the texture names
+
+		//Only used by plane colliders
+		XMFLOAT3 planeCentre;
+		XMFLOAT3 planePointOne;
+		XMFLOAT3 planePointTwo;
+		float planeOffset;
+	};
+
+	struct BinaryHeader {
+		unsigned int magic;
+		unsigned int version;
+		unsigned int bodyCount;
+		unsigned int textureCount;
+		unsigned int textureNameBytes; //Null terminated names, padded so the bodies that follow stay aligned
+	};
+
+	SceneFile(); // Default Constructor
+	SceneFile(const SceneFile& other); // Copy Constructor
+	SceneFile(SceneFile&& other) noexcept; // Move Constructor
+	~SceneFile(); // Destructor
+
+	SceneFile& operator = (const SceneFile& other); // Copy Assignment Operator
+	SceneFile& operator = (SceneFile&& other) noexcept; // Move Assignment Operator
+
+	//Reads the binary form if the file starts with the binary magic number, otherwise the text form
+	bool Load(const char* fileName);
+	bool LoadText(const char* fileName);
+	bool LoadBinary(const char* fileName);
+
+	bool SaveText(const char* fileName) const;
+	bool SaveBinary(const char* fileName) const;
+
+	void Clear();
+
+	//Texture names are shared between bodies, adding a name that's already in the scene returns its existing index
+	unsigned int AddTexture(const wstring& textureFileName);
+	void AddBody(const SceneBody& body);
+
+	const vector<SceneBody>& GetBodies() const;
+	const vector<wstring>& GetTextureNames() const;
+
+	//Line of the text file that failed to parse, zero if the error wasn't on a particular line
+	unsigned int GetErrorLine() const;
+
+private:
+	bool ParseLine(const string& line);
+	bool IsValid(const SceneBody& body) const;
+
+	vector<SceneBody> m_bodies;
+	vector<wstring> m_textureNames;
+
+	unsigned int m_errorLine;
+};
@@ -2,7 +2,7 @@
 
 //So we only need one instance of each shader and the gameobject just declares the shader choice
 
-ShaderManager::ShaderManager(ID3D11Device* device, HWND hwnd) : m_initializationFailed(false), m_colourShader(nullptr), m_lightShader(nullptr), m_textureShader(nullptr)
+ShaderManager::ShaderManager(ID3D11Device* device, HWND hwnd) : m_initializationFailed(false), m_colourShader(nullptr), m_lightShader(nullptr), m_textureShader(nullptr), m_instancedTextureShader(nullptr)
 {
 	//Initialize our shaders
 	m_colourShader = new ColourShader(device, hwnd);
@@ -29,6 +29,15 @@ ShaderManager::ShaderManager(ID3D11Device* device, HWND hwnd) : m_initialization
 	{
 		m_initializationFailed = true;
 		MessageBox(hwnd, "Could not initialize the texture shader", "Error", MB_OK);
+		return;
+	}
+
+	m_instancedTextureShader = new InstancedTextureShader(device, hwnd);
+
+	if (m_instancedTextureShader->GetInitializationState())
+	{
+		m_initializationFailed = true;
+		MessageBox(hwnd, "Could not initialize the instanced texture shader", "Error", MB_OK);
 	}
 }
 
@@ -38,6 +47,12 @@ ShaderManager::ShaderManager(ShaderManager&& other) noexcept = default;
 
 ShaderManager::~ShaderManager()
 {
+	if (m_instancedTextureShader)
+	{
+		delete m_instancedTextureShader;
+		m_instancedTextureShader = nullptr;
+	}
+
 	if (m_textureShader)
 	{
 		delete m_textureShader;
@@ -73,6 +88,10 @@ Shader* ShaderManager::GetTextureShader() const {
 	return m_textureShader;
 }
 
+InstancedTextureShader* ShaderManager::GetInstancedTextureShader() const {
+	return m_instancedTextureShader;
+}
+
 
 
 bool ShaderManager::GetInitializationState() const
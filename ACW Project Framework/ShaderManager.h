@@ -6,6 +6,7 @@
 #include "ColourShader.h"
 #include "LightShader.h"
 #include "TextureShader.h"
+#include "InstancedTextureShader.h"
 
 class ShaderManager
 {
@@ -22,6 +23,7 @@ public:
 	Shader* GetColourShader() const;
 	Shader* GetLightShader() const;
 	Shader* GetTextureShader() const;
+	InstancedTextureShader* GetInstancedTextureShader() const;
 
 	//Example methods for current shaders, will need to make one for each new shader created or final ones used
 	//bool RenderColourShader(ID3D11DeviceContext* deviceContext, int indexCount, XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix);
@@ -37,5 +39,6 @@ private:
 	Shader* m_colourShader;
 	Shader* m_lightShader;
 	Shader* m_textureShader;
+	InstancedTextureShader* m_instancedTextureShader;
 };
 
@@ -0,0 +1,71 @@
+#include "SimulationThread.h"
+
+SimulationThread::SimulationThread() : m_running(false), m_stepInterval(0)
+{
+}
+
+SimulationThread::~SimulationThread()
+{
+	Stop();
+}
+
+void SimulationThread::Start(const function<void()>& step, const float stepInterval)
+{
+	if (m_running)
+	{
+		return;
+	}
+
+	m_step = step;
+	m_stepInterval = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<float>(stepInterval));
+	m_running = true;
+
+	m_thread = thread(&SimulationThread::Run, this);
+}
+
+void SimulationThread::Stop()
+{
+	{
+		//Cleared under the wake mutex so the thread can't miss the notify between checking it and starting to wait
+		lock_guard<mutex> lock(m_wakeMutex);
+		m_running = false;
+	}
+
+	m_wake.notify_all();
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+}
+
+mutex& SimulationThread::GetMutex()
+{
+	return m_mutex;
+}
+
+void SimulationThread::Run()
+{
+	auto nextStep = chrono::steady_clock::now() + m_stepInterval;
+
+	while (true)
+	{
+		//Sleep until the next step is due without holding the simulation mutex, so anyone else can take it in the meantime
+		{
+			unique_lock<mutex> lock(m_wakeMutex);
+
+			if (m_wake.wait_until(lock, nextStep, [this]() { return !m_running; }))
+			{
+				return;
+			}
+		}
+
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_step();
+		}
+
+		//Keep to the step rate, but after a step that overran start the next one now rather than running a burst to catch up
+		nextStep = max(nextStep + m_stepInterval, chrono::steady_clock::now());
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+
+using namespace std;
+
+//Runs a simulation step on its own thread at a fixed rate until stopped. Each step runs with the mutex held so the scene can be safely
+//changed between steps from other threads by locking it, in between steps the thread sleeps without holding it
+class SimulationThread
+{
+public:
+	SimulationThread(); // Default Constructor
+	SimulationThread(const SimulationThread& other) = delete; // Copy Constructor
+	SimulationThread(SimulationThread&& other) noexcept = delete; // Move Constructor
+	~SimulationThread(); // Destructor
+
+	SimulationThread& operator = (const SimulationThread& other) = delete; // Copy Assignment Operator
+	SimulationThread& operator = (SimulationThread&& other) noexcept = delete; // Move Assignment Operator
+
+	//Steps are started stepInterval seconds apart, a step that overruns is followed straight away
+	void Start(const function<void()>& step, const float stepInterval);
+	void Stop();
+
+	mutex& GetMutex();
+
+private:
+	void Run();
+
+	thread m_thread;
+	mutex m_mutex;
+	atomic<bool> m_running;
+
+	//Wakes the thread early when it's stopped
+	mutex m_wakeMutex;
+	condition_variable m_wake;
+
+	function<void()> m_step;
+	chrono::steady_clock::duration m_stepInterval;
+};
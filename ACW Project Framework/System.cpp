@@ -2,8 +2,9 @@
 #include <winuser.h>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 
-System::System() : m_initializationFailed(false), m_applicationName(nullptr), m_hInstance(nullptr), m_hwnd(nullptr), m_input(nullptr), m_graphics(nullptr) {
+System::System(const char* commandLine) : m_initializationFailed(false), m_applicationName(nullptr), m_hInstance(nullptr), m_hwnd(nullptr), m_input(nullptr), m_graphics(nullptr) {
 	auto screenWidth = 0;
 	auto screenHeight = 0;
 
@@ -19,8 +20,33 @@ System::System() : m_initializationFailed(false), m_applicationName(nullptr), m_
 		return;
 	}
 
+	//"-replay <file>" plays a recorded session back before handing over to the user
+	istringstream arguments(commandLine ? commandLine : "");
+	string argument;
+	//"-deterministic" starts in the deterministic mode
+	//"-threads <count>" sets how many threads the simulation uses, one per hardware thread by default
+	string replayFileName;
+	auto deterministic = false;
+	auto threadCount = 0u;
+
+	while (arguments >> argument)
+	{
+		if (argument == "-replay")
+		{
+			arguments >> replayFileName;
+		}
+		else if (argument == "-deterministic")
+		{
+			deterministic = true;
+		}
+		else if (argument == "-threads")
+		{
+			arguments >> threadCount;
+		}
+	}
+
 	//Create our graphics object for handling the rendering of all the graphics
-	m_graphics = new GraphicsRenderer(screenWidth, screenHeight, m_hwnd);
+	m_graphics = new GraphicsRenderer(screenWidth, screenHeight, m_hwnd, replayFileName.empty() ? nullptr : replayFileName.c_str(), deterministic, threadCount);
 
 	if (m_graphics->GetInitializationState())
 	{
@@ -114,7 +140,8 @@ bool System::Frame() {
 	}
 
 	if (m_input->IsKeyUp(0x31) && m_input->IsKeyUp(0x32) && m_input->IsKeyUp(0x52) && m_input->IsKeyUp(0x50) && m_input->IsKeyUp(0x55) && m_input->IsKeyUp(0x4A) && m_input->IsKeyUp(0x49) && m_input->IsKeyUp(0x4B) &&
-		m_input->IsKeyUp(0x4F) && m_input->IsKeyUp(0x4C) && m_input->IsKeyUp(0x54) && m_input->IsKeyUp(0x42) && m_input->IsKeyUp(VK_SPACE))
+		m_input->IsKeyUp(0x4F) && m_input->IsKeyUp(0x4C) && m_input->IsKeyUp(0x54) && m_input->IsKeyUp(0x42) && m_input->IsKeyUp(VK_SPACE) && m_input->IsKeyUp(0x46) &&
+		m_input->IsKeyUp(VK_F5) && m_input->IsKeyUp(VK_F9) && m_input->IsKeyUp(0x4D) && m_input->IsKeyUp(0x56) && m_input->IsKeyUp(0x4E))
 	{
 		m_input->ToggleDoOnce(true);
 	}
@@ -217,6 +244,47 @@ bool System::Frame() {
 		m_input->ToggleDoOnce(false);
 	}
 
+	//Toggle Deterministic Mode
+	if (m_input->IsKeyDown(0x4D) && m_input->DoOnce())
+	{
+		m_graphics->ToggleDeterministicMode();
+		m_input->ToggleDoOnce(false);
+	}
+
+	//Toggle Wide Contact Solver
+	if (m_input->IsKeyDown(0x56) && m_input->DoOnce())
+	{
+		m_graphics->ToggleWideSolver();
+		m_input->ToggleDoOnce(false);
+	}
+
+	//Cycle Solver Substeps
+	if (m_input->IsKeyDown(0x4E) && m_input->DoOnce())
+	{
+		m_graphics->CycleSubsteps();
+		m_input->ToggleDoOnce(false);
+	}
+
+	//Refresh Frame Statistics
+	if (m_input->IsKeyDown(0x46) && m_input->DoOnce())
+	{
+		m_graphics->RefreshFrameStatistics();
+		m_input->ToggleDoOnce(false);
+	}
+
+	//Save/Restore World Snapshot
+	if (m_input->IsKeyDown(VK_F5) && m_input->DoOnce())
+	{
+		m_graphics->SaveWorldSnapshot();
+		m_input->ToggleDoOnce(false);
+	}
+
+	if (m_input->IsKeyDown(VK_F9) && m_input->DoOnce())
+	{
+		m_graphics->LoadWorldSnapshot(m_hwnd);
+		m_input->ToggleDoOnce(false);
+	}
+
 	//Camera Controls
 	if (m_input->IsKeyDown(0x57))
 	{
@@ -12,7 +12,7 @@
 class System
 {
 public:
-	System(); // Default Constructor
+	System(const char* commandLine); // Default Constructor
 	System(const System& other); // Copy Constructor
 	System(System&& other) noexcept; // Move Constructor
 	~System(); // Destructor
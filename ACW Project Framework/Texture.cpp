@@ -1,41 +1,46 @@
 #include "Texture.h"
+#include "ResourceManager.h"
 
-Texture::Texture(ID3D11Device* device, const WCHAR* fileName, ResourceManager* resourceManager) : m_texture(nullptr), m_initializationFailed(false)
+Texture::Texture(ID3D11Device* device, const wchar_t* fileName, ResourceManager* resourceManager) : m_textureHandle(INVALID_RESOURCE_HANDLE), m_initializationFailed(false)
 {
 	m_resourceManager = resourceManager;
-	const auto result = resourceManager->GetTexture(device, fileName, m_texture);
 
-	if (FAILED(result))
-	{
-		m_initializationFailed = true;
-	}
+	//Draws the placeholder until the texture has finished loading
+	m_textureHandle = resourceManager->GetTextureHandle(fileName);
 }
 
 Texture::Texture(const Texture& other) = default;
 
 Texture::Texture(Texture&& other) = default;
 
-Texture::~Texture()
-{
-	//Release resources
-
-	if (m_texture)
-	{
-		m_texture->Release();
-		m_texture = nullptr;
-	}
-}
+Texture::~Texture() = default;
 
 Texture& Texture::operator=(const Texture& other) = default;
 
 Texture& Texture::operator=(Texture&& other) noexcept = default;
 
 ID3D11ShaderResourceView* Texture::GetTexture() const {
-	return m_texture;
+	return m_resourceManager->GetTexture(m_textureHandle);
+}
+
+ID3D11ShaderResourceView* Texture::GetTextureArray() const {
+	return m_resourceManager->GetTextureArray(m_textureHandle);
+}
+
+unsigned int Texture::GetTextureLayer() const {
+	return m_resourceManager->GetTextureLayer(m_textureHandle);
+}
+
+unsigned int Texture::GetTextureHandle() const {
+	return m_textureHandle;
+}
+
+void Texture::SetTextureHandle(const unsigned int textureHandle) {
+	m_textureHandle = textureHandle;
 }
 
 void Texture::ChangeRandomTexture() {
-	m_resourceManager->ReturnRandomTexture(m_texture);
+	m_textureHandle = m_resourceManager->ReturnRandomTexture(m_textureHandle);
 }
 
 
@@ -1,17 +1,14 @@
 #pragma once
 
-//DirectX Libraries
-#include <d3d11.h>
-#include <d3d11_1.h>
-
-#include "ResourceManager.h"
-
-using namespace DirectX;
+//Direct3D and the resource manager are only used through pointers here so the header builds without the Windows SDK
+struct ID3D11Device;
+struct ID3D11ShaderResourceView;
+class ResourceManager;
 
 class Texture
 {
 public:
-	Texture(ID3D11Device* device, const WCHAR* fileName, ResourceManager* resourceManager); // Default Constructor
+	Texture(ID3D11Device* device, const wchar_t* fileName, ResourceManager* resourceManager); // Default Constructor
 	Texture(const Texture& other); // Copy Constructor
 	Texture(Texture&& other); // Move Constructor
 	~Texture(); // Destructor
@@ -20,12 +17,18 @@ public:
 	Texture& operator = (Texture&& other) noexcept; // Move Assignment Operator
 
 	ID3D11ShaderResourceView* GetTexture() const;
+	ID3D11ShaderResourceView* GetTextureArray() const;
+	unsigned int GetTextureLayer() const;
+
+	unsigned int GetTextureHandle() const;
+	void SetTextureHandle(const unsigned int textureHandle);
+
 	void ChangeRandomTexture();
 
 	bool GetInitializationState() const;
 
 private:
-	ID3D11ShaderResourceView* m_texture;
+	unsigned int m_textureHandle;
 
 	ResourceManager* m_resourceManager;
 
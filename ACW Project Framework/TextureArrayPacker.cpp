@@ -0,0 +1,82 @@
+#include "TextureArrayPacker.h"
+
+TextureArrayPacker::TextureArrayPacker() = default;
+
+TextureArrayPacker::TextureArrayPacker(const TextureArrayPacker& other) = default;
+
+TextureArrayPacker::TextureArrayPacker(TextureArrayPacker&& other) noexcept = default;
+
+TextureArrayPacker::~TextureArrayPacker() = default;
+
+TextureArrayPacker& TextureArrayPacker::operator=(const TextureArrayPacker& other) = default;
+
+TextureArrayPacker& TextureArrayPacker::operator=(TextureArrayPacker&& other) noexcept = default;
+
+void TextureArrayPacker::Clear()
+{
+	m_placements.clear();
+	m_arrayDescriptions.clear();
+	m_arrayTextures.clear();
+}
+
+void TextureArrayPacker::Add(const TextureDescription& description)
+{
+	const auto textureIndex = static_cast<unsigned int>(m_placements.size());
+
+	//Only a handful of distinct formats so a linear search over the arrays is plenty
+	auto array = 0u;
+
+	for (; array < m_arrayDescriptions.size(); array++)
+	{
+		const auto& arrayDescription = m_arrayDescriptions[array];
+
+		if (arrayDescription.width == description.width && arrayDescription.height == description.height &&
+			arrayDescription.mipLevels == description.mipLevels && arrayDescription.format == description.format)
+		{
+			break;
+		}
+	}
+
+	if (array == m_arrayDescriptions.size())
+	{
+		m_arrayDescriptions.push_back(description);
+		m_arrayTextures.emplace_back();
+	}
+
+	Placement placement;
+	placement.array = array;
+	placement.layer = static_cast<unsigned int>(m_arrayTextures[array].size());
+
+	m_arrayTextures[array].push_back(textureIndex);
+	m_placements.push_back(placement);
+}
+
+const vector<TextureArrayPacker::Placement>& TextureArrayPacker::GetPlacements() const
+{
+	return m_placements;
+}
+
+unsigned int TextureArrayPacker::GetArrayCount() const
+{
+	return static_cast<unsigned int>(m_arrayDescriptions.size());
+}
+
+const TextureArrayPacker::TextureDescription& TextureArrayPacker::GetArrayDescription(const unsigned int array) const
+{
+	return m_arrayDescriptions[array];
+}
+
+unsigned int TextureArrayPacker::GetLayerCount(const unsigned int array) const
+{
+	return static_cast<unsigned int>(m_arrayTextures[array].size());
+}
+
+unsigned int TextureArrayPacker::GetTextureIndex(const unsigned int array, const unsigned int layer) const
+{
+	return m_arrayTextures[array][layer];
+}
+
+unsigned int TextureArrayPacker::GetSubresource(const unsigned int mipLevel, const unsigned int layer, const unsigned int mipLevels)
+{
+	return mipLevel + layer * mipLevels;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+
+using namespace std;
+
+//Works out how to pack textures into texture arrays. Textures with the same size, format and mip count can share an array so
+//objects using any of them can be drawn together with the texture picked by a per instance layer index.
+//No Direct3D in here, the format is just compared as a number
+class TextureArrayPacker
+{
+public:
+	struct TextureDescription {
+		unsigned int width;
+		unsigned int height;
+		unsigned int mipLevels;
+		unsigned int format;
+	};
+
+	//Which array a texture went into and which layer of it
+	struct Placement {
+		unsigned int array;
+		unsigned int layer;
+	};
+
+	TextureArrayPacker(); // Default Constructor
+	TextureArrayPacker(const TextureArrayPacker& other); // Copy Constructor
+	TextureArrayPacker(TextureArrayPacker&& other) noexcept; // Move Constructor
+	~TextureArrayPacker(); // Destructor
+
+	TextureArrayPacker& operator = (const TextureArrayPacker& other); // Copy Assignment Operator
+	TextureArrayPacker& operator = (TextureArrayPacker&& other) noexcept; // Move Assignment Operator
+
+	void Clear();
+
+	//Placements are returned in the order textures were added
+	void Add(const TextureDescription& description);
+
+	const vector<Placement>& GetPlacements() const;
+
+	unsigned int GetArrayCount() const;
+	const TextureDescription& GetArrayDescription(const unsigned int array) const;
+	unsigned int GetLayerCount(const unsigned int array) const;
+
+	//Index of the texture added at the given layer of an array, used to find what to copy into each layer
+	unsigned int GetTextureIndex(const unsigned int array, const unsigned int layer) const;
+
+	//Same ordering as D3D11CalcSubresource, every mip of layer 0 comes before layer 1
+	static unsigned int GetSubresource(const unsigned int mipLevel, const unsigned int layer, const unsigned int mipLevels);
+
+private:
+	vector<Placement> m_placements;
+
+	vector<TextureDescription> m_arrayDescriptions;
+	vector<vector<unsigned int>> m_arrayTextures;
+};
@@ -0,0 +1,52 @@
+#include "TransformStore.h"
+
+auto const INDEX_MASK = 0x3u;
+auto const FRESH_FLAG = 0x4u;
+
+TransformStore::TransformStore() : m_snapshots(), m_middle(1), m_back(0), m_front(2)
+{
+}
+
+TransformStore::~TransformStore() = default;
+
+TransformStore::Snapshot& TransformStore::GetWriteSnapshot()
+{
+	return m_snapshots[m_back];
+}
+
+void TransformStore::Publish()
+{
+	//Hand the finished back buffer over and take whatever was in the middle to write into next
+	m_back = m_middle.exchange(m_back | FRESH_FLAG, memory_order_acq_rel) & INDEX_MASK;
+}
+
+const TransformStore::Snapshot& TransformStore::AcquireLatest()
+{
+	//Only swap if something new has been published, otherwise keep drawing the last snapshot
+	if (m_middle.load(memory_order_acquire) & FRESH_FLAG)
+	{
+		m_front = m_middle.exchange(m_front, memory_order_acq_rel) & INDEX_MASK;
+	}
+
+	return m_snapshots[m_front];
+}
+
+unsigned int TransformStore::Checksum(const Snapshot& snapshot)
+{
+	//FNV-1a over the raw bytes of the positions and rotations
+	auto checksum = 2166136261u;
+
+	for (const auto& transform : snapshot.transforms)
+	{
+		const float values[7] = { transform.position.x, transform.position.y, transform.position.z, transform.rotation.x, transform.rotation.y, transform.rotation.z, transform.rotation.w };
+		const auto* bytes = reinterpret_cast<const unsigned char*>(values);
+
+		for (unsigned int i = 0; i < sizeof(values); i++)
+		{
+			checksum ^= bytes[i];
+			checksum *= 16777619u;
+		}
+	}
+
+	return checksum;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+#include <atomic>
+
+#include "BroadphaseGrid.h"
+
+using namespace DirectX;
+using namespace std;
+
+struct ID3D11ShaderResourceView;
+
+//Triple buffered store of object transforms passed from the simulation thread to the render thread.
+//The simulation writes into its own back buffer and publishes it by swapping it with the middle buffer, the renderer swaps its front buffer
+//with the middle one whenever a newer snapshot has been published. Neither side ever waits on the other
+class TransformStore
+{
+public:
+	struct Transform {
+		XMFLOAT3 position;
+		XMFLOAT4 rotation;
+		ID3D11ShaderResourceView* texture;
+
+		//Where the texture lives in its texture array, used by the instanced shader
+		ID3D11ShaderResourceView* textureArray;
+		unsigned int textureLayer;
+	};
+
+	struct Snapshot {
+		vector<Transform> transforms;
+		unsigned long long stepNumber;
+		float stepTime;
+		unsigned long long stateHash; //Only calculated in the deterministic mode, zero otherwise
+		unsigned int broadphasePairCount;
+		unsigned int contactCount;
+		unsigned int contactBatchCount; //Zero when the contacts were solved one at a time
+		float velocitySolveRate; //Contacts per microsecond through the coloured velocity batches
+		unsigned long long derivedDataUpdates; //World inertia tensors rebuilt since the last snapshot
+		BroadphaseGrid::Timings broadphaseTimings;
+	};
+
+	TransformStore(); // Default Constructor
+	TransformStore(const TransformStore& other) = delete; // Copy Constructor
+	TransformStore(TransformStore&& other) noexcept = delete; // Move Constructor
+	~TransformStore(); // Destructor
+
+	TransformStore& operator = (const TransformStore& other) = delete; // Copy Assignment Operator
+	TransformStore& operator = (TransformStore&& other) noexcept = delete; // Move Assignment Operator
+
+	//Writer side, only ever called by one thread at a time
+	Snapshot& GetWriteSnapshot();
+	void Publish();
+
+	//Reader side, returns the latest published snapshot which stays valid until the next call
+	const Snapshot& AcquireLatest();
+
+	//Hash of every position and rotation in a snapshot, lets two runs be compared without rendering anything
+	static unsigned int Checksum(const Snapshot& snapshot);
+
+private:
+	Snapshot m_snapshots[3];
+
+	//Index of the middle buffer with a flag set when it holds a snapshot the reader hasn't picked up yet
+	atomic<unsigned int> m_middle;
+
+	unsigned int m_back;
+	unsigned int m_front;
+};
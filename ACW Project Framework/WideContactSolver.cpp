@@ -0,0 +1,326 @@
+#include "WideContactSolver.h"
+
+void WideContactSolver::ApplyVelocityChanges(ManifoldPoint* const points[], XMVECTOR* const velocityChanges[], XMVECTOR* const angularChanges[], const unsigned int pointCount)
+{
+	//Unused lanes repeat the first contact, their results are never written back
+	XMVECTOR normals[WIDE_SOLVER_LANES];
+	XMVECTOR tangentsOne[WIDE_SOLVER_LANES];
+	XMVECTOR tangentsTwo[WIDE_SOLVER_LANES];
+	XMVECTOR relativePositionsOne[WIDE_SOLVER_LANES];
+	XMVECTOR relativePositionsTwo[WIDE_SOLVER_LANES];
+	XMMATRIX inverseInertiaTensorsOne[WIDE_SOLVER_LANES];
+	XMMATRIX inverseInertiaTensorsTwo[WIDE_SOLVER_LANES];
+
+	float inverseMassesOne[WIDE_SOLVER_LANES];
+	float inverseMassesTwo[WIDE_SOLVER_LANES];
+	float frictions[WIDE_SOLVER_LANES];
+	float desiredDeltaVelocities[WIDE_SOLVER_LANES];
+	float contactVelocitiesY[WIDE_SOLVER_LANES];
+	float contactVelocitiesZ[WIDE_SOLVER_LANES];
+
+	for (unsigned int lane = 0; lane < WIDE_SOLVER_LANES; lane++)
+	{
+		const auto& point = *points[lane < pointCount ? lane : 0];
+
+		normals[lane] = point.contactToWorld.r[0];
+		tangentsOne[lane] = point.contactToWorld.r[1];
+		tangentsTwo[lane] = point.contactToWorld.r[2];
+		relativePositionsOne[lane] = point.relativeContactPosition[0];
+
+		point.contactID[0]->GetInverseInertiaTensorWorld(inverseInertiaTensorsOne[lane]);
+		inverseMassesOne[lane] = point.contactID[0]->GetInverseMass();
+
+		//Without a second body its terms all come out as zero
+		if (point.contactID[1])
+		{
+			relativePositionsTwo[lane] = point.relativeContactPosition[1];
+
+			point.contactID[1]->GetInverseInertiaTensorWorld(inverseInertiaTensorsTwo[lane]);
+			inverseMassesTwo[lane] = point.contactID[1]->GetInverseMass();
+		}
+		else
+		{
+			relativePositionsTwo[lane] = XMVectorZero();
+			inverseInertiaTensorsTwo[lane] = XMMATRIX(XMVectorZero(), XMVectorZero(), XMVectorZero(), XMVectorZero());
+			inverseMassesTwo[lane] = 0.0f;
+		}
+
+		frictions[lane] = point.friction;
+		desiredDeltaVelocities[lane] = point.desiredDeltaVelocity;
+		contactVelocitiesY[lane] = XMVectorGetY(point.contactVelocity);
+		contactVelocitiesZ[lane] = XMVectorGetZ(point.contactVelocity);
+	}
+
+	const auto normal = Gather(normals);
+	const auto tangentOne = Gather(tangentsOne);
+	const auto tangentTwo = Gather(tangentsTwo);
+	const auto relativePositionOne = Gather(relativePositionsOne);
+	const auto relativePositionTwo = Gather(relativePositionsTwo);
+	const auto inverseInertiaTensorOne = GatherRows(inverseInertiaTensorsOne);
+	const auto inverseInertiaTensorTwo = GatherRows(inverseInertiaTensorsTwo);
+
+	const auto inverseMassOne = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(inverseMassesOne));
+	const auto inverseMassTwo = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(inverseMassesTwo));
+	const auto friction = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(frictions));
+	const auto desiredDeltaVelocity = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(desiredDeltaVelocities));
+	const auto contactVelocityY = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(contactVelocitiesY));
+	const auto contactVelocityZ = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(contactVelocitiesZ));
+
+	const auto inverseMass = XMVectorAdd(inverseMassOne, inverseMassTwo);
+
+	//Frictionless impulse, the change in velocity along the normal for a unit impulse
+	auto deltaVelocityAlongNormal = Dot(Cross(Transform(Cross(relativePositionOne, normal), inverseInertiaTensorOne), relativePositionOne), normal);
+	deltaVelocityAlongNormal = XMVectorAdd(deltaVelocityAlongNormal, Dot(Cross(Transform(Cross(relativePositionTwo, normal), inverseInertiaTensorTwo), relativePositionTwo), normal));
+	deltaVelocityAlongNormal = XMVectorAdd(deltaVelocityAlongNormal, inverseMass);
+
+	const auto frictionlessImpulseX = XMVectorDivide(desiredDeltaVelocity, deltaVelocityAlongNormal);
+
+	//Friction impulse, the full change in contact velocity for a unit impulse in each contact direction
+	const auto impulseTorqueOne = SkewSymmetric(relativePositionOne);
+	const auto impulseTorqueTwo = SkewSymmetric(relativePositionTwo);
+
+	const auto deltaVelocityWorldOne = Multiply(Multiply(impulseTorqueOne, inverseInertiaTensorOne), impulseTorqueOne);
+	const auto deltaVelocityWorldTwo = Multiply(Multiply(impulseTorqueTwo, inverseInertiaTensorTwo), impulseTorqueTwo);
+
+	Matrix3 totalDeltaVelocityWorld;
+
+	for (unsigned int row = 0; row < 3; row++)
+	{
+		for (unsigned int column = 0; column < 3; column++)
+		{
+			totalDeltaVelocityWorld.m[row][column] = XMVectorNegate(XMVectorAdd(deltaVelocityWorldOne.m[row][column], deltaVelocityWorldTwo.m[row][column]));
+		}
+	}
+
+	Matrix3 contactToWorld;
+
+	contactToWorld.m[0][0] = normal.x; contactToWorld.m[0][1] = normal.y; contactToWorld.m[0][2] = normal.z;
+	contactToWorld.m[1][0] = tangentOne.x; contactToWorld.m[1][1] = tangentOne.y; contactToWorld.m[1][2] = tangentOne.z;
+	contactToWorld.m[2][0] = tangentTwo.x; contactToWorld.m[2][1] = tangentTwo.y; contactToWorld.m[2][2] = tangentTwo.z;
+
+	auto deltaVelocity = Multiply(contactToWorld, MultiplyTransposed(totalDeltaVelocityWorld, contactToWorld));
+
+	for (unsigned int i = 0; i < 3; i++)
+	{
+		deltaVelocity.m[i][i] = XMVectorAdd(deltaVelocity.m[i][i], inverseMass);
+	}
+
+	const auto impulseMatrix = Inverse(deltaVelocity);
+
+	Vector3 velocityKiller;
+	velocityKiller.x = desiredDeltaVelocity;
+	velocityKiller.y = XMVectorNegate(contactVelocityY);
+	velocityKiller.z = XMVectorNegate(contactVelocityZ);
+
+	auto impulseContact = Transform(velocityKiller, impulseMatrix);
+
+	//Lanes where the planar impulse is more than friction allows slide instead
+	const auto planarImpulse = XMVectorSqrt(XMVectorAdd(XMVectorMultiply(impulseContact.y, impulseContact.y), XMVectorMultiply(impulseContact.z, impulseContact.z)));
+	const auto sliding = XMVectorGreater(planarImpulse, XMVectorMultiply(impulseContact.x, friction));
+
+	const auto slidingDirectionY = XMVectorDivide(impulseContact.y, planarImpulse);
+	const auto slidingDirectionZ = XMVectorDivide(impulseContact.z, planarImpulse);
+
+	auto slidingImpulseX = XMVectorAdd(deltaVelocity.m[0][0], XMVectorMultiply(XMVectorMultiply(deltaVelocity.m[0][1], friction), slidingDirectionY));
+	slidingImpulseX = XMVectorAdd(slidingImpulseX, XMVectorMultiply(XMVectorMultiply(deltaVelocity.m[0][2], friction), slidingDirectionZ));
+	slidingImpulseX = XMVectorDivide(desiredDeltaVelocity, slidingImpulseX);
+
+	impulseContact.x = XMVectorSelect(impulseContact.x, slidingImpulseX, sliding);
+	impulseContact.y = XMVectorSelect(impulseContact.y, XMVectorMultiply(XMVectorMultiply(slidingDirectionY, friction), slidingImpulseX), sliding);
+	impulseContact.z = XMVectorSelect(impulseContact.z, XMVectorMultiply(XMVectorMultiply(slidingDirectionZ, friction), slidingImpulseX), sliding);
+
+	//Frictionless lanes only push along the normal
+	const auto frictionless = XMVectorEqual(friction, XMVectorZero());
+
+	impulseContact.x = XMVectorSelect(impulseContact.x, frictionlessImpulseX, frictionless);
+	impulseContact.y = XMVectorSelect(impulseContact.y, XMVectorZero(), frictionless);
+	impulseContact.z = XMVectorSelect(impulseContact.z, XMVectorZero(), frictionless);
+
+	//Impulse in world space and the velocity changes it makes to each body
+	const auto impulseWorld = Add(Add(Scale(normal, impulseContact.x), Scale(tangentOne, impulseContact.y)), Scale(tangentTwo, impulseContact.z));
+
+	XMVECTOR velocityChangesOne[WIDE_SOLVER_LANES];
+	XMVECTOR velocityChangesTwo[WIDE_SOLVER_LANES];
+	XMVECTOR angularChangesOne[WIDE_SOLVER_LANES];
+	XMVECTOR angularChangesTwo[WIDE_SOLVER_LANES];
+
+	Scatter(Scale(impulseWorld, inverseMassOne), velocityChangesOne);
+	Scatter(Scale(impulseWorld, XMVectorNegate(inverseMassTwo)), velocityChangesTwo);
+	Scatter(Transform(Cross(relativePositionOne, impulseWorld), inverseInertiaTensorOne), angularChangesOne);
+	Scatter(Transform(Cross(impulseWorld, relativePositionTwo), inverseInertiaTensorTwo), angularChangesTwo);
+
+	for (unsigned int lane = 0; lane < pointCount; lane++)
+	{
+		const auto& point = *points[lane];
+
+		velocityChanges[lane][0] = velocityChangesOne[lane];
+		angularChanges[lane][0] = angularChangesOne[lane];
+
+		auto velocity = XMVECTOR();
+		auto angularVelocity = XMVECTOR();
+
+		point.contactID[0]->GetNewVelocity(velocity);
+		point.contactID[0]->GetAngularVelocity(angularVelocity);
+
+		point.contactID[0]->SetNewVelocity(velocity + velocityChangesOne[lane]);
+		point.contactID[0]->SetAngularVelocity(angularVelocity + angularChangesOne[lane]);
+
+		if (point.contactID[1])
+		{
+			velocityChanges[lane][1] = velocityChangesTwo[lane];
+			angularChanges[lane][1] = angularChangesTwo[lane];
+
+			point.contactID[1]->GetNewVelocity(velocity);
+			point.contactID[1]->GetAngularVelocity(angularVelocity);
+
+			point.contactID[1]->SetNewVelocity(velocity + velocityChangesTwo[lane]);
+			point.contactID[1]->SetAngularVelocity(angularVelocity + angularChangesTwo[lane]);
+		}
+	}
+}
+
+WideContactSolver::Vector3 WideContactSolver::Gather(const XMVECTOR values[])
+{
+	//One vector per lane in, one component per vector out
+	const auto lanes = XMMatrixTranspose(XMMATRIX(values[0], values[1], values[2], values[3]));
+
+	return { lanes.r[0], lanes.r[1], lanes.r[2] };
+}
+
+void WideContactSolver::Scatter(const Vector3& lanes, XMVECTOR values[])
+{
+	const auto transposed = XMMatrixTranspose(XMMATRIX(lanes.x, lanes.y, lanes.z, XMVectorZero()));
+
+	for (unsigned int lane = 0; lane < WIDE_SOLVER_LANES; lane++)
+	{
+		values[lane] = transposed.r[lane];
+	}
+}
+
+WideContactSolver::Matrix3 WideContactSolver::GatherRows(const XMMATRIX matrices[])
+{
+	Matrix3 lanes;
+
+	for (unsigned int row = 0; row < 3; row++)
+	{
+		const XMVECTOR rows[WIDE_SOLVER_LANES] = { matrices[0].r[row], matrices[1].r[row], matrices[2].r[row], matrices[3].r[row] };
+		const auto rowLanes = Gather(rows);
+
+		lanes.m[row][0] = rowLanes.x;
+		lanes.m[row][1] = rowLanes.y;
+		lanes.m[row][2] = rowLanes.z;
+	}
+
+	return lanes;
+}
+
+WideContactSolver::Vector3 WideContactSolver::Add(const Vector3& a, const Vector3& b)
+{
+	return { XMVectorAdd(a.x, b.x), XMVectorAdd(a.y, b.y), XMVectorAdd(a.z, b.z) };
+}
+
+WideContactSolver::Vector3 WideContactSolver::Scale(const Vector3& a, const XMVECTOR& scale)
+{
+	return { XMVectorMultiply(a.x, scale), XMVectorMultiply(a.y, scale), XMVectorMultiply(a.z, scale) };
+}
+
+WideContactSolver::Vector3 WideContactSolver::Cross(const Vector3& a, const Vector3& b)
+{
+	return {
+		XMVectorSubtract(XMVectorMultiply(a.y, b.z), XMVectorMultiply(a.z, b.y)),
+		XMVectorSubtract(XMVectorMultiply(a.z, b.x), XMVectorMultiply(a.x, b.z)),
+		XMVectorSubtract(XMVectorMultiply(a.x, b.y), XMVectorMultiply(a.y, b.x))
+	};
+}
+
+XMVECTOR WideContactSolver::Dot(const Vector3& a, const Vector3& b)
+{
+	return XMVectorAdd(XMVectorAdd(XMVectorMultiply(a.x, b.x), XMVectorMultiply(a.y, b.y)), XMVectorMultiply(a.z, b.z));
+}
+
+WideContactSolver::Vector3 WideContactSolver::Transform(const Vector3& v, const Matrix3& matrix)
+{
+	Vector3 result;
+	XMVECTOR* components[3] = { &result.x, &result.y, &result.z };
+
+	for (unsigned int column = 0; column < 3; column++)
+	{
+		*components[column] = XMVectorAdd(XMVectorAdd(XMVectorMultiply(v.x, matrix.m[0][column]), XMVectorMultiply(v.y, matrix.m[1][column])), XMVectorMultiply(v.z, matrix.m[2][column]));
+	}
+
+	return result;
+}
+
+WideContactSolver::Matrix3 WideContactSolver::Multiply(const Matrix3& a, const Matrix3& b)
+{
+	Matrix3 result;
+
+	for (unsigned int row = 0; row < 3; row++)
+	{
+		for (unsigned int column = 0; column < 3; column++)
+		{
+			result.m[row][column] = XMVectorAdd(XMVectorAdd(XMVectorMultiply(a.m[row][0], b.m[0][column]), XMVectorMultiply(a.m[row][1], b.m[1][column])), XMVectorMultiply(a.m[row][2], b.m[2][column]));
+		}
+	}
+
+	return result;
+}
+
+WideContactSolver::Matrix3 WideContactSolver::MultiplyTransposed(const Matrix3& a, const Matrix3& b)
+{
+	Matrix3 result;
+
+	for (unsigned int row = 0; row < 3; row++)
+	{
+		for (unsigned int column = 0; column < 3; column++)
+		{
+			result.m[row][column] = XMVectorAdd(XMVectorAdd(XMVectorMultiply(a.m[row][0], b.m[column][0]), XMVectorMultiply(a.m[row][1], b.m[column][1])), XMVectorMultiply(a.m[row][2], b.m[column][2]));
+		}
+	}
+
+	return result;
+}
+
+WideContactSolver::Matrix3 WideContactSolver::SkewSymmetric(const Vector3& v)
+{
+	const auto zero = XMVectorZero();
+
+	Matrix3 result;
+
+	result.m[0][0] = zero; result.m[0][1] = XMVectorNegate(v.z); result.m[0][2] = v.y;
+	result.m[1][0] = v.z; result.m[1][1] = zero; result.m[1][2] = XMVectorNegate(v.x);
+	result.m[2][0] = XMVectorNegate(v.y); result.m[2][1] = v.x; result.m[2][2] = zero;
+
+	return result;
+}
+
+WideContactSolver::Matrix3 WideContactSolver::Inverse(const Matrix3& matrix)
+{
+	const auto& m = matrix.m;
+
+	//Adjugate over the determinant
+	Matrix3 result;
+
+	result.m[0][0] = XMVectorSubtract(XMVectorMultiply(m[1][1], m[2][2]), XMVectorMultiply(m[1][2], m[2][1]));
+	result.m[0][1] = XMVectorSubtract(XMVectorMultiply(m[0][2], m[2][1]), XMVectorMultiply(m[0][1], m[2][2]));
+	result.m[0][2] = XMVectorSubtract(XMVectorMultiply(m[0][1], m[1][2]), XMVectorMultiply(m[0][2], m[1][1]));
+	result.m[1][0] = XMVectorSubtract(XMVectorMultiply(m[1][2], m[2][0]), XMVectorMultiply(m[1][0], m[2][2]));
+	result.m[1][1] = XMVectorSubtract(XMVectorMultiply(m[0][0], m[2][2]), XMVectorMultiply(m[0][2], m[2][0]));
+	result.m[1][2] = XMVectorSubtract(XMVectorMultiply(m[0][2], m[1][0]), XMVectorMultiply(m[0][0], m[1][2]));
+	result.m[2][0] = XMVectorSubtract(XMVectorMultiply(m[1][0], m[2][1]), XMVectorMultiply(m[1][1], m[2][0]));
+	result.m[2][1] = XMVectorSubtract(XMVectorMultiply(m[0][1], m[2][0]), XMVectorMultiply(m[0][0], m[2][1]));
+	result.m[2][2] = XMVectorSubtract(XMVectorMultiply(m[0][0], m[1][1]), XMVectorMultiply(m[0][1], m[1][0]));
+
+	const auto determinant = XMVectorAdd(XMVectorAdd(XMVectorMultiply(m[0][0], result.m[0][0]), XMVectorMultiply(m[0][1], result.m[1][0])), XMVectorMultiply(m[0][2], result.m[2][0]));
+	const auto inverseDeterminant = XMVectorReciprocal(determinant);
+
+	for (unsigned int row = 0; row < 3; row++)
+	{
+		for (unsigned int column = 0; column < 3; column++)
+		{
+			result.m[row][column] = XMVectorMultiply(result.m[row][column], inverseDeterminant);
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+#include "ContactManifold.h"
+
+using namespace DirectX;
+
+//Contacts solved side by side, one per lane of an XMVECTOR
+auto const WIDE_SOLVER_LANES = 4u;
+
+//Velocity solve for up to four contacts at once. Each contact's bodies, inertia and basis are gathered into structure of arrays form
+//so every XMVECTOR holds one value for all four contacts, the friction impulse including the 3x3 inverse is worked out lane by lane,
+//then the changes are scattered back to the bodies. The contacts must not share a body, which the coloured batches already guarantee.
+//Same maths as ManifoldPoint::ApplyVelocityChange, but the results can differ from it in the last bits.
+//Only the velocity phase is wide and only four lanes, the XMVECTOR width. Eight lanes would need AVX2 code outside DirectXMath, and the
+//position phase still resolves one contact at a time through ManifoldPoint::ResolvePenetration
+class WideContactSolver
+{
+public:
+	WideContactSolver() = delete; // Default Constructor
+	WideContactSolver(const WideContactSolver& other) = delete; // Copy Constructor
+	WideContactSolver(WideContactSolver&& other) noexcept = delete; // Move Constructor
+	~WideContactSolver() = delete; // Destructor
+
+	WideContactSolver& operator = (const WideContactSolver& other) = delete; // Copy Assignment Operator
+	WideContactSolver& operator = (WideContactSolver&& other) noexcept = delete; // Move Assignment Operator
+
+	//Applies the impulse for each contact and writes the two velocity and angular velocity changes for each, like ApplyVelocityChange
+	static void ApplyVelocityChanges(ManifoldPoint* const points[], XMVECTOR* const velocityChanges[], XMVECTOR* const angularChanges[], const unsigned int pointCount);
+
+private:
+	//A 3D vector for every lane
+	struct Vector3 {
+		XMVECTOR x;
+		XMVECTOR y;
+		XMVECTOR z;
+	};
+
+	//A 3x3 matrix for every lane, row major like the XMMATRIX rows it's gathered from
+	struct Matrix3 {
+		XMVECTOR m[3][3];
+	};
+
+	static Vector3 Gather(const XMVECTOR values[]);
+	static void Scatter(const Vector3& lanes, XMVECTOR values[]);
+	static Matrix3 GatherRows(const XMMATRIX matrices[]);
+
+	static Vector3 Add(const Vector3& a, const Vector3& b);
+	static Vector3 Scale(const Vector3& a, const XMVECTOR& scale);
+	static Vector3 Cross(const Vector3& a, const Vector3& b);
+	static XMVECTOR Dot(const Vector3& a, const Vector3& b);
+
+	//Row vector times matrix, the same as XMVector3Transform
+	static Vector3 Transform(const Vector3& v, const Matrix3& matrix);
+
+	static Matrix3 Multiply(const Matrix3& a, const Matrix3& b);
+	static Matrix3 MultiplyTransposed(const Matrix3& a, const Matrix3& b);
+	static Matrix3 SkewSymmetric(const Vector3& v);
+	static Matrix3 Inverse(const Matrix3& matrix);
+};
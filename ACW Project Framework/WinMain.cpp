@@ -4,7 +4,7 @@
 //Windows entry point
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR pScmdline, int iCmdshow) {
 	
-	auto* system = new System();
+	auto* system = new System(pScmdline);
 
 	if (system->GetInitializationState())
 	{
@@ -0,0 +1,143 @@
+#include "WorkerPool.h"
+
+auto const MAXIMUM_DEFAULT_THREAD_COUNT = 16u;
+
+WorkerPool::WorkerPool(const unsigned int threadCount) : m_generation(0), m_busyWorkers(0), m_stopping(false), m_task(nullptr), m_taskCount(0), m_nextTask(0)
+{
+	StartWorkers(threadCount > 1 ? threadCount - 1 : 0);
+}
+
+WorkerPool::~WorkerPool()
+{
+	StopWorkers();
+}
+
+void WorkerPool::Run(const unsigned int taskCount, const function<void(unsigned int)>& task)
+{
+	if (m_workers.empty() || taskCount < 2)
+	{
+		for (unsigned int i = 0; i < taskCount; i++)
+		{
+			task(i);
+		}
+
+		return;
+	}
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		m_task = &task;
+		m_taskCount = taskCount;
+		m_nextTask = 0;
+		m_busyWorkers = static_cast<unsigned int>(m_workers.size());
+		m_generation++;
+	}
+
+	m_workAvailable.notify_all();
+
+	//The calling thread takes tasks too rather than sitting idle
+	RunTasks();
+
+	unique_lock<mutex> lock(m_mutex);
+	m_workFinished.wait(lock, [this]() { return m_busyWorkers == 0; });
+
+	m_task = nullptr;
+}
+
+void WorkerPool::SetThreadCount(const unsigned int threadCount)
+{
+	const auto workerCount = threadCount > 1 ? threadCount - 1 : 0;
+
+	if (workerCount == m_workers.size())
+	{
+		return;
+	}
+
+	StopWorkers();
+	StartWorkers(workerCount);
+}
+
+unsigned int WorkerPool::GetThreadCount() const
+{
+	return static_cast<unsigned int>(m_workers.size()) + 1;
+}
+
+unsigned int WorkerPool::GetDefaultThreadCount()
+{
+	const auto hardwareThreads = thread::hardware_concurrency();
+
+	if (hardwareThreads == 0)
+	{
+		return 1;
+	}
+
+	return hardwareThreads < MAXIMUM_DEFAULT_THREAD_COUNT ? hardwareThreads : MAXIMUM_DEFAULT_THREAD_COUNT;
+}
+
+void WorkerPool::StartWorkers(const unsigned int workerCount)
+{
+	m_stopping = false;
+
+	m_workers.reserve(workerCount);
+
+	for (unsigned int i = 0; i < workerCount; i++)
+	{
+		m_workers.emplace_back(&WorkerPool::WorkerLoop, this, m_generation);
+	}
+}
+
+void WorkerPool::StopWorkers()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+
+	m_workAvailable.notify_all();
+
+	for (auto& worker : m_workers)
+	{
+		worker.join();
+	}
+
+	m_workers.clear();
+}
+
+void WorkerPool::WorkerLoop(unsigned long long lastGeneration)
+{
+	//Only runs started after the worker was created count, they're what m_busyWorkers was set for
+	while (true)
+	{
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_workAvailable.wait(lock, [this, lastGeneration]() { return m_stopping || m_generation != lastGeneration; });
+
+			if (m_stopping)
+			{
+				return;
+			}
+
+			lastGeneration = m_generation;
+		}
+
+		RunTasks();
+
+		{
+			lock_guard<mutex> lock(m_mutex);
+
+			if (--m_busyWorkers == 0)
+			{
+				m_workFinished.notify_one();
+			}
+		}
+	}
+}
+
+void WorkerPool::RunTasks()
+{
+	for (auto task = m_nextTask++; task < m_taskCount; task = m_nextTask++)
+	{
+		(*m_task)(task);
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+using namespace std;
+
+//Persistent worker threads for splitting simulation work into tasks. Run hands out task indices to the workers and the calling thread
+//until they're all taken and returns once every task has finished, so anything the tasks wrote is safe to read straight after.
+//Which thread runs which task isn't fixed, work that needs the same result for any thread count has to be split by task rather than by thread
+class WorkerPool
+{
+public:
+	WorkerPool(const unsigned int threadCount); // Default Constructor
+	WorkerPool(const WorkerPool& other) = delete; // Copy Constructor
+	WorkerPool(WorkerPool&& other) noexcept = delete; // Move Constructor
+	~WorkerPool(); // Destructor
+
+	WorkerPool& operator = (const WorkerPool& other) = delete; // Copy Assignment Operator
+	WorkerPool& operator = (WorkerPool&& other) noexcept = delete; // Move Assignment Operator
+
+	//Calls task once for each index below taskCount, one task count or one thread runs everything on the calling thread
+	void Run(const unsigned int taskCount, const function<void(unsigned int)>& task);
+
+	//Includes the calling thread, so one means no workers. Must not be called while Run is running
+	void SetThreadCount(const unsigned int threadCount);
+	unsigned int GetThreadCount() const;
+
+	//Default thread count, one per hardware thread up to the most that has been measured to help
+	static unsigned int GetDefaultThreadCount();
+
+private:
+	void StartWorkers(const unsigned int workerCount);
+	void StopWorkers();
+
+	void WorkerLoop(unsigned long long lastGeneration);
+	void RunTasks();
+
+	vector<thread> m_workers;
+
+	mutex m_mutex;
+	condition_variable m_workAvailable;
+	condition_variable m_workFinished;
+
+	//Bumped for every Run so a worker can tell new work from a spurious wake up
+	unsigned long long m_generation;
+	unsigned int m_busyWorkers;
+	bool m_stopping;
+
+	const function<void(unsigned int)>* m_task;
+	unsigned int m_taskCount;
+	atomic<unsigned int> m_nextTask;
+};
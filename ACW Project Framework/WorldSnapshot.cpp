@@ -0,0 +1,354 @@
+#include "WorldSnapshot.h"
+#include "ResourceRegistry.h"
+
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#include "ResourceManager.h"
+#endif
+
+//"SNAP" in little endian, bump the version whenever the header, ObjectState or RigidBody::State changes
+auto const WORLD_SNAPSHOT_MAGIC = 0x50414E53u;
+auto const WORLD_SNAPSHOT_VERSION = 1u;
+
+WorldSnapshot::WorldSnapshot() = default;
+
+WorldSnapshot::WorldSnapshot(const WorldSnapshot& other) = default;
+
+WorldSnapshot::WorldSnapshot(WorldSnapshot&& other) noexcept = default;
+
+WorldSnapshot::~WorldSnapshot() = default;
+
+WorldSnapshot& WorldSnapshot::operator=(const WorldSnapshot& other) = default;
+
+WorldSnapshot& WorldSnapshot::operator=(WorldSnapshot&& other) noexcept = default;
+
+void WorldSnapshot::Capture(const vector<GameObject*>& gameObjects, const ResourceManager* resourceManager, const Settings& settings)
+{
+	const auto objectCount = static_cast<unsigned int>(gameObjects.size());
+
+	m_buffer.resize(sizeof(Header) + sizeof(ObjectState) * objectCount);
+	m_textureNames.clear();
+
+	//Snapshot texture index for each texture handle, handles are only meaningful to this run so the names are saved instead
+	vector<unsigned int> textureIndices;
+
+	auto* objectStates = reinterpret_cast<ObjectState*>(m_buffer.data() + sizeof(Header));
+
+	for (unsigned int i = 0; i < objectCount; i++)
+	{
+		const auto* gameObject = gameObjects[i];
+		auto& objectState = objectStates[i];
+
+		objectState = ObjectState();
+
+		gameObject->GetRigidBodyComponent()->GetState(objectState.rigidBody);
+
+		auto scale = XMVECTOR();
+		gameObject->GetScale(scale);
+		XMStoreFloat4(&objectState.scale, scale);
+
+		objectState.colliderType = gameObject->GetColliderComponent()->GetCollider();
+		objectState.modelType = gameObject->GetModelType();
+
+		if (objectState.colliderType == Collider::ColliderType::Plane)
+		{
+			const auto* planeCollider = dynamic_cast<PlaneCollider*>(gameObject->GetColliderComponent());
+
+			XMStoreFloat4(&objectState.planeNormal, planeCollider->GetNormal());
+			objectState.planeOffset = planeCollider->GetOffset();
+		}
+
+		objectState.textureIndex = 0;
+
+#ifdef _WIN32
+		if (resourceManager)
+		{
+			const auto textureHandle = gameObject->GetTextureHandle();
+
+			if (textureHandle >= textureIndices.size())
+			{
+				textureIndices.resize(textureHandle + 1, INVALID_RESOURCE_HANDLE);
+			}
+
+			if (textureIndices[textureHandle] == INVALID_RESOURCE_HANDLE)
+			{
+				textureIndices[textureHandle] = static_cast<unsigned int>(m_textureNames.size());
+				m_textureNames.push_back(resourceManager->GetTexturePath(textureHandle));
+			}
+
+			objectState.textureIndex = textureIndices[textureHandle];
+		}
+#endif
+	}
+
+	if (m_textureNames.empty() && objectCount > 0)
+	{
+		m_textureNames.emplace_back();
+	}
+
+	//Names go on the end as null terminated wide strings
+	auto textureNameBytes = 0u;
+
+	for (const auto& textureName : m_textureNames)
+	{
+		textureNameBytes += static_cast<unsigned int>((textureName.size() + 1) * sizeof(wchar_t));
+	}
+
+	m_buffer.resize(sizeof(Header) + sizeof(ObjectState) * objectCount + textureNameBytes);
+
+	auto* textureNames = reinterpret_cast<wchar_t*>(m_buffer.data() + sizeof(Header) + sizeof(ObjectState) * objectCount);
+
+	for (const auto& textureName : m_textureNames)
+	{
+		memcpy(textureNames, textureName.c_str(), (textureName.size() + 1) * sizeof(wchar_t));
+		textureNames += textureName.size() + 1;
+	}
+
+	Header header;
+	header.magic = WORLD_SNAPSHOT_MAGIC;
+	header.version = WORLD_SNAPSHOT_VERSION;
+	header.objectCount = objectCount;
+	header.textureCount = static_cast<unsigned int>(m_textureNames.size());
+	header.textureNameBytes = textureNameBytes;
+	header.settings = settings;
+
+	memcpy(m_buffer.data(), &header, sizeof(Header));
+}
+
+bool WorldSnapshot::Save(const char* fileName) const
+{
+	if (IsEmpty())
+	{
+		return false;
+	}
+
+	ofstream fout;
+
+	fout.open(fileName, ios::out | ios::binary | ios::trunc);
+
+	if (fout.fail())
+	{
+		return false;
+	}
+
+	fout.write(reinterpret_cast<const char*>(m_buffer.data()), static_cast<streamsize>(m_buffer.size()));
+
+	return !fout.fail();
+}
+
+bool WorldSnapshot::Load(const char* fileName)
+{
+	m_buffer.clear();
+	m_textureNames.clear();
+
+	ifstream fin;
+
+	fin.open(fileName, ios::in | ios::binary | ios::ate);
+
+	if (fin.fail())
+	{
+		return false;
+	}
+
+	const auto fileSize = static_cast<unsigned long long>(fin.tellg());
+
+	if (fileSize < sizeof(Header))
+	{
+		return false;
+	}
+
+	m_buffer.resize(static_cast<size_t>(fileSize));
+
+	fin.seekg(0, ios::beg);
+	fin.read(reinterpret_cast<char*>(m_buffer.data()), static_cast<streamsize>(fileSize));
+
+	if (fin.fail())
+	{
+		m_buffer.clear();
+		return false;
+	}
+
+	return Validate();
+}
+
+bool WorldSnapshot::Read(const unsigned char* data, const unsigned long long size)
+{
+	m_buffer.clear();
+	m_textureNames.clear();
+
+	if (size < sizeof(Header))
+	{
+		return false;
+	}
+
+	m_buffer.assign(data, data + size);
+
+	return Validate();
+}
+
+bool WorldSnapshot::MatchesObjects(const vector<GameObject*>& gameObjects) const
+{
+	if (IsEmpty() || gameObjects.size() != GetObjectCount())
+	{
+		return false;
+	}
+
+	for (unsigned int i = 0; i < gameObjects.size(); i++)
+	{
+		const auto& objectState = GetObjectState(i);
+
+		if (gameObjects[i]->GetColliderComponent()->GetCollider() != objectState.colliderType || gameObjects[i]->GetModelType() != objectState.modelType)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void WorldSnapshot::Apply(const vector<GameObject*>& gameObjects, ResourceManager* resourceManager) const
+{
+	//Look each name up once rather than once per object
+	vector<unsigned int> textureHandles;
+
+#ifdef _WIN32
+	if (resourceManager)
+	{
+		textureHandles.reserve(m_textureNames.size());
+
+		for (const auto& textureName : m_textureNames)
+		{
+			textureHandles.push_back(resourceManager->GetTextureHandle(textureName.c_str()));
+		}
+	}
+#endif
+
+	for (unsigned int i = 0; i < gameObjects.size(); i++)
+	{
+		auto* gameObject = gameObjects[i];
+		const auto& objectState = GetObjectState(i);
+
+		gameObject->GetRigidBodyComponent()->SetState(objectState.rigidBody);
+		gameObject->GetScaleComponent()->SetScale(XMLoadFloat4(&objectState.scale));
+
+		if (objectState.colliderType == Collider::ColliderType::Plane)
+		{
+			auto* planeCollider = dynamic_cast<PlaneCollider*>(gameObject->GetColliderComponent());
+
+			planeCollider->SetNormal(XMLoadFloat4(&objectState.planeNormal));
+			planeCollider->SetOffset(objectState.planeOffset);
+		}
+
+#ifdef _WIN32
+		if (!textureHandles.empty())
+		{
+			gameObject->SetTextureHandle(textureHandles[objectState.textureIndex]);
+		}
+#endif
+	}
+}
+
+bool WorldSnapshot::IsEmpty() const
+{
+	return m_buffer.size() < sizeof(Header);
+}
+
+unsigned int WorldSnapshot::GetObjectCount() const
+{
+	return IsEmpty() ? 0 : GetHeader().objectCount;
+}
+
+const WorldSnapshot::Settings& WorldSnapshot::GetSettings() const
+{
+	return GetHeader().settings;
+}
+
+const WorldSnapshot::ObjectState& WorldSnapshot::GetObjectState(const unsigned int index) const
+{
+	return reinterpret_cast<const ObjectState*>(m_buffer.data() + sizeof(Header))[index];
+}
+
+const wstring& WorldSnapshot::GetTextureName(const unsigned int textureIndex) const
+{
+	return m_textureNames[textureIndex];
+}
+
+const unsigned char* WorldSnapshot::GetData() const
+{
+	return m_buffer.data();
+}
+
+unsigned long long WorldSnapshot::GetSize() const
+{
+	return m_buffer.size();
+}
+
+const WorldSnapshot::Header& WorldSnapshot::GetHeader() const
+{
+	return *reinterpret_cast<const Header*>(m_buffer.data());
+}
+
+void WorldSnapshot::ReadTextureNames()
+{
+	const auto& header = GetHeader();
+
+	const auto* textureNames = reinterpret_cast<const wchar_t*>(m_buffer.data() + sizeof(Header) + sizeof(ObjectState) * header.objectCount);
+	const auto* textureNamesEnd = textureNames + header.textureNameBytes / sizeof(wchar_t);
+
+	while (textureNames < textureNamesEnd)
+	{
+		const auto* nameEnd = textureNames;
+
+		while (nameEnd < textureNamesEnd && *nameEnd != L'\0')
+		{
+			nameEnd++;
+		}
+
+		//A name without its terminator means the file is damaged, leaving the count short makes Load reject it
+		if (nameEnd == textureNamesEnd)
+		{
+			return;
+		}
+
+		m_textureNames.emplace_back(textureNames, nameEnd);
+		textureNames = nameEnd + 1;
+	}
+}
+
+bool WorldSnapshot::Validate()
+{
+	const auto& header = GetHeader();
+
+	if (header.magic != WORLD_SNAPSHOT_MAGIC || header.version != WORLD_SNAPSHOT_VERSION ||
+		m_buffer.size() != sizeof(Header) + sizeof(ObjectState) * static_cast<unsigned long long>(header.objectCount) + header.textureNameBytes ||
+		header.textureNameBytes % sizeof(wchar_t) != 0)
+	{
+		m_buffer.clear();
+		return false;
+	}
+
+	ReadTextureNames();
+
+	if (m_textureNames.size() != header.textureCount)
+	{
+		m_buffer.clear();
+		m_textureNames.clear();
+		return false;
+	}
+
+	for (unsigned int i = 0; i < header.objectCount; i++)
+	{
+		const auto& objectState = GetObjectState(i);
+
+		if (objectState.colliderType > Collider::ColliderType::Cylinder || objectState.modelType > Model::ModelType::Cylinder || objectState.textureIndex >= header.textureCount)
+		{
+			m_buffer.clear();
+			m_textureNames.clear();
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+#include "GameObject.h"
+
+using namespace std;
+
+class ResourceManager;
+
+//Complete simulation state of every game object so a settled scene can be saved once and restored instantly
+//Everything lives in one buffer laid out exactly like the file, a header then the object states then the texture names,
+//so saving is a single write and loading is a single read into storage that is only ever grown
+//Contacts are rebuilt from scratch every step so there's no solver state to carry over
+class WorldSnapshot
+{
+public:
+	//Simulation settings that affect the result, restored along with the objects
+	struct Settings {
+		float friction;
+		float restitution;
+		unsigned int sphereCount;
+		unsigned int cubeCount;
+	};
+
+	struct ObjectState {
+		RigidBody::State rigidBody;
+		XMFLOAT4 scale;
+		XMFLOAT4 planeNormal; //Only used by plane colliders
+		float planeOffset;
+		unsigned int colliderType;
+		unsigned int modelType;
+		unsigned int textureIndex; //Index into the snapshot's texture names
+	};
+
+	struct Header {
+		unsigned int magic;
+		unsigned int version;
+		unsigned int objectCount;
+		unsigned int textureCount;
+		unsigned int textureNameBytes;
+		Settings settings;
+	};
+
+	WorldSnapshot(); // Default Constructor
+	WorldSnapshot(const WorldSnapshot& other); // Copy Constructor
+	WorldSnapshot(WorldSnapshot&& other) noexcept; // Move Constructor
+	~WorldSnapshot(); // Destructor
+
+	WorldSnapshot& operator = (const WorldSnapshot& other); // Copy Assignment Operator
+	WorldSnapshot& operator = (WorldSnapshot&& other) noexcept; // Move Assignment Operator
+
+	//Copies the state of every object, the simulation must not be stepping while this runs. Headless worlds pass no resource manager,
+	//their objects have no textures so they all share one empty name that restores as the placeholder texture
+	void Capture(const vector<GameObject*>& gameObjects, const ResourceManager* resourceManager, const Settings& settings);
+
+	bool Save(const char* fileName) const;
+
+	//Fails for missing files and files written by another version, the snapshot is left empty
+	bool Load(const char* fileName);
+
+	//Same as Load but from a copy already in memory, such as one embedded in a replay
+	bool Read(const unsigned char* data, const unsigned long long size);
+
+	//True if the objects have the same count, colliders and models as the snapshot so the state can be written straight over them
+	bool MatchesObjects(const vector<GameObject*>& gameObjects) const;
+
+	//Writes the saved state over every object, MatchesObjects needs to be true. Textures are only set when there's a resource manager
+	void Apply(const vector<GameObject*>& gameObjects, ResourceManager* resourceManager) const;
+
+	bool IsEmpty() const;
+	unsigned int GetObjectCount() const;
+	const Settings& GetSettings() const;
+	const ObjectState& GetObjectState(const unsigned int index) const;
+	const wstring& GetTextureName(const unsigned int textureIndex) const;
+
+	//The snapshot exactly as Save writes it
+	const unsigned char* GetData() const;
+	unsigned long long GetSize() const;
+
+private:
+	const Header& GetHeader() const;
+	void ReadTextureNames();
+
+	//Checks a freshly read buffer, emptying it if it isn't a snapshot from this version
+	bool Validate();
+
+	//Header, object states and names back to back, never shrunk so capturing or loading the same world again doesn't allocate
+	vector<unsigned char> m_buffer;
+
+	vector<wstring> m_textureNames;
+};
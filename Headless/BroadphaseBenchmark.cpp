@@ -0,0 +1,154 @@
+#include "BroadphaseGrid.h"
+#include "HeadlessTest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+//BroadphaseGrid builds at 10k, 100k and 500k bodies for each worker thread count, checked against every pair tested directly at the
+//smallest size and against the single thread pairs at every size
+
+static const unsigned int g_bodyCounts[] = { 10000, 100000, 500000 };
+static const unsigned int g_threadCounts[] = { 1, 2, 4, 8, 16 };
+
+//Same cell size CollisionManager gives the grid
+auto const CELL_SIZE = 1.0f;
+
+//Bodies per unit of volume, kept the same at every size so the pairs per body stay about the same
+auto const BODY_DENSITY = 0.5f;
+
+//One body in this many is larger than a cell so the multi cell path is timed too
+auto const LARGE_BODY_INTERVAL = 100u;
+
+auto const DIRECT_CHECK_BODY_COUNT = 10000u;
+auto const BOUNDS_OVERLAP_SCALE = 1.0001f;
+
+static unsigned int GetRepeatCount(const unsigned int bodyCount)
+{
+	return max(1000000u / bodyCount, 2u);
+}
+
+static vector<XMFLOAT4> RandomBounds(const unsigned int bodyCount)
+{
+	//Fixed seed so every run builds the same grid
+	mt19937 random(4321);
+
+	const auto side = cbrt(bodyCount / BODY_DENSITY);
+
+	uniform_real_distribution<float> position(-side / 2, side / 2);
+	uniform_real_distribution<float> smallRadius(0.2f, 0.5f);
+	uniform_real_distribution<float> largeRadius(0.6f, 2.0f);
+
+	vector<XMFLOAT4> bounds(bodyCount);
+
+	for (auto i = 0u; i < bodyCount; i++)
+	{
+		const auto x = position(random);
+		const auto y = position(random);
+		const auto z = position(random);
+
+		bounds[i] = XMFLOAT4(x, y, z, i % LARGE_BODY_INTERVAL == 0 ? largeRadius(random) : smallRadius(random));
+	}
+
+	return bounds;
+}
+
+static vector<BroadphaseGrid::Pair> DirectPairs(const vector<XMFLOAT4>& bounds)
+{
+	vector<BroadphaseGrid::Pair> pairs;
+
+	for (auto i = 0u; i < bounds.size(); i++)
+	{
+		for (auto j = i + 1; j < bounds.size(); j++)
+		{
+			const auto x = bounds[i].x - bounds[j].x;
+			const auto y = bounds[i].y - bounds[j].y;
+			const auto z = bounds[i].z - bounds[j].z;
+			const auto radiusSum = (bounds[i].w + bounds[j].w) * BOUNDS_OVERLAP_SCALE;
+
+			if (x * x + y * y + z * z <= radiusSum * radiusSum)
+			{
+				pairs.push_back(BroadphaseGrid::Pair{ i, j });
+			}
+		}
+	}
+
+	return pairs;
+}
+
+static bool SamePairs(const vector<BroadphaseGrid::Pair>& pairsOne, const vector<BroadphaseGrid::Pair>& pairsTwo)
+{
+	return pairsOne.size() == pairsTwo.size() && equal(pairsOne.begin(), pairsOne.end(), pairsTwo.begin(), [](const BroadphaseGrid::Pair& pairOne, const BroadphaseGrid::Pair& pairTwo)
+	{
+		return pairOne.first == pairTwo.first && pairOne.second == pairTwo.second;
+	});
+}
+
+static vector<BroadphaseGrid::Pair> SortedPairs(vector<BroadphaseGrid::Pair> pairs)
+{
+	sort(pairs.begin(), pairs.end(), [](const BroadphaseGrid::Pair& pairOne, const BroadphaseGrid::Pair& pairTwo)
+	{
+		return pairOne.first < pairTwo.first || (pairOne.first == pairTwo.first && pairOne.second < pairTwo.second);
+	});
+
+	return pairs;
+}
+
+int main()
+{
+	WorkerPool workerPool(1);
+
+	printf("%u hardware threads\n", WorkerPool::GetDefaultThreadCount());
+	printf("   bodies  threads   build us  cells us  entries us  sort us  pairs us  speedup     pairs\n");
+
+	for (const auto bodyCount : g_bodyCounts)
+	{
+		const auto bounds = RandomBounds(bodyCount);
+
+		BroadphaseGrid broadphaseGrid(CELL_SIZE);
+
+		vector<BroadphaseGrid::Pair> singleThreadPairs;
+		auto singleThreadTime = 0.0;
+		auto pairsMatch = true;
+
+		for (const auto threadCount : g_threadCounts)
+		{
+			workerPool.SetThreadCount(threadCount);
+
+			BroadphaseGrid::Timings timings = {};
+
+			const auto buildTime = TimeMicroseconds(GetRepeatCount(bodyCount), [&]()
+			{
+				broadphaseGrid.Build(bounds, &workerPool);
+
+				timings.cellKeys += broadphaseGrid.GetTimings().cellKeys;
+				timings.entries += broadphaseGrid.GetTimings().entries;
+				timings.sort += broadphaseGrid.GetTimings().sort;
+				timings.pairs += broadphaseGrid.GetTimings().pairs;
+			});
+
+			//The warm up build is counted in the pass timings too
+			const auto buildCount = static_cast<float>(GetRepeatCount(bodyCount) + 1);
+
+			if (threadCount == g_threadCounts[0])
+			{
+				singleThreadPairs = broadphaseGrid.GetPairs();
+				singleThreadTime = buildTime;
+			}
+
+			pairsMatch = pairsMatch && SamePairs(broadphaseGrid.GetPairs(), singleThreadPairs);
+
+			printf("%9u  %7u  %9.0f  %8.0f  %10.0f  %7.0f  %8.0f  %7.2f  %8zu\n", bodyCount, threadCount, buildTime, timings.cellKeys / buildCount, timings.entries / buildCount,
+				timings.sort / buildCount, timings.pairs / buildCount, singleThreadTime / buildTime, broadphaseGrid.GetPairs().size());
+		}
+
+		Check(pairsMatch, "every thread count gives the same pairs in the same order");
+
+		if (bodyCount == DIRECT_CHECK_BODY_COUNT)
+		{
+			Check(SamePairs(SortedPairs(singleThreadPairs), DirectPairs(bounds)), "the grid finds exactly the pairs that overlap");
+		}
+	}
+
+	return CheckResult();
+}
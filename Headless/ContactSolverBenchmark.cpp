@@ -0,0 +1,63 @@
+#include "HeadlessWorld.h"
+#include "HeadlessTest.h"
+
+//ResolutionManager on a single island of 20k overlapping spheres on the floor for each worker thread count. Every thread count steps
+//its own world from the same block so the coloured batches have to leave them all in the same state. The floor stops the block
+//falling as one, so the velocity batches have closing contacts to solve as well as the position batches
+
+auto const BENCHMARK_BODY_COUNT = 20000u;
+auto const BENCHMARK_STEP_COUNT = 10u;
+auto const SPHERE_DIAMETER = 0.7f;
+
+//Just under the diameter so every sphere is pushed apart from the six next to it and the whole block is one island
+auto const SPHERE_SPACING = 0.68f;
+
+static const unsigned int g_threadCounts[] = { 1, 2, 4, 8, 16 };
+
+int main()
+{
+	printf("%u spheres, %u steps, %u hardware threads\n", BENCHMARK_BODY_COUNT, BENCHMARK_STEP_COUNT, WorkerPool::GetDefaultThreadCount());
+	printf("threads  resolve us  contacts  batches  speedup\n");
+
+	auto stateHash = 0ull;
+	auto statesMatch = true;
+	auto allColoured = true;
+	auto singleThreadTime = 0.0;
+
+	for (const auto threadCount : g_threadCounts)
+	{
+		HeadlessWorld world(threadCount);
+		world.AddFloor();
+		world.AddSphereBlock(BENCHMARK_BODY_COUNT, SPHERE_DIAMETER, SPHERE_SPACING);
+
+		auto resolveTime = 0.0;
+
+		for (auto step = 0u; step < BENCHMARK_STEP_COUNT; step++)
+		{
+			world.Step(HEADLESS_SIMULATION_STEP);
+
+			resolveTime += world.GetStageTimes().resolve;
+			allColoured = allColoured && world.GetResolutionManager()->GetBatchCount() > 0;
+		}
+
+		resolveTime /= BENCHMARK_STEP_COUNT;
+
+		if (threadCount == g_threadCounts[0])
+		{
+			stateHash = world.GetPhysicsManager()->CalculateStateHash();
+			singleThreadTime = resolveTime;
+		}
+
+		statesMatch = statesMatch && world.GetPhysicsManager()->CalculateStateHash() == stateHash;
+
+		printf("%7u  %10.0f  %8u  %7u  %7.2f\n", threadCount, resolveTime, world.GetCollisionManager()->GetContactManifoldReference()->GetNumberOfPoints(),
+			world.GetResolutionManager()->GetBatchCount(), singleThreadTime / resolveTime);
+	}
+
+	printf("State hash %016llx\n", stateHash);
+
+	Check(allColoured, "the pile is solved in coloured batches every step");
+	Check(statesMatch, "every thread count ends in the same state");
+
+	return CheckResult();
+}
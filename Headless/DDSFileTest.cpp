@@ -0,0 +1,211 @@
+#include "DDSFile.h"
+#include "HeadlessTest.h"
+#include "MappedFile.h"
+#include "PeakMemory.h"
+
+#include <vector>
+#include <cstring>
+
+//Header checks for ParseDDSFile on the textures the app ships with, mapped the way the texture workers map them, and on broken files built in memory
+
+static const char* const g_shippedFileNames[] = {
+	"bins.dds", "seafloor.dds", "sphere.dds", "sphere2.dds", "walls.dds",
+	"texture1.dds", "texture2.dds", "texture3.dds", "texture4.dds", "texture5.dds",
+	"texture6.dds", "texture7.dds", "texture8.dds", "texture9.dds", "texture10.dds"
+};
+
+auto const DXGI_FORMAT_R8G8B8A8_UNORM_VALUE = 28u;
+auto const D3D11_RESOURCE_DIMENSION_TEXTURE2D_VALUE = 3u;
+
+//A 4x4 32 bit RGBA file with a single mip, optionally using the DX10 header to say so
+static vector<uint8_t> MakeFile(const bool dx10)
+{
+	DDS_HEADER header;
+	memset(&header, 0, sizeof(header));
+
+	header.size = sizeof(DDS_HEADER);
+	header.flags = DDS_HEIGHT | DDS_WIDTH;
+	header.width = 4;
+	header.height = 4;
+	header.mipMapCount = 1;
+	header.ddspf.size = sizeof(DDS_PIXELFORMAT);
+
+	if (dx10)
+	{
+		header.ddspf.flags = DDS_FOURCC;
+		header.ddspf.fourCC = MAKEFOURCC('D', 'X', '1', '0');
+	}
+	else
+	{
+		header.ddspf.flags = DDS_RGB | DDS_ALPHA;
+		header.ddspf.RGBBitCount = 32;
+		header.ddspf.RBitMask = 0x000000ff;
+		header.ddspf.GBitMask = 0x0000ff00;
+		header.ddspf.BBitMask = 0x00ff0000;
+		header.ddspf.ABitMask = 0xff000000;
+	}
+
+	vector<uint8_t> file(sizeof(DDS_MAGIC) + sizeof(header));
+	memcpy(file.data(), &DDS_MAGIC, sizeof(DDS_MAGIC));
+	memcpy(file.data() + sizeof(DDS_MAGIC), &header, sizeof(header));
+
+	if (dx10)
+	{
+		DDS_HEADER_DXT10 dx10Header;
+		dx10Header.dxgiFormat = DXGI_FORMAT_R8G8B8A8_UNORM_VALUE;
+		dx10Header.resourceDimension = D3D11_RESOURCE_DIMENSION_TEXTURE2D_VALUE;
+		dx10Header.miscFlag = 0;
+		dx10Header.arraySize = 1;
+		dx10Header.miscFlags2 = 0;
+
+		const auto* bytes = reinterpret_cast<const uint8_t*>(&dx10Header);
+		file.insert(file.end(), bytes, bytes + sizeof(dx10Header));
+	}
+
+	//Every pixel is its own index so the data can be checked
+	for (auto i = 0u; i < 4 * 4 * 4; i++)
+	{
+		file.push_back(static_cast<uint8_t>(i));
+	}
+
+	return file;
+}
+
+static void TestShippedFiles()
+{
+	auto allMap = true;
+	auto allParse = true;
+	auto layoutsMatch = true;
+	auto sizesMatch = true;
+	auto mappedBytes = 0ull;
+
+	for (const auto* fileName : g_shippedFileNames)
+	{
+		MappedFile file;
+
+		if (!file.Open(fileName))
+		{
+			printf("%s doesn't map\n", fileName);
+			allMap = false;
+			continue;
+		}
+
+		file.Prefetch();
+		mappedBytes += file.GetSize();
+
+		const auto* data = file.GetData();
+		const auto size = static_cast<size_t>(file.GetSize());
+
+		DDSFileLayout layout;
+
+		if (!ParseDDSFile(data, size, layout))
+		{
+			printf("%s doesn't parse\n", fileName);
+			allParse = false;
+			continue;
+		}
+
+		layoutsMatch = layoutsMatch && layout.header == reinterpret_cast<const DDS_HEADER*>(data + sizeof(DDS_MAGIC)) && !layout.dx10Header;
+		layoutsMatch = layoutsMatch && layout.bitData == data + sizeof(DDS_MAGIC) + sizeof(DDS_HEADER) && layout.bitData + layout.bitSize == data + size;
+
+		//Every shipped texture is uncompressed with one mip, so the pixel data is exactly one image
+		sizesMatch = sizesMatch && layout.bitSize == static_cast<size_t>(layout.header->width) * layout.header->height * layout.header->ddspf.RGBBitCount / 8;
+	}
+
+	printf("Mapped %.1f MB of textures, peak resident %.1f MB\n", mappedBytes / (1024.0 * 1024.0), PeakResidentBytes() / (1024.0 * 1024.0));
+
+	Check(allMap, "every shipped texture maps");
+	Check(allParse, "every shipped texture parses");
+	Check(layoutsMatch, "the header and pixel data point into the file without a DX10 header");
+	Check(sizesMatch, "the pixel data is one whole image for every shipped texture");
+}
+
+static void TestValidFile()
+{
+	const auto file = MakeFile(false);
+
+	DDSFileLayout layout;
+
+	Check(ParseDDSFile(file.data(), file.size(), layout), "a plain file parses");
+	Check(layout.header && layout.header->width == 4 && layout.header->height == 4, "the header is read in place");
+	Check(layout.bitSize == 64 && layout.bitData[0] == 0 && layout.bitData[63] == 63, "the pixel data follows the header");
+}
+
+static void TestDX10Header()
+{
+	const auto file = MakeFile(true);
+
+	DDSFileLayout layout;
+
+	if (!Check(ParseDDSFile(file.data(), file.size(), layout), "a file with a DX10 header parses"))
+	{
+		return;
+	}
+
+	Check(layout.dx10Header != nullptr, "the DX10 header is found");
+	Check(layout.dx10Header && layout.dx10Header->dxgiFormat == DXGI_FORMAT_R8G8B8A8_UNORM_VALUE && layout.dx10Header->arraySize == 1, "the DX10 header is read in place");
+	Check(layout.bitData == file.data() + sizeof(DDS_MAGIC) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10) && layout.bitSize == 64, "the pixel data starts after the DX10 header");
+}
+
+static void TestTruncatedFiles()
+{
+	const auto file = MakeFile(false);
+	const auto dx10File = MakeFile(true);
+
+	DDSFileLayout layout;
+
+	Check(!ParseDDSFile(file.data(), 0, layout), "an empty file is rejected");
+	Check(!ParseDDSFile(nullptr, 0, layout), "no data is rejected");
+	Check(!ParseDDSFile(file.data(), sizeof(DDS_MAGIC), layout), "a file with only the magic number is rejected");
+	Check(!ParseDDSFile(file.data(), sizeof(DDS_MAGIC) + sizeof(DDS_HEADER) - 1, layout), "a file cut off inside the header is rejected");
+	Check(!ParseDDSFile(dx10File.data(), sizeof(DDS_MAGIC) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10) - 1, layout), "a file cut off inside the DX10 header is rejected");
+
+	//Both headers and no pixels is a valid layout, whether there's enough pixel data is up to the loader
+	Check(ParseDDSFile(file.data(), sizeof(DDS_MAGIC) + sizeof(DDS_HEADER), layout) && layout.bitSize == 0, "a file that's only headers parses with no pixel data");
+}
+
+static void TestBadHeaders()
+{
+	DDSFileLayout layout;
+
+	auto badMagic = MakeFile(false);
+	badMagic[3] = 'X';
+
+	Check(!ParseDDSFile(badMagic.data(), badMagic.size(), layout), "a file with the wrong magic number is rejected");
+	Check(layout.header == nullptr && layout.bitData == nullptr, "a rejected file leaves the layout empty");
+
+	auto badHeaderSize = MakeFile(false);
+	badHeaderSize[sizeof(DDS_MAGIC)] = 123;
+
+	Check(!ParseDDSFile(badHeaderSize.data(), badHeaderSize.size(), layout), "a file with the wrong header size is rejected");
+
+	auto badPixelFormatSize = MakeFile(false);
+	badPixelFormatSize[sizeof(DDS_MAGIC) + offsetof(DDS_HEADER, ddspf)] = 12;
+
+	Check(!ParseDDSFile(badPixelFormatSize.data(), badPixelFormatSize.size(), layout), "a file with the wrong pixel format size is rejected");
+}
+
+static void TestUnalignedData()
+{
+	//A file inside a larger buffer doesn't have to start on a four byte boundary
+	const auto file = MakeFile(true);
+
+	vector<uint8_t> buffer(file.size() + 1);
+	memcpy(buffer.data() + 1, file.data(), file.size());
+
+	DDSFileLayout layout;
+
+	Check(ParseDDSFile(buffer.data() + 1, file.size(), layout) && layout.dx10Header && layout.bitSize == 64, "a file that isn't four byte aligned parses");
+}
+
+int main()
+{
+	TestShippedFiles();
+	TestValidFile();
+	TestDX10Header();
+	TestTruncatedFiles();
+	TestBadHeaders();
+	TestUnalignedData();
+
+	return CheckResult();
+}
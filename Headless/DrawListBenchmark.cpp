@@ -0,0 +1,199 @@
+#include "DrawListBuilder.h"
+#include "HeadlessTest.h"
+
+#include <random>
+
+//Sort and bind elision checks for DrawListBuilder, then the time to build a 50k object draw list
+
+auto const BENCHMARK_OBJECT_COUNT = 50000u;
+auto const BENCHMARK_SHADER_COUNT = 3u;
+auto const BENCHMARK_TEXTURE_COUNT = 14u;
+auto const BENCHMARK_MODEL_COUNT = 4u;
+auto const BENCHMARK_REPEAT_COUNT = 50u;
+
+//Stand ins for shaders and texture views, the builder only uses the pointers as keys
+static int g_shaders[BENCHMARK_SHADER_COUNT];
+static int g_textures[BENCHMARK_TEXTURE_COUNT];
+
+struct DrawState {
+	unsigned int shader;
+	unsigned int texture;
+	unsigned int model;
+};
+
+static void AddObjects(DrawListBuilder& drawListBuilder, const vector<DrawState>& states)
+{
+	for (auto i = 0u; i < states.size(); i++)
+	{
+		drawListBuilder.Add(&g_shaders[states[i].shader], &g_textures[states[i].texture], states[i].model, i);
+	}
+}
+
+static vector<DrawState> RandomStates(const unsigned int objectCount)
+{
+	//Fixed seed so every run sorts the same list
+	mt19937 random(1234);
+
+	vector<DrawState> states(objectCount);
+
+	for (auto& state : states)
+	{
+		state.shader = random() % BENCHMARK_SHADER_COUNT;
+		state.texture = random() % BENCHMARK_TEXTURE_COUNT;
+		state.model = random() % BENCHMARK_MODEL_COUNT;
+	}
+
+	return states;
+}
+
+static void TestEmpty()
+{
+	DrawListBuilder drawListBuilder;
+
+	drawListBuilder.Build();
+
+	Check(drawListBuilder.GetSortedKeys().empty(), "an empty list builds to nothing");
+	Check(drawListBuilder.GetSortedStateChanges().shaderChanges == 0 && drawListBuilder.GetSortedStateChanges().modelChanges == 0, "an empty list needs no binds");
+}
+
+static void TestStateChangeCounts()
+{
+	DrawListBuilder drawListBuilder;
+
+	//Alternating between two textures and two models with one shader
+	const vector<DrawState> states = { { 0, 0, 0 }, { 0, 1, 1 }, { 0, 0, 0 }, { 0, 1, 1 }, { 0, 0, 0 }, { 0, 1, 1 } };
+
+	AddObjects(drawListBuilder, states);
+	drawListBuilder.Build();
+
+	const auto& unsortedStateChanges = drawListBuilder.GetUnsortedStateChanges();
+	const auto& sortedStateChanges = drawListBuilder.GetSortedStateChanges();
+
+	Check(unsortedStateChanges.shaderChanges == 1 && unsortedStateChanges.textureChanges == 6 && unsortedStateChanges.modelChanges == 6, "unsorted order binds the texture and model for every object");
+	Check(sortedStateChanges.shaderChanges == 1 && sortedStateChanges.textureChanges == 2 && sortedStateChanges.modelChanges == 2, "sorted order binds each texture and model once");
+}
+
+static void TestSortOrder()
+{
+	DrawListBuilder drawListBuilder;
+
+	const auto states = RandomStates(1000);
+
+	AddObjects(drawListBuilder, states);
+	drawListBuilder.Build();
+
+	const auto& sortedKeys = drawListBuilder.GetSortedKeys();
+
+	if (!Check(sortedKeys.size() == states.size(), "every object is in the sorted list"))
+	{
+		return;
+	}
+
+	auto grouped = true;
+	auto indicesInOrder = true;
+	auto statesMatch = true;
+
+	vector<bool> seen(states.size(), false);
+
+	for (auto i = 0u; i < sortedKeys.size(); i++)
+	{
+		const auto objectIndex = DrawListBuilder::GetObjectIndex(sortedKeys[i]);
+		seen[objectIndex] = true;
+
+		if (i > 0)
+		{
+			const auto previousState = DrawListBuilder::GetStateKey(sortedKeys[i - 1]);
+			const auto state = DrawListBuilder::GetStateKey(sortedKeys[i]);
+
+			grouped = grouped && previousState <= state;
+			indicesInOrder = indicesInOrder && (previousState != state || DrawListBuilder::GetObjectIndex(sortedKeys[i - 1]) < objectIndex);
+
+			//Objects sharing a state key must share the shader, texture and model they were added with
+			if (previousState == state)
+			{
+				const auto& previousObject = states[DrawListBuilder::GetObjectIndex(sortedKeys[i - 1])];
+				const auto& object = states[objectIndex];
+
+				statesMatch = statesMatch && previousObject.shader == object.shader && previousObject.texture == object.texture && previousObject.model == object.model;
+			}
+		}
+	}
+
+	auto allSeen = true;
+
+	for (const auto objectSeen : seen)
+	{
+		allSeen = allSeen && objectSeen;
+	}
+
+	Check(grouped, "keys come out in state order");
+	Check(indicesInOrder, "objects keep their original order within a state");
+	Check(statesMatch, "a state key stands for one shader, texture and model");
+	Check(allSeen, "every object index comes out exactly once");
+
+	const auto& sortedStateChanges = drawListBuilder.GetSortedStateChanges();
+
+	Check(sortedStateChanges.shaderChanges == BENCHMARK_SHADER_COUNT, "each shader is bound once");
+	Check(sortedStateChanges.textureChanges <= BENCHMARK_SHADER_COUNT * BENCHMARK_TEXTURE_COUNT, "each texture is bound at most once per shader");
+}
+
+static void TestStateIDsKeptBetweenFrames()
+{
+	DrawListBuilder drawListBuilder;
+
+	drawListBuilder.Add(&g_shaders[0], &g_textures[5], 0, 0);
+	drawListBuilder.Add(&g_shaders[0], &g_textures[2], 0, 1);
+	drawListBuilder.Build();
+
+	const auto firstFrameOrder = DrawListBuilder::GetObjectIndex(drawListBuilder.GetSortedKeys().front());
+
+	//The textures are added the other way round the next frame, the draw order shouldn't follow them
+	drawListBuilder.Clear();
+	drawListBuilder.Add(&g_shaders[0], &g_textures[2], 0, 0);
+	drawListBuilder.Add(&g_shaders[0], &g_textures[5], 0, 1);
+	drawListBuilder.Build();
+
+	const auto secondFrameOrder = DrawListBuilder::GetObjectIndex(drawListBuilder.GetSortedKeys().front());
+
+	Check(firstFrameOrder == 0 && secondFrameOrder == 1, "textures keep the id they were first given so batches draw in a stable order");
+}
+
+static void Benchmark()
+{
+	DrawListBuilder drawListBuilder;
+
+	const auto states = RandomStates(BENCHMARK_OBJECT_COUNT);
+
+	const auto addTime = TimeMicroseconds(BENCHMARK_REPEAT_COUNT, [&]()
+	{
+		drawListBuilder.Clear();
+		AddObjects(drawListBuilder, states);
+	});
+
+	const auto buildTime = TimeMicroseconds(BENCHMARK_REPEAT_COUNT, [&]()
+	{
+		drawListBuilder.Clear();
+		AddObjects(drawListBuilder, states);
+		drawListBuilder.Build();
+	}) - addTime;
+
+	const auto& unsortedStateChanges = drawListBuilder.GetUnsortedStateChanges();
+	const auto& sortedStateChanges = drawListBuilder.GetSortedStateChanges();
+
+	printf("%u objects, %u shaders, %u textures, %u models\n", BENCHMARK_OBJECT_COUNT, BENCHMARK_SHADER_COUNT, BENCHMARK_TEXTURE_COUNT, BENCHMARK_MODEL_COUNT);
+	printf("Add keys: %.1fus, sort and count: %.1fus, total: %.1fus (%.1f objects/us)\n", addTime, buildTime, addTime + buildTime, BENCHMARK_OBJECT_COUNT / (addTime + buildTime));
+	printf("State changes unsorted (shader/texture/model): %u/%u/%u\n", unsortedStateChanges.shaderChanges, unsortedStateChanges.textureChanges, unsortedStateChanges.modelChanges);
+	printf("State changes sorted (shader/texture/model): %u/%u/%u\n", sortedStateChanges.shaderChanges, sortedStateChanges.textureChanges, sortedStateChanges.modelChanges);
+}
+
+int main()
+{
+	TestEmpty();
+	TestStateChangeCounts();
+	TestSortOrder();
+	TestStateIDsKeptBetweenFrames();
+
+	Benchmark();
+
+	return CheckResult();
+}
@@ -0,0 +1,224 @@
+#include "FrustumCuller.h"
+#include "HeadlessTest.h"
+
+#include <random>
+
+//Visibility checks for FrustumCuller against a sphere by sphere reference, then culling throughput in objects per microsecond
+
+auto const BENCHMARK_OBJECT_COUNT = 100000u;
+auto const BENCHMARK_REPEAT_COUNT = 50u;
+
+//Same projection as D3DContainer with the camera where GraphicsRenderer starts it
+auto const FIELD_OF_VIEW = XM_PI / 4.0f;
+auto const ASPECT_RATIO = 1280.0f / 720.0f;
+auto const SCREEN_NEAR = 0.1f;
+auto const SCREEN_DEPTH = 1000.0f;
+
+struct Sphere {
+	XMFLOAT3 centre;
+	float radius;
+};
+
+static void GetCameraMatrices(const XMFLOAT3& position, XMMATRIX& viewMatrix, XMMATRIX& projectionMatrix)
+{
+	const auto eye = XMLoadFloat3(&position);
+
+	viewMatrix = XMMatrixLookAtLH(eye, XMVectorAdd(eye, XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f)), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	projectionMatrix = XMMatrixPerspectiveFovLH(FIELD_OF_VIEW, ASPECT_RATIO, SCREEN_NEAR, SCREEN_DEPTH);
+}
+
+static void AddSpheres(FrustumCuller& frustumCuller, const vector<Sphere>& spheres)
+{
+	for (const auto& sphere : spheres)
+	{
+		frustumCuller.Add(XMLoadFloat3(&sphere.centre), sphere.radius);
+	}
+}
+
+//The plain version of the test, a sphere is visible unless it's entirely behind one of the planes in clip space
+static vector<unsigned int> ReferenceCull(const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix, const vector<Sphere>& spheres)
+{
+	const auto viewProjection = XMMatrixTranspose(XMMatrixMultiply(viewMatrix, projectionMatrix));
+
+	const XMVECTOR planes[6] = {
+		XMPlaneNormalize(XMVectorAdd(viewProjection.r[3], viewProjection.r[0])),
+		XMPlaneNormalize(XMVectorSubtract(viewProjection.r[3], viewProjection.r[0])),
+		XMPlaneNormalize(XMVectorAdd(viewProjection.r[3], viewProjection.r[1])),
+		XMPlaneNormalize(XMVectorSubtract(viewProjection.r[3], viewProjection.r[1])),
+		XMPlaneNormalize(viewProjection.r[2]),
+		XMPlaneNormalize(XMVectorSubtract(viewProjection.r[3], viewProjection.r[2]))
+	};
+
+	vector<unsigned int> visibleIndices;
+
+	for (auto i = 0u; i < spheres.size(); i++)
+	{
+		auto visible = true;
+
+		for (const auto& plane : planes)
+		{
+			XMFLOAT4 p;
+			XMStoreFloat4(&p, plane);
+
+			//Summed in the same order as the culler so spheres right on a plane agree
+			const auto distance = spheres[i].centre.x * p.x + (spheres[i].centre.y * p.y + (spheres[i].centre.z * p.z + p.w));
+
+			visible = visible && distance >= -spheres[i].radius;
+		}
+
+		if (visible)
+		{
+			visibleIndices.push_back(i);
+		}
+	}
+
+	return visibleIndices;
+}
+
+static vector<Sphere> RandomSpheres(const unsigned int sphereCount)
+{
+	//Spread over a box a bit larger than the scene so some are off every side of the view, fixed seed so every run culls the same set
+	mt19937 random(1234);
+	uniform_real_distribution<float> x(-60.0f, 60.0f);
+	uniform_real_distribution<float> y(-20.0f, 70.0f);
+	uniform_real_distribution<float> z(-100.0f, 40.0f);
+	uniform_real_distribution<float> radius(0.05f, 1.0f);
+
+	vector<Sphere> spheres(sphereCount);
+
+	for (auto& sphere : spheres)
+	{
+		sphere.centre = XMFLOAT3(x(random), y(random), z(random));
+		sphere.radius = radius(random);
+	}
+
+	return spheres;
+}
+
+static void TestSingleSpheres()
+{
+	XMMATRIX viewMatrix;
+	XMMATRIX projectionMatrix;
+
+	GetCameraMatrices(XMFLOAT3(0.0f, 0.0f, 0.0f), viewMatrix, projectionMatrix);
+
+	FrustumCuller frustumCuller;
+	frustumCuller.ExtractPlanes(viewMatrix, projectionMatrix);
+
+	const vector<Sphere> spheres = {
+		{ XMFLOAT3(0.0f, 0.0f, 10.0f), 1.0f }, //Straight ahead
+		{ XMFLOAT3(0.0f, 0.0f, -10.0f), 1.0f }, //Behind the camera
+		{ XMFLOAT3(0.0f, 0.0f, 1100.0f), 1.0f }, //Past the far plane
+		{ XMFLOAT3(-100.0f, 0.0f, 10.0f), 1.0f }, //Off to the left
+		{ XMFLOAT3(0.0f, 50.0f, 10.0f), 1.0f }, //Above
+		{ XMFLOAT3(0.0f, 0.0f, 1000.5f), 1.0f }, //Centre past the far plane but overlapping it
+		{ XMFLOAT3(-10.0f, 0.0f, 10.0f), 5.0f } //Centre outside the left plane but overlapping it
+	};
+
+	frustumCuller.Clear();
+	AddSpheres(frustumCuller, spheres);
+	frustumCuller.Cull();
+
+	const vector<unsigned int> expected = { 0, 5, 6 };
+
+	Check(frustumCuller.GetVisibleIndices() == expected, "single spheres in front of, behind, beyond and overlapping the frustum");
+	Check(frustumCuller.GetObjectCount() == spheres.size(), "object count is the number of spheres added");
+}
+
+static void TestMatchesReference()
+{
+	XMMATRIX viewMatrix;
+	XMMATRIX projectionMatrix;
+
+	GetCameraMatrices(XMFLOAT3(0.0f, 25.0f, -70.0f), viewMatrix, projectionMatrix);
+
+	FrustumCuller frustumCuller;
+	frustumCuller.ExtractPlanes(viewMatrix, projectionMatrix);
+
+	//Counts that aren't a multiple of four check the padding never comes back as visible
+	for (const auto sphereCount : { 0u, 1u, 3u, 4u, 5u, 1001u })
+	{
+		const auto spheres = RandomSpheres(sphereCount);
+
+		frustumCuller.Clear();
+		AddSpheres(frustumCuller, spheres);
+		frustumCuller.Cull();
+
+		Check(frustumCuller.GetVisibleIndices() == ReferenceCull(viewMatrix, projectionMatrix, spheres), "four at a time culling matches the sphere by sphere test");
+	}
+}
+
+static void TestCullTwice()
+{
+	XMMATRIX viewMatrix;
+	XMMATRIX projectionMatrix;
+
+	GetCameraMatrices(XMFLOAT3(0.0f, 25.0f, -70.0f), viewMatrix, projectionMatrix);
+
+	FrustumCuller frustumCuller;
+	frustumCuller.ExtractPlanes(viewMatrix, projectionMatrix);
+
+	const auto spheres = RandomSpheres(10);
+
+	//More spheres added after a cull go on the end of the list, not after the padding
+	AddSpheres(frustumCuller, spheres);
+	frustumCuller.Cull();
+	AddSpheres(frustumCuller, spheres);
+	frustumCuller.Cull();
+
+	auto doubled = spheres;
+	doubled.insert(doubled.end(), spheres.begin(), spheres.end());
+
+	Check(frustumCuller.GetObjectCount() == 20, "spheres can be added after a cull");
+	Check(frustumCuller.GetVisibleIndices() == ReferenceCull(viewMatrix, projectionMatrix, doubled), "culling again after adding more spheres");
+}
+
+static void Benchmark()
+{
+	XMMATRIX viewMatrix;
+	XMMATRIX projectionMatrix;
+
+	GetCameraMatrices(XMFLOAT3(0.0f, 25.0f, -70.0f), viewMatrix, projectionMatrix);
+
+	FrustumCuller frustumCuller;
+
+	const auto spheres = RandomSpheres(BENCHMARK_OBJECT_COUNT);
+
+	frustumCuller.Clear();
+	AddSpheres(frustumCuller, spheres);
+
+	const auto cullTime = TimeMicroseconds(BENCHMARK_REPEAT_COUNT, [&]()
+	{
+		frustumCuller.ExtractPlanes(viewMatrix, projectionMatrix);
+		frustumCuller.Cull();
+	});
+
+	//What the render loop pays each frame, filling the sphere arrays as well as testing them
+	const auto frameTime = TimeMicroseconds(BENCHMARK_REPEAT_COUNT, [&]()
+	{
+		frustumCuller.ExtractPlanes(viewMatrix, projectionMatrix);
+		frustumCuller.Clear();
+		AddSpheres(frustumCuller, spheres);
+		frustumCuller.Cull();
+	});
+
+	const auto referenceTime = TimeMicroseconds(BENCHMARK_REPEAT_COUNT, [&]()
+	{
+		ReferenceCull(viewMatrix, projectionMatrix, spheres);
+	});
+
+	printf("%u spheres, %zu visible\n", BENCHMARK_OBJECT_COUNT, frustumCuller.GetVisibleIndices().size());
+	printf("Cull: %.1fus (%.1f objects/us), add and cull: %.1fus (%.1f objects/us)\n", cullTime, BENCHMARK_OBJECT_COUNT / cullTime, frameTime, BENCHMARK_OBJECT_COUNT / frameTime);
+	printf("Sphere by sphere reference: %.1fus (%.1f objects/us)\n", referenceTime, BENCHMARK_OBJECT_COUNT / referenceTime);
+}
+
+int main()
+{
+	TestSingleSpheres();
+	TestMatchesReference();
+	TestCullTwice();
+
+	Benchmark();
+
+	return CheckResult();
+}
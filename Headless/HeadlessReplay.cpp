@@ -0,0 +1,248 @@
+#include "HeadlessWorld.h"
+#include "HeadlessTest.h"
+#include "ReplayFile.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+//Plays a session replay with no window, writing the same per step timings file GraphicsRenderer::PlayReplay writes next to it.
+//HeadlessReplay <replay file> [thread count] plays a recording from the app. With no file it records a session of its own first,
+//then checks the playback takes the same steps and runs faster than real time
+
+auto const SCENE_FILE_NAME = "scene.txt";
+auto const RECORDED_STEP_COUNT = 600u;
+
+struct Playback {
+	unsigned int stepCount;
+	double simulatedTime;
+	double wallTime;
+	vector<unsigned long long> stateHashes;
+};
+
+//Does what GraphicsRenderer does for the record, the substep count is the only setting the world doesn't keep itself
+static void ApplyRecord(HeadlessWorld& world, const ReplayFile::Record& record, unsigned int& substepCount)
+{
+	switch (record.type)
+	{
+	case ReplayFile::RecordType::Step:
+		world.Step(record.value, substepCount);
+		break;
+	case ReplayFile::RecordType::SpawnSpheres:
+		world.AddSpheres(record.count, record.value);
+		break;
+	case ReplayFile::RecordType::SpawnCube:
+		world.AddCube();
+		break;
+	case ReplayFile::RecordType::ClearMoveable:
+		world.RemoveMoveable();
+		break;
+	case ReplayFile::RecordType::SetFriction:
+		world.SetFriction(record.value);
+		break;
+	case ReplayFile::RecordType::SetRestitution:
+		world.SetRestitution(record.value);
+		break;
+	case ReplayFile::RecordType::SetDeterministic:
+		world.GetCollisionManager()->SetDeterministic(record.count != 0);
+		break;
+	case ReplayFile::RecordType::SetWideSolver:
+		world.GetResolutionManager()->SetWideSolver(record.count != 0);
+		break;
+	case ReplayFile::RecordType::SetSubsteps:
+		//Kept in range so a damaged record can't stop the steps running
+		substepCount = min(max(static_cast<unsigned int>(record.count), 1u), HEADLESS_MAXIMUM_SUBSTEPS);
+		break;
+	default:
+		break;
+	}
+}
+
+static bool Play(const ReplayFile& replay, const unsigned int threadCount, const string& timingsFileName, Playback& playback)
+{
+	ofstream timings;
+
+	timings.open(timingsFileName, ios::out | ios::trunc);
+
+	if (timings.fail())
+	{
+		printf("Could not write the replay timings to %s\n", timingsFileName.c_str());
+		return false;
+	}
+
+	timings << "step,dt,time scale,objects,integrate us,detect us,resolve us,update us,state hash" << endl;
+
+	HeadlessWorld world(threadCount);
+
+	playback = Playback();
+
+	auto substepCount = 1u;
+
+	const auto playbackStart = chrono::steady_clock::now();
+
+	world.RestoreWorldSnapshot(replay.GetStartState());
+
+	for (const auto& record : replay.GetRecords())
+	{
+		ApplyRecord(world, record, substepCount);
+
+		if (record.type != ReplayFile::RecordType::Step)
+		{
+			continue;
+		}
+
+		const auto& stageTimes = world.GetStageTimes();
+		const auto stateHash = world.GetPhysicsManager()->CalculateStateHash();
+
+		timings << playback.stepCount << ',' << record.value << ',' << record.count << ',' << world.GetGameObjects().size() << ','
+			<< stageTimes.integrate << ',' << stageTimes.detect << ',' << stageTimes.resolve << ',' << stageTimes.update << ',' << hex << stateHash << dec << '\n';
+
+		playback.stateHashes.push_back(stateHash);
+		playback.simulatedTime += record.value;
+		playback.stepCount++;
+	}
+
+	playback.wallTime = chrono::duration<double>(chrono::steady_clock::now() - playbackStart).count();
+
+	return !timings.fail();
+}
+
+static void PrintPlayback(const Playback& playback, const string& timingsFileName)
+{
+	printf("%u steps, %.1f s simulated in %.2f s, %.0fx real time\n", playback.stepCount, playback.simulatedTime, playback.wallTime,
+		playback.wallTime > 0.0 ? playback.simulatedTime / playback.wallTime : 0.0);
+	printf("Timings written to %s\n", timingsFileName.c_str());
+}
+
+//A session like one in the app: spheres dropped into the scene, a cube, a change of friction and substeps part way through, then
+//everything cleared and dropped again. Returns the state hash after every step
+static vector<unsigned long long> RecordSession(const char* replayFileName)
+{
+	vector<unsigned long long> stateHashes;
+
+	HeadlessWorld world(1);
+
+	if (!Check(!world.AddScene(SCENE_FILE_NAME), "the scene file loads without a device"))
+	{
+		return stateHashes;
+	}
+
+	WorldSnapshot startState;
+	startState.Capture(world.GetGameObjects(), nullptr, world.GetWorldSettings());
+
+	ReplayFile replay;
+
+	if (!Check(replay.BeginRecording(replayFileName, startState), "the session records"))
+	{
+		return stateHashes;
+	}
+
+	auto substepCount = 1u;
+
+	const auto record = [&](const ReplayFile::RecordType type, const int count, const float value)
+	{
+		replay.AddRecord(type, count, value);
+		ApplyRecord(world, ReplayFile::Record { static_cast<unsigned int>(type), count, value }, substepCount);
+	};
+
+	record(ReplayFile::RecordType::SetDeterministic, 1, 0.0f);
+	record(ReplayFile::RecordType::SetWideSolver, 0, 0.0f);
+	record(ReplayFile::RecordType::SetSubsteps, 1, 0.0f);
+	record(ReplayFile::RecordType::SpawnSpheres, 150, 0.7f);
+
+	for (auto step = 0u; step < RECORDED_STEP_COUNT; step++)
+	{
+		switch (step)
+		{
+		case 100:
+			record(ReplayFile::RecordType::SpawnCube, 1, 0.0f);
+			break;
+		case 200:
+			record(ReplayFile::RecordType::SetFriction, 0, 0.6f);
+			record(ReplayFile::RecordType::SetSubsteps, 2, 0.0f);
+			break;
+		case 400:
+			record(ReplayFile::RecordType::ClearMoveable, 0, 0.0f);
+			record(ReplayFile::RecordType::SpawnSpheres, 60, 1.0f);
+			break;
+		default:
+			break;
+		}
+
+		record(ReplayFile::RecordType::Step, 1, HEADLESS_SIMULATION_STEP);
+		stateHashes.push_back(world.GetPhysicsManager()->CalculateStateHash());
+	}
+
+	replay.EndRecording();
+
+	return stateHashes;
+}
+
+static int PlayFile(const char* replayFileName, const unsigned int threadCount)
+{
+	ReplayFile replay;
+
+	if (!replay.Load(replayFileName))
+	{
+		printf("Could not load the replay %s\n", replayFileName);
+		return 1;
+	}
+
+	const auto timingsFileName = string(replayFileName) + ".csv";
+
+	Playback playback;
+
+	if (!Play(replay, threadCount, timingsFileName, playback))
+	{
+		return 1;
+	}
+
+	PrintPlayback(playback, timingsFileName);
+
+	return 0;
+}
+
+static int RecordAndPlay(const unsigned int threadCount)
+{
+	//Kept out of the framework folder the tests run in
+	const auto replayFileName = (filesystem::temp_directory_path() / "HeadlessReplay.replay").string();
+	const auto timingsFileName = replayFileName + ".csv";
+
+	const auto recordedHashes = RecordSession(replayFileName.c_str());
+
+	ReplayFile replay;
+
+	if (!Check(replay.Load(replayFileName.c_str()), "the recorded session loads"))
+	{
+		return CheckResult();
+	}
+
+	Playback playback;
+
+	if (Check(Play(replay, threadCount, timingsFileName, playback), "the timings are written"))
+	{
+		PrintPlayback(playback, timingsFileName);
+	}
+
+	Check(playback.stateHashes == recordedHashes, "playback takes exactly the steps that were recorded");
+	Check(playback.wallTime < playback.simulatedTime, "playback runs faster than real time");
+
+	filesystem::remove(replayFileName);
+	filesystem::remove(timingsFileName);
+
+	return CheckResult();
+}
+
+int main(int argc, char* argv[])
+{
+	const auto threadCount = argc > 2 ? static_cast<unsigned int>(max(atoi(argv[2]), 1)) : WorkerPool::GetDefaultThreadCount();
+
+	if (argc > 1)
+	{
+		return PlayFile(argv[1], threadCount);
+	}
+
+	return RecordAndPlay(threadCount);
+}
@@ -0,0 +1,141 @@
+#include "HeadlessWorld.h"
+#include "HeadlessTest.h"
+#include "SimulationThread.h"
+
+#include <thread>
+#include <algorithm>
+
+//The application's threading without the window. SimulationThread steps the scene and publishes every step through a TransformStore,
+//the main thread stands in for the renderer and checksums whatever snapshot is latest. Every snapshot it sees has to be a whole step,
+//in order, and match the same step taken on a single thread with nothing reading
+
+auto const SCENE_FILE_NAME = "scene.txt";
+auto const SPHERE_COUNT = 200;
+auto const SPHERE_DIAMETER = 0.7f;
+auto const STEP_COUNT = 300u;
+
+//Much faster than real time so the test doesn't take long, the consumer still misses steps the way a slow frame would
+auto const STEP_INTERVAL = 0.001f;
+auto const CONSUMER_FRAME_TIME = chrono::microseconds(2500);
+auto const TIMEOUT = chrono::seconds(60);
+
+static bool CreateWorld(HeadlessWorld& world)
+{
+	if (!Check(!world.AddScene(SCENE_FILE_NAME), "the scene file loads without a device"))
+	{
+		return false;
+	}
+
+	world.AddSpheres(SPHERE_COUNT, SPHERE_DIAMETER);
+
+	return true;
+}
+
+//Checksum of every step from the initial state to the last, index zero is the state before the first step
+static vector<unsigned int> SerialChecksums()
+{
+	HeadlessWorld world(1);
+	TransformStore transformStore;
+
+	vector<unsigned int> checksums;
+
+	if (!CreateWorld(world))
+	{
+		return checksums;
+	}
+
+	for (auto stepNumber = 0u; stepNumber <= STEP_COUNT; stepNumber++)
+	{
+		if (stepNumber > 0)
+		{
+			world.Step(HEADLESS_SIMULATION_STEP);
+		}
+
+		world.PublishTransforms(transformStore, stepNumber);
+		checksums.push_back(TransformStore::Checksum(transformStore.AcquireLatest()));
+	}
+
+	return checksums;
+}
+
+static void TestPublishedSnapshots(const vector<unsigned int>& serialChecksums)
+{
+	//At least two threads so the step is split into tasks even on one core
+	HeadlessWorld world(max(WorkerPool::GetDefaultThreadCount(), 2u));
+	TransformStore transformStore;
+	SimulationThread simulationThread;
+
+	if (!CreateWorld(world) || serialChecksums.size() != STEP_COUNT + 1)
+	{
+		return;
+	}
+
+	const auto bodyCount = world.GetGameObjects().size();
+
+	//Owned by the simulation thread until it's stopped
+	auto stepNumber = 0ull;
+	auto totalStepTime = 0.0;
+
+	world.PublishTransforms(transformStore, stepNumber);
+
+	simulationThread.Start([&]()
+	{
+		if (stepNumber == STEP_COUNT)
+		{
+			return;
+		}
+
+		const auto stepStart = chrono::steady_clock::now();
+
+		world.Step(HEADLESS_SIMULATION_STEP);
+
+		totalStepTime += chrono::duration<double, micro>(chrono::steady_clock::now() - stepStart).count();
+
+		world.PublishTransforms(transformStore, ++stepNumber);
+	}, STEP_INTERVAL);
+
+	auto lastStepNumber = 0ull;
+	auto snapshotsChecked = 0u;
+	auto inOrder = true;
+	auto wholeSnapshots = true;
+	auto matchesSerial = true;
+
+	const auto deadline = chrono::steady_clock::now() + TIMEOUT;
+
+	while (lastStepNumber < STEP_COUNT && chrono::steady_clock::now() < deadline)
+	{
+		const auto& snapshot = transformStore.AcquireLatest();
+
+		inOrder = inOrder && snapshot.stepNumber >= lastStepNumber;
+
+		if (snapshot.stepNumber != lastStepNumber || snapshotsChecked == 0)
+		{
+			wholeSnapshots = wholeSnapshots && snapshot.transforms.size() == bodyCount;
+			matchesSerial = matchesSerial && snapshot.stepNumber <= STEP_COUNT && TransformStore::Checksum(snapshot) == serialChecksums[snapshot.stepNumber];
+
+			lastStepNumber = snapshot.stepNumber;
+			snapshotsChecked++;
+		}
+
+		this_thread::sleep_for(CONSUMER_FRAME_TIME);
+	}
+
+	simulationThread.Stop();
+
+	Check(lastStepNumber == STEP_COUNT, "the consumer sees the last step before the timeout");
+	Check(inOrder, "published step numbers never go backwards");
+	Check(wholeSnapshots, "every snapshot holds every body");
+	Check(matchesSerial, "every snapshot matches the same step run on one thread");
+
+	printf("%zu bodies, %u steps on %u threads, %.1fus per step\n", bodyCount, STEP_COUNT, world.GetWorkerPool()->GetThreadCount(), totalStepTime / STEP_COUNT);
+	printf("Consumer checked %u snapshots, final checksum %08x\n", snapshotsChecked, serialChecksums.back());
+}
+
+int main()
+{
+	const auto serialChecksums = SerialChecksums();
+
+	TestPublishedSnapshots(serialChecksums);
+
+	return CheckResult();
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+using namespace std;
+
+//Checks and timing shared by the headless programs. A failed check is reported and counted rather than stopping the program,
+//so one run shows every failure and main returns CheckResult()
+
+inline unsigned int& FailedCheckCount()
+{
+	static auto failedCheckCount = 0u;
+	return failedCheckCount;
+}
+
+inline bool Check(const bool condition, const char* description)
+{
+	if (!condition)
+	{
+		printf("FAILED: %s\n", description);
+		FailedCheckCount()++;
+	}
+
+	return condition;
+}
+
+//Exit code for main, non zero if any check failed
+inline int CheckResult()
+{
+	if (FailedCheckCount() > 0)
+	{
+		printf("%u checks failed\n", FailedCheckCount());
+		return 1;
+	}
+
+	printf("All checks passed\n");
+	return 0;
+}
+
+//Average wall time of one call in microseconds, the first call is a warm up and isn't counted
+template <typename Function>
+double TimeMicroseconds(const unsigned int repeatCount, Function function)
+{
+	function();
+
+	const auto start = chrono::steady_clock::now();
+
+	for (auto i = 0u; i < repeatCount; i++)
+	{
+		function();
+	}
+
+	const auto end = chrono::steady_clock::now();
+
+	return chrono::duration<double, micro>(end - start).count() / repeatCount;
+}
@@ -0,0 +1,364 @@
+#include "HeadlessWorld.h"
+#include "SceneFile.h"
+
+#include <chrono>
+#include <cmath>
+
+//Same friction, restitution and solver settings GraphicsRenderer starts with
+auto const HEADLESS_FRICTION = 0.4f;
+auto const HEADLESS_RESTITUTION = 0.4f;
+
+static double ElapsedMicroseconds(const chrono::steady_clock::time_point& start, const chrono::steady_clock::time_point& end)
+{
+	return chrono::duration<double, micro>(end - start).count();
+}
+
+HeadlessWorld::HeadlessWorld(const unsigned int threadCount) : m_gameObjects(), m_bodyStateStore(nullptr), m_gameObjectFactory(nullptr), m_workerPool(nullptr), m_physicsManager(nullptr), m_collisionManager(nullptr), m_resolutionManager(nullptr), m_friction(HEADLESS_FRICTION), m_restitution(HEADLESS_RESTITUTION), m_stageTimes(), m_penetration()
+{
+	m_bodyStateStore = new BodyStateStore();
+	m_gameObjectFactory = new GameObjectFactory(m_gameObjects, m_bodyStateStore);
+	m_workerPool = new WorkerPool(threadCount);
+
+	m_physicsManager = new PhysicsManager(m_gameObjects, m_bodyStateStore);
+	m_collisionManager = new CollisionManager(m_gameObjects, m_friction, m_restitution);
+	m_resolutionManager = new ResolutionManager(m_collisionManager->GetContactManifoldReference(), 1000, 1000, 0.001f, 0.01f);
+
+	//Contacts always come out in the same order, so worlds with different thread counts can be compared step by step
+	m_collisionManager->SetDeterministic(true);
+
+	m_physicsManager->SetWorkerPool(m_workerPool);
+	m_collisionManager->SetWorkerPool(m_workerPool);
+	m_resolutionManager->SetWorkerPool(m_workerPool);
+}
+
+HeadlessWorld::~HeadlessWorld()
+{
+	for (auto* gameObject : m_gameObjects)
+	{
+		delete gameObject;
+	}
+
+	m_gameObjects.clear();
+
+	delete m_resolutionManager;
+	m_resolutionManager = nullptr;
+
+	delete m_collisionManager;
+	m_collisionManager = nullptr;
+
+	delete m_physicsManager;
+	m_physicsManager = nullptr;
+
+	delete m_workerPool;
+	m_workerPool = nullptr;
+
+	delete m_gameObjectFactory;
+	m_gameObjectFactory = nullptr;
+
+	delete m_bodyStateStore;
+	m_bodyStateStore = nullptr;
+}
+
+bool HeadlessWorld::AddScene(const char* fileName)
+{
+	SceneFile scene;
+
+	if (!scene.Load(fileName))
+	{
+		return true;
+	}
+
+	if (m_gameObjectFactory->AddScene(nullptr, nullptr, scene, nullptr, nullptr))
+	{
+		return true;
+	}
+
+	for (auto* gameObject : m_gameObjects)
+	{
+		gameObject->GetRigidBodyComponent()->ClearAccumulators();
+	}
+
+	return false;
+}
+
+void HeadlessWorld::AddSpheres(const int count, const float diameter)
+{
+	XMFLOAT3 startPosition(-7.5f, 38.75f, 0.0f);
+	auto distributionX = abs(startPosition.x * 2) / 7;
+
+	int totalCount = 0;
+	unsigned xCount = 1;
+	unsigned yCount = 1;
+
+	while (totalCount < count)
+	{
+		if (xCount == 7)
+		{
+			xCount = 1;
+			yCount++;
+		}
+
+		AddSphere(XMFLOAT3(startPosition.x + (xCount * distributionX), startPosition.y + (yCount * distributionX), 0.0f), diameter);
+
+		xCount++;
+		totalCount++;
+	}
+}
+
+void HeadlessWorld::AddSphere(const XMFLOAT3& position, const float diameter)
+{
+	m_gameObjectFactory->AddGameObject(nullptr, nullptr, position, XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(diameter / 2, diameter / 2, diameter / 2), XMFLOAT3(), XMFLOAT3(),
+		Collider::ColliderType::Sphere, Model::ModelType::Sphere, true, 0.5f, 0.3f, 0.3f,
+		nullptr, L"sphere2.dds", nullptr);
+
+	m_gameObjects.back()->GetRigidBodyComponent()->ClearAccumulators();
+}
+
+void HeadlessWorld::AddBox(const XMFLOAT3& position, const XMFLOAT3& rotation, const XMFLOAT3& scale)
+{
+	m_gameObjectFactory->AddGameObject(nullptr, nullptr, position, rotation, scale, XMFLOAT3(), XMFLOAT3(),
+		Collider::ColliderType::OBBCube, Model::ModelType::Cube, true, 0.2f, 0.1f, 0.1f,
+		nullptr, L"sphere.dds", nullptr);
+
+	m_gameObjects.back()->GetRigidBodyComponent()->ClearAccumulators();
+}
+
+void HeadlessWorld::AddCube()
+{
+	AddBox(XMFLOAT3(0.3f, 42.75f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.45f, 0.45f, 0.45f));
+}
+
+void HeadlessWorld::RemoveMoveable()
+{
+	for (unsigned i = 0; i < m_gameObjects.size(); i++)
+	{
+		if (m_gameObjects[i]->GetRigidBodyComponent()->GetUseGravity())
+		{
+			delete m_gameObjects[i];
+			m_gameObjects.erase(m_gameObjects.begin() + i);
+			--i;
+		}
+	}
+
+	m_bodyStateStore->Compact();
+}
+
+void HeadlessWorld::SetFriction(const float friction)
+{
+	m_friction = friction;
+	m_collisionManager->SetFriction(m_friction);
+}
+
+void HeadlessWorld::SetRestitution(const float restitution)
+{
+	m_restitution = restitution;
+	m_collisionManager->SetRestitution(m_restitution);
+}
+
+WorldSnapshot::Settings HeadlessWorld::GetWorldSettings() const
+{
+	WorldSnapshot::Settings settings;
+	settings.friction = m_friction;
+	settings.restitution = m_restitution;
+	settings.sphereCount = 0;
+	settings.cubeCount = 0;
+
+	for (const auto* gameObject : m_gameObjects)
+	{
+		if (gameObject->GetRigidBodyComponent()->GetUseGravity())
+		{
+			settings.sphereCount += gameObject->GetModelType() == Model::ModelType::Sphere ? 1 : 0;
+			settings.cubeCount += gameObject->GetModelType() == Model::ModelType::Cube ? 1 : 0;
+		}
+	}
+
+	return settings;
+}
+
+void HeadlessWorld::RestoreWorldSnapshot(const WorldSnapshot& worldSnapshot)
+{
+	if (!worldSnapshot.MatchesObjects(m_gameObjects))
+	{
+		for (auto* gameObject : m_gameObjects)
+		{
+			delete gameObject;
+		}
+
+		m_gameObjects.clear();
+		m_bodyStateStore->Compact();
+
+		m_gameObjectFactory->AddSnapshot(nullptr, nullptr, worldSnapshot, nullptr, nullptr);
+	}
+
+	worldSnapshot.Apply(m_gameObjects, nullptr);
+
+	SetFriction(worldSnapshot.GetSettings().friction);
+	SetRestitution(worldSnapshot.GetSettings().restitution);
+}
+
+void HeadlessWorld::AddFloor()
+{
+	m_gameObjectFactory->AddGameObject(nullptr, nullptr, XMFLOAT3(0.0f, 0.375f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(9.375f, 1.0f, 3.0f), XMFLOAT3(), XMFLOAT3(),
+		Collider::ColliderType::Plane, Model::ModelType::Plane, false, 0.5f, 0.2f, 0.1f,
+		nullptr, L"walls.dds", nullptr);
+
+	m_gameObjects.back()->SetPlaneColliderData(XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT3(9.375f, 1.0f, 0.0f), XMFLOAT3(0.0f, 1.0f, 9.375f), -1.0f);
+	m_gameObjects.back()->GetRigidBodyComponent()->ClearAccumulators();
+}
+
+void HeadlessWorld::AddSphereBlock(const unsigned int count, const float diameter, const float spacing)
+{
+	auto side = 1u;
+
+	while (side * side * side < count)
+	{
+		side++;
+	}
+
+	const auto offset = (side - 1) * spacing / 2;
+
+	m_gameObjects.reserve(m_gameObjects.size() + count);
+
+	for (auto i = 0u; i < count; i++)
+	{
+		const auto x = i % side;
+		const auto z = (i / side) % side;
+		const auto y = i / (side * side);
+
+		AddSphere(XMFLOAT3(x * spacing - offset, diameter / 2 + y * spacing, z * spacing - offset), diameter);
+	}
+}
+
+void HeadlessWorld::Step(const float dt, const unsigned int substepCount, const int substepPasses, const int colouredSubstepPasses)
+{
+	m_stageTimes = StageTimes();
+	m_penetration = Penetration();
+
+	const auto substepDt = dt / substepCount;
+
+	for (unsigned int substep = 0; substep < substepCount; substep++)
+	{
+		const auto stageStart = chrono::steady_clock::now();
+
+		m_physicsManager->CalculateGameObjectPhysics(substepDt);
+
+		const auto integrateEnd = chrono::steady_clock::now();
+
+		if (substep == 0)
+		{
+			m_collisionManager->DynamicCollisionDetection();
+
+			MeasurePenetration();
+
+			if (substepCount > 1)
+			{
+				m_resolutionManager->BeginSubsteps();
+			}
+		}
+
+		const auto detectEnd = chrono::steady_clock::now();
+
+		if (substepCount > 1)
+		{
+			m_resolutionManager->ResolveSubstep(substepDt, substepPasses, colouredSubstepPasses);
+		}
+		else
+		{
+			m_resolutionManager->ResolveContacts(dt);
+		}
+
+		const auto resolveEnd = chrono::steady_clock::now();
+
+		m_physicsManager->UpdateGameObjectPhysics();
+
+		const auto updateEnd = chrono::steady_clock::now();
+
+		m_stageTimes.integrate += ElapsedMicroseconds(stageStart, integrateEnd);
+		m_stageTimes.detect += ElapsedMicroseconds(integrateEnd, detectEnd);
+		m_stageTimes.resolve += ElapsedMicroseconds(detectEnd, resolveEnd);
+		m_stageTimes.update += ElapsedMicroseconds(resolveEnd, updateEnd);
+	}
+}
+
+void HeadlessWorld::PublishTransforms(TransformStore& transformStore, const unsigned long long stepNumber) const
+{
+	auto& snapshot = transformStore.GetWriteSnapshot();
+
+	snapshot.transforms.resize(m_gameObjects.size());
+
+	for (unsigned int i = 0; i < m_gameObjects.size(); i++)
+	{
+		auto position = XMVECTOR();
+		auto rotation = XMVECTOR();
+
+		m_gameObjects[i]->GetRigidBodyComponent()->GetPosition(position);
+		m_gameObjects[i]->GetRigidBodyComponent()->GetRotation(rotation);
+
+		XMStoreFloat3(&snapshot.transforms[i].position, position);
+		XMStoreFloat4(&snapshot.transforms[i].rotation, rotation);
+		snapshot.transforms[i].texture = nullptr;
+		snapshot.transforms[i].textureArray = nullptr;
+		snapshot.transforms[i].textureLayer = 0;
+	}
+
+	snapshot.stepNumber = stepNumber;
+	snapshot.stateHash = m_physicsManager->CalculateStateHash();
+	snapshot.broadphasePairCount = m_collisionManager->GetBroadphasePairCount();
+	snapshot.contactCount = m_collisionManager->GetContactManifoldReference()->GetNumberOfPoints();
+	snapshot.contactBatchCount = m_resolutionManager->GetBatchCount();
+
+	transformStore.Publish();
+}
+
+const vector<GameObject*>& HeadlessWorld::GetGameObjects() const
+{
+	return m_gameObjects;
+}
+
+PhysicsManager* HeadlessWorld::GetPhysicsManager() const
+{
+	return m_physicsManager;
+}
+
+CollisionManager* HeadlessWorld::GetCollisionManager() const
+{
+	return m_collisionManager;
+}
+
+ResolutionManager* HeadlessWorld::GetResolutionManager() const
+{
+	return m_resolutionManager;
+}
+
+WorkerPool* HeadlessWorld::GetWorkerPool() const
+{
+	return m_workerPool;
+}
+
+const HeadlessWorld::StageTimes& HeadlessWorld::GetStageTimes() const
+{
+	return m_stageTimes;
+}
+
+const HeadlessWorld::Penetration& HeadlessWorld::GetPenetration() const
+{
+	return m_penetration;
+}
+
+void HeadlessWorld::MeasurePenetration()
+{
+	auto* contactManifold = m_collisionManager->GetContactManifoldReference();
+	const auto contactCount = contactManifold->GetNumberOfPoints();
+
+	auto total = 0.0;
+
+	for (unsigned int i = 0; i < contactCount; i++)
+	{
+		const auto penetrationDepth = contactManifold->GetPoint(i).penetrationDepth;
+
+		total += penetrationDepth;
+		m_penetration.maximum = max(m_penetration.maximum, penetrationDepth);
+	}
+
+	m_penetration.mean = contactCount > 0 ? static_cast<float>(total / contactCount) : 0.0f;
+}
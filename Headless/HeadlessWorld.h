@@ -0,0 +1,116 @@
+#pragma once
+
+#include <vector>
+
+#include "GameObjectFactory.h"
+#include "PhysicsManager.h"
+#include "CollisionManager.h"
+#include "ResolutionManager.h"
+#include "BodyStateStore.h"
+#include "TransformStore.h"
+#include "WorkerPool.h"
+#include "WorldSnapshot.h"
+
+using namespace std;
+
+//Same step as GraphicsRenderer's deterministic mode
+auto const HEADLESS_SIMULATION_STEP = 1.0f / 60.0f;
+
+//Same limit as GraphicsRenderer's substep setting
+auto const HEADLESS_MAXIMUM_SUBSTEPS = 8u;
+
+//The physics half of GraphicsRenderer without a window, device or renderer. Bodies are created with no device or resource manager,
+//so they get their model type for the inertia tensor but no buffers, texture or shader
+class HeadlessWorld
+{
+public:
+	//Time spent in each stage of the last step in microseconds, the same stages GraphicsRenderer times
+	struct StageTimes {
+		double integrate;
+		double detect;
+		double resolve;
+		double update;
+	};
+
+	//Penetration of the contacts collision detection found in the last step, before they were resolved
+	struct Penetration {
+		float mean;
+		float maximum;
+	};
+
+	HeadlessWorld(const unsigned int threadCount); // Default Constructor
+	HeadlessWorld(const HeadlessWorld& other) = delete; // Copy Constructor
+	HeadlessWorld(HeadlessWorld&& other) noexcept = delete; // Move Constructor
+	~HeadlessWorld(); // Destructor
+
+	HeadlessWorld& operator = (const HeadlessWorld& other) = delete; // Copy Assignment Operator
+	HeadlessWorld& operator = (HeadlessWorld&& other) noexcept = delete; // Move Assignment Operator
+
+	//Returns true if the scene couldn't be loaded or created, like GameObjectFactory::AddScene
+	bool AddScene(const char* fileName);
+
+	//Same grid GraphicsRenderer::SpawnSpheres drops them from
+	void AddSpheres(const int count, const float diameter);
+	void AddSphere(const XMFLOAT3& position, const float diameter);
+
+	//An oriented box with the mass and drag GraphicsRenderer::SpawnCube gives its cubes, the rotation is roll, pitch and yaw like the
+	//scene file. Any scale with two different sides gives a tensor that has to be rebuilt as the box turns
+	void AddBox(const XMFLOAT3& position, const XMFLOAT3& rotation, const XMFLOAT3& scale);
+
+	//The cube GraphicsRenderer::SpawnCube drops
+	void AddCube();
+
+	//Every body that uses gravity, like GraphicsRenderer::RemoveMoveableGameObjects
+	void RemoveMoveable();
+
+	void SetFriction(const float friction);
+	void SetRestitution(const float restitution);
+
+	//Settings to capture a snapshot with, the sphere and cube counts are the moving bodies of each model
+	WorldSnapshot::Settings GetWorldSettings() const;
+
+	//Same as GraphicsRenderer::RestoreWorldSnapshot, the state is written straight over the objects if they match the snapshot's and
+	//the objects are rebuilt first if they don't
+	void RestoreWorldSnapshot(const WorldSnapshot& worldSnapshot);
+
+	//The floor plane from scene.txt on its own. Its contact test leaves a resting sphere's centre at one minus its radius, so
+	//a sphere of diameter 0.7 sits at 0.65 rather than on y = 0
+	void AddFloor();
+
+	//Spheres in a cube lattice spacing apart, resting on y = 0 and centred on x and z. A spacing below the diameter leaves every
+	//sphere overlapping its neighbours, so the whole block is one pile of contacts from the first step
+	void AddSphereBlock(const unsigned int count, const float diameter, const float spacing);
+
+	//One step of every stage in the same order as GraphicsRenderer::RunSimulationStages, the passes are the sweeps each substep gets
+	//when the contacts are solved one at a time and when they go through the coloured batches
+	void Step(const float dt, const unsigned int substepCount = 1, const int substepPasses = SUBSTEP_SOLVER_PASSES, const int colouredSubstepPasses = COLOURED_SUBSTEP_SOLVER_PASSES);
+
+	//Copies every body's transform into the store's write snapshot and publishes it, like GraphicsRenderer::PublishTransforms
+	void PublishTransforms(TransformStore& transformStore, const unsigned long long stepNumber) const;
+
+	const vector<GameObject*>& GetGameObjects() const;
+	PhysicsManager* GetPhysicsManager() const;
+	CollisionManager* GetCollisionManager() const;
+	ResolutionManager* GetResolutionManager() const;
+	WorkerPool* GetWorkerPool() const;
+	const StageTimes& GetStageTimes() const;
+	const Penetration& GetPenetration() const;
+
+private:
+	void MeasurePenetration();
+
+	vector<GameObject*> m_gameObjects;
+
+	BodyStateStore* m_bodyStateStore;
+	GameObjectFactory* m_gameObjectFactory;
+	WorkerPool* m_workerPool;
+	PhysicsManager* m_physicsManager;
+	CollisionManager* m_collisionManager;
+	ResolutionManager* m_resolutionManager;
+
+	float m_friction;
+	float m_restitution;
+
+	StageTimes m_stageTimes;
+	Penetration m_penetration;
+};
@@ -0,0 +1,76 @@
+#include "HeadlessWorld.h"
+#include "HeadlessTest.h"
+
+//World inertia tensors rebuilt per frame in the scene with spheres and boxes dropped into it. Rebuilding every moving body on every
+//integration, as the original CalculateDerivedData did before the penetration fixes rebuilt them again, would cost one per moving body
+//a frame. Now only bodies whose rotation changed rebuild, and spheres and cubes never do as their tensor is the same in every orientation
+
+auto const SCENE_FILE_NAME = "scene.txt";
+auto const SPHERE_COUNT = 200;
+auto const SPHERE_DIAMETER = 0.7f;
+auto const BOX_COUNT = 60u;
+auto const BOXES_PER_ROW = 10u;
+auto const BOX_SPACING = 1.2f;
+auto const STEP_COUNT = 600u;
+
+int main()
+{
+	HeadlessWorld world(1);
+
+	if (!Check(!world.AddScene(SCENE_FILE_NAME), "the scene file loads without a device"))
+	{
+		return CheckResult();
+	}
+
+	world.AddSpheres(SPHERE_COUNT, SPHERE_DIAMETER);
+
+	//Rows above the spheres, tilted so they tumble when they land. Every other box is a cube, which never needs a rebuild
+	for (auto i = 0u; i < BOX_COUNT; i++)
+	{
+		const auto scale = i % 2 == 0 ? XMFLOAT3(0.4f, 0.25f, 0.3f) : XMFLOAT3(0.3f, 0.3f, 0.3f);
+
+		world.AddBox(XMFLOAT3(-5.4f + (i % BOXES_PER_ROW) * BOX_SPACING, 48.0f + (i / BOXES_PER_ROW) * BOX_SPACING, 0.0f), XMFLOAT3(0.1f, 0.2f, 0.3f), scale);
+	}
+
+	auto movingBodyCount = 0u;
+	auto anisotropicBodyCount = 0u;
+
+	for (const auto* gameObject : world.GetGameObjects())
+	{
+		const auto* rigidBody = gameObject->GetRigidBodyComponent();
+
+		if (rigidBody->GetUseGravity())
+		{
+			movingBodyCount++;
+			anisotropicBodyCount += rigidBody->HasIsotropicInertia() ? 0 : 1;
+		}
+	}
+
+	auto* physicsManager = world.GetPhysicsManager();
+
+	auto totalRebuilds = 0ull;
+	auto mostRebuilds = 0ull;
+	auto integrateTime = 0.0;
+
+	for (auto step = 0u; step < STEP_COUNT; step++)
+	{
+		const auto rebuildsBefore = physicsManager->GetDerivedDataUpdateCount();
+
+		world.Step(HEADLESS_SIMULATION_STEP);
+
+		const auto rebuilds = physicsManager->GetDerivedDataUpdateCount() - rebuildsBefore;
+
+		totalRebuilds += rebuilds;
+		mostRebuilds = max(mostRebuilds, rebuilds);
+		integrateTime += world.GetStageTimes().integrate / STEP_COUNT;
+	}
+
+	printf("%u moving bodies, %u of them boxes with unequal sides, %u frames\n", movingBodyCount, anisotropicBodyCount, STEP_COUNT);
+	printf("Rebuilds per frame: mean %.1f, most %llu, rebuilding every moving body would be %u\n", static_cast<double>(totalRebuilds) / STEP_COUNT, mostRebuilds, movingBodyCount);
+	printf("Integration %.0f us per frame\n", integrateTime);
+
+	Check(totalRebuilds > 0, "the tumbling boxes rebuild their tensors");
+	Check(mostRebuilds <= anisotropicBodyCount, "no body rebuilds more than once a frame and spheres and cubes never do");
+
+	return CheckResult();
+}
@@ -0,0 +1,148 @@
+#include "InstanceBatcher.h"
+#include "HeadlessTest.h"
+
+#include <cmath>
+
+//Batching checks for InstanceBatcher, then the time to pack a frame's worth of instances
+
+auto const BENCHMARK_OBJECT_COUNT = 50000u;
+auto const BENCHMARK_MODEL_COUNT = 4u;
+auto const BENCHMARK_TEXTURE_COUNT = 10u;
+auto const BENCHMARK_REPEAT_COUNT = 50u;
+
+//Stand ins for texture views, the batcher only compares the pointers
+static int g_textures[BENCHMARK_TEXTURE_COUNT];
+
+static void AddObject(InstanceBatcher& instanceBatcher, const unsigned int modelKey, const unsigned int textureIndex, const unsigned int textureLayer, const unsigned int objectIndex)
+{
+	const auto position = XMVectorSet(static_cast<float>(objectIndex), 1.0f, 2.0f, 0.0f);
+	const auto scale = XMVectorSet(0.5f, 0.5f, 0.5f, 0.0f);
+
+	instanceBatcher.Add(modelKey, &g_textures[textureIndex], textureLayer, objectIndex, position, XMQuaternionIdentity(), scale);
+}
+
+static void TestEmpty()
+{
+	InstanceBatcher instanceBatcher;
+
+	Check(instanceBatcher.GetBatches().empty(), "a new batcher has no batches");
+	Check(instanceBatcher.GetInstances().empty(), "a new batcher has no instances");
+	Check(instanceBatcher.GetLargestBatchSize() == 0, "a new batcher has no largest batch");
+}
+
+static void TestBatchesSplitOnModelAndTexture()
+{
+	InstanceBatcher instanceBatcher;
+
+	//Three objects sharing model 0 and texture 0, two with texture 1, then one with model 1 and texture 1
+	AddObject(instanceBatcher, 0, 0, 0, 10);
+	AddObject(instanceBatcher, 0, 0, 0, 11);
+	AddObject(instanceBatcher, 0, 0, 0, 12);
+	AddObject(instanceBatcher, 0, 1, 0, 13);
+	AddObject(instanceBatcher, 0, 1, 0, 14);
+	AddObject(instanceBatcher, 1, 1, 0, 15);
+
+	const auto& batches = instanceBatcher.GetBatches();
+
+	if (!Check(batches.size() == 3, "a new batch starts whenever the model or texture changes"))
+	{
+		return;
+	}
+
+	Check(batches[0].firstInstance == 0 && batches[0].instanceCount == 3, "first batch covers the first three instances");
+	Check(batches[1].firstInstance == 3 && batches[1].instanceCount == 2, "second batch covers the next two instances");
+	Check(batches[2].firstInstance == 5 && batches[2].instanceCount == 1, "third batch covers the last instance");
+
+	Check(batches[0].objectIndex == 10 && batches[1].objectIndex == 13 && batches[2].objectIndex == 15, "each batch keeps the index of its first object");
+	Check(batches[1].textureKey == &g_textures[1] && batches[2].modelKey == 1, "batches keep their model and texture keys");
+
+	Check(instanceBatcher.GetInstances().size() == 6, "every object gets an instance");
+	Check(instanceBatcher.GetLargestBatchSize() == 3, "largest batch size is counted");
+}
+
+static void TestTextureLayerDoesNotSplit()
+{
+	InstanceBatcher instanceBatcher;
+
+	for (auto i = 0u; i < 4; i++)
+	{
+		AddObject(instanceBatcher, 0, 0, i, i);
+	}
+
+	Check(instanceBatcher.GetBatches().size() == 1, "objects only differing by texture layer share a batch");
+
+	auto layersInOrder = true;
+
+	for (auto i = 0u; i < instanceBatcher.GetInstances().size(); i++)
+	{
+		layersInOrder = layersInOrder && instanceBatcher.GetInstances()[i].textureLayer == i;
+	}
+
+	Check(layersInOrder, "texture layers are kept per instance");
+}
+
+static void TestWorldMatrix()
+{
+	InstanceBatcher instanceBatcher;
+
+	//A quarter turn about y, scaled by two and moved to (1, 2, 3)
+	const auto rotation = XMQuaternionRotationAxis(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), XM_PIDIV2);
+	instanceBatcher.Add(0, &g_textures[0], 0, 0, XMVectorSet(1.0f, 2.0f, 3.0f, 0.0f), rotation, XMVectorSet(2.0f, 2.0f, 2.0f, 0.0f));
+
+	const auto& worldMatrix = instanceBatcher.GetInstances()[0].worldMatrix;
+
+	//Row vectors, so x goes to -z and the translation is the last row
+	Check(fabsf(worldMatrix._11) < 1e-5f && fabsf(worldMatrix._13 + 2.0f) < 1e-5f, "scale then rotation in the upper 3x3");
+	Check(worldMatrix._41 == 1.0f && worldMatrix._42 == 2.0f && worldMatrix._43 == 3.0f && worldMatrix._44 == 1.0f, "translation in the last row");
+}
+
+static void TestClear()
+{
+	InstanceBatcher instanceBatcher;
+
+	AddObject(instanceBatcher, 0, 0, 0, 0);
+	AddObject(instanceBatcher, 0, 0, 0, 1);
+
+	instanceBatcher.Clear();
+	AddObject(instanceBatcher, 1, 1, 0, 2);
+
+	Check(instanceBatcher.GetBatches().size() == 1 && instanceBatcher.GetInstances().size() == 1, "clear drops the previous frame's batches");
+	Check(instanceBatcher.GetBatches()[0].firstInstance == 0, "batches start from the beginning again after a clear");
+	Check(instanceBatcher.GetLargestBatchSize() == 1, "clear resets the largest batch size");
+}
+
+static void Benchmark()
+{
+	InstanceBatcher instanceBatcher;
+
+	//Objects arrive in draw list order, so everything with the same model and texture is next to each other
+	const auto objectsPerBatch = BENCHMARK_OBJECT_COUNT / (BENCHMARK_MODEL_COUNT * BENCHMARK_TEXTURE_COUNT);
+
+	const auto time = TimeMicroseconds(BENCHMARK_REPEAT_COUNT, [&]()
+	{
+		instanceBatcher.Clear();
+
+		for (auto i = 0u; i < BENCHMARK_OBJECT_COUNT; i++)
+		{
+			const auto batch = i / objectsPerBatch;
+			AddObject(instanceBatcher, batch / BENCHMARK_TEXTURE_COUNT, batch % BENCHMARK_TEXTURE_COUNT, i % 8, i);
+		}
+	});
+
+	Check(instanceBatcher.GetBatches().size() == BENCHMARK_MODEL_COUNT * BENCHMARK_TEXTURE_COUNT, "benchmark frame packs into one batch per model and texture");
+
+	printf("Packed %u objects into %zu batches in %.1fus, %.1f objects/us\n", BENCHMARK_OBJECT_COUNT, instanceBatcher.GetBatches().size(), time, BENCHMARK_OBJECT_COUNT / time);
+}
+
+int main()
+{
+	TestEmpty();
+	TestBatchesSplitOnModelAndTexture();
+	TestTextureLayerDoesNotSplit();
+	TestWorldMatrix();
+	TestClear();
+
+	Benchmark();
+
+	return CheckResult();
+}
@@ -0,0 +1,66 @@
+#include "HeadlessWorld.h"
+#include "HeadlessTest.h"
+
+//PhysicsManager's integration and update passes over 100k bodies for each worker thread count. A serial world is stepped alongside
+//and has to end every thread count with the same state
+
+auto const BENCHMARK_BODY_COUNT = 100000u;
+auto const BENCHMARK_REPEAT_COUNT = 20u;
+auto const SPHERE_DIAMETER = 0.7f;
+
+//Far enough apart that nothing touches, only integration is being timed
+auto const SPHERE_SPACING = 1.0f;
+
+static const unsigned int g_threadCounts[] = { 1, 2, 4, 8, 16 };
+
+static void Integrate(HeadlessWorld& world)
+{
+	world.GetPhysicsManager()->CalculateGameObjectPhysics(HEADLESS_SIMULATION_STEP);
+}
+
+int main()
+{
+	HeadlessWorld world(1);
+	HeadlessWorld serialWorld(1);
+
+	world.AddSphereBlock(BENCHMARK_BODY_COUNT, SPHERE_DIAMETER, SPHERE_SPACING);
+	serialWorld.AddSphereBlock(BENCHMARK_BODY_COUNT, SPHERE_DIAMETER, SPHERE_SPACING);
+
+	//The serial world never gets a worker pool so its chunks run one after another on this thread
+	serialWorld.GetPhysicsManager()->SetWorkerPool(nullptr);
+
+	printf("%u bodies, %u hardware threads\n", BENCHMARK_BODY_COUNT, WorkerPool::GetDefaultThreadCount());
+	printf("threads  integrate us  update us  bodies per us  speedup\n");
+
+	auto statesMatch = true;
+	auto singleThreadTime = 0.0;
+
+	for (const auto threadCount : g_threadCounts)
+	{
+		world.GetWorkerPool()->SetThreadCount(threadCount);
+
+		const auto integrateTime = TimeMicroseconds(BENCHMARK_REPEAT_COUNT, [&world]() { Integrate(world); });
+		const auto updateTime = TimeMicroseconds(BENCHMARK_REPEAT_COUNT, [&world]() { world.GetPhysicsManager()->UpdateGameObjectPhysics(); });
+
+		//Integrating again from the same state gives the same new state, so the serial world only needs the same number of updates
+		Integrate(serialWorld);
+
+		for (auto i = 0u; i < BENCHMARK_REPEAT_COUNT + 1; i++)
+		{
+			serialWorld.GetPhysicsManager()->UpdateGameObjectPhysics();
+		}
+
+		statesMatch = statesMatch && world.GetPhysicsManager()->CalculateStateHash() == serialWorld.GetPhysicsManager()->CalculateStateHash();
+
+		if (threadCount == g_threadCounts[0])
+		{
+			singleThreadTime = integrateTime;
+		}
+
+		printf("%7u  %12.0f  %9.2f  %13.1f  %7.2f\n", threadCount, integrateTime, updateTime, BENCHMARK_BODY_COUNT / integrateTime, singleThreadTime / integrateTime);
+	}
+
+	Check(statesMatch, "every thread count integrates to the same state as the serial world");
+
+	return CheckResult();
+}
@@ -0,0 +1,67 @@
+#include "HeadlessWorld.h"
+#include "HeadlessTest.h"
+
+//Collision detection on a block of touching spheres for each worker thread count. The broadphase has its own benchmark, its passes
+//are timed by the grid and taken off the total so what's left is the bounds, the pair tests and merging the contact buffers
+
+auto const BENCHMARK_BODY_COUNT = 20000u;
+auto const BENCHMARK_REPEAT_COUNT = 20u;
+auto const SPHERE_DIAMETER = 0.7f;
+
+//Just under the diameter so every sphere touches the six next to it
+auto const SPHERE_SPACING = 0.68f;
+
+static const unsigned int g_threadCounts[] = { 1, 2, 4, 8, 16 };
+
+int main()
+{
+	HeadlessWorld world(1);
+	world.AddSphereBlock(BENCHMARK_BODY_COUNT, SPHERE_DIAMETER, SPHERE_SPACING);
+
+	auto* collisionManager = world.GetCollisionManager();
+
+	printf("%u spheres, %u hardware threads\n", BENCHMARK_BODY_COUNT, WorkerPool::GetDefaultThreadCount());
+	printf("threads  detect us  broadphase us  narrowphase us  speedup\n");
+
+	auto contactCount = 0u;
+	auto contactCountsMatch = true;
+	auto singleThreadTime = 0.0;
+
+	for (const auto threadCount : g_threadCounts)
+	{
+		world.GetWorkerPool()->SetThreadCount(threadCount);
+
+		auto broadphaseTime = 0.0;
+
+		const auto detectTime = TimeMicroseconds(BENCHMARK_REPEAT_COUNT, [&]()
+		{
+			collisionManager->DynamicCollisionDetection();
+
+			const auto& timings = collisionManager->GetBroadphaseTimings();
+			broadphaseTime += timings.cellKeys + timings.entries + timings.sort + timings.pairs;
+		});
+
+		//The warm up call added its broadphase time too
+		broadphaseTime /= BENCHMARK_REPEAT_COUNT + 1;
+
+		const auto threadContactCount = collisionManager->GetContactManifoldReference()->GetNumberOfPoints();
+
+		if (threadCount == g_threadCounts[0])
+		{
+			contactCount = threadContactCount;
+			singleThreadTime = detectTime;
+		}
+
+		contactCountsMatch = contactCountsMatch && threadContactCount == contactCount;
+
+		printf("%7u  %9.0f  %13.0f  %14.0f  %7.2f\n", threadCount, detectTime, broadphaseTime, detectTime - broadphaseTime, singleThreadTime / detectTime);
+	}
+
+	printf("%u contacts\n", contactCount);
+
+	//Each sphere touches up to six neighbours and each touching pair gives one contact
+	Check(contactCount >= BENCHMARK_BODY_COUNT * 2, "every sphere in the block is touching its neighbours");
+	Check(contactCountsMatch, "every thread count finds the same contacts");
+
+	return CheckResult();
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+//Most memory the process has had resident at once in bytes, the peak working set on Windows and the peak RSS everywhere else.
+//Pages of a mapped file only count once they've been touched
+inline unsigned long long PeakResidentBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS memoryCounters;
+
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &memoryCounters, sizeof(memoryCounters)))
+	{
+		return 0;
+	}
+
+	return memoryCounters.PeakWorkingSetSize;
+#else
+	rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0;
+	}
+
+#ifdef __APPLE__
+	return static_cast<unsigned long long>(usage.ru_maxrss);
+#else
+	//Linux reports kilobytes
+	return static_cast<unsigned long long>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
@@ -0,0 +1,212 @@
+#include "QuaternionIntegrator.h"
+#include "HeadlessTest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+//Angle error and cost of QuaternionIntegrator against the roll, pitch and yaw update RigidBody used before it, which read the rotation
+//vector as Euler angles. The error is measured against the exact rotation by |v| about v, each result normalised the way
+//RigidBody::SetRotation normalises it
+
+auto const ROTATION_COUNT = 4096u;
+auto const BENCHMARK_REPEAT_COUNT = 200u;
+
+//Angular velocity times dt for slow, fast and very fast spin at the 60Hz step
+static const float g_rotationSizes[] = { 0.01f, 0.05f, 0.2f };
+
+struct DoubleQuaternion {
+	double x;
+	double y;
+	double z;
+	double w;
+};
+
+//Worked in double so the error of the first order update, under a ten millionth of a radian for slow spin, isn't lost in rounding
+static DoubleQuaternion ToDouble(const XMVECTOR& quaternion)
+{
+	XMFLOAT4 q;
+	XMStoreFloat4(&q, quaternion);
+
+	const auto length = sqrt(static_cast<double>(q.x) * q.x + static_cast<double>(q.y) * q.y + static_cast<double>(q.z) * q.z + static_cast<double>(q.w) * q.w);
+
+	return DoubleQuaternion { q.x / length, q.y / length, q.z / length, q.w / length };
+}
+
+//The exact update, (cos(|v| / 2), sin(|v| / 2) v / |v|) * q with the world space rotation on the left
+static DoubleQuaternion ExactRotation(const XMVECTOR& rotation, const XMVECTOR& rotationVector)
+{
+	const auto q = ToDouble(rotation);
+
+	XMFLOAT3 v;
+	XMStoreFloat3(&v, rotationVector);
+
+	const auto angle = sqrt(static_cast<double>(v.x) * v.x + static_cast<double>(v.y) * v.y + static_cast<double>(v.z) * v.z);
+	const auto scale = sin(angle * 0.5) / angle;
+	const DoubleQuaternion r = { v.x * scale, v.y * scale, v.z * scale, cos(angle * 0.5) };
+
+	return DoubleQuaternion {
+		r.w * q.x + r.x * q.w + r.y * q.z - r.z * q.y,
+		r.w * q.y - r.x * q.z + r.y * q.w + r.z * q.x,
+		r.w * q.z + r.x * q.y - r.y * q.x + r.z * q.w,
+		r.w * q.w - r.x * q.x - r.y * q.y - r.z * q.z
+	};
+}
+
+//Angle of the rotation taking one orientation to the other, from the vector part of the difference so it stays accurate when tiny
+static double AngleBetween(const DoubleQuaternion& a, const DoubleQuaternion& b)
+{
+	const auto x = a.w * b.x - a.x * b.w - a.y * b.z + a.z * b.y;
+	const auto y = a.w * b.y + a.x * b.z - a.y * b.w - a.z * b.x;
+	const auto z = a.w * b.z - a.x * b.y + a.y * b.x - a.z * b.w;
+	const auto w = a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+
+	return 2.0 * atan2(sqrt(x * x + y * y + z * z), fabs(w));
+}
+
+static XMVECTOR RollPitchYawRotation(const XMVECTOR& rotation, const XMVECTOR& rotationVector)
+{
+	return XMQuaternionMultiply(rotation, XMQuaternionRotationRollPitchYawFromVector(rotationVector));
+}
+
+//Random orientations each turned by a random direction scaled to the given size, fixed seed so every run measures the same set
+static void MakeRotations(const float rotationSize, vector<XMVECTOR>& rotations, vector<XMVECTOR>& rotationVectors)
+{
+	mt19937 random(49);
+	normal_distribution<float> component(0.0f, 1.0f);
+
+	rotations.resize(ROTATION_COUNT);
+	rotationVectors.resize(ROTATION_COUNT);
+
+	for (auto i = 0u; i < ROTATION_COUNT; i++)
+	{
+		rotations[i] = XMQuaternionNormalize(XMVectorSet(component(random), component(random), component(random), component(random)));
+		rotationVectors[i] = XMVectorScale(XMVector3Normalize(XMVectorSet(component(random), component(random), component(random), 0.0f)), rotationSize);
+	}
+}
+
+//Same grouping PhysicsManager uses, the last group is short when the count isn't a multiple of four
+static void IntegrateWideAll(vector<XMVECTOR>& rotations, const vector<XMVECTOR>& rotationVectors)
+{
+	for (auto i = 0u; i < rotations.size(); i += QUATERNION_INTEGRATOR_LANES)
+	{
+		const auto count = min(QUATERNION_INTEGRATOR_LANES, static_cast<unsigned int>(rotations.size()) - i);
+
+		QuaternionIntegrator::IntegrateWide(&rotations[i], &rotationVectors[i], count);
+	}
+}
+
+static void TestWideMatchesSingle()
+{
+	vector<XMVECTOR> rotations;
+	vector<XMVECTOR> rotationVectors;
+
+	MakeRotations(0.2f, rotations, rotationVectors);
+
+	//An odd count leaves a group of one at the end
+	rotations.resize(1001);
+	rotationVectors.resize(1001);
+
+	auto wideRotations = rotations;
+	IntegrateWideAll(wideRotations, rotationVectors);
+
+	auto largestDifference = 0.0;
+
+	for (auto i = 0u; i < rotations.size(); i++)
+	{
+		const auto single = QuaternionIntegrator::Integrate(rotations[i], rotationVectors[i]);
+
+		largestDifference = max(largestDifference, AngleBetween(ToDouble(single), ToDouble(wideRotations[i])));
+	}
+
+	Check(largestDifference < 1.0e-6, "four at a time integration matches one at a time");
+}
+
+static void Benchmark()
+{
+	printf("%u rotations, angle error against the exact rotation in radians\n", ROTATION_COUNT);
+
+	for (const auto rotationSize : g_rotationSizes)
+	{
+		vector<XMVECTOR> startRotations;
+		vector<XMVECTOR> rotationVectors;
+
+		MakeRotations(rotationSize, startRotations, rotationVectors);
+
+		auto rollPitchYawError = 0.0;
+		auto firstOrderError = 0.0;
+		auto largestFirstOrderError = 0.0;
+
+		for (auto i = 0u; i < ROTATION_COUNT; i++)
+		{
+			const auto exact = ExactRotation(startRotations[i], rotationVectors[i]);
+			const auto firstOrder = AngleBetween(ToDouble(QuaternionIntegrator::Integrate(startRotations[i], rotationVectors[i])), exact);
+
+			rollPitchYawError += AngleBetween(ToDouble(RollPitchYawRotation(startRotations[i], rotationVectors[i])), exact) / ROTATION_COUNT;
+			firstOrderError += firstOrder / ROTATION_COUNT;
+			largestFirstOrderError = max(largestFirstOrderError, firstOrder);
+		}
+
+		printf("|v| %.2f: roll, pitch and yaw %.2e, first order %.2e (most %.2e)\n", rotationSize, rollPitchYawError, firstOrderError, largestFirstOrderError);
+
+		//Normalising 1 + v / 2 turns by 2 atan(|v| / 2), short of |v| by |v|^3 / 12, the float rounding floor covers the slow spin
+		const auto firstOrderLimit = max(static_cast<double>(rotationSize) * rotationSize * rotationSize / 10.0, 1.0e-6);
+
+		Check(firstOrderError < rollPitchYawError, "the first order update is closer to the exact rotation than roll, pitch and yaw");
+		Check(largestFirstOrderError < firstOrderLimit, "the first order update is only out by the third order term");
+	}
+
+	vector<XMVECTOR> startRotations;
+	vector<XMVECTOR> rotationVectors;
+
+	MakeRotations(0.05f, startRotations, rotationVectors);
+
+	vector<XMVECTOR> rotations;
+
+	//Every version copies the start orientations back and normalises its results, as SetRotation does
+	const auto rollPitchYawTime = TimeMicroseconds(BENCHMARK_REPEAT_COUNT, [&]()
+	{
+		rotations = startRotations;
+
+		for (auto i = 0u; i < ROTATION_COUNT; i++)
+		{
+			rotations[i] = XMQuaternionNormalize(RollPitchYawRotation(rotations[i], rotationVectors[i]));
+		}
+	});
+
+	const auto integrateTime = TimeMicroseconds(BENCHMARK_REPEAT_COUNT, [&]()
+	{
+		rotations = startRotations;
+
+		for (auto i = 0u; i < ROTATION_COUNT; i++)
+		{
+			rotations[i] = XMQuaternionNormalize(QuaternionIntegrator::Integrate(rotations[i], rotationVectors[i]));
+		}
+	});
+
+	const auto integrateWideTime = TimeMicroseconds(BENCHMARK_REPEAT_COUNT, [&]()
+	{
+		rotations = startRotations;
+
+		IntegrateWideAll(rotations, rotationVectors);
+
+		for (auto& rotation : rotations)
+		{
+			rotation = XMQuaternionNormalize(rotation);
+		}
+	});
+
+	printf("Roll, pitch and yaw: %.1f ns per rotation\n", rollPitchYawTime * 1000.0 / ROTATION_COUNT);
+	printf("Integrate: %.1f ns per rotation, %.1fx faster\n", integrateTime * 1000.0 / ROTATION_COUNT, rollPitchYawTime / integrateTime);
+	printf("IntegrateWide: %.1f ns per rotation, %.1fx faster\n", integrateWideTime * 1000.0 / ROTATION_COUNT, rollPitchYawTime / integrateWideTime);
+}
+
+int main()
+{
+	TestWideMatchesSingle();
+
+	Benchmark();
+
+	return CheckResult();
+}
@@ -0,0 +1,170 @@
+#include "ResourceManager.h"
+#include "HeadlessTest.h"
+
+//Checks the asynchronous loading in ResourceManager against a software device, then times startup loading every resource one at a time
+//the way it used to against handing them all to the workers at once. Runs from the framework folder so every file is the one the app loads
+
+auto const BENCHMARK_REPEAT_COUNT = 10u;
+
+//texture1.dds to texture10.dds, asked for by the ResourceManager constructor
+auto const CONSTRUCTOR_TEXTURE_COUNT = 10u;
+
+//Everything GraphicsRenderer and the scene ask for on top of the ten textures the resource manager loads itself
+static const char* const g_modelFileNames[] = { "sphere.obj", "cube.obj", "plane.obj", "cylinder.obj" };
+static const WCHAR* const g_textureFileNames[] = { L"walls.dds", L"bins.dds", L"sphere.dds", L"sphere2.dds" };
+
+static ID3D11Device* CreateDevice()
+{
+	//WARP is the software rasterizer that ships with Windows, so the test doesn't need a graphics card
+	ID3D11Device* device = nullptr;
+
+	const auto result = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_WARP, nullptr, 0, nullptr, 0, D3D11_SDK_VERSION, &device, nullptr, nullptr);
+
+	if (FAILED(result))
+	{
+		return nullptr;
+	}
+
+	return device;
+}
+
+static void RequestAll(ResourceManager& resourceManager)
+{
+	for (const auto* modelFileName : g_modelFileNames)
+	{
+		resourceManager.GetModelHandle(modelFileName);
+	}
+
+	for (const auto* textureFileName : g_textureFileNames)
+	{
+		resourceManager.GetTextureHandle(textureFileName);
+	}
+}
+
+static void TestHandles(ID3D11Device* device)
+{
+	ResourceManager resourceManager(device);
+
+	const auto modelHandle = resourceManager.GetModelHandle("sphere.obj");
+	const auto textureHandle = resourceManager.GetTextureHandle(L"sphere2.dds");
+
+	Check(resourceManager.GetModelHandle("sphere.obj") == modelHandle, "asking for a model again gives the same handle");
+	Check(resourceManager.GetTextureHandle(L"sphere2.dds") == textureHandle, "asking for a texture again gives the same handle");
+	Check(resourceManager.GetModelHandle("cube.obj") != modelHandle, "different models get different handles");
+
+	//Nothing is created until CompleteLoads, so the handles are usable straight away with nothing to draw
+	Check(resourceManager.HasPendingLoads(), "handles are returned before the loads finish");
+	Check(resourceManager.GetIndexCount(modelHandle) == 0, "a model draws nothing until it's created");
+
+	const auto* placeholderTexture = resourceManager.GetTexture(textureHandle);
+
+	resourceManager.CompleteLoads(device, true);
+
+	Check(!resourceManager.HasPendingLoads(), "waiting for every load leaves nothing pending");
+	Check(resourceManager.GetFailedLoadCount() == 0, "every file loads");
+	Check(resourceManager.GetIndexCount(modelHandle) > 0, "the model has its indices once it's created");
+	Check(resourceManager.GetTexture(textureHandle) != nullptr && resourceManager.GetTexture(textureHandle) != placeholderTexture, "the texture replaces the placeholder once it's created");
+}
+
+static void TestEveryResourceLoads(ID3D11Device* device)
+{
+	ResourceManager resourceManager(device);
+
+	RequestAll(resourceManager);
+	resourceManager.CompleteLoads(device, true);
+
+	auto modelsLoaded = true;
+
+	for (auto i = 0u; i < resourceManager.GetModelCount(); i++)
+	{
+		const auto& loadInformation = resourceManager.GetModelLoadInformation(i);
+
+		modelsLoaded = modelsLoaded && loadInformation.loaded && !loadInformation.loadFailed && loadInformation.indexCount > 0;
+	}
+
+	Check(resourceManager.GetModelCount() == sizeof(g_modelFileNames) / sizeof(g_modelFileNames[0]), "one model for each file");
+	Check(modelsLoaded, "every model the app uses loads");
+	Check(resourceManager.GetFailedLoadCount() == 0, "every texture the app uses loads");
+}
+
+static void TestMissingFile(ID3D11Device* device)
+{
+	ResourceManager resourceManager(device);
+
+	const auto modelHandle = resourceManager.GetModelHandle("missing.obj");
+	const auto textureHandle = resourceManager.GetTextureHandle(L"missing.dds");
+
+	const auto* placeholderTexture = resourceManager.GetTexture(textureHandle);
+
+	resourceManager.CompleteLoads(device, true);
+
+	Check(resourceManager.GetFailedLoadCount() == 2, "missing files are counted as failed loads");
+	Check(resourceManager.GetModelLoadInformation(modelHandle).loadFailed && resourceManager.GetIndexCount(modelHandle) == 0, "a missing model draws nothing");
+	Check(resourceManager.GetTexture(textureHandle) == placeholderTexture, "a missing texture keeps the placeholder");
+}
+
+static void Benchmark(ID3D11Device* device)
+{
+	//Every request waited for before the next, which is how the constructors used to load
+	const auto serialTime = TimeMicroseconds(BENCHMARK_REPEAT_COUNT, [&]()
+	{
+		ResourceManager resourceManager(device);
+
+		resourceManager.CompleteLoads(device, true);
+
+		for (const auto* modelFileName : g_modelFileNames)
+		{
+			resourceManager.GetModelHandle(modelFileName);
+			resourceManager.CompleteLoads(device, true);
+		}
+
+		for (const auto* textureFileName : g_textureFileNames)
+		{
+			resourceManager.GetTextureHandle(textureFileName);
+			resourceManager.CompleteLoads(device, true);
+		}
+	});
+
+	//What startup waits for now, the first frame is drawn with placeholders while the workers carry on
+	auto requestTime = 0.0;
+
+	const auto asyncTime = TimeMicroseconds(BENCHMARK_REPEAT_COUNT, [&]()
+	{
+		const auto start = chrono::steady_clock::now();
+
+		ResourceManager resourceManager(device);
+		RequestAll(resourceManager);
+
+		requestTime += chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+
+		resourceManager.CompleteLoads(device, true);
+	});
+
+	//The warm up call is counted in the request time too
+	requestTime /= BENCHMARK_REPEAT_COUNT + 1;
+
+	printf("%zu models and %zu textures, the mesh cache and file cache are warm after the first load\n", sizeof(g_modelFileNames) / sizeof(g_modelFileNames[0]), CONSTRUCTOR_TEXTURE_COUNT + sizeof(g_textureFileNames) / sizeof(g_textureFileNames[0]));
+	printf("One at a time: %.1fus\n", serialTime);
+	printf("Asynchronous: %.1fus until every resource is created, %.1fus until startup has its handles\n", asyncTime, requestTime);
+}
+
+int main()
+{
+	auto* device = CreateDevice();
+
+	if (!Check(device != nullptr, "a WARP device can be created"))
+	{
+		return CheckResult();
+	}
+
+	TestHandles(device);
+	TestEveryResourceLoads(device);
+	TestMissingFile(device);
+
+	Benchmark(device);
+
+	device->Release();
+	device = nullptr;
+
+	return CheckResult();
+}
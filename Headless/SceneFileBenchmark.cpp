@@ -0,0 +1,104 @@
+#include "SceneFile.h"
+#include "HeadlessTest.h"
+
+#include <cstring>
+#include <filesystem>
+#include <random>
+
+//Load time of a 100k body scene in the text and binary forms, against the tens of milliseconds a scene that size should take to
+//load before any game objects are created. Both forms are checked to read back exactly the scene that was saved
+
+auto const SCENE_BODY_COUNT = 100000u;
+auto const TEXT_REPEAT_COUNT = 3u;
+auto const BINARY_REPEAT_COUNT = 20u;
+auto const BINARY_LOAD_LIMIT_MILLISECONDS = 50.0;
+
+static const wchar_t* const g_textureNames[] = { L"sphere.dds", L"sphere2.dds", L"walls.dds", L"bins.dds" };
+
+//Positions and sizes are on a quarter unit grid so the text form, which only writes six significant figures, reads them back exactly
+static void MakeScene(SceneFile& scene)
+{
+	mt19937 generator(37);
+	uniform_int_distribution<int> cell(-400, 400);
+	uniform_int_distribution<int> size(1, 8);
+
+	for (const auto* textureName : g_textureNames)
+	{
+		scene.AddTexture(textureName);
+	}
+
+	for (auto i = 0u; i < SCENE_BODY_COUNT; i++)
+	{
+		SceneFile::SceneBody body;
+		memset(&body, 0, sizeof(body));
+
+		const auto isBox = i % 4 == 0;
+		const auto side = size(generator) * 0.25f;
+
+		body.position = XMFLOAT3(cell(generator) * 0.25f, cell(generator) * 0.25f + 120.0f, cell(generator) * 0.25f);
+		body.rotation = isBox ? XMFLOAT3(0.25f, 0.5f, 0.75f) : XMFLOAT3(0.0f, 0.0f, 0.0f);
+		body.scale = isBox ? XMFLOAT3(side, side * 0.5f, side * 0.75f) : XMFLOAT3(side, side, side);
+		body.mass = isBox ? 0.5f : 0.25f;
+		body.drag = 0.125f;
+		body.angularDrag = 0.125f;
+		body.colliderType = isBox ? 2 : 0; //OBBCube or Sphere
+		body.modelType = isBox ? 1 : 0; //Cube or Sphere
+		body.useGravity = i % 50 == 0 ? 0 : 1;
+		body.textureIndex = i % (sizeof(g_textureNames) / sizeof(g_textureNames[0]));
+
+		scene.AddBody(body);
+	}
+}
+
+static bool MatchesScene(const SceneFile& loaded, const SceneFile& scene)
+{
+	return loaded.GetTextureNames() == scene.GetTextureNames() && loaded.GetBodies().size() == scene.GetBodies().size() &&
+		memcmp(loaded.GetBodies().data(), scene.GetBodies().data(), scene.GetBodies().size() * sizeof(SceneFile::SceneBody)) == 0;
+}
+
+int main()
+{
+	SceneFile scene;
+	MakeScene(scene);
+
+	//Kept out of the framework folder the tests run in
+	const auto directory = filesystem::temp_directory_path();
+	const auto textFileName = (directory / "SceneFileBenchmark.txt").string();
+	const auto binaryFileName = (directory / "SceneFileBenchmark.scene").string();
+
+	if (!Check(scene.SaveText(textFileName.c_str()) && scene.SaveBinary(binaryFileName.c_str()), "both forms of the scene save"))
+	{
+		return CheckResult();
+	}
+
+	SceneFile textScene;
+	SceneFile binaryScene;
+
+	auto textLoaded = true;
+	auto binaryLoaded = true;
+
+	//Load picks the form from the magic number the way the renderer loads its scene
+	const auto textTime = TimeMicroseconds(TEXT_REPEAT_COUNT, [&]()
+	{
+		textLoaded = textScene.Load(textFileName.c_str()) && textLoaded;
+	});
+
+	const auto binaryTime = TimeMicroseconds(BINARY_REPEAT_COUNT, [&]()
+	{
+		binaryLoaded = binaryScene.Load(binaryFileName.c_str()) && binaryLoaded;
+	});
+
+	printf("%u bodies, text %.1f MB and binary %.1f MB\n", SCENE_BODY_COUNT,
+		filesystem::file_size(textFileName) / (1024.0 * 1024.0), filesystem::file_size(binaryFileName) / (1024.0 * 1024.0));
+	printf("Text load: %.1f ms\n", textTime / 1000.0);
+	printf("Binary load: %.1f ms, %.0fx faster\n", binaryTime / 1000.0, textTime / binaryTime);
+
+	Check(textLoaded && MatchesScene(textScene, scene), "the text form reads back the scene that was saved");
+	Check(binaryLoaded && MatchesScene(binaryScene, scene), "the binary form reads back the scene that was saved");
+	Check(binaryTime / 1000.0 < BINARY_LOAD_LIMIT_MILLISECONDS, "the binary form loads a 100k body scene in tens of milliseconds");
+
+	filesystem::remove(textFileName);
+	filesystem::remove(binaryFileName);
+
+	return CheckResult();
+}
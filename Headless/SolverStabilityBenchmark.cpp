@@ -0,0 +1,155 @@
+#include "HeadlessWorld.h"
+#include "HeadlessTest.h"
+
+#include <cmath>
+
+//Resting penetration, leftover motion and step time of columns of spheres standing on the floor after they've had time to settle, for
+//the one step solver and for substepping with different numbers of sweeps per substep. This is what SUBSTEP_SOLVER_PASSES and
+//COLOURED_SUBSTEP_SOLVER_PASSES are chosen from, and two substeps at either has to rest the columns at least as well as one step.
+//Every sphere sits straight on top of the one below so the contact normals are exactly vertical and a column can only sink, never topple.
+//The 5 by 5 columns have few enough contacts to be solved one contact at a time. The 18 by 18 ones keep over a thousand contacts
+//even while the tops of the columns bounce, so every step goes through the coloured batches
+
+static const unsigned int g_columnsPerSide[] = { 5, 18 };
+
+auto const COLOURED_COLUMNS_PER_SIDE = 18u;
+
+auto const COLUMN_HEIGHT = 10u;
+auto const SPHERE_DIAMETER = 0.7f;
+
+//Far enough apart that neighbouring columns never touch
+auto const COLUMN_SPACING = 1.0f;
+
+//The floor holds a resting sphere's centre at one minus its radius, every sphere starts exactly touching the one below
+auto const COLUMN_BOTTOM = 1.0f - SPHERE_DIAMETER / 2;
+
+//Two seconds to settle, then measured over the next second
+auto const SETTLE_STEP_COUNT = 120u;
+auto const MEASURE_STEP_COUNT = 60u;
+
+struct SolverSettings {
+	unsigned int substepCount;
+	int passes;
+};
+
+struct StabilityResult {
+	float meanPenetration;
+	float maximumPenetration;
+	float maximumSpeed;
+	double stepTime;
+	bool allFinite;
+};
+
+static const SolverSettings g_settings[] = {
+	{ 1, 0 },
+	{ 2, 1 }, { 2, 2 }, { 2, 4 }, { 2, 8 },
+	{ 4, 1 }, { 4, 2 }, { 4, 4 }, { 4, 8 },
+	{ 8, 1 }, { 8, 2 }
+};
+
+static StabilityResult Measure(const unsigned int columnsPerSide, const SolverSettings& settings)
+{
+	HeadlessWorld world(1);
+
+	world.AddFloor();
+
+	for (auto x = 0u; x < columnsPerSide; x++)
+	{
+		for (auto z = 0u; z < columnsPerSide; z++)
+		{
+			for (auto y = 0u; y < COLUMN_HEIGHT; y++)
+			{
+				world.AddSphere(XMFLOAT3(x * COLUMN_SPACING, COLUMN_BOTTOM + y * SPHERE_DIAMETER, z * COLUMN_SPACING), SPHERE_DIAMETER);
+			}
+		}
+	}
+
+	StabilityResult result = {};
+	result.allFinite = true;
+
+	for (auto step = 0u; step < SETTLE_STEP_COUNT + MEASURE_STEP_COUNT; step++)
+	{
+		//Each size of scene only ever reaches one of the solvers, so the passes go to both
+		world.Step(HEADLESS_SIMULATION_STEP, settings.substepCount, settings.passes, settings.passes);
+
+		if (step < SETTLE_STEP_COUNT)
+		{
+			continue;
+		}
+
+		const auto& stageTimes = world.GetStageTimes();
+
+		result.meanPenetration += world.GetPenetration().mean / MEASURE_STEP_COUNT;
+		result.maximumPenetration = max(result.maximumPenetration, world.GetPenetration().maximum);
+		result.stepTime += (stageTimes.integrate + stageTimes.detect + stageTimes.resolve + stageTimes.update) / MEASURE_STEP_COUNT;
+
+		for (const auto* gameObject : world.GetGameObjects())
+		{
+			auto* rigidBody = gameObject->GetRigidBodyComponent();
+
+			if (!rigidBody->GetUseGravity())
+			{
+				continue;
+			}
+
+			auto position = XMVECTOR();
+			auto velocity = XMVECTOR();
+
+			rigidBody->GetPosition(position);
+			rigidBody->GetVelocity(velocity);
+
+			XMFLOAT3 storedPosition;
+			XMStoreFloat3(&storedPosition, position);
+
+			result.allFinite = result.allFinite && isfinite(storedPosition.x) && isfinite(storedPosition.y) && isfinite(storedPosition.z);
+			result.maximumSpeed = max(result.maximumSpeed, XMVectorGetX(XMVector3Length(velocity)));
+		}
+	}
+
+	return result;
+}
+
+int main()
+{
+	auto allFinite = true;
+
+	for (const auto columnsPerSide : g_columnsPerSide)
+	{
+		printf("%u by %u columns %u high, measured over steps %u to %u\n", columnsPerSide, columnsPerSide, COLUMN_HEIGHT, SETTLE_STEP_COUNT, SETTLE_STEP_COUNT + MEASURE_STEP_COUNT);
+		printf("substeps  passes  mean penetration  max penetration  max speed  step us\n");
+
+		const auto defaultPasses = columnsPerSide == COLOURED_COLUMNS_PER_SIDE ? COLOURED_SUBSTEP_SOLVER_PASSES : SUBSTEP_SOLVER_PASSES;
+
+		auto oneStepPenetration = 0.0f;
+		auto defaultPenetration = 0.0f;
+
+		for (const auto& settings : g_settings)
+		{
+			const auto result = Measure(columnsPerSide, settings);
+
+			if (settings.substepCount == 1)
+			{
+				printf("%8u  %6s  %16.5f  %15.5f  %9.4f  %7.0f\n", settings.substepCount, "-", result.meanPenetration, result.maximumPenetration, result.maximumSpeed, result.stepTime);
+
+				oneStepPenetration = result.meanPenetration;
+			}
+			else
+			{
+				printf("%8u  %6d  %16.5f  %15.5f  %9.4f  %7.0f\n", settings.substepCount, settings.passes, result.meanPenetration, result.maximumPenetration, result.maximumSpeed, result.stepTime);
+
+				if (settings.substepCount == 2 && settings.passes == defaultPasses)
+				{
+					defaultPenetration = result.meanPenetration;
+				}
+			}
+
+			allFinite = allFinite && result.allFinite;
+		}
+
+		Check(defaultPenetration > 0.0f && defaultPenetration <= oneStepPenetration, "two substeps at the default passes rest the columns at least as well as one step");
+	}
+
+	Check(allFinite, "every setting keeps the spheres finite");
+
+	return CheckResult();
+}
@@ -0,0 +1,160 @@
+#include "TextureArrayPacker.h"
+#include "DDSFile.h"
+#include "HeadlessTest.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+//Grouping, layer order and subresource checks for TextureArrayPacker, then packing the textures the app loads described from their files
+
+//Stand ins for DXGI formats, the packer only compares them
+auto const FORMAT_RGBA = 28u;
+auto const FORMAT_BC1 = 71u;
+
+//Every texture ResourceManager loads, texture1 to texture10 are the ones collisions swap between
+static const char* const g_loadedFileNames[] = {
+	"texture1.dds", "texture2.dds", "texture3.dds", "texture4.dds", "texture5.dds",
+	"texture6.dds", "texture7.dds", "texture8.dds", "texture9.dds", "texture10.dds",
+	"walls.dds", "bins.dds", "sphere.dds", "sphere2.dds"
+};
+
+static TextureArrayPacker::TextureDescription Describe(const unsigned int width, const unsigned int height, const unsigned int mipLevels, const unsigned int format)
+{
+	TextureArrayPacker::TextureDescription description;
+	description.width = width;
+	description.height = height;
+	description.mipLevels = mipLevels;
+	description.format = format;
+
+	return description;
+}
+
+static void TestEmpty()
+{
+	TextureArrayPacker packer;
+
+	Check(packer.GetArrayCount() == 0 && packer.GetPlacements().empty(), "a new packer has no arrays");
+}
+
+static void TestSameDescriptionShareAnArray()
+{
+	TextureArrayPacker packer;
+
+	for (auto i = 0u; i < 10; i++)
+	{
+		packer.Add(Describe(256, 256, 1, FORMAT_RGBA));
+	}
+
+	auto layersInOrder = true;
+
+	for (auto i = 0u; i < packer.GetPlacements().size(); i++)
+	{
+		layersInOrder = layersInOrder && packer.GetPlacements()[i].array == 0 && packer.GetPlacements()[i].layer == i && packer.GetTextureIndex(0, i) == i;
+	}
+
+	Check(packer.GetArrayCount() == 1 && packer.GetLayerCount(0) == 10, "ten matching textures go into one array");
+	Check(layersInOrder, "layers are handed out in the order textures are added");
+}
+
+static void TestDifferentDescriptionsSplit()
+{
+	TextureArrayPacker packer;
+
+	packer.Add(Describe(256, 256, 1, FORMAT_RGBA));
+	packer.Add(Describe(128, 256, 1, FORMAT_RGBA)); //Width
+	packer.Add(Describe(256, 128, 1, FORMAT_RGBA)); //Height
+	packer.Add(Describe(256, 256, 9, FORMAT_RGBA)); //Mip count
+	packer.Add(Describe(256, 256, 1, FORMAT_BC1)); //Format
+	packer.Add(Describe(256, 256, 1, FORMAT_RGBA)); //Back to the first
+
+	const auto& placements = packer.GetPlacements();
+
+	Check(packer.GetArrayCount() == 5, "textures differing in size, mip count or format get their own arrays");
+	Check(placements[5].array == placements[0].array && placements[5].layer == 1, "a later match joins the earlier array");
+
+	//The interleaved adds still map back to the right texture from each array's layers
+	Check(packer.GetTextureIndex(placements[0].array, 0) == 0 && packer.GetTextureIndex(placements[5].array, 1) == 5, "texture indices come back from each array layer");
+	Check(packer.GetArrayDescription(placements[3].array).mipLevels == 9 && packer.GetArrayDescription(placements[4].array).format == FORMAT_BC1, "each array keeps the description it was made for");
+}
+
+static void TestSubresources()
+{
+	//Same as D3D11CalcSubresource, every mip of a layer then the next layer, with no gaps or repeats
+	const auto mipLevels = 9u;
+	const auto layerCount = 10u;
+
+	vector<unsigned int> subresources;
+
+	for (auto layer = 0u; layer < layerCount; layer++)
+	{
+		for (auto mipLevel = 0u; mipLevel < mipLevels; mipLevel++)
+		{
+			subresources.push_back(TextureArrayPacker::GetSubresource(mipLevel, layer, mipLevels));
+		}
+	}
+
+	auto consecutive = true;
+
+	for (auto i = 0u; i < subresources.size(); i++)
+	{
+		consecutive = consecutive && subresources[i] == i;
+	}
+
+	Check(TextureArrayPacker::GetSubresource(3, 2, mipLevels) == 21, "subresource is the mip plus the layer times the mip count");
+	Check(consecutive, "every mip of every layer has its own subresource in order");
+}
+
+static void TestClear()
+{
+	TextureArrayPacker packer;
+
+	packer.Add(Describe(256, 256, 1, FORMAT_RGBA));
+	packer.Add(Describe(64, 64, 1, FORMAT_RGBA));
+	packer.Clear();
+	packer.Add(Describe(64, 64, 1, FORMAT_RGBA));
+
+	Check(packer.GetArrayCount() == 1 && packer.GetPlacements().size() == 1, "clear drops every array");
+	Check(packer.GetPlacements()[0].array == 0 && packer.GetPlacements()[0].layer == 0, "arrays start from zero again after a clear");
+}
+
+static void TestLoadedTextures()
+{
+	TextureArrayPacker packer;
+
+	auto allRead = true;
+
+	for (const auto* fileName : g_loadedFileNames)
+	{
+		ifstream file(fileName, ios::binary);
+		const vector<uint8_t> data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+		DDSFileLayout layout;
+
+		if (!ParseDDSFile(data.data(), data.size(), layout))
+		{
+			allRead = false;
+			continue;
+		}
+
+		//None of them have a DX10 header, the bit count stands in for the format and a mip count of zero means one like the loader
+		packer.Add(Describe(layout.header->width, layout.header->height, max(layout.header->mipMapCount, 1u), layout.header->ddspf.RGBBitCount));
+	}
+
+	Check(allRead, "every texture the app loads can be read");
+	Check(packer.GetArrayCount() == 1 && packer.GetLayerCount(0) == sizeof(g_loadedFileNames) / sizeof(g_loadedFileNames[0]), "every texture the app loads fits in one array");
+
+	printf("%zu textures, %u texture arrays\n", sizeof(g_loadedFileNames) / sizeof(g_loadedFileNames[0]), packer.GetArrayCount());
+}
+
+int main()
+{
+	TestEmpty();
+	TestSameDescriptionShareAnArray();
+	TestDifferentDescriptionsSplit();
+	TestSubresources();
+	TestClear();
+	TestLoadedTextures();
+
+	return CheckResult();
+}
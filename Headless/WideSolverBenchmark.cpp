@@ -0,0 +1,91 @@
+#include "HeadlessWorld.h"
+#include "HeadlessTest.h"
+
+#include <cmath>
+
+//Coloured velocity batches solved one contact at a time and four at a time with the WideContactSolver, on the same 20k sphere block
+//resting on the floor. Throughput is the contacts the velocity batches solve per microsecond, as the renderer's console shows it.
+//Only the time inside ApplyBatchVelocityChanges is counted, bringing each contact up to date and solving it but not handing the
+//chunks out, so the velocity time is part of the resolve time next to it, which also has preparing the contacts and the position batches
+
+auto const BENCHMARK_BODY_COUNT = 20000u;
+auto const BENCHMARK_STEP_COUNT = 10u;
+auto const SPHERE_DIAMETER = 0.7f;
+auto const SPHERE_SPACING = 0.68f;
+
+//The two solvers differ in the last bits, which a pile soon grows into visibly different motion, so they're only compared after
+//the first step
+auto const MAXIMUM_POSITION_DIFFERENCE = 0.001f;
+
+struct SolverResult {
+	double solveRate;
+	double solveTime;
+	double resolveTime;
+	vector<XMFLOAT3> positions;
+};
+
+static SolverResult RunSolver(const bool wideSolver)
+{
+	HeadlessWorld world(1);
+	world.AddFloor();
+	world.AddSphereBlock(BENCHMARK_BODY_COUNT, SPHERE_DIAMETER, SPHERE_SPACING);
+	world.GetResolutionManager()->SetWideSolver(wideSolver);
+
+	SolverResult result = {};
+
+	for (auto step = 0u; step < BENCHMARK_STEP_COUNT; step++)
+	{
+		world.Step(HEADLESS_SIMULATION_STEP);
+
+		result.solveRate += world.GetResolutionManager()->GetVelocitySolveRate();
+		result.solveTime += world.GetResolutionManager()->GetVelocitySolveMicroseconds();
+		result.resolveTime += world.GetStageTimes().resolve;
+
+		if (step == 0)
+		{
+			for (const auto* gameObject : world.GetGameObjects())
+			{
+				auto position = XMVECTOR();
+				gameObject->GetRigidBodyComponent()->GetPosition(position);
+
+				result.positions.emplace_back();
+				XMStoreFloat3(&result.positions.back(), position);
+			}
+		}
+	}
+
+	result.solveRate /= BENCHMARK_STEP_COUNT;
+	result.solveTime /= BENCHMARK_STEP_COUNT;
+	result.resolveTime /= BENCHMARK_STEP_COUNT;
+
+	return result;
+}
+
+int main()
+{
+	const auto scalar = RunSolver(false);
+	const auto wide = RunSolver(true);
+
+	auto largestDifference = 0.0f;
+	auto allFinite = true;
+
+	for (auto i = 0u; i < wide.positions.size(); i++)
+	{
+		const auto& position = wide.positions[i];
+
+		allFinite = allFinite && isfinite(position.x) && isfinite(position.y) && isfinite(position.z);
+		largestDifference = max(largestDifference, max(abs(position.x - scalar.positions[i].x), max(abs(position.y - scalar.positions[i].y), abs(position.z - scalar.positions[i].z))));
+	}
+
+	printf("%u spheres, %u steps, one thread\n", BENCHMARK_BODY_COUNT, BENCHMARK_STEP_COUNT);
+	printf("solver  contacts per us  velocity us  resolve us\n");
+	printf("scalar  %15.2f  %11.0f  %10.0f\n", scalar.solveRate, scalar.solveTime, scalar.resolveTime);
+	printf("wide    %15.2f  %11.0f  %10.0f\n", wide.solveRate, wide.solveTime, wide.resolveTime);
+	printf("Wide is %.2fx the scalar velocity throughput, largest position difference after one step %f\n", wide.solveRate / scalar.solveRate, largestDifference);
+
+	Check(scalar.solveRate > 0.0 && wide.solveRate > 0.0, "both solvers go through the coloured velocity batches");
+	Check(allFinite, "the wide solver keeps every body finite");
+	Check(largestDifference < MAXIMUM_POSITION_DIFFERENCE, "one step of the wide solver ends close to the scalar one");
+
+	return CheckResult();
+}
@@ -0,0 +1,142 @@
+#include "HeadlessWorld.h"
+#include "HeadlessTest.h"
+
+#include <filesystem>
+
+//Restoring a world snapshot has to put the simulation back exactly where it was captured. Each test captures a settled world, steps it,
+//restores the snapshot and steps again, and the state hash after every step has to match the first run. Restoring over the same
+//objects writes the state in place, restoring over a different set of objects rebuilds them first, and both paths are covered
+
+auto const SCENE_FILE_NAME = "scene.txt";
+auto const SPHERE_COUNT = 150;
+auto const SPHERE_DIAMETER = 0.7f;
+auto const SETTLE_STEP_COUNT = 120u;
+auto const COMPARED_STEP_COUNT = 120u;
+
+static bool CreateWorld(HeadlessWorld& world)
+{
+	if (!Check(!world.AddScene(SCENE_FILE_NAME), "the scene file loads without a device"))
+	{
+		return false;
+	}
+
+	world.AddSpheres(SPHERE_COUNT, SPHERE_DIAMETER);
+	world.AddCube();
+
+	//Part way down so bodies are falling, colliding and resting when the snapshot is taken
+	for (auto step = 0u; step < SETTLE_STEP_COUNT; step++)
+	{
+		world.Step(HEADLESS_SIMULATION_STEP);
+	}
+
+	return true;
+}
+
+static vector<unsigned long long> StepHashes(HeadlessWorld& world)
+{
+	vector<unsigned long long> stateHashes;
+
+	for (auto step = 0u; step < COMPARED_STEP_COUNT; step++)
+	{
+		world.Step(HEADLESS_SIMULATION_STEP);
+		stateHashes.push_back(world.GetPhysicsManager()->CalculateStateHash());
+	}
+
+	return stateHashes;
+}
+
+static void TestRestoreInPlace()
+{
+	HeadlessWorld world(1);
+
+	if (!CreateWorld(world))
+	{
+		return;
+	}
+
+	WorldSnapshot worldSnapshot;
+	worldSnapshot.Capture(world.GetGameObjects(), nullptr, world.GetWorldSettings());
+
+	const auto capturedHash = world.GetPhysicsManager()->CalculateStateHash();
+	const auto firstRun = StepHashes(world);
+
+	Check(worldSnapshot.MatchesObjects(world.GetGameObjects()), "the same objects match the snapshot so it's restored in place");
+
+	world.RestoreWorldSnapshot(worldSnapshot);
+
+	Check(world.GetPhysicsManager()->CalculateStateHash() == capturedHash, "restoring in place gives the captured state");
+	Check(StepHashes(world) == firstRun, "stepping after restoring in place takes the same steps");
+}
+
+static void TestRestoreRebuilt()
+{
+	HeadlessWorld world(1);
+
+	if (!CreateWorld(world))
+	{
+		return;
+	}
+
+	WorldSnapshot worldSnapshot;
+	worldSnapshot.Capture(world.GetGameObjects(), nullptr, world.GetWorldSettings());
+
+	const auto capturedHash = world.GetPhysicsManager()->CalculateStateHash();
+	const auto firstRun = StepHashes(world);
+
+	//A different set of bodies, the way clearing or spawning in the app leaves them before a snapshot is loaded
+	world.RemoveMoveable();
+	world.AddSpheres(20, 1.0f);
+
+	Check(!worldSnapshot.MatchesObjects(world.GetGameObjects()), "a different set of objects doesn't match the snapshot so they're rebuilt");
+
+	world.RestoreWorldSnapshot(worldSnapshot);
+
+	Check(world.GetGameObjects().size() == worldSnapshot.GetObjectCount(), "rebuilding creates one object per snapshot object");
+	Check(world.GetPhysicsManager()->CalculateStateHash() == capturedHash, "rebuilding gives the captured state");
+	Check(StepHashes(world) == firstRun, "stepping after rebuilding takes the same steps");
+}
+
+static void TestRestoreFromFile()
+{
+	HeadlessWorld world(1);
+
+	if (!CreateWorld(world))
+	{
+		return;
+	}
+
+	//Kept out of the framework folder the tests run in
+	const auto fileName = (filesystem::temp_directory_path() / "WorldSnapshotTest.snapshot").string();
+
+	WorldSnapshot worldSnapshot;
+	worldSnapshot.Capture(world.GetGameObjects(), nullptr, world.GetWorldSettings());
+
+	if (!Check(worldSnapshot.Save(fileName.c_str()), "the snapshot saves"))
+	{
+		return;
+	}
+
+	const auto firstRun = StepHashes(world);
+
+	//A new world starts empty, so everything is rebuilt from the file
+	HeadlessWorld restoredWorld(1);
+	WorldSnapshot loadedSnapshot;
+
+	if (Check(loadedSnapshot.Load(fileName.c_str()), "the saved snapshot loads"))
+	{
+		restoredWorld.RestoreWorldSnapshot(loadedSnapshot);
+
+		Check(StepHashes(restoredWorld) == firstRun, "a new world restored from the file takes the same steps");
+	}
+
+	filesystem::remove(fileName);
+}
+
+int main()
+{
+	TestRestoreInPlace();
+	TestRestoreRebuilt();
+	TestRestoreFromFile();
+
+	return CheckResult();
+}